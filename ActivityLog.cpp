@@ -0,0 +1,100 @@
+/*
+ * ActivityLog.cpp - Device Activity Log Implementation
+ */
+
+#include "data/ActivityLog.h"
+#include "core/Clock.h"
+
+// ============== Activity Log ==============
+ActivityEntry activityLog[MAX_ACTIVITY_LOG];
+int activityLogCount = 0;
+int activityLogIndex = 0;
+
+void logActivity(const Device* dev, const DeviceReading& r) {
+    ActivityEntry* entry = &activityLog[activityLogIndex];
+    entry->timestamp = clockMillis();
+    entry->device = (uint8_t)(dev - devices);
+    entry->fields = r.fields;
+    entry->temp_x10 = (int16_t)lroundf(constrain(r.temperature, -3000.0f, 3000.0f) * 10);
+    entry->humidity = (uint8_t)constrain((int)r.humidity, 0, 255);
+    entry->battery = (uint8_t)constrain(r.battery, 0, 255);
+    entry->lux = (uint16_t)constrain(r.lux, 0, 65535);
+
+    activityLogIndex = (activityLogIndex + 1) % MAX_ACTIVITY_LOG;
+    if (activityLogCount < MAX_ACTIVITY_LOG) {
+        activityLogCount++;
+    }
+}
+
+void clearActivityLog() {
+    activityLogCount = 0;
+    activityLogIndex = 0;
+}
+
+bool removeActivity(int idx) {
+    if (idx < 0 || idx >= MAX_ACTIVITY_LOG) return false;
+    activityLog[idx].device = ACTIVITY_NO_DEVICE;
+    return true;
+}
+
+void forgetActivityDevice(int device) {
+    for (int i = 0; i < MAX_ACTIVITY_LOG; i++) {
+        if (activityLog[i].device == device) activityLog[i].device = ACTIVITY_NO_DEVICE;
+    }
+}
+
+int getActivitySlot(int n) {
+    return (activityLogIndex - 1 - n + 2 * MAX_ACTIVITY_LOG) % MAX_ACTIVITY_LOG;
+}
+
+const char* getActivityDeviceName(const ActivityEntry& entry) {
+    if (entry.device >= device_count) return "?";
+    return devices[entry.device].name;
+}
+
+// ============== Formatting ==============
+size_t formatActivity(const ActivityEntry& entry, char* out, size_t len) {
+    size_t n = 0;
+    out[0] = 0;
+
+#define APPEND(...) \
+    if (n < len) n += snprintf(out + n, len - n, __VA_ARGS__)
+
+    if (entry.fields & ACT_TEMP) {
+        APPEND("%.1f°C ", entry.temp_x10 / 10.0f);
+    }
+    if (entry.fields & ACT_HUM) {
+        APPEND("%u%% ", entry.humidity);
+    }
+    if (entry.fields & ACT_BATT) {
+        APPEND("bat %u%% ", entry.battery);
+    }
+    if (entry.fields & ACT_LUX) {
+        APPEND("%u lx ", entry.lux);
+    }
+    if (entry.fields & ACT_MOTION) {
+        APPEND("%s ", (entry.fields & ACT_MOTION_ON) ? "motion" : "clear");
+    }
+    if (entry.fields & ACT_CONTACT) {
+        APPEND("%s ", (entry.fields & ACT_CONTACT_CLOSED) ? "closed" : "open");
+    }
+
+#undef APPEND
+
+    if (n >= len) n = len - 1;
+    // Drop the trailing separator
+    if (n > 0 && out[n - 1] == ' ') out[--n] = 0;
+    return n;
+}
+
+// ============== Event Sink ==============
+static void activitySink(const DeviceEvent& ev) {
+    const Device* dev = getEventDevice(ev);
+    if (dev) logActivity(dev, ev.reading);
+}
+
+void subscribeActivityEvents() {
+    static DeviceEvent queue[8];
+    eventBusSubscribe("activity", activitySink, DEVICE_EVENT_BIT(DEVICE_EVENT_READING),
+                      2, EVENT_DROP_OLDEST, queue, 8);
+}
@@ -0,0 +1,390 @@
+/*
+ * Adr.cpp - Adaptive Data Rate Implementation
+ */
+
+#include "hardware/Adr.h"
+#include "hardware/Downlink.h"
+#include "hardware/LoRaModule.h"
+#include "hardware/NoiseMonitor.h"
+#include "data/Settings.h"
+#include "core/Device.h"
+#include "core/Clock.h"
+#include "core/Log.h"
+#include <freertos/FreeRTOS.h>
+
+AdrStats adr_stats;
+uint8_t adr_mode = ADR_MODE_RECOMMEND;
+
+// Written by the radio task, copied out by the loop task
+static portMUX_TYPE adr_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static AdrDevice adr_devices[ADR_MAX_DEVICES];
+static uint8_t last_rx_sf = 0;            // adrReceiveSf()'s last answer
+
+static const char* const adr_mode_names[ADR_MODE_COUNT] = {"off", "recommend", "auto"};
+
+const char* getAdrModeName(uint8_t mode) {
+    return mode < ADR_MODE_COUNT ? adr_mode_names[mode] : "unknown";
+}
+
+// ============== Decisions ==============
+void adrRecommend(float snr_max, uint8_t sf, int8_t power, bool move_sf, uint8_t& out_sf, int8_t& out_power) {
+    int steps = (int)floorf((snr_max - noiseSnrLimitDb(sf) - ADR_MARGIN_DB) / ADR_STEP_DB);
+    int s = sf;
+    int p = power;
+
+    while (steps > 0 && move_sf && s > ADR_SF_MIN) { s--; steps--; }
+    while (steps > 0 && p > ADR_POWER_MIN) {
+        p = p - ADR_STEP_DB < ADR_POWER_MIN ? ADR_POWER_MIN : p - ADR_STEP_DB;
+        steps--;
+    }
+    while (steps < 0 && p < ADR_POWER_MAX) {
+        p = p + ADR_STEP_DB > ADR_POWER_MAX ? ADR_POWER_MAX : p + ADR_STEP_DB;
+        steps++;
+    }
+    while (steps < 0 && move_sf && s < ADR_SF_MAX) { s++; steps++; }
+
+    out_sf = (uint8_t)s;
+    out_power = (int8_t)p;
+}
+
+// ============== Device Table ==============
+// Entry for an id: its own, a free one, or the longest silent
+static AdrDevice* findEntry(const char* id) {
+    AdrDevice* spare = nullptr;
+    for (uint8_t i = 0; i < ADR_MAX_DEVICES; i++) {
+        AdrDevice& a = adr_devices[i];
+        if (strcmp(a.id, id) == 0) return &a;
+        if (spare && !spare->id[0]) continue;
+        if (!a.id[0] || !spare || (int32_t)(a.last_heard_ms - spare->last_heard_ms) < 0) spare = &a;
+    }
+    memset(spare, 0, sizeof(*spare));
+    snprintf(spare->id, sizeof(spare->id), "%s", id);
+    return spare;
+}
+
+static void resetHistory(AdrDevice& a) {
+    a.snr_count = 0;
+    a.snr_head = 0;
+    a.rec_sf = 0;
+}
+
+static float bestSnr(const AdrDevice& a) {
+    int8_t best = INT8_MIN;
+    for (uint8_t i = 0; i < a.snr_count; i++) {
+        if (a.snr_q[i] > best) best = a.snr_q[i];
+    }
+    return best / 4.0f;
+}
+
+// Share of the time (percent) follow windows keep the receiver off
+// lora_sf, 'skip' left out
+static uint32_t followSharePct(const AdrDevice* skip) {
+    uint32_t share = 0;
+    for (uint8_t i = 0; i < ADR_MAX_DEVICES; i++) {
+        const AdrDevice& a = adr_devices[i];
+        if (&a == skip || !a.period_ms) continue;
+        share += (a.deaf_ms * 100 + a.period_ms - 1) / a.period_ms;
+    }
+    return share;
+}
+
+// Time per period a device's follow window keeps the receiver off lora_sf:
+// the window, plus a frame on lora_sf that started before it opened and
+// is cut off. 0 if the device cannot be followed.
+static uint32_t followDeafMs(const char* id, int len, uint8_t sf, uint32_t& period_ms, uint32_t& guard_ms) {
+    Device* dev = findDevice(id);
+    if (!dev || dev->has_motion || dev->has_contact) return 0;
+
+    DeviceSnapshot snap;
+    snapshotDevice(dev, snap);
+    if (snap.interval.samples < ADR_FOLLOW_MIN_INTERVALS || !snap.interval.period_ms) return 0;
+
+    period_ms = snap.interval.period_ms;
+    guard_ms = 4 * snap.interval.jitter_ms + ADR_FOLLOW_GUARD_MS;
+    uint32_t toa_ms = loraTimeOnAirUs(len, sf > lora_sf ? sf : lora_sf, lora_bw, lora_cr, lora_preamble) / 1000 + 1;
+    uint32_t deaf_ms = 2 * guard_ms + toa_ms + loraTimeOnAirUs(len, lora_sf, lora_bw, lora_cr, lora_preamble) / 1000;
+    return (uint64_t)deaf_ms * 100 <= (uint64_t)period_ms * ADR_FOLLOW_SHARE_PCT ? deaf_ms : 0;
+}
+
+// ============== Uplinks ==============
+enum AdrEvent : uint8_t { ADR_EVENT_NONE = 0, ADR_EVENT_ACK, ADR_EVENT_REVERT, ADR_EVENT_GAVE_UP };
+
+void adrUplink(const AdrUplink& up) {
+    if (!up.id || !up.id[0]) return;
+
+    uint32_t period_ms = 0, guard_ms = 0;
+    uint32_t deaf_ms = followDeafMs(up.id, up.len, up.sf, period_ms, guard_ms);
+    int64_t saved_us = (int64_t)loraTimeOnAirUs(up.len, lora_sf, lora_bw, lora_cr, lora_preamble) -
+                       (int64_t)loraTimeOnAirUs(up.len, up.sf, lora_bw, lora_cr, lora_preamble);
+    uint32_t now = clockMillis();
+
+    bool send = false;
+    DownlinkCommand cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.power = DOWNLINK_POWER_KEEP;
+    bool keepalive = false;
+    uint8_t event = ADR_EVENT_NONE;
+    uint8_t from_sf = 0;
+    int8_t from_power = 0;
+
+    portENTER_CRITICAL(&adr_lock);
+    AdrDevice& a = *findEntry(up.id);
+    bool first = a.uplinks == 0;
+    a.uplinks++;
+    a.last_heard_ms = now;
+    a.downlink = up.downlink;
+    adr_stats.uplinks++;
+    if (up.sf != lora_sf) adr_stats.followed_frames++;
+    from_sf = a.sf;
+    from_power = a.power;
+
+    if (first) {
+        a.sf = up.sf;
+        a.power = ADR_POWER_MAX;
+    } else if (a.cmd_pending && (up.ack == a.cmd_seq || (a.cmd_sf && up.sf == a.cmd_sf && up.sf != a.sf))) {
+        // Acknowledged, or heard on the SF it was told to use
+        if (a.cmd_sf) a.sf = a.cmd_sf;
+        if (a.cmd_power != DOWNLINK_POWER_KEEP) a.power = a.cmd_power;
+        a.cmd_pending = false;
+        a.acks++;
+        adr_stats.acks++;
+        resetHistory(a);
+        event = ADR_EVENT_ACK;
+    } else if (up.sf != a.sf) {
+        // Not where it should be: back on lora_sf means it reverted
+        if (up.sf == lora_sf) {
+            a.power = ADR_POWER_MAX;
+            a.cmd_pending = false;
+            adr_stats.reverts++;
+            event = ADR_EVENT_REVERT;
+        }
+        a.sf = up.sf;
+        resetHistory(a);
+    }
+    if (up.power != ADR_POWER_UNKNOWN && up.power != a.power) {
+        a.power = up.power;
+        resetHistory(a);
+    }
+
+    // SNR history at the current settings
+    int q = (int)lroundf(up.snr * 4);
+    a.snr_q[a.snr_head] = (int8_t)(q < -128 ? -128 : (q > 127 ? 127 : q));
+    a.snr_head = (a.snr_head + 1) % ADR_HISTORY;
+    if (a.snr_count < ADR_HISTORY) a.snr_count++;
+    a.saved_us += saved_us;
+    adr_stats.saved_us += saved_us;
+    if (a.since_downlink < UINT8_MAX) a.since_downlink++;
+
+    // Recommendation
+    a.followable = deaf_ms != 0;
+    if (adr_mode != ADR_MODE_OFF && a.snr_count >= ADR_MIN_SAMPLES) {
+        if (!a.followable && a.sf != lora_sf) {
+            a.rec_sf = lora_sf;
+            a.rec_power = ADR_POWER_MAX;
+        } else {
+            bool move_sf = a.followable &&
+                           (a.sf != lora_sf || followSharePct(&a) + deaf_ms * 100 / period_ms <= ADR_FOLLOW_BUDGET_PCT);
+            adrRecommend(bestSnr(a), a.sf, a.power, move_sf, a.rec_sf, a.rec_power);
+        }
+    }
+
+    // Command, retry or keepalive
+    if (adr_mode == ADR_MODE_AUTO && a.downlink) {
+        if (a.backoff) a.backoff--;
+        if (a.cmd_pending && a.cmd_attempts >= ADR_MAX_ATTEMPTS) {
+            a.cmd_pending = false;
+            a.backoff = ADR_BACKOFF_UPLINKS;
+            adr_stats.gave_up++;
+            event = ADR_EVENT_GAVE_UP;
+        } else if (!a.cmd_pending && !a.backoff && a.rec_sf && (a.rec_sf != a.sf || a.rec_power != a.power)) {
+            a.cmd_seq = a.cmd_seq % 255 + 1;
+            a.cmd_sf = a.rec_sf != a.sf ? a.rec_sf : 0;
+            a.cmd_power = a.rec_power != a.power ? a.rec_power : DOWNLINK_POWER_KEEP;
+            a.cmd_attempts = 0;
+            a.cmd_pending = true;
+        }
+
+        if (a.cmd_pending) {
+            cmd.seq = a.cmd_seq;
+            cmd.sf = a.cmd_sf;
+            cmd.power = a.cmd_power;
+            send = true;
+        } else if ((a.sf != lora_sf || a.power != ADR_POWER_MAX) && a.since_downlink >= ADR_KEEPALIVE_UPLINKS) {
+            a.cmd_seq = a.cmd_seq % 255 + 1;
+            cmd.seq = a.cmd_seq;
+            send = keepalive = true;
+        }
+    }
+
+    // Next follow window, first on the SF a command moves it to. Sensors
+    // keep their cadence from the start of a frame, so the window is timed
+    // from this one's start and fits the longer frame of the two SFs.
+    a.misses = 0;
+    uint8_t next_sf = a.cmd_pending && a.cmd_sf ? a.cmd_sf : a.sf;
+    if (deaf_ms && (next_sf != lora_sf || a.sf != lora_sf)) {
+        uint8_t long_sf = next_sf > a.sf ? next_sf : a.sf;
+        uint32_t start_ms = now - loraTimeOnAirUs(up.len, up.sf, lora_bw, lora_cr, lora_preamble) / 1000;
+        a.period_ms = period_ms;
+        a.deaf_ms = deaf_ms;
+        a.window_ms = 2 * guard_ms + loraTimeOnAirUs(up.len, long_sf, lora_bw, lora_cr, lora_preamble) / 1000 + 1;
+        a.window_start_ms = start_ms + period_ms - guard_ms;
+        a.window_sf = next_sf;
+    } else {
+        a.period_ms = 0;
+    }
+    portEXIT_CRITICAL(&adr_lock);
+
+    if (send) {
+        snprintf(cmd.id, sizeof(cmd.id), "%s", up.id);
+        if (downlinkSchedule(cmd, up.sf, up.end_us)) {
+            portENTER_CRITICAL(&adr_lock);
+            if (strcmp(a.id, up.id) == 0) {
+                a.since_downlink = 0;
+                if (!keepalive) a.cmd_attempts++;
+            }
+            if (keepalive) adr_stats.keepalives++;
+            else adr_stats.commands++;
+            portEXIT_CRITICAL(&adr_lock);
+        }
+    }
+
+    switch (event) {
+        case ADR_EVENT_ACK:
+            LOG_INFO("[ADR] %s: SF%u %d dBm -> SF%u %d dBm", up.id, from_sf, from_power, a.sf, a.power);
+            break;
+        case ADR_EVENT_REVERT:
+            LOG_WARN("[ADR] %s: back on SF%u (no downlink reached it)", up.id, up.sf);
+            break;
+        case ADR_EVENT_GAVE_UP:
+            LOG_WARN("[ADR] %s: command %u not acknowledged after %u downlinks", up.id, a.cmd_seq,
+                     ADR_MAX_ATTEMPTS);
+            break;
+    }
+}
+
+// ============== Follow Windows ==============
+uint8_t adrReceiveSf() {
+    uint32_t now = clockMillis();
+    uint8_t sf = lora_sf;
+    uint8_t reverted = 0;
+
+    portENTER_CRITICAL(&adr_lock);
+    for (uint8_t i = 0; i < ADR_MAX_DEVICES; i++) {
+        AdrDevice& a = adr_devices[i];
+        if (!a.period_ms) continue;
+
+        // Window closed without the device: expect it a period later, on
+        // the other SF while a command may or may not have reached it
+        while (a.period_ms && clockReached(a.window_start_ms + a.window_ms, now)) {
+            a.window_start_ms += a.period_ms;
+            a.misses++;
+            adr_stats.follow_misses++;
+            if (a.cmd_pending && a.cmd_sf) a.window_sf = a.window_sf == a.cmd_sf ? a.sf : a.cmd_sf;
+            if (a.misses >= ADR_FOLLOW_MISS_LIMIT && !a.cmd_pending) {
+                a.sf = lora_sf;
+                a.power = ADR_POWER_MAX;
+                a.period_ms = 0;
+                resetHistory(a);
+                adr_stats.reverts++;
+                reverted++;
+            }
+        }
+        if (a.period_ms && sf == lora_sf && a.window_sf != lora_sf && clockReached(a.window_start_ms, now)) {
+            sf = a.window_sf;
+        }
+    }
+    if (sf != last_rx_sf && sf != lora_sf) adr_stats.follow_windows++;
+    last_rx_sf = sf;
+    portEXIT_CRITICAL(&adr_lock);
+
+    if (reverted) LOG_WARN("[ADR] %u device(s) missed in %u windows, assumed back on SF%u", reverted,
+                           ADR_FOLLOW_MISS_LIMIT, lora_sf);
+    return sf;
+}
+
+uint32_t adrNextSwitchMs() {
+    uint32_t now = clockMillis();
+    uint32_t next = UINT32_MAX;
+
+    portENTER_CRITICAL(&adr_lock);
+    for (uint8_t i = 0; i < ADR_MAX_DEVICES; i++) {
+        const AdrDevice& a = adr_devices[i];
+        if (!a.period_ms) continue;
+        uint32_t edge = clockReached(a.window_start_ms, now) ? a.window_start_ms + a.window_ms : a.window_start_ms;
+        uint32_t in = clockReached(edge, now) ? 0 : edge - now;
+        if (in < next) next = in;
+    }
+    portEXIT_CRITICAL(&adr_lock);
+    return next;
+}
+
+// ============== Reporting ==============
+uint8_t adrSnapshot(AdrDevice* out, uint8_t max, AdrStats& stats) {
+    uint8_t n = 0;
+    portENTER_CRITICAL(&adr_lock);
+    stats = adr_stats;
+    for (uint8_t i = 0; i < ADR_MAX_DEVICES && n < max; i++) {
+        if (adr_devices[i].id[0]) out[n++] = adr_devices[i];
+    }
+    portEXIT_CRITICAL(&adr_lock);
+    return n;
+}
+
+bool adrDevice(const char* id, AdrDevice& out) {
+    bool found = false;
+    portENTER_CRITICAL(&adr_lock);
+    for (uint8_t i = 0; i < ADR_MAX_DEVICES && !found; i++) {
+        if (adr_devices[i].id[0] && strcmp(adr_devices[i].id, id) == 0) {
+            out = adr_devices[i];
+            found = true;
+        }
+    }
+    portEXIT_CRITICAL(&adr_lock);
+    return found;
+}
+
+void appendAdrMetrics(String& out) {
+    static AdrDevice table[ADR_MAX_DEVICES];    // Kept off the loop task stack
+    AdrStats s;
+    uint8_t n = adrSnapshot(table, ADR_MAX_DEVICES, s);
+
+    char line[512];
+    snprintf(line, sizeof(line),
+             "# TYPE lora_bridge_adr_mode gauge\n"
+             "lora_bridge_adr_mode %u\n"
+             "# TYPE lora_bridge_adr_downlinks_total counter\n"
+             "lora_bridge_adr_downlinks_total{kind=\"command\"} %lu\n"
+             "lora_bridge_adr_downlinks_total{kind=\"keepalive\"} %lu\n",
+             adr_mode, (unsigned long)s.commands, (unsigned long)s.keepalives);
+    out += line;
+    snprintf(line, sizeof(line),
+             "# TYPE lora_bridge_adr_acks_total counter\n"
+             "lora_bridge_adr_acks_total %lu\n"
+             "# TYPE lora_bridge_adr_gave_up_total counter\n"
+             "lora_bridge_adr_gave_up_total %lu\n"
+             "# TYPE lora_bridge_adr_reverts_total counter\n"
+             "lora_bridge_adr_reverts_total %lu\n",
+             (unsigned long)s.acks, (unsigned long)s.gave_up, (unsigned long)s.reverts);
+    out += line;
+    snprintf(line, sizeof(line),
+             "# TYPE lora_bridge_adr_follow_windows_total counter\n"
+             "lora_bridge_adr_follow_windows_total %lu\n"
+             "# TYPE lora_bridge_adr_follow_misses_total counter\n"
+             "lora_bridge_adr_follow_misses_total %lu\n"
+             "# HELP lora_bridge_adr_airtime_saved_seconds_total Uplink airtime saved against the bridge SF\n"
+             "# TYPE lora_bridge_adr_airtime_saved_seconds_total counter\n"
+             "lora_bridge_adr_airtime_saved_seconds_total %.3f\n",
+             (unsigned long)s.follow_windows, (unsigned long)s.follow_misses, s.saved_us / 1e6);
+    out += line;
+
+    uint8_t per_sf[ADR_SF_MAX + 1] = {0};
+    for (uint8_t i = 0; i < n; i++) {
+        if (table[i].sf <= ADR_SF_MAX) per_sf[table[i].sf]++;
+    }
+    out += "# TYPE lora_bridge_adr_devices gauge\n";
+    for (uint8_t sf = ADR_SF_MIN; sf <= ADR_SF_MAX; sf++) {
+        snprintf(line, sizeof(line), "lora_bridge_adr_devices{sf=\"%u\"} %u\n", sf, per_sf[sf]);
+        out += line;
+    }
+}
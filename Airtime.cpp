@@ -0,0 +1,205 @@
+/*
+ * Airtime.cpp - Time-on-Air Accounting Implementation
+ */
+
+#include "hardware/Airtime.h"
+#include "hardware/LoRaModule.h"
+#include "core/Clock.h"
+#include <freertos/FreeRTOS.h>
+
+AirtimeStats airtime_stats;
+AirtimeSource airtime_sources[AIRTIME_MAX_SOURCES];
+
+// Written by the ingest task, read and rolled over by the loop task
+static portMUX_TYPE airtime_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static float window_history[AIRTIME_HISTORY];   // Utilisation per complete window
+static uint8_t history_index = 0;
+static uint32_t window_start_ms = 0;
+
+// ============== Recording ==============
+// The last slot is AIRTIME_OTHER_ID; the others are taken by id as heard
+#define AIRTIME_OTHER_SLOT (AIRTIME_MAX_SOURCES - 1)
+
+// Slot for a sender: its own, a free one, one idle long enough to reuse,
+// or the shared one
+static AirtimeSource* findSource(const char* id) {
+    AirtimeSource* spare = nullptr;
+    for (int i = 0; i < AIRTIME_OTHER_SLOT && id[0]; i++) {
+        AirtimeSource& s = airtime_sources[i];
+        if (strcmp(s.id, id) == 0) return &s;
+        if (!spare && (!s.id[0] || clockElapsedMs(s.last_heard_ms) >= AIRTIME_SOURCE_IDLE_MS)) {
+            spare = &s;
+        }
+    }
+
+    AirtimeSource* s = spare ? spare : &airtime_sources[AIRTIME_OTHER_SLOT];
+    if (s->id[0] && s != spare) return s;
+    memset(s, 0, sizeof(*s));
+    snprintf(s->id, sizeof(s->id), "%s", spare ? id : AIRTIME_OTHER_ID);
+    return s;
+}
+
+void airtimeRecord(const char* id, int len, uint8_t verdict) {
+    uint32_t toa = loraTimeOnAirUs(len);
+
+    // Ids of rejected frames are whatever the sender put there: keep them
+    // printable and safe inside a metrics label
+    char key[sizeof(AirtimeSource::id)];
+    size_t n = 0;
+    for (; id && id[n] && n < sizeof(key) - 1; n++) {
+        char c = id[n];
+        key[n] = (c < 0x20 || c > 0x7E || c == '"' || c == '\\') ? '_' : c;
+    }
+    key[n] = 0;
+
+    portENTER_CRITICAL(&airtime_lock);
+    airtime_stats.total_us += toa;
+    airtime_stats.frames++;
+    airtime_stats.window_us += toa;
+    if (verdict != 0) airtime_stats.rejected_us += toa;
+
+    AirtimeSource* s = findSource(key);
+    s->total_us += toa;
+    s->frames++;
+    if (verdict != 0) s->rejected++;
+    s->window_us += toa;
+    s->last_heard_ms = clockMillis();
+    portEXIT_CRITICAL(&airtime_lock);
+}
+
+// ============== Windows ==============
+void airtimeBegin() {
+    window_start_ms = clockMillis();
+}
+
+void airtimeRollWindow() {
+    uint32_t elapsed_ms = clockElapsedMs(window_start_ms);
+    window_start_ms = clockMillis();
+    if (elapsed_ms == 0) return;
+
+    portENTER_CRITICAL(&airtime_lock);
+    uint32_t used_us = airtime_stats.window_us;
+    airtime_stats.last_window_us = used_us;
+    airtime_stats.last_window_ms = elapsed_ms;
+    airtime_stats.window_us = 0;
+    airtime_stats.windows++;
+    for (int i = 0; i < AIRTIME_MAX_SOURCES; i++) {
+        airtime_sources[i].last_window_us = airtime_sources[i].window_us;
+        airtime_sources[i].window_us = 0;
+    }
+    portEXIT_CRITICAL(&airtime_lock);
+
+    window_history[history_index] = min(used_us / (elapsed_ms * 1000.0f), 1.0f);
+    history_index = (history_index + 1) % AIRTIME_HISTORY;
+}
+
+float airtimeUtilisation() {
+    if (airtime_stats.windows == 0) return 0;
+    return window_history[(history_index + AIRTIME_HISTORY - 1) % AIRTIME_HISTORY];
+}
+
+float airtimePeakUtilisation() {
+    float peak = 0;
+    for (int i = 0; i < AIRTIME_HISTORY; i++) peak = max(peak, window_history[i]);
+    return peak;
+}
+
+// ============== ALOHA Model ==============
+float airtimeOfferedLoad(float utilisation) {
+    // S = G * e^(-2G) rises monotonically up to G = 0.5, S = 1/(2e)
+    const float s_max = 0.5f * expf(-1.0f);
+    if (utilisation <= 0) return 0;
+    if (utilisation >= s_max) return 0.5f;
+
+    float lo = 0, hi = 0.5f;
+    for (int i = 0; i < 24; i++) {
+        float g = (lo + hi) / 2;
+        if (g * expf(-2 * g) < utilisation) lo = g;
+        else hi = g;
+    }
+    return (lo + hi) / 2;
+}
+
+float airtimeCollisionProbability(float utilisation) {
+    return 1.0f - expf(-2.0f * airtimeOfferedLoad(utilisation));
+}
+
+// ============== Metrics ==============
+void appendAirtimeMetrics(String& out) {
+    char line[256];
+    float utilisation = airtimeUtilisation();
+
+    portENTER_CRITICAL(&airtime_lock);
+    AirtimeStats stats = airtime_stats;
+    portEXIT_CRITICAL(&airtime_lock);
+
+    snprintf(line, sizeof(line),
+             "# TYPE lora_bridge_airtime_seconds_total counter\n"
+             "lora_bridge_airtime_seconds_total %.3f\n"
+             "# TYPE lora_bridge_airtime_rejected_seconds_total counter\n"
+             "lora_bridge_airtime_rejected_seconds_total %.3f\n",
+             stats.total_us / 1e6, stats.rejected_us / 1e6);
+    out += line;
+    snprintf(line, sizeof(line),
+             "# HELP lora_bridge_channel_utilisation Airtime share of the last minute\n"
+             "# TYPE lora_bridge_channel_utilisation gauge\n"
+             "lora_bridge_channel_utilisation %.5f\n",
+             utilisation);
+    out += line;
+    snprintf(line, sizeof(line),
+             "# HELP lora_bridge_channel_utilisation_peak Highest minute in the last hour\n"
+             "# TYPE lora_bridge_channel_utilisation_peak gauge\n"
+             "lora_bridge_channel_utilisation_peak %.5f\n",
+             airtimePeakUtilisation());
+    out += line;
+    snprintf(line, sizeof(line),
+             "# HELP lora_bridge_channel_offered_load ALOHA offered load behind the last minute\n"
+             "# TYPE lora_bridge_channel_offered_load gauge\n"
+             "lora_bridge_channel_offered_load %.5f\n",
+             airtimeOfferedLoad(utilisation));
+    out += line;
+    snprintf(line, sizeof(line),
+             "# HELP lora_bridge_channel_collision_probability Chance a frame collides (ALOHA)\n"
+             "# TYPE lora_bridge_channel_collision_probability gauge\n"
+             "lora_bridge_channel_collision_probability %.5f\n",
+             airtimeCollisionProbability(utilisation));
+    out += line;
+
+    out += F("# HELP lora_bridge_device_airtime_seconds_total Airtime per sender (accepted or not)\n"
+             "# TYPE lora_bridge_device_airtime_seconds_total counter\n");
+    for (int i = 0; i < AIRTIME_MAX_SOURCES; i++) {
+        portENTER_CRITICAL(&airtime_lock);
+        AirtimeSource s = airtime_sources[i];
+        portEXIT_CRITICAL(&airtime_lock);
+        if (!s.id[0]) continue;
+        snprintf(line, sizeof(line), "lora_bridge_device_airtime_seconds_total{device=\"%s\"} %.3f\n",
+                 s.id, s.total_us / 1e6);
+        out += line;
+    }
+
+    out += F("# HELP lora_bridge_device_channel_utilisation Sender's airtime share of the last minute\n"
+             "# TYPE lora_bridge_device_channel_utilisation gauge\n");
+    for (int i = 0; i < AIRTIME_MAX_SOURCES; i++) {
+        portENTER_CRITICAL(&airtime_lock);
+        AirtimeSource s = airtime_sources[i];
+        portEXIT_CRITICAL(&airtime_lock);
+        if (!s.id[0]) continue;
+        snprintf(line, sizeof(line), "lora_bridge_device_channel_utilisation{device=\"%s\"} %.5f\n",
+                 s.id, stats.last_window_ms ? s.last_window_us / (stats.last_window_ms * 1000.0f) : 0.0f);
+        out += line;
+    }
+
+    out += F("# TYPE lora_bridge_device_frames_total counter\n");
+    for (int i = 0; i < AIRTIME_MAX_SOURCES; i++) {
+        portENTER_CRITICAL(&airtime_lock);
+        AirtimeSource s = airtime_sources[i];
+        portEXIT_CRITICAL(&airtime_lock);
+        if (!s.id[0]) continue;
+        snprintf(line, sizeof(line),
+                 "lora_bridge_device_frames_total{device=\"%s\",verdict=\"accepted\"} %lu\n"
+                 "lora_bridge_device_frames_total{device=\"%s\",verdict=\"rejected\"} %lu\n",
+                 s.id, (unsigned long)(s.frames - s.rejected), s.id, (unsigned long)s.rejected);
+        out += line;
+    }
+}
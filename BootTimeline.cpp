@@ -0,0 +1,66 @@
+/*
+ * BootTimeline.cpp - Boot Phase Timeline Implementation
+ */
+
+#include "core/BootTimeline.h"
+#include "core/Clock.h"
+
+// ============== Timeline State ==============
+BootPhaseTime boot_phases[BOOT_PHASE_COUNT];
+uint32_t boot_complete_ms = 0;
+bool fast_boot = false;
+
+static const char* const phase_names[BOOT_PHASE_COUNT] = {
+    "display", "settings", "lora", "wifi", "ap", "homekit", "web", "mqtt"
+};
+
+// ============== Timeline Functions ==============
+const char* getBootPhaseName(uint8_t phase) {
+    return phase < BOOT_PHASE_COUNT ? phase_names[phase] : "unknown";
+}
+
+void bootPhaseBegin(BootPhase phase) {
+    boot_phases[phase].start_ms = clockMillis();
+    boot_phases[phase].started = true;
+    boot_phases[phase].done = false;
+}
+
+void bootPhaseEnd(BootPhase phase) {
+    if (!boot_phases[phase].started) return;
+    boot_phases[phase].end_ms = clockMillis();
+    boot_phases[phase].done = true;
+    Serial.printf("[BOOT] %s done at %lu ms (%lu ms)\n", phase_names[phase],
+                  (unsigned long)boot_phases[phase].end_ms,
+                  (unsigned long)getBootPhaseDuration(phase));
+}
+
+uint32_t getBootPhaseDuration(uint8_t phase) {
+    if (phase >= BOOT_PHASE_COUNT || !boot_phases[phase].done) return 0;
+    return boot_phases[phase].end_ms - boot_phases[phase].start_ms;
+}
+
+void bootComplete() {
+    if (boot_complete_ms != 0) return;
+    boot_complete_ms = clockMillis();
+    printBootTimeline();
+}
+
+bool isBootComplete() {
+    return boot_complete_ms != 0;
+}
+
+void bootDelay(uint32_t ms) {
+    if (!fast_boot) delay(ms);
+}
+
+void printBootTimeline() {
+    Serial.printf("[BOOT] Timeline (%s boot), complete at %lu ms:\n",
+                  fast_boot ? "fast" : "normal", (unsigned long)boot_complete_ms);
+    for (uint8_t i = 0; i < BOOT_PHASE_COUNT; i++) {
+        const BootPhaseTime& p = boot_phases[i];
+        if (!p.started) continue;
+        Serial.printf("[BOOT]   %-8s %6lu -> %6lu ms  (%lu ms)\n", phase_names[i],
+                      (unsigned long)p.start_ms, (unsigned long)p.end_ms,
+                      (unsigned long)getBootPhaseDuration(i));
+    }
+}
@@ -0,0 +1,407 @@
+/*
+ * Capture.cpp - Raw Frame Capture Implementation
+ */
+
+#include "data/Capture.h"
+#include "core/Clock.h"
+#include "core/Log.h"
+#include "data/Settings.h"
+#include "data/Encryption.h"
+#include "data/Journal.h"
+#include <esp_partition.h>
+
+#define CAPTURE_READ_CHUNK 256       // Bytes per flash read when streaming
+
+// ============== Capture State ==============
+bool capture_enabled = false;
+bool capture_flash_available = false;
+uint32_t capture_total = 0;
+uint32_t capture_lost = 0;
+
+static CapturedFrame* ring = nullptr;
+static uint32_t capture_base = 0;    // capture_total at the last clear
+static bool frame_open = false;      // captureFrame() waiting for its verdict (radio task)
+static uint32_t flushed = 0;         // Next frame number to append to flash (loop task)
+
+static const esp_partition_t* capture_part = nullptr;
+static uint8_t sector_count = 0;
+static uint32_t sector_seq[CAPTURE_MAX_SECTORS];    // 0 = not a capture sector
+static uint16_t sector_used[CAPTURE_MAX_SECTORS];   // Bytes in use, header included
+static int head_sector = -1;
+static bool head_open = false;       // Head was started by this boot with head_hdr
+static CaptureSectorHeader head_hdr;
+static uint32_t next_sector_seq = 1;
+
+static const char* const enc_tokens[] = {"none", "xor", "aes"};
+
+// ============== Helpers ==============
+static uint8_t crc8(uint8_t crc, const uint8_t* data, size_t len) {
+    while (len--) {
+        crc ^= *data++;
+        for (uint8_t i = 0; i < 8; i++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+// Covers the record header except the crc byte itself, then the payload
+static uint8_t recordCrc(const CaptureRecord& rec, const uint8_t* payload) {
+    const uint8_t* hdr = (const uint8_t*)&rec;
+    uint8_t crc = crc8(0, hdr, offsetof(CaptureRecord, crc));
+    crc = crc8(crc, hdr + offsetof(CaptureRecord, crc) + 1, sizeof(rec) - offsetof(CaptureRecord, crc) - 1);
+    return crc8(crc, payload, rec.len);
+}
+
+static size_t sectorOffset(uint8_t sector) {
+    return (size_t)sector * CAPTURE_SECTOR_SIZE;
+}
+
+// Sectors holding captures, oldest first. Returns how many.
+static uint8_t sectorsInOrder(uint8_t* order) {
+    uint8_t n = 0;
+    for (uint8_t s = 0; s < sector_count; s++) {
+        if (sector_seq[s] == 0) continue;
+        uint8_t i = n++;
+        while (i > 0 && sector_seq[order[i - 1]] > sector_seq[s]) {
+            order[i] = order[i - 1];
+            i--;
+        }
+        order[i] = s;
+    }
+    return n;
+}
+
+// Records are appended back to back, so the first blank or torn mark ends
+// the sector. A record that fails its CRC still has a usable length.
+static uint16_t scanSector(uint8_t sector) {
+    uint16_t pos = sizeof(CaptureSectorHeader);
+    while (pos + sizeof(CaptureRecord) <= CAPTURE_SECTOR_SIZE) {
+        CaptureRecord rec;
+        esp_partition_read(capture_part, sectorOffset(sector) + pos, &rec, sizeof(rec));
+        if ((rec.mark & 0xF0) != CAPTURE_RECORD_MARK) break;
+        if (pos + sizeof(rec) + rec.len > CAPTURE_SECTOR_SIZE) break;
+        pos += sizeof(rec) + rec.len;
+    }
+    return pos;
+}
+
+// Current boot and main profile settings (seq and crc are filled in when
+// written); each record has the settings it was received with
+static void makeHeader(CaptureSectorHeader& hdr) {
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = CAPTURE_MAGIC;
+    hdr.version = CAPTURE_VERSION;
+    hdr.boot = journal_boot;
+    hdr.freq_hz = (uint32_t)lroundf(lora_frequency * 1e6f);
+    hdr.bw_hz = lora_bw;
+    hdr.sf = lora_sf;
+    hdr.cr = lora_cr;
+    hdr.sync = lora_syncword;
+    hdr.enc = encryption_mode;
+    hdr.preamble = lora_preamble;
+}
+
+static bool sameSettings(const CaptureSectorHeader& a, const CaptureSectorHeader& b) {
+    return a.boot == b.boot && a.freq_hz == b.freq_hz && a.bw_hz == b.bw_hz && a.sf == b.sf &&
+           a.cr == b.cr && a.sync == b.sync && a.enc == b.enc && a.preamble == b.preamble;
+}
+
+// Erase the sector after the head (dropping the oldest frames) and start it
+static bool advanceSector(CaptureSectorHeader& hdr) {
+    uint8_t next = head_sector < 0 ? 0 : (head_sector + 1) % sector_count;
+
+    if (esp_partition_erase_range(capture_part, sectorOffset(next), CAPTURE_SECTOR_SIZE) != ESP_OK) {
+        LOG_ERROR("[CAPTURE] Erase of sector %u failed", next);
+        return false;
+    }
+    sector_seq[next] = 0;
+    sector_used[next] = 0;
+
+    hdr.seq = next_sector_seq;
+    hdr.crc = crc8(0, (const uint8_t*)&hdr, sizeof(hdr) - 1);
+    if (esp_partition_write(capture_part, sectorOffset(next), &hdr, sizeof(hdr)) != ESP_OK) {
+        return false;
+    }
+
+    sector_seq[next] = next_sector_seq++;
+    sector_used[next] = sizeof(hdr);
+    head_sector = next;
+    head_hdr = hdr;
+    head_open = true;
+    return true;
+}
+
+static void append(const CapturedFrame& f) {
+    // Every sector describes all of its frames, so a reboot or a change of
+    // the main settings starts a new one
+    CaptureSectorHeader now;
+    makeHeader(now);
+
+    size_t size = sizeof(CaptureRecord) + f.len;
+    if (!head_open || !sameSettings(now, head_hdr) ||
+        sector_used[head_sector] + size > CAPTURE_SECTOR_SIZE) {
+        if (!advanceSector(now)) return;
+    }
+
+    CaptureRecord rec;
+    rec.mark = CAPTURE_RECORD_MARK | (f.verdict & 0x0F);
+    rec.len = f.len;
+    rec.snr_x4 = f.snr_x4;
+    rec.at_ms = f.at_ms;
+    rec.rssi = f.rssi;
+    rec.freq_err = f.freq_err;
+    rec.freq_hz = f.freq_hz;
+    rec.sf = f.sf;
+    rec.bw_125k = f.bw_125k;
+    rec.sync = f.sync;
+    rec.profile = f.profile;
+    rec.crc = recordCrc(rec, f.data);
+
+    // One write per record, so an interrupted write leaves at most one
+    // torn record at the end of the head sector
+    uint8_t buf[sizeof(CaptureRecord) + CAPTURE_FRAME_MAX];
+    memcpy(buf, &rec, sizeof(rec));
+    memcpy(buf + sizeof(rec), f.data, f.len);
+    if (esp_partition_write(capture_part, sectorOffset(head_sector) + sector_used[head_sector], buf, size) != ESP_OK) {
+        LOG_ERROR("[CAPTURE] Flash write failed");
+    }
+    sector_used[head_sector] += size;
+}
+
+// ============== Capture Control ==============
+void captureInit() {
+    capture_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                            (esp_partition_subtype_t)CAPTURE_PARTITION_SUBTYPE,
+                                            CAPTURE_PARTITION_LABEL);
+    if (capture_part) {
+        sector_count = min((uint32_t)CAPTURE_MAX_SECTORS, (uint32_t)(capture_part->size / CAPTURE_SECTOR_SIZE));
+
+        // The newest valid header is the head; anything else is erased when reached
+        head_sector = -1;
+        for (uint8_t s = 0; s < sector_count; s++) {
+            CaptureSectorHeader hdr;
+            esp_partition_read(capture_part, sectorOffset(s), &hdr, sizeof(hdr));
+            bool valid = hdr.magic == CAPTURE_MAGIC && hdr.version == CAPTURE_VERSION &&
+                         hdr.crc == crc8(0, (const uint8_t*)&hdr, sizeof(hdr) - 1);
+            sector_seq[s] = valid ? hdr.seq : 0;
+            sector_used[s] = valid ? scanSector(s) : 0;
+            if (valid && (head_sector < 0 || hdr.seq > sector_seq[head_sector])) {
+                head_sector = s;
+            }
+        }
+        if (head_sector >= 0) next_sector_seq = sector_seq[head_sector] + 1;
+
+        capture_flash_available = true;
+        Serial.printf("[CAPTURE] %lu of %lu bytes in flash\n", (unsigned long)captureFlashUsed(),
+                      (unsigned long)captureFlashCapacity());
+    } else {
+        Serial.println("[CAPTURE] No capture partition - RAM capture only");
+    }
+
+    if (capture_enabled && !captureEnable(true)) capture_enabled = false;
+}
+
+bool captureEnable(bool enable) {
+    if (enable && !ring) {
+        ring = (CapturedFrame*)calloc(CAPTURE_RAM_FRAMES, sizeof(CapturedFrame));
+        if (!ring) {
+            LOG_ERROR("[CAPTURE] Out of memory");
+            return false;
+        }
+    }
+    capture_enabled = enable;
+    LOG_INFO("[CAPTURE] %s", enable ? "Recording" : "Stopped");
+    return true;
+}
+
+void captureClear() {
+    uint32_t total = __atomic_load_n(&capture_total, __ATOMIC_ACQUIRE);
+    capture_base = total;
+    flushed = total;
+    capture_lost = 0;
+
+    if (!capture_flash_available) return;
+    for (uint8_t s = 0; s < sector_count; s++) {
+        if (sector_seq[s] == 0 && sector_used[s] == 0) continue;
+        esp_partition_erase_range(capture_part, sectorOffset(s), CAPTURE_SECTOR_SIZE);
+        sector_seq[s] = 0;
+        sector_used[s] = 0;
+    }
+    head_sector = -1;
+    head_open = false;
+    LOG_INFO("[CAPTURE] Cleared");
+}
+
+// ============== Recording ==============
+// Slot seq tells readers which frame the slot holds and whether it is
+// complete, so the radio task never waits for a reader. The slot stays
+// incomplete until the verdict is known.
+void captureFrame(const uint8_t* data, int len, int rssi, float snr, long freq_err, const RxProfile& rx,
+                  uint8_t profile) {
+    if (!capture_enabled || !ring) return;
+
+    uint32_t index = capture_total;
+    CapturedFrame& f = ring[index % CAPTURE_RAM_FRAMES];
+    __atomic_store_n(&f.seq, 2 * index + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    f.at_ms = clockMillis();
+    f.rssi = (int16_t)rssi;
+    f.freq_err = (int16_t)constrain(freq_err, -32768L, 32767L);
+    f.snr_x4 = (int8_t)constrain(lroundf(snr * 4), -128L, 127L);
+    f.verdict = CAPTURE_ACCEPTED;
+    f.profile = profile;
+    f.sf = rx.sf;
+    f.bw_125k = (uint8_t)(rx.bw / 125000);
+    f.sync = rx.syncword;
+    f.freq_hz = (uint32_t)lround(rx.frequency * 1e6);
+    f.len = (uint8_t)constrain(len, 0, CAPTURE_FRAME_MAX);
+    memcpy(f.data, data, f.len);
+    frame_open = true;
+}
+
+void captureVerdict(uint8_t verdict) {
+    if (!frame_open) return;
+    frame_open = false;
+
+    uint32_t index = capture_total;
+    CapturedFrame& f = ring[index % CAPTURE_RAM_FRAMES];
+    f.verdict = verdict;
+    __atomic_store_n(&f.seq, 2 * index + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&capture_total, index + 1, __ATOMIC_RELEASE);
+}
+
+// ============== Reading ==============
+static bool readSlot(uint32_t index, CapturedFrame& out) {
+    const CapturedFrame& f = ring[index % CAPTURE_RAM_FRAMES];
+    uint32_t expected = 2 * index + 2;
+    if (__atomic_load_n(&f.seq, __ATOMIC_ACQUIRE) != expected) return false;
+    memcpy(&out, &f, sizeof(out));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&f.seq, __ATOMIC_RELAXED) == expected;
+}
+
+void captureFlush() {
+    if (!capture_flash_available || !ring) return;
+
+    uint32_t total = __atomic_load_n(&capture_total, __ATOMIC_ACQUIRE);
+    if (total - flushed > CAPTURE_RAM_FRAMES) {
+        capture_lost += total - flushed - CAPTURE_RAM_FRAMES;
+        flushed = total - CAPTURE_RAM_FRAMES;
+    }
+
+    CapturedFrame frame;
+    for (; flushed != total; flushed++) {
+        if (readSlot(flushed, frame)) append(frame);
+        else capture_lost++;
+    }
+}
+
+uint16_t captureCount() {
+    uint32_t recorded = __atomic_load_n(&capture_total, __ATOMIC_ACQUIRE) - capture_base;
+    return (uint16_t)min(recorded, (uint32_t)CAPTURE_RAM_FRAMES);
+}
+
+uint32_t captureFlashUsed() {
+    uint32_t used = 0;
+    for (uint8_t s = 0; s < sector_count; s++) {
+        if (sector_seq[s] != 0) used += sector_used[s];
+    }
+    return used;
+}
+
+uint32_t captureFlashCapacity() {
+    return (uint32_t)sector_count * CAPTURE_SECTOR_SIZE;
+}
+
+bool captureRead(uint16_t n, CapturedFrame& out) {
+    if (!ring) return false;
+
+    uint32_t total = __atomic_load_n(&capture_total, __ATOMIC_ACQUIRE);
+    uint32_t count = min(total - capture_base, (uint32_t)CAPTURE_RAM_FRAMES);
+    if (n >= count) return false;
+    return readSlot(total - count + n, out);
+}
+
+void captureReadFlash(CaptureVisitor visit, void* ctx) {
+    if (!capture_flash_available) return;
+
+    uint8_t order[CAPTURE_MAX_SECTORS];
+    uint8_t n = sectorsInOrder(order);
+    CapturedFrame frame;
+    memset(&frame, 0, sizeof(frame));
+
+    for (uint8_t i = 0; i < n; i++) {
+        uint8_t s = order[i];
+        uint16_t pos = sizeof(CaptureSectorHeader);
+        while (pos + sizeof(CaptureRecord) <= sector_used[s]) {
+            CaptureRecord rec;
+            esp_partition_read(capture_part, sectorOffset(s) + pos, &rec, sizeof(rec));
+            esp_partition_read(capture_part, sectorOffset(s) + pos + sizeof(rec), frame.data, rec.len);
+            pos += sizeof(rec) + rec.len;
+            if (rec.crc != recordCrc(rec, frame.data)) continue;
+
+            frame.at_ms = rec.at_ms;
+            frame.rssi = rec.rssi;
+            frame.freq_err = rec.freq_err;
+            frame.snr_x4 = rec.snr_x4;
+            frame.verdict = rec.mark & 0x0F;
+            frame.profile = rec.profile;
+            frame.sf = rec.sf;
+            frame.bw_125k = rec.bw_125k;
+            frame.sync = rec.sync;
+            frame.freq_hz = rec.freq_hz;
+            frame.len = rec.len;
+            if (!visit(frame, ctx)) return;
+        }
+    }
+}
+
+void captureDumpFlash(CaptureChunkWriter write, void* ctx) {
+    if (!capture_flash_available) return;
+
+    uint8_t order[CAPTURE_MAX_SECTORS];
+    uint8_t n = sectorsInOrder(order);
+    uint8_t chunk[CAPTURE_READ_CHUNK];
+
+    for (uint8_t i = 0; i < n; i++) {
+        uint8_t s = order[i];
+        for (uint16_t pos = 0; pos < sector_used[s]; pos += sizeof(chunk)) {
+            size_t len = min((size_t)(sector_used[s] - pos), sizeof(chunk));
+            esp_partition_read(capture_part, sectorOffset(s) + pos, chunk, len);
+            write(chunk, len, ctx);
+        }
+    }
+}
+
+// ============== Formatting ==============
+size_t formatCaptureHeader(char* out, size_t len) {
+    const char* enc = encryption_mode < 3 ? enc_tokens[encryption_mode] : "unknown";
+    int n = snprintf(out, len,
+                     "# lora-capture v%u freq=%.3f sf=%u bw=%lu cr=%u pre=%u sync=0x%02X enc=%s\n",
+                     CAPTURE_VERSION, lora_frequency, lora_sf, (unsigned long)lora_bw, lora_cr, lora_preamble,
+                     lora_syncword, enc);
+    return n < 0 ? 0 : min((size_t)n, len - 1);
+}
+
+size_t formatCapturedFrame(const CapturedFrame& frame, char* out, size_t len) {
+    static const char hex[] = "0123456789ABCDEF";
+
+    int n = snprintf(out, len, "%lu %d %.2f %u ", (unsigned long)frame.at_ms, frame.rssi,
+                     frame.snr_x4 / 4.0f, frame.len);
+    if (n < 0) return 0;
+
+    size_t pos = (size_t)n;
+    for (uint8_t i = 0; i < frame.len && pos + 3 < len; i++) {
+        out[pos++] = hex[frame.data[i] >> 4];
+        out[pos++] = hex[frame.data[i] & 0x0F];
+    }
+    if (pos < len) {
+        n = snprintf(out + pos, len - pos, " %.3f/%u/%u/%02X %u\n", frame.freq_hz / 1e6, frame.sf,
+                     frame.bw_125k * 125, frame.sync, frame.profile);
+        if (n > 0) pos += (size_t)n;
+    }
+    out[min(pos, len - 1)] = 0;
+    return min(pos, len - 1);
+}
@@ -0,0 +1,39 @@
+/*
+ * Clock.cpp - Injectable Time Source Implementation
+ */
+
+#include "core/Clock.h"
+#include <esp_timer.h>
+
+// ============== System Clock ==============
+static uint32_t systemMillis() { return (uint32_t)millis(); }
+static uint32_t systemMicros() { return (uint32_t)micros(); }
+static uint64_t systemMicros64() { return (uint64_t)esp_timer_get_time(); }
+
+const ClockSource clock_system = {"system", systemMillis, systemMicros, systemMicros64};
+const ClockSource* clock_source = &clock_system;
+
+void setClockSource(const ClockSource* source) {
+    clock_source = source ? source : &clock_system;
+    Serial.printf("[CLOCK] Time source: %s\n", clock_source->name);
+}
+
+// ============== Virtual Clock ==============
+// Read from both tasks in dual-core mode; 64-bit loads are not atomic on
+// the ESP32 without the builtins
+static uint64_t virtual_us = 0;
+
+void clockVirtualSet(uint64_t us) { __atomic_store_n(&virtual_us, us, __ATOMIC_RELAXED); }
+void clockVirtualAdvance(uint64_t us) { __atomic_fetch_add(&virtual_us, us, __ATOMIC_RELAXED); }
+uint64_t clockVirtualMicros() { return __atomic_load_n(&virtual_us, __ATOMIC_RELAXED); }
+
+static uint32_t virtualMillis() { return (uint32_t)(clockVirtualMicros() / 1000); }
+static uint32_t virtualMicros() { return (uint32_t)clockVirtualMicros(); }
+
+const ClockSource clock_virtual = {"virtual", virtualMillis, virtualMicros, clockVirtualMicros};
+
+// ============== Uptime ==============
+static uint64_t boot_us = 0;
+
+void clockMarkBoot() { boot_us = clockMicros64(); }
+uint32_t clockUptimeSeconds() { return (uint32_t)((clockMicros64() - boot_us) / 1000000ULL); }
@@ -3,11 +3,13 @@
  */
 
 #include "core/Device.h"
+#include "core/Clock.h"
 #include <string.h>
 
 // ============== Global Device Array ==============
 Device devices[MAX_DEVICES];
 int device_count = 0;
+uint32_t device_snapshot_retries = 0;
 
 // ============== Helper Functions ==============
 int getActiveDeviceCount() {
@@ -46,3 +48,177 @@ Device* findDevice(const char* id) {
     }
     return nullptr;
 }
+
+// ============== Device Snapshots ==============
+void deviceWriteBegin(Device* dev) {
+    uint32_t seq = __atomic_load_n(&dev->seq, __ATOMIC_RELAXED);
+    for (;;) {
+        if (!(seq & 1) && __atomic_compare_exchange_n(&dev->seq, &seq, seq + 1, false,
+                                                      __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            break;
+        }
+        seq = __atomic_load_n(&dev->seq, __ATOMIC_RELAXED);
+    }
+    // Field stores must not become visible before the odd sequence
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void deviceWriteEnd(Device* dev) {
+    __atomic_store_n(&dev->seq, dev->seq + 1, __ATOMIC_RELEASE);
+}
+
+void snapshotDevice(const Device* dev, DeviceSnapshot& out) {
+    for (uint32_t attempt = 0;; attempt++) {
+        uint32_t before = __atomic_load_n(&dev->seq, __ATOMIC_ACQUIRE);
+        if (!(before & 1)) {
+            out.rssi = dev->rssi;
+            out.last_seen = dev->last_seen;
+            out.temperature = dev->temperature;
+            out.humidity = dev->humidity;
+            out.battery = dev->battery;
+            out.lux = dev->lux;
+            out.motion = dev->motion;
+            out.contact = dev->contact;
+            out.interval = dev->interval;
+
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&dev->seq, __ATOMIC_RELAXED) == before) {
+                out.seq = before;
+                return;
+            }
+        }
+
+        __atomic_fetch_add(&device_snapshot_retries, 1, __ATOMIC_RELAXED);   // Readers on both cores
+        // The writer may have been preempted mid-update
+        if (attempt % DEVICE_SNAPSHOT_SPINS == DEVICE_SNAPSHOT_SPINS - 1) yield();
+    }
+}
+
+// ============== Reporting Interval ==============
+#define INTERVAL_RELEARN 4         // Matching off-period gaps in a row that replace the period
+
+static uint32_t intervalTolerance(const DeviceInterval& iv) {
+    uint32_t floor_ms = iv.period_ms / 10;
+    return 2 * iv.jitter_ms > floor_ms ? 2 * iv.jitter_ms : floor_ms;
+}
+
+void deviceIntervalObserve(DeviceInterval& iv, uint32_t last_seen, uint32_t now) {
+    bool first = !iv.heard;
+    iv.heard = true;
+    uint32_t gap = now - last_seen;
+    if (first || gap == 0) return;
+    if (gap > DEVICE_TIMEOUT_MAX_MS) return;     // Back from an outage
+
+    if (iv.period_ms == 0) {
+        iv.period_ms = gap;
+        iv.jitter_ms = gap / 4;
+        iv.samples = 1;
+        return;
+    }
+
+    // Whole number of periods since the last report, if it is close to one
+    uint32_t tolerance = intervalTolerance(iv);
+    uint32_t k = (gap + iv.period_ms / 2) / iv.period_ms;
+    int64_t residual = (int64_t)gap - (int64_t)k * iv.period_ms;
+    bool fits = k >= 1 && llabs(residual) <= (int64_t)k * tolerance;
+
+    if (!fits || k > 1) {
+        // Early (event-driven) or a multiple of the period (lost reports).
+        // The same off-period gap again and again means the sensor was
+        // reconfigured: start over from it.
+        if (iv.candidate_count && llabs((int64_t)gap - iv.candidate_ms) <= iv.candidate_ms / 10) {
+            iv.candidate_count++;
+        } else {
+            iv.candidate_ms = gap;
+            iv.candidate_count = 1;
+        }
+        if (iv.candidate_count >= INTERVAL_RELEARN) {
+            iv.period_ms = iv.candidate_ms;
+            iv.jitter_ms = iv.candidate_ms / 8;
+            iv.samples = 1;
+            iv.candidate_count = 0;
+            return;
+        }
+    } else {
+        iv.candidate_count = 0;
+    }
+
+    bool learned = iv.samples >= DEVICE_INTERVAL_MIN_SAMPLES;
+    if (k == 0) return;                  // Event-driven report: nothing to learn
+    if (learned) {
+        iv.expected += fits ? k : 1;
+        if (fits) iv.on_time++;
+    }
+    if (!fits) k = 1;                    // A genuinely longer interval
+
+    // Jacobson/Karels update, gain 1/8 (1/2 while learning). Errors are
+    // clamped once learned so an outlier moves the estimate a bounded amount.
+    int32_t err = (int32_t)(gap / k) - (int32_t)iv.period_ms;
+    if (learned) {
+        int32_t limit = (int32_t)(4 * iv.jitter_ms > iv.period_ms / 4 ? 4 * iv.jitter_ms : iv.period_ms / 4);
+        err = constrain(err, -limit, limit);
+    }
+    int32_t gain = learned ? 8 : 2;
+    int32_t period = (int32_t)iv.period_ms + err / gain;
+    int32_t jitter = (int32_t)iv.jitter_ms + (abs(err) - (int32_t)iv.jitter_ms) / gain;
+    iv.period_ms = period > 0 ? period : 1;
+    iv.jitter_ms = jitter > 0 ? jitter : 0;
+    if (iv.samples < 255) iv.samples++;
+}
+
+uint32_t deviceOfflineTimeout(const DeviceInterval& iv) {
+    if (iv.samples < DEVICE_INTERVAL_MIN_SAMPLES) return DEVICE_TIMEOUT_MS;
+    uint64_t timeout = (uint64_t)DEVICE_MISSED_INTERVALS * iv.period_ms + 4ULL * iv.jitter_ms;
+    if (timeout < DEVICE_TIMEOUT_MIN_MS) return DEVICE_TIMEOUT_MIN_MS;
+    if (timeout > DEVICE_TIMEOUT_MAX_MS) return DEVICE_TIMEOUT_MAX_MS;
+    return (uint32_t)timeout;
+}
+
+int32_t deviceNextReportIn(const DeviceInterval& iv, uint32_t last_seen) {
+    if (!iv.heard || iv.period_ms == 0) return 0;
+    return (int32_t)(last_seen + iv.period_ms - clockMillis());
+}
+
+float deviceOnTimeRatio(const DeviceInterval& iv) {
+    return iv.expected ? (float)iv.on_time / iv.expected : -1.0f;
+}
+
+void appendDeviceIntervalMetrics(String& out) {
+    char line[160];
+
+    out += F("# HELP lora_bridge_device_interval_seconds Learned reporting interval\n"
+             "# TYPE lora_bridge_device_interval_seconds gauge\n");
+    for (int i = 0; i < device_count; i++) {
+        if (!devices[i].active) continue;
+        DeviceSnapshot snap;
+        snapshotDevice(&devices[i], snap);
+        if (snap.interval.samples < DEVICE_INTERVAL_MIN_SAMPLES) continue;
+        snprintf(line, sizeof(line), "lora_bridge_device_interval_seconds{device=\"%.31s\"} %.1f\n",
+                 devices[i].id, snap.interval.period_ms / 1000.0f);
+        out += line;
+    }
+
+    out += F("# HELP lora_bridge_device_offline_timeout_seconds Silence before the device is offline\n"
+             "# TYPE lora_bridge_device_offline_timeout_seconds gauge\n");
+    for (int i = 0; i < device_count; i++) {
+        if (!devices[i].active) continue;
+        DeviceSnapshot snap;
+        snapshotDevice(&devices[i], snap);
+        snprintf(line, sizeof(line), "lora_bridge_device_offline_timeout_seconds{device=\"%.31s\"} %lu\n",
+                 devices[i].id, (unsigned long)(deviceOfflineTimeout(snap.interval) / 1000));
+        out += line;
+    }
+
+    out += F("# HELP lora_bridge_device_on_time_ratio Predicted reports that arrived on time\n"
+             "# TYPE lora_bridge_device_on_time_ratio gauge\n");
+    for (int i = 0; i < device_count; i++) {
+        if (!devices[i].active) continue;
+        DeviceSnapshot snap;
+        snapshotDevice(&devices[i], snap);
+        float ratio = deviceOnTimeRatio(snap.interval);
+        if (ratio < 0) continue;
+        snprintf(line, sizeof(line), "lora_bridge_device_on_time_ratio{device=\"%.31s\"} %.4f\n",
+                 devices[i].id, ratio);
+        out += line;
+    }
+}
@@ -9,8 +9,13 @@
 #include "hardware/LoRaModule.h"
 #include "hardware/Display.h"
 #include "core/Config.h"
+#include "core/BootTimeline.h"
+#include "core/HeapProfiler.h"
+#include "core/EventBus.h"
+#include "core/Log.h"
+#include "core/Clock.h"
+#include "data/ActivityLog.h"
 #include "network/WebServerModule.h"
-#include "network/MQTTModule.h"
 
 // ============== Mode Flags ==============
 bool homekit_started = false;
@@ -22,7 +27,7 @@ extern volatile bool power_led_enabled;
 void setupHomeKit() {
     displayProgress("HomeKit", "Initializing...", 0);
     homeSpan.setPortNum(51827);
-    Serial.println("[HOMEKIT] Configuring...");
+    LOG_INFO("[HOMEKIT] Configuring...");
     homeSpan.setLogLevel(1);
 
     // Only enable status LED if power LED is enabled
@@ -35,15 +40,15 @@ void setupHomeKit() {
     homeSpan.setQRID(HOMEKIT_SETUP_ID);
     homeSpan.enableOTA();
 
-    Serial.printf("[HOMEKIT] Pairing code: %s\n", homekit_code_display);
+    LOG_INFO("[HOMEKIT] Pairing code: %s", homekit_code_display);
 
     displayProgress("HomeKit", "Creating bridge...", 50);
 
-    Serial.println("[HOMEKIT] Starting bridge...");
+    LOG_INFO("[HOMEKIT] Starting bridge...");
     homeSpan.begin(Category::Bridges, "LoRa Bridge", "LORA", "LoRa-HK");
 
     // Create bridge accessory
-    Serial.println("[HOMEKIT] Creating bridge accessory...");
+    LOG_INFO("[HOMEKIT] Creating bridge accessory...");
     new SpanAccessory();
     new Service::AccessoryInformation();
     new Characteristic::Identify();
@@ -55,10 +60,9 @@ void setupHomeKit() {
 
     homekit_started = true;
 
-    // Load saved devices and create HomeKit accessories
-    loadDevices();
+    // Create HomeKit accessories for devices loaded at boot (or heard since)
     if (device_count > 0) {
-        Serial.printf("[HOMEKIT] Creating accessories for %d saved devices...\n", device_count);
+        LOG_INFO("[HOMEKIT] Creating accessories for %d saved devices...", device_count);
         for (int i = 0; i < device_count; i++) {
             if (devices[i].active) {
                 createHomekitAccessory(&devices[i]);
@@ -67,21 +71,23 @@ void setupHomeKit() {
     }
 
     displayProgress("HomeKit", "Ready!", 100);
-    Serial.printf("[HOMEKIT] Initialized with %d devices\n", device_count);
+    LOG_INFO("[HOMEKIT] Initialized with %d devices", device_count);
 
-    delay(500);
+    bootDelay(500);
 }
 
 // ============== Device Management Functions ==============
 void createHomekitAccessory(Device* dev) {
     if (!homekit_started) return;
 
-    Serial.printf("[HOMEKIT] Creating accessory for LoRa:%s as HomeKit:%s\n", dev->id, dev->name);
+    HeapScope heapScope(HEAP_SUBSYS_HOMEKIT);
+
+    LOG_INFO("[HOMEKIT] Creating accessory for LoRa:%s as HomeKit:%s", dev->id, dev->name);
 
     SpanAccessory* acc = new SpanAccessory();
     dev->aid = acc->getAID();  // Store AID for later deletion
     dev->nameChar = nullptr;   // Will be set by first sensor service with ConfiguredName
-    Serial.printf("[HOMEKIT] Assigned AID: %d\n", dev->aid);
+    LOG_INFO("[HOMEKIT] Assigned AID: %d", dev->aid);
 
     new Service::AccessoryInformation();
     new Characteristic::Identify();
@@ -99,26 +105,26 @@ void createHomekitAccessory(Device* dev) {
 
     // Motion sensor with type selection (Leak/Smoke/CO have critical alerts!)
     if (dev->has_motion) {
-        Serial.printf("[HOMEKIT] Creating motion sensor type: %d (%s)\n", dev->motion_type, getMotionTypeName(dev->motion_type));
+        LOG_INFO("[HOMEKIT] Creating motion sensor type: %d (%s)", dev->motion_type, getMotionTypeName(dev->motion_type));
         switch (dev->motion_type) {
             case MOTION_TYPE_OCCUPANCY:
-                Serial.println("[HOMEKIT] -> OccupancySensor");
+                LOG_INFO("[HOMEKIT] -> OccupancySensor");
                 new OccupancySensorMotion(dev);
                 break;
             case MOTION_TYPE_LEAK:
-                Serial.println("[HOMEKIT] -> LeakSensor (critical!)");
+                LOG_INFO("[HOMEKIT] -> LeakSensor (critical!)");
                 new LeakSensorMotion(dev);
                 break;
             case MOTION_TYPE_SMOKE:
-                Serial.println("[HOMEKIT] -> SmokeSensor (critical!)");
+                LOG_INFO("[HOMEKIT] -> SmokeSensor (critical!)");
                 new SmokeSensorMotion(dev);
                 break;
             case MOTION_TYPE_CO:
-                Serial.println("[HOMEKIT] -> COSensor (critical!)");
+                LOG_INFO("[HOMEKIT] -> COSensor (critical!)");
                 new COSensorMotion(dev);
                 break;
             default:
-                Serial.println("[HOMEKIT] -> MotionSensor");
+                LOG_INFO("[HOMEKIT] -> MotionSensor");
                 new MotionSensorService(dev);
                 break;
         }
@@ -147,35 +153,46 @@ void createHomekitAccessory(Device* dev) {
 
     // Notify HomeKit that accessory database has changed
     homeSpan.updateDatabase();
-    Serial.println("[HOMEKIT] Database updated");
+    LOG_INFO("[HOMEKIT] Database updated");
 }
 
-Device* registerDevice(const char* id, JsonDocument& doc) {
-    if (device_count >= MAX_DEVICES) {
-        Serial.println("[DEVICE] Max devices reached!");
+Device* registerDevice(const DeviceReading& r) {
+    HeapScope heapScope(HEAP_SUBSYS_DEVICE);
+
+    // Reuse the slot of a removed device before growing the table
+    int slot = device_count;
+    for (int i = 0; i < device_count; i++) {
+        if (!devices[i].active) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot >= MAX_DEVICES) {
+        LOG_WARN("[DEVICE] Max devices reached!");
         last_event = "ERR: Max devices!";
         return nullptr;
     }
 
-    Device* dev = &devices[device_count++];
+    // Fill the slot before publishing it: the ingest task may be searching
+    // the table concurrently in dual-core mode
+    Device* dev = &devices[slot];
     memset(dev, 0, sizeof(Device));
-    strncpy(dev->id, id, sizeof(dev->id) - 1);
-    strncpy(dev->name, id, sizeof(dev->name) - 1);  // Default name = ID
-    dev->active = true;
+    snprintf(dev->id, sizeof(dev->id), "%s", r.id);
+    snprintf(dev->name, sizeof(dev->name), "%s", r.id);  // Default name = ID
 
     // Detect capabilities from first message
-    dev->has_temp = doc.containsKey("t");
-    dev->has_hum = doc.containsKey("hu");
-    dev->has_batt = doc.containsKey("b");
-    dev->has_light = doc.containsKey("l");
-    dev->has_motion = doc.containsKey("m");
-    dev->has_contact = doc.containsKey("c");
-
-    Serial.printf("[DEVICE] New: %s (temp:%d hum:%d batt:%d light:%d motion:%d contact:%d)\n",
-                  id, dev->has_temp, dev->has_hum, dev->has_batt,
-                  dev->has_light, dev->has_motion, dev->has_contact);
-
-    last_event = "New: " + String(id);
+    dev->has_temp = r.fields & ACT_TEMP;
+    dev->has_hum = r.fields & ACT_HUM;
+    dev->has_batt = r.fields & ACT_BATT;
+    dev->has_light = r.fields & ACT_LUX;
+    dev->has_motion = r.fields & ACT_MOTION;
+    dev->has_contact = r.fields & ACT_CONTACT;
+    __atomic_store_n(&dev->active, true, __ATOMIC_RELEASE);
+    if (slot == device_count) device_count++;
+
+    LOG_INFO("[DEVICE] New: %s (temp:%d hum:%d batt:%d light:%d motion:%d contact:%d)",
+             dev->id, dev->has_temp, dev->has_hum, dev->has_batt,
+             dev->has_light, dev->has_motion, dev->has_contact);
 
     // Create HomeKit accessory
     createHomekitAccessory(dev);
@@ -183,12 +200,10 @@ Device* registerDevice(const char* id, JsonDocument& doc) {
     // Save to flash
     saveDevices();
 
-    // Publish Home Assistant auto-discovery if MQTT enabled
-    if (mqtt_enabled) {
-        publishHomeAssistantDiscovery(dev, id);
-        // Update gateway diagnostics (active_devices count changed)
-        publishBridgeDiagnosticsIfChanged();
-    }
+    // MQTT discovery, journal and display follow from the event
+    DeviceEvent ev;
+    initDeviceEvent(ev, DEVICE_EVENT_REGISTERED, dev);
+    eventBusPublish(ev);
 
     return dev;
 }
@@ -196,28 +211,26 @@ Device* registerDevice(const char* id, JsonDocument& doc) {
 bool removeDevice(const char* id) {
     for (int i = 0; i < device_count; i++) {
         if (devices[i].active && strcmp(devices[i].id, id) == 0) {
-            Serial.printf("[DEVICE] Removing: %s (AID: %d)\n", id, devices[i].aid);
+            LOG_INFO("[DEVICE] Removing: %s (AID: %d)", id, devices[i].aid);
+
+            DeviceEvent ev;
+            initDeviceEvent(ev, DEVICE_EVENT_REMOVED, &devices[i]);
+            eventBusPublish(ev);
 
             // Delete from HomeKit dynamically
             if (devices[i].aid > 0 && homekit_started) {
                 if (homeSpan.deleteAccessory(devices[i].aid)) {
-                    Serial.printf("[HOMEKIT] Deleted accessory AID: %d\n", devices[i].aid);
+                    LOG_INFO("[HOMEKIT] Deleted accessory AID: %d", devices[i].aid);
                     homeSpan.updateDatabase();
-                    Serial.println("[HOMEKIT] Database updated");
+                    LOG_INFO("[HOMEKIT] Database updated");
                 } else {
-                    Serial.printf("[HOMEKIT] Failed to delete AID: %d\n", devices[i].aid);
+                    LOG_WARN("[HOMEKIT] Failed to delete AID: %d", devices[i].aid);
                 }
             }
 
-            // Remove from MQTT (Home Assistant)
-            if (mqtt_enabled) {
-                removeDeviceFromMQTT(id);
-                // Update gateway diagnostics (active_devices count changed)
-                publishBridgeDiagnosticsIfChanged();
-            }
-
-            // Clear device pointers
+            // Clear device pointers; the slot is free for the next new device
             devices[i].active = false;
+            forgetActivityDevice(i);
             devices[i].aid = 0;
             devices[i].tempChar = nullptr;
             devices[i].humChar = nullptr;
@@ -238,12 +251,12 @@ bool renameDevice(const char* id, const char* newName) {
     Device* dev = findDevice(id);
     if (!dev) return false;
 
-    Serial.printf("[DEVICE] Renaming %s (LoRa ID: %s) to: %s\n", dev->name, dev->id, newName);
+    LOG_INFO("[DEVICE] Renaming %s (LoRa ID: %s) to: %s", dev->name, dev->id, newName);
 
     // Delete old HomeKit accessory and recreate with new AID
     uint32_t spacerAid = 0;
     if (dev->aid > 0 && homekit_started) {
-        Serial.printf("[HOMEKIT] Deleting accessory AID: %d for rename\n", dev->aid);
+        LOG_INFO("[HOMEKIT] Deleting accessory AID: %d for rename", dev->aid);
         homeSpan.deleteAccessory(dev->aid);
 
         // Create spacer to consume old AID
@@ -276,68 +289,142 @@ bool renameDevice(const char* id, const char* newName) {
             homeSpan.deleteAccessory(spacerAid);
             homeSpan.updateDatabase();
         }
-        Serial.printf("[HOMEKIT] Recreated accessory with new name, AID=%d\n", dev->aid);
+        LOG_INFO("[HOMEKIT] Recreated accessory with new name, AID=%d", dev->aid);
     }
 
     saveDevices();
+
+    DeviceEvent ev;
+    initDeviceEvent(ev, DEVICE_EVENT_RENAMED, dev);
+    eventBusPublish(ev);
     return true;
 }
 
-void updateDevice(Device* dev, JsonDocument& doc, int rssi) {
-    dev->rssi = rssi;
-    dev->last_seen = millis();
+// Binary sensor value: accepts true/false, 1 and "on"/"1"/"true" (any case)
+static bool parseOnOff(JsonVariant v) {
+    if (v.is<bool>()) return v.as<bool>();
+    if (v.is<int>()) return v.as<int>() == 1;
+    const char* s = v.as<const char*>();
+    if (!s) return false;
+    return strcasecmp(s, "on") == 0 || strcmp(s, "1") == 0 || strcasecmp(s, "true") == 0;
+}
 
-    String eventStr = String(dev->id) + " ";
+bool parseReading(JsonDocument& doc, int rssi, DeviceReading& r) {
+    memset(&r, 0, sizeof(r));
+    const char* id = doc["id"];
+    if (!id || !*id) return false;
+    strncpy(r.id, id, sizeof(r.id) - 1);
+    r.rssi = rssi;
 
     if (doc.containsKey("t")) {
-        dev->temperature = doc["t"].as<float>();
-        if (dev->tempChar) dev->tempChar->setVal(dev->temperature);
-        eventStr += String(dev->temperature, 1) + "C ";
+        r.fields |= ACT_TEMP;
+        r.temperature = doc["t"].as<float>();
     }
     if (doc.containsKey("hu")) {
-        dev->humidity = doc["hu"].as<float>();
-        if (dev->humChar) dev->humChar->setVal(dev->humidity);
-        eventStr += String((int)dev->humidity) + "% ";
+        r.fields |= ACT_HUM;
+        r.humidity = doc["hu"].as<float>();
     }
     if (doc.containsKey("b")) {
-        dev->battery = doc["b"].as<int>();
-        if (dev->battChar) dev->battChar->setVal(dev->battery);
+        r.fields |= ACT_BATT;
+        r.battery = doc["b"].as<int>();
     }
     if (doc.containsKey("l")) {
-        dev->lux = doc["l"].as<int>();
-        if (dev->lightChar) dev->lightChar->setVal(max(0.0001f, (float)dev->lux));
+        r.fields |= ACT_LUX;
+        r.lux = doc["l"].as<int>();
     }
     if (doc.containsKey("m")) {
-        // Handle both string ("on"/"off") and boolean (true/false) values
-        if (doc["m"].is<bool>()) {
-            dev->motion = doc["m"].as<bool>();
-        } else {
-            String mVal = doc["m"].as<String>();
-            dev->motion = (mVal == "on" || mVal == "1" || mVal == "true");
-        }
-        if (dev->motionChar) dev->motionChar->setVal(dev->motion);
-        eventStr += dev->motion ? "MOT " : "";
+        r.fields |= ACT_MOTION;
+        if (parseOnOff(doc["m"])) r.fields |= ACT_MOTION_ON;
     }
     if (doc.containsKey("c")) {
-        // Handle both string ("on"/"off") and boolean (true/false) values
-        if (doc["c"].is<bool>()) {
-            dev->contact = doc["c"].as<bool>();
-        } else {
-            String cVal = doc["c"].as<String>();
-            dev->contact = (cVal == "on" || cVal == "1" || cVal == "true");
+        r.fields |= ACT_CONTACT;
+        if (parseOnOff(doc["c"])) r.fields |= ACT_CONTACT_CLOSED;
+    }
+    return true;
+}
+
+// Device state only - safe to call from the ingest task
+void applyReading(Device* dev, const DeviceReading& r) {
+    deviceWriteBegin(dev);
+    uint32_t now = clockMillis();
+    dev->rssi = r.rssi;
+    deviceIntervalObserve(dev->interval, dev->last_seen, now);
+    dev->last_seen = now;
+
+    if (r.fields & ACT_TEMP) dev->temperature = r.temperature;
+    if (r.fields & ACT_HUM) dev->humidity = r.humidity;
+    if (r.fields & ACT_BATT) dev->battery = r.battery;
+    if (r.fields & ACT_LUX) dev->lux = r.lux;
+    if (r.fields & ACT_MOTION) dev->motion = r.fields & ACT_MOTION_ON;
+    if (r.fields & ACT_CONTACT) dev->contact = r.fields & ACT_CONTACT_CLOSED;
+    deviceWriteEnd(dev);
+}
+
+static void publishAvailability(Device* dev, bool online) {
+    dev->offline = !online;
+    LOG_INFO("[DEVICE] %s is %s", dev->id, online ? "back online" : "offline");
+
+    DeviceEvent ev;
+    initDeviceEvent(ev, DEVICE_EVENT_AVAILABILITY, dev);
+    ev.online = online;
+    eventBusPublish(ev);
+}
+
+// Hot path: runs for every packet. Only queues the reading; the sinks
+// (HomeKit, logs, MQTT, display) run from eventBusDispatch().
+void publishReading(Device* dev, const DeviceReading& r) {
+    if (dev->offline) publishAvailability(dev, true);
+
+    DeviceEvent ev;
+    initDeviceEvent(ev, DEVICE_EVENT_READING, dev);
+    ev.reading = r;
+    eventBusPublish(ev);
+}
+
+void updateDevice(Device* dev, const DeviceReading& r) {
+    applyReading(dev, r);
+    publishReading(dev, r);
+}
+
+void checkDeviceAvailability() {
+    for (int i = 0; i < device_count; i++) {
+        Device* dev = &devices[i];
+        if (!dev->active || dev->offline) continue;
+
+        DeviceSnapshot snap;
+        snapshotDevice(dev, snap);
+        if (clockElapsedMs(snap.last_seen) > deviceOfflineTimeout(snap.interval)) {
+            publishAvailability(dev, false);
         }
-        if (dev->contactChar) dev->contactChar->setVal(dev->contact ? 0 : 1);
     }
+}
 
-    last_event = eventStr;
+// ============== HomeKit Event Sink ==============
+// Uses the event's values, not dev's, which may already be newer
+static void homekitSink(const DeviceEvent& ev) {
+    HeapScope heapScope(HEAP_SUBSYS_HOMEKIT);
 
-    // Log activity for web UI - serialize JSON document to string
-    String jsonStr;
-    serializeJson(doc, jsonStr);
-    logActivity(dev->name, jsonStr.c_str());
+    Device* dev = getEventDevice(ev);
+    const DeviceReading& r = ev.reading;
+    if (!dev) return;
 
-    // Publish to MQTT if enabled
-    if (mqtt_enabled) {
-        publishDeviceData(dev, doc, rssi);
+    if ((r.fields & ACT_TEMP) && dev->tempChar) dev->tempChar->setVal(r.temperature);
+    if ((r.fields & ACT_HUM) && dev->humChar) dev->humChar->setVal(r.humidity);
+    if ((r.fields & ACT_BATT) && dev->battChar) dev->battChar->setVal(r.battery);
+    if ((r.fields & ACT_LUX) && dev->lightChar) {
+        dev->lightChar->setVal(max(0.0001f, (float)r.lux));
     }
+    if ((r.fields & ACT_MOTION) && dev->motionChar) {
+        dev->motionChar->setVal((bool)(r.fields & ACT_MOTION_ON));
+    }
+    if ((r.fields & ACT_CONTACT) && dev->contactChar) {
+        dev->contactChar->setVal((r.fields & ACT_CONTACT_CLOSED) ? 0 : 1);
+    }
+}
+
+void subscribeHomeKitEvents() {
+    // Only the latest value matters to HomeKit, so queued readings coalesce
+    static DeviceEvent queue[8];
+    eventBusSubscribe("homekit", homekitSink, DEVICE_EVENT_BIT(DEVICE_EVENT_READING),
+                      3, EVENT_COALESCE, queue, 8);
 }
@@ -9,11 +9,17 @@
 // Use QRCode library wrapper to avoid conflict with ESP32 SDK
 #include <QRCode_Library.h>
 #include "core/Device.h"
+#include "core/FixedString.h"
+#include "core/HeapProfiler.h"
+#include "core/EventBus.h"
+#include "core/Clock.h"
+#include "core/Log.h"
+#include "data/ActivityLog.h"
 
 // External global variables
 extern float lora_frequency;
-extern String last_event;
-extern unsigned long last_packet_time;
+extern FixedString<LAST_EVENT_LEN> last_event;
+extern uint32_t last_packet_time;
 extern uint32_t packets_received;
 
 // ============== Display Globals ==============
@@ -24,7 +30,7 @@ bool display_available = false;
 bool oled_enabled = true;
 uint8_t oled_brightness = 255;
 uint16_t oled_timeout = 60;  // seconds
-unsigned long oled_last_activity = 0;
+uint32_t oled_last_activity = 0;
 bool oled_is_off = false;
 
 void feedWatchdog() {
@@ -52,7 +58,7 @@ void displayInit() {
 
 void displayMessage(const char* line1, const char* line2, const char* line3, const char* line4) {
     // Always log to serial
-    Serial.printf("[MSG] %s | %s | %s | %s\n", line1, line2, line3, line4);
+    LOG_INFO("[MSG] %s | %s | %s | %s", line1, line2, line3, line4);
 
     if (!display_available || !oled_enabled) return;
     wakeOled();
@@ -148,7 +154,7 @@ void displayPairingScreen() {
 
 void wakeOled() {
     if (!display_available) return;
-    oled_last_activity = millis();
+    oled_last_activity = clockMillis();
     if (oled_is_off && oled_enabled) {
         display.displayOn();
         oled_is_off = false;
@@ -158,7 +164,7 @@ void wakeOled() {
 void checkOledTimeout() {
     if (!display_available || !oled_enabled || oled_timeout == 0) return;
 
-    if (!oled_is_off && (millis() - oled_last_activity > oled_timeout * 1000)) {
+    if (!oled_is_off && (clockElapsedMs(oled_last_activity) > oled_timeout * 1000)) {
         display.displayOff();
         oled_is_off = true;
     }
@@ -167,6 +173,8 @@ void checkOledTimeout() {
 void displayStatus() {
     if (!display_available || !oled_enabled) return;
 
+    HeapScope heapScope(HEAP_SUBSYS_DISPLAY);
+
     // Check if we should show pairing screen (WiFi connected but not paired)
     if (!ap_mode && homekit_started && WiFi.status() == WL_CONNECTED) {
         bool isPaired = homeSpan.controllerListBegin() != homeSpan.controllerListEnd();
@@ -195,6 +203,8 @@ void displayStatus() {
         // Normal operation display
         if (WiFi.status() == WL_CONNECTED) {
             display.drawString(0, 16, WiFi.localIP().toString());
+        } else if (wifi_connect_pending) {
+            display.drawString(0, 16, "WiFi: Connecting...");
         } else {
             display.drawString(0, 16, "WiFi: Reconnecting...");
         }
@@ -203,8 +213,9 @@ void displayStatus() {
         display.drawString(0, 40, "Dev:" + String(device_count) + " Pkt:" + String(packets_received));
 
         // Show last event or pairing code
-        if (last_event.length() > 0 && millis() - last_packet_time < 5000) {
-            display.drawString(0, 52, last_event.substring(0, 21));
+        if (last_event.length() > 0 && clockElapsedMs(last_packet_time) < 5000) {
+            FixedString<22> eventLine = last_event.c_str();
+            display.drawString(0, 52, eventLine.c_str());
         } else {
             display.drawString(0, 52, "HK: " + String(homekit_code_display));
         }
@@ -212,3 +223,38 @@ void displayStatus() {
 
     display.display();
 }
+
+// ============== Event Sink ==============
+// Keeps the status line (last_event) current
+static void displaySink(const DeviceEvent& ev) {
+    const DeviceReading& r = ev.reading;
+
+    switch (ev.type) {
+        case DEVICE_EVENT_READING:
+            last_event = r.id;
+            last_event.append(" ");
+            if (r.fields & ACT_TEMP) last_event.appendf("%.1fC ", r.temperature);
+            if (r.fields & ACT_HUM) last_event.appendf("%d%% ", (int)r.humidity);
+            if (r.fields & ACT_MOTION_ON) last_event.append("MOT ");
+            break;
+        case DEVICE_EVENT_REGISTERED:
+            last_event = "New: ";
+            last_event.append(r.id);
+            break;
+        case DEVICE_EVENT_AVAILABILITY:
+            if (!ev.online) {
+                last_event = "Offline: ";
+                last_event.append(r.id);
+            }
+            break;
+    }
+}
+
+void subscribeDisplayEvents() {
+    static DeviceEvent queue[4];
+    eventBusSubscribe("display", displaySink,
+                      DEVICE_EVENT_BIT(DEVICE_EVENT_READING) |
+                          DEVICE_EVENT_BIT(DEVICE_EVENT_REGISTERED) |
+                          DEVICE_EVENT_BIT(DEVICE_EVENT_AVAILABILITY),
+                      0, EVENT_COALESCE, queue, 4);
+}
@@ -0,0 +1,121 @@
+/*
+ * Downlink.cpp - Commands to Sensors Implementation
+ */
+
+#include "hardware/Downlink.h"
+#include "hardware/LoRaModule.h"
+#include "data/Encryption.h"
+#include "data/Settings.h"
+#include "core/Clock.h"
+#include "core/Log.h"
+#include <freertos/FreeRTOS.h>
+
+DownlinkStats downlink_stats;
+
+// Stats are written by the radio task and read by the loop task; the
+// pending downlink is the radio task's alone
+static portMUX_TYPE downlink_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static bool pending = false;
+static DownlinkCommand pending_cmd;
+static uint8_t pending_sf = 0;
+static uint32_t due_us = 0;
+
+// ============== Frames ==============
+size_t downlinkEncode(const DownlinkCommand& cmd, uint8_t* out, size_t size) {
+    char fields[24] = "";
+    int n = 0;
+    if (cmd.sf) n += snprintf(fields + n, sizeof(fields) - n, ",\"sf\":%u", cmd.sf);
+    if (cmd.power != DOWNLINK_POWER_KEEP) snprintf(fields + n, sizeof(fields) - n, ",\"pw\":%d", cmd.power);
+
+    int len = snprintf((char*)out, size, "{\"k\":\"%s\",\"id\":\"%s\",\"q\":%u%s}", gateway_key, cmd.id,
+                       cmd.seq, fields);
+    if (len < 0 || (size_t)len >= size) return 0;
+    return encryptBuffer(out, len, size);
+}
+
+// ============== Scheduling ==============
+bool downlinkSchedule(const DownlinkCommand& cmd, uint8_t sf, uint32_t uplink_end_us) {
+    if (pending) {
+        portENTER_CRITICAL(&downlink_lock);
+        downlink_stats.busy++;
+        portEXIT_CRITICAL(&downlink_lock);
+        return false;
+    }
+    pending_cmd = cmd;
+    pending_sf = sf;
+    due_us = uplink_end_us + DOWNLINK_RX_DELAY_MS * 1000UL;
+    pending = true;
+
+    portENTER_CRITICAL(&downlink_lock);
+    downlink_stats.scheduled++;
+    portEXIT_CRITICAL(&downlink_lock);
+    return true;
+}
+
+uint32_t downlinkNextDueMs() {
+    if (!pending) return UINT32_MAX;
+    int32_t until_us = (int32_t)(due_us - clockMicros());
+    return until_us > 0 ? (uint32_t)until_us / 1000 : 0;
+}
+
+void downlinkService() {
+    if (!pending) return;
+    int32_t until_us = (int32_t)(due_us - clockMicros());
+    if (until_us > 0) return;
+    pending = false;
+
+    uint32_t late_us = (uint32_t)-until_us;
+    if (late_us > DOWNLINK_MAX_LATE_MS * 1000UL) {
+        portENTER_CRITICAL(&downlink_lock);
+        downlink_stats.missed++;
+        portEXIT_CRITICAL(&downlink_lock);
+        LOG_WARN("[DL] %s: window missed by %lu ms", pending_cmd.id, (unsigned long)(late_us / 1000));
+        return;
+    }
+
+    uint8_t frame[DOWNLINK_FRAME_MAX];
+    size_t len = downlinkEncode(pending_cmd, frame, sizeof(frame));
+    if (len == 0) return;
+    uint32_t toa_us = loraTransmit(frame, len, pending_sf, DOWNLINK_TX_POWER);
+
+    portENTER_CRITICAL(&downlink_lock);
+    downlink_stats.sent++;
+    downlink_stats.airtime_us += toa_us;
+    downlink_stats.late_sum_us += late_us;
+    if (late_us > downlink_stats.late_max_us) downlink_stats.late_max_us = late_us;
+    portEXIT_CRITICAL(&downlink_lock);
+
+    LOG_INFO("[DL] %s q=%u sf=%u pw=%d on SF%u, %lu us late", pending_cmd.id, pending_cmd.seq,
+             pending_cmd.sf, pending_cmd.power == DOWNLINK_POWER_KEEP ? 0 : pending_cmd.power, pending_sf,
+             (unsigned long)late_us);
+}
+
+// ============== Reporting ==============
+void downlinkSnapshot(DownlinkStats& out) {
+    portENTER_CRITICAL(&downlink_lock);
+    out = downlink_stats;
+    portEXIT_CRITICAL(&downlink_lock);
+}
+
+void appendDownlinkMetrics(String& out) {
+    DownlinkStats s;
+    downlinkSnapshot(s);
+
+    char line[512];
+    snprintf(line, sizeof(line),
+             "# TYPE lora_bridge_downlinks_total counter\n"
+             "lora_bridge_downlinks_total{result=\"sent\"} %lu\n"
+             "lora_bridge_downlinks_total{result=\"busy\"} %lu\n"
+             "lora_bridge_downlinks_total{result=\"missed\"} %lu\n",
+             (unsigned long)s.sent, (unsigned long)s.busy, (unsigned long)s.missed);
+    out += line;
+    snprintf(line, sizeof(line),
+             "# TYPE lora_bridge_downlink_airtime_seconds_total counter\n"
+             "lora_bridge_downlink_airtime_seconds_total %.3f\n"
+             "# HELP lora_bridge_downlink_late_seconds_max Latest start after a window opened\n"
+             "# TYPE lora_bridge_downlink_late_seconds_max gauge\n"
+             "lora_bridge_downlink_late_seconds_max %.6f\n",
+             s.airtime_us / 1e6, s.late_max_us / 1e6);
+    out += line;
+}
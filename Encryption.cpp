@@ -39,6 +39,25 @@ void aesDecrypt(uint8_t* data, size_t len) {
     mbedtls_aes_free(&aes);
 }
 
+// Encrypt whole 16-byte blocks, as the sensors do for uplinks
+void aesEncrypt(uint8_t* data, size_t len) {
+    if (encrypt_key_len == 0 || len == 0) return;
+
+    uint8_t aes_key[16] = {0};
+    memcpy(aes_key, encrypt_key, min((int)encrypt_key_len, 16));
+
+    mbedtls_aes_context aes;
+    mbedtls_aes_init(&aes);
+    mbedtls_aes_setkey_enc(&aes, aes_key, 128);
+
+    size_t blocks = len / 16;
+    for (size_t i = 0; i < blocks; i++) {
+        mbedtls_aes_crypt_ecb(&aes, MBEDTLS_AES_ENCRYPT, data + (i * 16), data + (i * 16));
+    }
+
+    mbedtls_aes_free(&aes);
+}
+
 // ============== Main Decryption Function ==============
 void decryptBuffer(uint8_t* data, size_t len) {
     switch (encryption_mode) {
@@ -55,6 +74,26 @@ void decryptBuffer(uint8_t* data, size_t len) {
     }
 }
 
+// ============== Main Encryption Function ==============
+size_t encryptBuffer(uint8_t* data, size_t len, size_t size) {
+    switch (encryption_mode) {
+        case ENCRYPT_XOR:
+            xorBuffer(data, len);
+            return len;
+        case ENCRYPT_AES: {
+            // Zero padding to a whole block
+            size_t padded = (len + 15) / 16 * 16;
+            if (padded > size) return 0;
+            memset(data + len, 0, padded - len);
+            aesEncrypt(data, padded);
+            return padded;
+        }
+        case ENCRYPT_NONE:
+        default:
+            return len;
+    }
+}
+
 // ============== Helper Functions ==============
 const char* getEncryptionModeName(uint8_t mode) {
     switch (mode) {
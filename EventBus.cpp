@@ -0,0 +1,236 @@
+/*
+ * EventBus.cpp - Device Event Bus Implementation
+ */
+
+#include "core/EventBus.h"
+#include "core/Clock.h"
+#include "core/Log.h"
+#include "data/ActivityLog.h"
+
+// ============== Bus State ==============
+EventSink event_sinks[EVENT_BUS_MAX_SINKS];
+uint8_t event_sink_count = 0;
+
+static const char* const type_names[DEVICE_EVENT_TYPE_COUNT] = {
+    "reading", "registered", "removed", "renamed", "availability"
+};
+
+static const char* const policy_names[EVENT_POLICY_COUNT] = {
+    "drop_oldest", "drop_newest", "coalesce"
+};
+
+const char* getDeviceEventTypeName(uint8_t type) {
+    return type < DEVICE_EVENT_TYPE_COUNT ? type_names[type] : "unknown";
+}
+
+const char* getEventPolicyName(uint8_t policy) {
+    return policy < EVENT_POLICY_COUNT ? policy_names[policy] : "unknown";
+}
+
+// ============== Queue Helpers ==============
+static DeviceEvent& slot(EventSink& s, uint8_t i) {
+    return s.queue[(s.head + i) % s.capacity];
+}
+
+// Fold 'ev' into a queued reading: sinks only apply the fields whose bits
+// are set, so values the new reading lacks must survive from the old one
+static void mergeReading(DeviceEvent& queued, const DeviceEvent& ev) {
+    DeviceReading& q = queued.reading;
+    const DeviceReading& r = ev.reading;
+    if (r.fields & ACT_TEMP) q.temperature = r.temperature;
+    if (r.fields & ACT_HUM) q.humidity = r.humidity;
+    if (r.fields & ACT_BATT) q.battery = r.battery;
+    if (r.fields & ACT_LUX) q.lux = r.lux;
+
+    // State bits go with their field: the newer reading's where it has one
+    uint8_t states = 0;
+    if (r.fields & ACT_MOTION) states |= ACT_MOTION_ON;
+    if (r.fields & ACT_CONTACT) states |= ACT_CONTACT_CLOSED;
+    q.fields = (uint8_t)((q.fields & ~states) | r.fields);
+
+    q.rssi = r.rssi;
+    q.synthetic = q.synthetic && r.synthetic;
+    queued.at_ms = ev.at_ms;
+}
+
+// Merge into the device's newest queued reading, unless a lifecycle event
+// for the same device was queued after it (order must be kept)
+static bool coalesce(EventSink& s, const DeviceEvent& ev) {
+    for (int i = s.count - 1; i >= 0; i--) {
+        DeviceEvent& queued = slot(s, i);
+        if (queued.device != ev.device) continue;
+        if (queued.type != DEVICE_EVENT_READING) return false;
+        mergeReading(queued, ev);
+        s.stats.coalesced++;
+        return true;
+    }
+    return false;
+}
+
+// Remove the oldest queued reading to make room
+static bool evictReading(EventSink& s) {
+    for (uint8_t i = 0; i < s.count; i++) {
+        if (slot(s, i).type != DEVICE_EVENT_READING) continue;
+        for (uint8_t j = i; j + 1 < s.count; j++) {
+            slot(s, j) = slot(s, j + 1);
+        }
+        s.count--;
+        return true;
+    }
+    return false;
+}
+
+static void enqueue(EventSink& s, const DeviceEvent& ev) {
+    bool reading = ev.type == DEVICE_EVENT_READING;
+
+    if (reading && s.policy == EVENT_COALESCE && coalesce(s, ev)) return;
+
+    if (s.count == s.capacity) {
+        s.stats.dropped++;
+        if (reading && s.policy == EVENT_DROP_NEWEST) return;
+        if (!evictReading(s)) return;   // Only lifecycle events queued
+    }
+
+    slot(s, s.count) = ev;
+    s.count++;
+    if (s.count > s.stats.high_water) s.stats.high_water = s.count;
+}
+
+// ============== Bus Functions ==============
+bool eventBusSubscribe(const char* name, DeviceEventHandler handler, uint8_t mask,
+                       uint8_t priority, EventDropPolicy policy,
+                       DeviceEvent* queue, uint8_t capacity) {
+    for (uint8_t i = 0; i < event_sink_count; i++) {
+        if (strcmp(event_sinks[i].name, name) == 0) return true;
+    }
+    if (event_sink_count >= EVENT_BUS_MAX_SINKS || capacity == 0) {
+        LOG_ERROR("[EVENTS] Cannot subscribe %s", name);
+        return false;
+    }
+
+    // Insert after sinks of equal or higher priority
+    uint8_t pos = event_sink_count;
+    while (pos > 0 && event_sinks[pos - 1].priority < priority) {
+        event_sinks[pos] = event_sinks[pos - 1];
+        pos--;
+    }
+
+    EventSink& s = event_sinks[pos];
+    memset(&s, 0, sizeof(s));
+    s.name = name;
+    s.handler = handler;
+    s.mask = mask;
+    s.priority = priority;
+    s.policy = policy;
+    s.queue = queue;
+    s.capacity = capacity;
+    event_sink_count++;
+
+    LOG_INFO("[EVENTS] %s subscribed (priority %u, %s, queue %u)",
+             name, priority, getEventPolicyName(policy), capacity);
+    return true;
+}
+
+void initDeviceEvent(DeviceEvent& ev, DeviceEventType type, const Device* dev) {
+    memset(&ev, 0, sizeof(ev));
+    ev.type = type;
+    ev.device = (uint8_t)(dev - devices);
+    ev.at_ms = clockMillis();
+    snprintf(ev.reading.id, sizeof(ev.reading.id), "%s", dev->id);
+}
+
+Device* getEventDevice(const DeviceEvent& ev) {
+    Device* dev = &devices[ev.device];
+    if (!dev->active || strncmp(dev->id, ev.reading.id, sizeof(dev->id)) != 0) return nullptr;
+    return dev;
+}
+
+void eventBusPublish(const DeviceEvent& ev) {
+    for (uint8_t i = 0; i < event_sink_count; i++) {
+        EventSink& s = event_sinks[i];
+        if (s.mask & DEVICE_EVENT_BIT(ev.type)) {
+            enqueue(s, ev);
+        }
+    }
+}
+
+void eventBusDispatch() {
+    for (uint8_t i = 0; i < event_sink_count; i++) {
+        EventSink& s = event_sinks[i];
+
+        for (uint8_t n = 0; n < EVENT_SINK_BUDGET && s.count > 0; n++) {
+            // Copy out first: the handler may publish to this queue
+            DeviceEvent ev = s.queue[s.head];
+            s.head = (s.head + 1) % s.capacity;
+            s.count--;
+
+            uint32_t start = clockMicros();
+            s.handler(ev);
+            uint32_t elapsed = clockElapsedUs(start);
+
+            s.stats.delivered++;
+            s.stats.total_us += elapsed;
+            if (elapsed > s.stats.max_us) s.stats.max_us = elapsed;
+        }
+    }
+}
+
+size_t eventBusPending() {
+    size_t pending = 0;
+    for (uint8_t i = 0; i < event_sink_count; i++) {
+        pending += event_sinks[i].count;
+    }
+    return pending;
+}
+
+void eventBusResetStats() {
+    for (uint8_t i = 0; i < event_sink_count; i++) {
+        memset(&event_sinks[i].stats, 0, sizeof(EventSinkStats));
+    }
+    LOG_INFO("[EVENTS] Statistics reset");
+}
+
+// ============== Metrics ==============
+void appendEventBusMetrics(String& out) {
+    char line[160];
+
+    out += F("# HELP lora_bridge_event_sink_delivered_total Events handled by each sink\n"
+             "# TYPE lora_bridge_event_sink_delivered_total counter\n");
+    for (uint8_t i = 0; i < event_sink_count; i++) {
+        snprintf(line, sizeof(line), "lora_bridge_event_sink_delivered_total{sink=\"%s\"} %lu\n",
+                 event_sinks[i].name, (unsigned long)event_sinks[i].stats.delivered);
+        out += line;
+    }
+
+    out += F("# HELP lora_bridge_event_sink_dropped_total Events lost to a full sink queue\n"
+             "# TYPE lora_bridge_event_sink_dropped_total counter\n");
+    for (uint8_t i = 0; i < event_sink_count; i++) {
+        snprintf(line, sizeof(line), "lora_bridge_event_sink_dropped_total{sink=\"%s\"} %lu\n",
+                 event_sinks[i].name, (unsigned long)event_sinks[i].stats.dropped);
+        out += line;
+    }
+
+    out += F("# HELP lora_bridge_event_sink_coalesced_total Readings merged into a queued one\n"
+             "# TYPE lora_bridge_event_sink_coalesced_total counter\n");
+    for (uint8_t i = 0; i < event_sink_count; i++) {
+        snprintf(line, sizeof(line), "lora_bridge_event_sink_coalesced_total{sink=\"%s\"} %lu\n",
+                 event_sinks[i].name, (unsigned long)event_sinks[i].stats.coalesced);
+        out += line;
+    }
+
+    out += F("# HELP lora_bridge_event_sink_queue_depth Events waiting in each sink queue\n"
+             "# TYPE lora_bridge_event_sink_queue_depth gauge\n");
+    for (uint8_t i = 0; i < event_sink_count; i++) {
+        snprintf(line, sizeof(line), "lora_bridge_event_sink_queue_depth{sink=\"%s\"} %u\n",
+                 event_sinks[i].name, event_sinks[i].count);
+        out += line;
+    }
+
+    out += F("# HELP lora_bridge_event_sink_microseconds_total Time spent in each sink\n"
+             "# TYPE lora_bridge_event_sink_microseconds_total counter\n");
+    for (uint8_t i = 0; i < event_sink_count; i++) {
+        snprintf(line, sizeof(line), "lora_bridge_event_sink_microseconds_total{sink=\"%s\"} %llu\n",
+                 event_sinks[i].name, (unsigned long long)event_sinks[i].stats.total_us);
+        out += line;
+    }
+}
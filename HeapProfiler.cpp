@@ -0,0 +1,197 @@
+/*
+ * HeapProfiler.cpp - Heap Allocation Profiler Implementation
+ */
+
+#include "core/HeapProfiler.h"
+#include "core/Clock.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// ============== Profiler State ==============
+HeapCounters heap_subsys[HEAP_SUBSYS_COUNT];
+volatile uint8_t heap_current_subsys = HEAP_SUBSYS_OTHER;
+bool heap_alloc_tracking = false;
+bool heap_report_verbose = false;
+HeapReport heap_last_packet, heap_worst_packet;
+HeapReport heap_last_http, heap_worst_http;
+HeapSample heap_trend[HEAP_TREND_SAMPLES];
+uint8_t heap_trend_count = 0;
+uint8_t heap_trend_index = 0;
+
+static const char* const subsys_names[HEAP_SUBSYS_COUNT] = {
+    "other", "lora", "device", "homekit", "mqtt", "web", "display", "tasks"
+};
+
+// ============== Allocator Hooks ==============
+void heapProfilerRecordAlloc(size_t size, uint8_t subsys) {
+    if (subsys >= HEAP_SUBSYS_COUNT) subsys = HEAP_SUBSYS_OTHER;
+    heap_subsys[subsys].allocs++;
+    heap_subsys[subsys].bytes += size;
+    heap_alloc_tracking = true;
+}
+
+void heapProfilerRecordFree(uint8_t subsys) {
+    if (subsys >= HEAP_SUBSYS_COUNT) subsys = HEAP_SUBSYS_OTHER;
+    heap_subsys[subsys].frees++;
+}
+
+static TaskHandle_t heap_loop_task = nullptr;
+
+bool heapProfilerOnLoopTask() {
+    return heap_loop_task == nullptr || xTaskGetCurrentTaskHandle() == heap_loop_task;
+}
+
+#if defined(HEAP_PROFILER_HOOKS) && defined(CONFIG_HEAP_USE_HOOKS)
+// Called by ESP-IDF for every allocation; counts are approximate when two
+// cores allocate at the same moment, which is fine for profiling
+extern "C" void IRAM_ATTR esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps) {
+    (void)ptr;
+    (void)caps;
+    uint8_t subsys = xTaskGetCurrentTaskHandle() == heap_loop_task ? heap_current_subsys
+                                                                   : HEAP_SUBSYS_TASKS;
+    heapProfilerRecordAlloc(size, subsys);
+}
+
+extern "C" void IRAM_ATTR esp_heap_trace_free_hook(void* ptr) {
+    (void)ptr;
+    uint8_t subsys = xTaskGetCurrentTaskHandle() == heap_loop_task ? heap_current_subsys
+                                                                   : HEAP_SUBSYS_TASKS;
+    heapProfilerRecordFree(subsys);
+}
+#endif
+
+// ============== Profiler Functions ==============
+const char* getHeapSubsystemName(uint8_t subsys) {
+    return subsys < HEAP_SUBSYS_COUNT ? subsys_names[subsys] : "unknown";
+}
+
+uint8_t getHeapFragmentation() {
+    uint32_t free_heap = ESP.getFreeHeap();
+    if (free_heap == 0) return 100;
+    uint32_t largest = ESP.getMaxAllocHeap();
+    return largest >= free_heap ? 0 : 100 - (uint8_t)((uint64_t)largest * 100 / free_heap);
+}
+
+void heapProfilerInit() {
+    heap_loop_task = xTaskGetCurrentTaskHandle();
+    heapProfilerSample();
+}
+
+void heapProfilerReset() {
+    memset(heap_subsys, 0, sizeof(heap_subsys));
+    memset(&heap_last_packet, 0, sizeof(HeapReport));
+    memset(&heap_worst_packet, 0, sizeof(HeapReport));
+    memset(&heap_last_http, 0, sizeof(HeapReport));
+    memset(&heap_worst_http, 0, sizeof(HeapReport));
+    Serial.println("[HEAP] Profiler statistics reset");
+}
+
+void heapProfilerSample() {
+    HeapSample& s = heap_trend[heap_trend_index];
+    s.free_heap = ESP.getFreeHeap();
+    s.largest_block = ESP.getMaxAllocHeap();
+
+    heap_trend_index = (heap_trend_index + 1) % HEAP_TREND_SAMPLES;
+    if (heap_trend_count < HEAP_TREND_SAMPLES) heap_trend_count++;
+}
+
+// ============== Report Scope ==============
+HeapReportScope::HeapReportScope(HeapReportKind kind, const char* site)
+    : active_(heapProfilerOnLoopTask()), kind_(kind) {
+    if (!active_) return;
+    setSite(site);
+    memcpy(before_, heap_subsys, sizeof(before_));
+    free_before_ = ESP.getFreeHeap();
+}
+
+void HeapReportScope::setSite(const char* site) {
+    strncpy(site_, site, sizeof(site_) - 1);
+    site_[sizeof(site_) - 1] = 0;
+}
+
+HeapReportScope::~HeapReportScope() {
+    if (!active_) return;
+
+    HeapReport r;
+    memset(&r, 0, sizeof(r));
+    memcpy(r.site, site_, sizeof(r.site));
+    r.at_ms = clockMillis();
+    r.free_delta = (int32_t)(ESP.getFreeHeap() - free_before_);
+    r.largest_block = ESP.getMaxAllocHeap();
+
+    for (uint8_t i = 0; i < HEAP_SUBSYS_COUNT; i++) {
+        uint32_t allocs = heap_subsys[i].allocs - before_[i].allocs;
+        r.allocs += allocs;
+        r.bytes += (uint32_t)(heap_subsys[i].bytes - before_[i].bytes);
+        r.subsys_allocs[i] = allocs > 0xFFFF ? 0xFFFF : allocs;
+    }
+
+    HeapReport& last = kind_ == HEAP_REPORT_PACKET ? heap_last_packet : heap_last_http;
+    HeapReport& worst = kind_ == HEAP_REPORT_PACKET ? heap_worst_packet : heap_worst_http;
+    last = r;
+
+    // Rank by bytes allocated when hooks are available, else by heap retained
+    bool is_worse = heap_alloc_tracking ? r.bytes > worst.bytes
+                                        : r.free_delta < worst.free_delta;
+    if (is_worse || worst.at_ms == 0) {
+        worst = r;
+    }
+
+    if (heap_report_verbose) {
+        const char* kind = kind_ == HEAP_REPORT_PACKET ? "packet" : "http";
+        if (heap_alloc_tracking) {
+            Serial.printf("[HEAP] %s %s: %lu allocs, %lu B, net %ld B, largest %lu B (",
+                          kind, r.site, (unsigned long)r.allocs, (unsigned long)r.bytes,
+                          (long)r.free_delta, (unsigned long)r.largest_block);
+            bool first = true;
+            for (uint8_t i = 0; i < HEAP_SUBSYS_COUNT; i++) {
+                if (r.subsys_allocs[i] == 0) continue;
+                Serial.printf("%s%s %u", first ? "" : ", ", subsys_names[i], r.subsys_allocs[i]);
+                first = false;
+            }
+            Serial.println(")");
+        } else {
+            Serial.printf("[HEAP] %s %s: net %ld B, free %lu B, largest %lu B\n", kind, r.site,
+                          (long)r.free_delta, (unsigned long)ESP.getFreeHeap(),
+                          (unsigned long)r.largest_block);
+        }
+    }
+}
+
+// ============== Metrics ==============
+void appendHeapProfilerMetrics(String& out) {
+    char line[160];
+
+    snprintf(line, sizeof(line),
+             "# TYPE lora_bridge_free_heap_bytes gauge\n"
+             "lora_bridge_free_heap_bytes %lu\n",
+             (unsigned long)ESP.getFreeHeap());
+    out += line;
+    snprintf(line, sizeof(line),
+             "# TYPE lora_bridge_min_free_heap_bytes gauge\n"
+             "lora_bridge_min_free_heap_bytes %lu\n",
+             (unsigned long)ESP.getMinFreeHeap());
+    out += line;
+    snprintf(line, sizeof(line),
+             "# TYPE lora_bridge_largest_free_block_bytes gauge\n"
+             "lora_bridge_largest_free_block_bytes %lu\n",
+             (unsigned long)ESP.getMaxAllocHeap());
+    out += line;
+
+    if (!heap_alloc_tracking) return;
+
+    out += F("# HELP lora_bridge_heap_allocs_total Allocations per subsystem\n"
+             "# TYPE lora_bridge_heap_allocs_total counter\n");
+    for (uint8_t i = 0; i < HEAP_SUBSYS_COUNT; i++) {
+        snprintf(line, sizeof(line), "lora_bridge_heap_allocs_total{subsystem=\"%s\"} %lu\n",
+                 subsys_names[i], (unsigned long)heap_subsys[i].allocs);
+        out += line;
+    }
+    out += F("# HELP lora_bridge_heap_alloc_bytes_total Bytes allocated per subsystem\n"
+             "# TYPE lora_bridge_heap_alloc_bytes_total counter\n");
+    for (uint8_t i = 0; i < HEAP_SUBSYS_COUNT; i++) {
+        snprintf(line, sizeof(line), "lora_bridge_heap_alloc_bytes_total{subsystem=\"%s\"} %llu\n",
+                 subsys_names[i], (unsigned long long)heap_subsys[i].bytes);
+        out += line;
+    }
+}
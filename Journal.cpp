@@ -0,0 +1,319 @@
+/*
+ * Journal.cpp - Flash Event Journal Implementation
+ */
+
+#include "data/Journal.h"
+#include "core/Clock.h"
+#include "core/Log.h"
+#include <esp_partition.h>
+#include <esp_system.h>
+
+#define JOURNAL_MAGIC 0x4C4E524A     // "JRNL"
+#define JOURNAL_VERSION 2            // 2: device prefix shortened for device_hash
+#define JOURNAL_READ_BATCH 8         // Records per flash read (256 bytes of stack)
+
+// ============== Sector Header ==============
+struct JournalSectorHeader {
+    uint32_t magic;
+    uint32_t first_seq;       // Sequence number of slot 1
+    uint16_t version;
+    uint8_t reserved[21];
+    uint8_t crc;
+};
+
+static_assert(sizeof(JournalSectorHeader) == JOURNAL_RECORD_SIZE, "Header must fill one slot");
+
+// ============== Journal State ==============
+bool journal_available = false;
+uint16_t journal_boot = 0;
+
+static const esp_partition_t* journal_part = nullptr;
+static uint8_t sector_count = 0;
+static uint32_t sector_seq[JOURNAL_MAX_SECTORS];   // First seq per sector, 0 = erased
+static int head_sector = -1;
+static uint16_t head_used = 0;
+static uint32_t next_seq = 1;
+
+static const char* const type_names[JOURNAL_TYPE_COUNT] = {
+    "", "boot", "reading", "registered", "removed", "renamed", "rejected", "availability"
+};
+
+// ============== Helpers ==============
+static uint8_t crc8(const uint8_t* data, size_t len) {
+    uint8_t crc = 0;
+    while (len--) {
+        crc ^= *data++;
+        for (uint8_t i = 0; i < 8; i++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+// Keep the first JOURNAL_DEVICE_LEN characters and a hash of the whole ID
+static void setDevice(JournalRecord& rec, const char* device) {
+    memcpy(rec.device, device, strnlen(device, JOURNAL_DEVICE_LEN));
+    rec.device_hash = journalDeviceHash(device);
+}
+
+static bool recordValid(const JournalRecord& rec) {
+    return rec.seq != 0xFFFFFFFF && rec.crc == crc8((const uint8_t*)&rec, sizeof(rec) - 1);
+}
+
+static size_t slotOffset(uint8_t sector, uint16_t slot) {
+    return (size_t)sector * JOURNAL_SECTOR_SIZE + (size_t)slot * JOURNAL_RECORD_SIZE;
+}
+
+static int findSector(uint32_t seq) {
+    for (uint8_t s = 0; s < sector_count; s++) {
+        if (sector_seq[s] != 0 && seq >= sector_seq[s] && seq < sector_seq[s] + JOURNAL_RECORDS_PER_SECTOR) {
+            return s;
+        }
+    }
+    return -1;
+}
+
+static bool readRecord(uint32_t seq, JournalRecord& rec) {
+    int s = findSector(seq);
+    if (s < 0) return false;
+    esp_partition_read(journal_part, slotOffset(s, 1 + seq - sector_seq[s]), &rec, sizeof(rec));
+    return recordValid(rec) && rec.seq == seq;
+}
+
+// Erase the sector after the head (dropping the oldest records) and start it
+static bool advanceSector() {
+    uint8_t next = head_sector < 0 ? 0 : (head_sector + 1) % sector_count;
+
+    if (esp_partition_erase_range(journal_part, slotOffset(next, 0), JOURNAL_SECTOR_SIZE) != ESP_OK) {
+        LOG_ERROR("[JOURNAL] Erase of sector %u failed", next);
+        return false;
+    }
+    sector_seq[next] = 0;
+
+    JournalSectorHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = JOURNAL_MAGIC;
+    hdr.first_seq = next_seq;
+    hdr.version = JOURNAL_VERSION;
+    hdr.crc = crc8((const uint8_t*)&hdr, sizeof(hdr) - 1);
+    if (esp_partition_write(journal_part, slotOffset(next, 0), &hdr, sizeof(hdr)) != ESP_OK) {
+        return false;
+    }
+
+    sector_seq[next] = next_seq;
+    head_sector = next;
+    head_used = 0;
+    return true;
+}
+
+static void append(JournalRecord& rec) {
+    if (!journal_available) return;
+
+    if (head_sector < 0 || head_used >= JOURNAL_RECORDS_PER_SECTOR) {
+        if (!advanceSector()) return;
+    }
+
+    rec.seq = next_seq;
+    rec.uptime_ms = clockMillis();
+    rec.boot = journal_boot;
+    rec.crc = crc8((const uint8_t*)&rec, sizeof(rec) - 1);
+
+    // A failed write still consumes the slot and sequence number (slot
+    // position is derived from seq); readers skip it by CRC
+    if (esp_partition_write(journal_part, slotOffset(head_sector, 1 + head_used), &rec, sizeof(rec)) != ESP_OK) {
+        LOG_ERROR("[JOURNAL] Write of seq %lu failed", (unsigned long)rec.seq);
+    }
+    next_seq++;
+    head_used++;
+}
+
+// ============== Event Sink ==============
+static void journalSink(const DeviceEvent& ev) {
+    switch (ev.type) {
+        case DEVICE_EVENT_READING:
+            // Load-test readings would only wear the flash
+            if (!ev.reading.synthetic) journalLogReading(ev.reading);
+            break;
+        case DEVICE_EVENT_REGISTERED:
+            journalLogEvent(JOURNAL_REGISTERED, ev.reading.id);
+            break;
+        case DEVICE_EVENT_REMOVED:
+            journalLogEvent(JOURNAL_REMOVED, ev.reading.id);
+            break;
+        case DEVICE_EVENT_RENAMED:
+            journalLogEvent(JOURNAL_RENAMED, ev.reading.id);
+            break;
+        case DEVICE_EVENT_AVAILABILITY:
+            journalLogEvent(JOURNAL_AVAILABILITY, ev.reading.id, ev.online);
+            break;
+    }
+}
+
+// ============== Journal Functions ==============
+bool journalInit() {
+    journal_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                            (esp_partition_subtype_t)JOURNAL_PARTITION_SUBTYPE,
+                                            JOURNAL_PARTITION_LABEL);
+    if (!journal_part) {
+        Serial.println("[JOURNAL] No journal partition - flash journal disabled");
+        return false;
+    }
+
+    sector_count = min((uint32_t)JOURNAL_MAX_SECTORS, (uint32_t)(journal_part->size / JOURNAL_SECTOR_SIZE));
+
+    // Rebuild the sequence index from the sector headers
+    head_sector = -1;
+    for (uint8_t s = 0; s < sector_count; s++) {
+        JournalSectorHeader hdr;
+        esp_partition_read(journal_part, slotOffset(s, 0), &hdr, sizeof(hdr));
+        bool valid = hdr.magic == JOURNAL_MAGIC && hdr.version == JOURNAL_VERSION &&
+                     hdr.crc == crc8((const uint8_t*)&hdr, sizeof(hdr) - 1);
+        sector_seq[s] = valid ? hdr.first_seq : 0;
+        if (valid && (head_sector < 0 || hdr.first_seq > sector_seq[head_sector])) {
+            head_sector = s;
+        }
+    }
+
+    if (head_sector >= 0) {
+        // Records are written in order, so the first blank slot ends the head
+        uint16_t lo = 0, hi = JOURNAL_RECORDS_PER_SECTOR;
+        while (lo < hi) {
+            uint16_t mid = (lo + hi) / 2;
+            uint32_t seq;
+            esp_partition_read(journal_part, slotOffset(head_sector, 1 + mid), &seq, sizeof(seq));
+            if (seq == 0xFFFFFFFF) hi = mid;
+            else lo = mid + 1;
+        }
+        head_used = lo;
+        next_seq = sector_seq[head_sector] + head_used;
+
+        // Continue the boot counter from the newest readable record
+        JournalRecord last;
+        for (uint32_t seq = next_seq - 1; seq > 0 && seq + 4 >= next_seq; seq--) {
+            if (readRecord(seq, last)) {
+                journal_boot = last.boot + 1;
+                break;
+            }
+        }
+    }
+
+    journal_available = true;
+    Serial.printf("[JOURNAL] %lu records (seq %lu-%lu), boot #%u\n",
+                  (unsigned long)(next_seq - journalOldestSeq()), (unsigned long)journalOldestSeq(),
+                  (unsigned long)journalNewestSeq(), journal_boot);
+
+    journalLogEvent(JOURNAL_BOOT, "", (uint8_t)esp_reset_reason());
+
+    static DeviceEvent queue[16];
+    eventBusSubscribe("journal", journalSink, DEVICE_EVENTS_ALL, 2, EVENT_DROP_OLDEST, queue, 16);
+    return true;
+}
+
+void journalLogReading(const DeviceReading& r) {
+    JournalRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.type = JOURNAL_READING;
+    rec.detail = r.fields;
+    setDevice(rec, r.id);
+    rec.temp_x10 = (int16_t)lroundf(constrain(r.temperature, -3000.0f, 3000.0f) * 10);
+    rec.lux = (uint16_t)constrain(r.lux, 0, 65535);
+    rec.humidity = (uint8_t)constrain((int)r.humidity, 0, 255);
+    rec.battery = (uint8_t)constrain(r.battery, 0, 255);
+    rec.rssi = (int8_t)constrain(r.rssi, -128, 127);
+    append(rec);
+}
+
+void journalLogEvent(JournalEventType type, const char* device, uint8_t detail) {
+    JournalRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.type = type;
+    rec.detail = detail;
+    setDevice(rec, device);
+    append(rec);
+}
+
+// FNV-1a folded to 16 bits; never 0 for a non-empty ID
+uint16_t journalDeviceHash(const char* device) {
+    if (!*device) return 0;
+    uint32_t h = 2166136261u;
+    while (*device) {
+        h ^= (uint8_t)*device++;
+        h *= 16777619u;
+    }
+    uint16_t folded = (uint16_t)(h ^ (h >> 16));
+    return folded ? folded : 1;
+}
+
+uint32_t journalOldestSeq() {
+    uint32_t oldest = next_seq;
+    for (uint8_t s = 0; s < sector_count; s++) {
+        if (sector_seq[s] != 0 && sector_seq[s] < oldest) oldest = sector_seq[s];
+    }
+    return oldest;
+}
+
+uint32_t journalNewestSeq() {
+    return next_seq - 1;
+}
+
+uint32_t journalCapacity() {
+    return (uint32_t)sector_count * JOURNAL_RECORDS_PER_SECTOR;
+}
+
+// ============== Queries ==============
+static bool matches(const JournalFilter& f, uint16_t device_hash, const JournalRecord& rec) {
+    if (f.type && rec.type != f.type) return false;
+    if (f.device && (rec.device_hash != device_hash || strncmp(rec.device, f.device, JOURNAL_DEVICE_LEN) != 0)) {
+        return false;
+    }
+    if (f.boot >= 0) {
+        if (rec.boot != (uint16_t)f.boot) return false;
+        if (rec.uptime_ms < f.from_ms || rec.uptime_ms > f.to_ms) return false;
+    }
+    return true;
+}
+
+uint32_t journalRead(const JournalFilter& filter, uint16_t limit, JournalVisitor visit, void* ctx, bool* more) {
+    if (more) *more = false;
+    if (!journal_available) return filter.after_seq;
+
+    uint32_t seq = max(filter.after_seq + 1, journalOldestSeq());
+    uint32_t matched = 0;
+    uint16_t device_hash = filter.device ? journalDeviceHash(filter.device) : 0;
+
+    JournalRecord batch[JOURNAL_READ_BATCH];
+    while (seq < next_seq) {
+        int s = findSector(seq);
+        if (s < 0) break;
+
+        uint32_t slot = seq - sector_seq[s];
+        uint32_t n = min((uint32_t)JOURNAL_READ_BATCH, (uint32_t)JOURNAL_RECORDS_PER_SECTOR - slot);
+        n = min(n, next_seq - seq);
+        esp_partition_read(journal_part, slotOffset(s, 1 + slot), batch, n * sizeof(JournalRecord));
+
+        for (uint32_t i = 0; i < n; i++) {
+            const JournalRecord& rec = batch[i];
+            if (!recordValid(rec) || rec.seq != seq + i || !matches(filter, device_hash, rec)) continue;
+
+            if (matched == limit) {
+                if (more) *more = true;
+                return seq + i - 1;
+            }
+            matched++;
+            if (!visit(rec, ctx)) return seq + i;
+        }
+        seq += n;
+    }
+    return seq - 1;
+}
+
+const char* getJournalTypeName(uint8_t type) {
+    return type > 0 && type < JOURNAL_TYPE_COUNT ? type_names[type] : "unknown";
+}
+
+uint8_t getJournalTypeByName(const char* name) {
+    for (uint8_t i = 1; i < JOURNAL_TYPE_COUNT; i++) {
+        if (strcmp(name, type_names[i]) == 0) return i;
+    }
+    return 0;
+}
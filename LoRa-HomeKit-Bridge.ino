@@ -20,11 +20,26 @@
 // ============== Include Modules ==============
 #include "core/Config.h"
 #include "core/Device.h"
+#include "core/LoopProfiler.h"
+#include "core/BootTimeline.h"
+#include "core/HeapProfiler.h"
+#include "core/Pipeline.h"
+#include "core/EventBus.h"
+#include "core/Scheduler.h"
+#include "core/Log.h"
+#include "core/Clock.h"
 #include "hardware/Display.h"
 #include "data/Encryption.h"
 #include "data/Settings.h"
+#include "data/Journal.h"
+#include "data/Capture.h"
+#include "data/ActivityLog.h"
 #include "homekit/HomeKitServices.h"
 #include "hardware/LoRaModule.h"
+#include "hardware/Airtime.h"
+#include "hardware/Downlink.h"
+#include "hardware/Adr.h"
+#include "hardware/RxScheduler.h"
 #include "network/WiFiModule.h"
 #include "homekit/DeviceManagement.h"
 #include "network/WebServerModule.h"
@@ -32,46 +47,20 @@
 
 // ============== Global Variables ==============
 // Boot time tracking (only variable defined in main sketch)
-unsigned long boot_time = 0;
+uint32_t boot_time = 0;
 
 // All other global variables are defined in their respective module .cpp files
 // and declared as extern in their .h files
 
-// ============== Setup ==============
-void setup() {
-    Serial.begin(115200);
-    delay(100);
-
-    boot_time = millis();
-
-    Serial.println();
-    Serial.println("========================================");
-    Serial.println("  LoRa HomeKit Bridge (Arduino/HomeSpan)");
-    Serial.println("  TTGO LoRa32 V2.1_1.6");
-    Serial.println("========================================");
-    Serial.println();
+// ============== Boot Steps ==============
+bool web_server_started = false;
 
-    // Initialize LED
-    pinMode(LED_PIN, OUTPUT);
-    digitalWrite(LED_PIN, LOW);  // LOW = OFF (LED is active-high on this board)
-
-    // Initialize Display
+void startDisplay() {
+    bootPhaseBegin(BOOT_PHASE_DISPLAY);
     Serial.println("[BOOT] Init display...");
     displayInit();
 
-    displayMessage("LoRa HomeKit", "Bridge v2.0", "", "Starting...");
-    delay(2000);
-
-    // Load settings from NVS
-    Serial.println("[BOOT] Loading settings...");
-    displayProgress("Settings", "Loading...", 50);
-    loadSettings();
-    displayProgress("Settings", "Loaded!", 100);
-
     // Apply hardware settings
-    if (!activity_led_enabled) {
-        digitalWrite(LED_PIN, LOW);  // Turn off LED
-    }
     if (display_available) {
         display.setBrightness(oled_brightness);
         if (!oled_enabled) {
@@ -79,57 +68,79 @@ void setup() {
         }
     }
 
-    delay(500);
+    displayMessage("LoRa HomeKit", "Bridge v2.0", "", "Starting...");
+    bootDelay(2000);
+    bootPhaseEnd(BOOT_PHASE_DISPLAY);
+}
 
-    // Initialize LoRa
+void startLoRa() {
+    bootPhaseBegin(BOOT_PHASE_LORA);
     Serial.println("[BOOT] Initializing LoRa...");
     if (!initLoRa()) {
         Serial.println("[BOOT] LoRa failed - halting!");
         while(1) { delay(1000); }
     }
+    pipelineBegin();
+    airtimeBegin();
+    bootPhaseEnd(BOOT_PHASE_LORA);
+}
 
-    // Try to connect to WiFi if configured
-    bool wifi_ok = false;
-    if (wifi_configured) {
-        Serial.println("[BOOT] WiFi configured, connecting...");
-        wifi_ok = connectWiFi();
-    } else {
-        Serial.println("[BOOT] No WiFi configured");
-    }
+void startWebServer() {
+    if (web_server_started) return;
+
+    // Start Web Server on port 80 (HomeSpan uses port 80 for HAP)
+    bootPhaseBegin(BOOT_PHASE_WEB);
+    Serial.println("[BOOT] Starting web server on port 80...");
+    displayProgress("Web Server", "Starting...", 0);
+    setupWebServer();
+    displayProgress("Web Server", "Ready!", 100);
+    web_server_started = true;
+    bootPhaseEnd(BOOT_PHASE_WEB);
+}
 
+// Everything that depends on the WiFi outcome. Called from setup() in normal
+// mode and from loop() once the background connect resolves in fast-boot mode.
+void startNetworkServices(bool wifi_ok) {
     // Start AP mode if WiFi not connected
     if (!wifi_ok) {
+        bootPhaseBegin(BOOT_PHASE_AP);
         Serial.println("[BOOT] Starting AP mode for setup...");
         startAPMode();
+        bootPhaseEnd(BOOT_PHASE_AP);
     }
 
     // Setup HomeKit only if WiFi is connected
     if (wifi_ok) {
+        bootPhaseBegin(BOOT_PHASE_HOMEKIT);
         Serial.println("[BOOT] Setting up HomeKit...");
         setupHomeKit();
+        bootPhaseEnd(BOOT_PHASE_HOMEKIT);
     }
 
-    // Start Web Server on port 80 (HomeSpan uses port 80 for HAP)
-    Serial.println("[BOOT] Starting web server on port 80...");
-    displayProgress("Web Server", "Starting...", 0);
-    setupWebServer();
-    displayProgress("Web Server", "Ready!", 100);
+    startWebServer();
 
     // Initialize MQTT if enabled
     if (mqtt_enabled && wifi_ok) {
+        bootPhaseBegin(BOOT_PHASE_MQTT);
         Serial.println("[BOOT] Initializing MQTT...");
         initMQTT();
         connectMQTT();
+        bootPhaseEnd(BOOT_PHASE_MQTT);
     }
 
     IPAddress ip = ap_mode ? WiFi.softAPIP() : WiFi.localIP();
     Serial.printf("[BOOT] Web UI: http://%s/\n", ip.toString().c_str());
 
-    delay(500);
+    bootDelay(500);
 
     // Show final status
     displayStatus();
 
+    bootComplete();
+    if (isMQTTConnected()) {
+        publishBootTimeline();
+    }
+
     Serial.println();
     Serial.println("========================================");
     if (ap_mode) {
@@ -146,108 +157,241 @@ void setup() {
     Serial.println();
 }
 
+// ============== Scheduled Jobs ==============
+// Periodic loop work, run by the scheduler between the polled sections
+
+void updateDisplayJob() {
+    if (!oled_is_off) {
+        displayStatus();
+    }
+}
+
+// Publish MQTT diagnostics every 5 minutes
+void diagnosticsJob() {
+    if (mqtt_enabled && !ap_mode && isMQTTConnected()) {
+        publishBridgeDiagnostics();
+    }
+}
+
+// Detect HomeKit pairing status changes and publish diagnostics
+void pairingStatusJob() {
+    static bool lastPairingStatus = false;
+    static bool pairingStatusInitialized = false;
+    if (!mqtt_enabled || ap_mode || !isMQTTConnected() || !homekit_started) {
+        return;
+    }
+
+    bool currentPairingStatus = (homeSpan.controllerListBegin() != homeSpan.controllerListEnd());
+
+    if (!pairingStatusInitialized) {
+        // First check after boot - just initialize the status
+        lastPairingStatus = currentPairingStatus;
+        pairingStatusInitialized = true;
+        // Publish diagnostics with correct initial status
+        publishBridgeDiagnosticsIfChanged();
+    } else if (currentPairingStatus != lastPairingStatus) {
+        // Pairing status changed!
+        LOG_INFO("[HOMEKIT] Pairing status changed: %s -> %s",
+                 lastPairingStatus ? "paired" : "unpaired",
+                 currentPairingStatus ? "paired" : "unpaired");
+        lastPairingStatus = currentPairingStatus;
+        // Publish diagnostics immediately (bypassing rate limit for this important change)
+        publishBridgeDiagnostics();
+    }
+}
+
+// In AP mode, try to get back onto the configured WiFi network
+void wifiReconnectJob() {
+    if (!ap_mode || !wifi_configured || !attemptWiFiReconnect()) {
+        return;
+    }
+
+    // WiFi reconnected successfully!
+    LOG_INFO("[WIFI] WiFi reconnected, initializing HomeKit and MQTT...");
+
+    // Setup HomeKit
+    if (!homekit_started) {
+        LOG_INFO("[BOOT] Setting up HomeKit...");
+        setupHomeKit();
+    }
+
+    // Initialize MQTT if enabled
+    if (mqtt_enabled) {
+        LOG_INFO("[BOOT] Initializing MQTT...");
+        initMQTT();
+        connectMQTT();
+    }
+
+    LOG_INFO("[WIFI] Ready! IP: %s", WiFi.localIP().toString());
+}
+
+void ledDebugJob() {
+    if (!activity_led_enabled) {
+        LOG_DEBUG("[LOOP] LED enforcement active: power=%d, activity=%d",
+                  power_led_enabled, activity_led_enabled);
+    }
+}
+
+void scheduleLoopJobs() {
+    schedulerBegin();
+    schedulerEvery("display", 2000, updateDisplayJob, SCHED_CATCHUP_SKIP, 50000);
+    schedulerEvery("availability", 10000, checkDeviceAvailability);
+    schedulerEvery("pairing", 1000, pairingStatusJob);
+    schedulerEvery("diagnostics", 300000, diagnosticsJob, SCHED_CATCHUP_SKIP, 0);
+    schedulerEvery("wifi_reconnect", WIFI_RECONNECT_INTERVAL, wifiReconnectJob, SCHED_CATCHUP_DELAY, 0);
+    schedulerEvery("led_debug", 5000, ledDebugJob);
+    schedulerEvery("loop_report", LOOP_PROFILE_REPORT_MS, printLoopProfile);
+    schedulerEvery("heap_trend", HEAP_TREND_INTERVAL_MS, heapProfilerSample);
+    schedulerEvery("capture", CAPTURE_FLUSH_MS, captureFlush, SCHED_CATCHUP_SKIP, 60000);
+    schedulerEvery("airtime", AIRTIME_WINDOW_MS, airtimeRollWindow);
+    schedulerEvery("intervals", DEVICE_INTERVAL_SAVE_MS, saveDeviceIntervals, SCHED_CATCHUP_SKIP, 0);
+}
+
+// ============== Setup ==============
+void setup() {
+    Serial.setTxBufferSize(LOG_UART_TX_BUFFER);   // Must precede begin()
+    Serial.begin(115200);
+    delay(100);
+
+    boot_time = clockMillis();
+    clockMarkBoot();
+    heapProfilerInit();
+
+    Serial.println();
+    Serial.println("========================================");
+    Serial.println("  LoRa HomeKit Bridge (Arduino/HomeSpan)");
+    Serial.println("  TTGO LoRa32 V2.1_1.6");
+    Serial.println("========================================");
+    Serial.println();
+
+    // Initialize LED
+    pinMode(LED_PIN, OUTPUT);
+    digitalWrite(LED_PIN, LOW);  // LOW = OFF (LED is active-high on this board)
+
+    // Load settings from NVS first: the boot order depends on fast_boot, and
+    // saved devices must be known before the radio can hear them
+    bootPhaseBegin(BOOT_PHASE_SETTINGS);
+    Serial.println("[BOOT] Loading settings...");
+    loadSettings();
+    loadDevices();
+    journalInit();
+    captureInit();
+    subscribeHomeKitEvents();
+    subscribeActivityEvents();
+    subscribeDisplayEvents();
+    scheduleLoopJobs();
+    bootPhaseEnd(BOOT_PHASE_SETTINGS);
+
+    if (!activity_led_enabled) {
+        digitalWrite(LED_PIN, LOW);  // Turn off LED
+    }
+
+    if (fast_boot) {
+        // Radio first so packets are accepted immediately; WiFi connects in
+        // the background and loop() brings up HomeKit/MQTT once it resolves
+        Serial.println("[BOOT] Fast boot enabled");
+        startLoRa();
+        startDisplay();
+
+        if (wifi_configured) {
+            bootPhaseBegin(BOOT_PHASE_WIFI);
+            beginWiFi();
+            startWebServer();
+        } else {
+            Serial.println("[BOOT] No WiFi configured");
+            startNetworkServices(false);
+        }
+        return;
+    }
+
+    startDisplay();
+    startLoRa();
+
+    // Try to connect to WiFi if configured
+    bool wifi_ok = false;
+    if (wifi_configured) {
+        Serial.println("[BOOT] WiFi configured, connecting...");
+        bootPhaseBegin(BOOT_PHASE_WIFI);
+        wifi_ok = connectWiFi();
+        bootPhaseEnd(BOOT_PHASE_WIFI);
+    } else {
+        Serial.println("[BOOT] No WiFi configured");
+    }
+
+    startNetworkServices(wifi_ok);
+}
+
 // ============== Main Loop ==============
 void loop() {
+    loopProfilerStart();
+
+    // Fast boot: finish startup once the background WiFi connect resolves
+    if (wifi_connect_pending) {
+        WiFiConnectState state = pollWiFiConnect();
+        if (state != WIFI_CONNECT_PENDING) {
+            bootPhaseEnd(BOOT_PHASE_WIFI);
+            startNetworkServices(state == WIFI_CONNECT_OK);
+        }
+    }
+
     // Handle DNS for captive portal in AP mode
     if (ap_mode) {
         dnsServer.processNextRequest();
-
-        // Try to reconnect to WiFi if configured
-        if (wifi_configured && attemptWiFiReconnect()) {
-            // WiFi reconnected successfully!
-            Serial.println("[WIFI] WiFi reconnected, initializing HomeKit and MQTT...");
-
-            // Setup HomeKit
-            if (!homekit_started) {
-                Serial.println("[BOOT] Setting up HomeKit...");
-                setupHomeKit();
-            }
-
-            // Initialize MQTT if enabled
-            if (mqtt_enabled) {
-                Serial.println("[BOOT] Initializing MQTT...");
-                initMQTT();
-                connectMQTT();
-            }
-
-            Serial.printf("[WIFI] Ready! IP: %s\n", WiFi.localIP().toString().c_str());
-        }
     }
+    loopProfilerMark(LOOP_SECTION_WIFI);
+
+    // Process LoRa packets (fan-out only when ingest runs on the other core)
+    pipelineLoop();
+    loopProfilerMark(LOOP_SECTION_LORA);
 
-    // Process LoRa packets
-    processLoRaPacket();
+    // Deliver device events to HomeKit, logs, MQTT and display
+    eventBusDispatch();
+    loopProfilerMark(LOOP_SECTION_EVENTS);
 
     // Process HomeSpan (only if started)
     if (homekit_started) {
+        HeapScope heapScope(HEAP_SUBSYS_HOMEKIT);
         homeSpan.poll();
     }
+    loopProfilerMark(LOOP_SECTION_HOMESPAN);
 
     // Handle web requests
-    webServer.handleClient();
+    {
+        HeapScope heapScope(HEAP_SUBSYS_WEB);
+        webServer.handleClient();
+    }
+    loopProfilerMark(LOOP_SECTION_WEB);
 
-    // Handle MQTT (reconnect if needed)
+    // Handle MQTT traffic (reconnects are a scheduled job)
     if (mqtt_enabled && !ap_mode) {
         loopMQTT();
     }
+    loopProfilerMark(LOOP_SECTION_MQTT);
 
     // Check OLED timeout
     checkOledTimeout();
+    loopProfilerMark(LOOP_SECTION_OLED);
 
-    // Update display periodically
-    static unsigned long lastDisplayUpdate = 0;
-    if (millis() - lastDisplayUpdate > 2000) {
-        if (!oled_is_off) {
-            displayStatus();
-        }
-        lastDisplayUpdate = millis();
-    }
-
-    // Publish MQTT diagnostics periodically (every 5 minutes)
-    static unsigned long lastDiagnosticsPublish = 0;
-    if (mqtt_enabled && !ap_mode && isMQTTConnected()) {
-        if (millis() - lastDiagnosticsPublish > 300000) {
-            publishBridgeDiagnostics();
-            lastDiagnosticsPublish = millis();
-        }
-    }
-
-    // Detect HomeKit pairing status changes and publish diagnostics
-    static bool lastPairingStatus = false;
-    static bool pairingStatusInitialized = false;
-    if (mqtt_enabled && !ap_mode && isMQTTConnected() && homekit_started) {
-        bool currentPairingStatus = (homeSpan.controllerListBegin() != homeSpan.controllerListEnd());
-
-        if (!pairingStatusInitialized) {
-            // First check after boot - just initialize the status
-            lastPairingStatus = currentPairingStatus;
-            pairingStatusInitialized = true;
-            // Publish diagnostics with correct initial status
-            publishBridgeDiagnosticsIfChanged();
-        } else if (currentPairingStatus != lastPairingStatus) {
-            // Pairing status changed!
-            Serial.printf("[HOMEKIT] Pairing status changed: %s -> %s\n",
-                         lastPairingStatus ? "paired" : "unpaired",
-                         currentPairingStatus ? "paired" : "unpaired");
-            lastPairingStatus = currentPairingStatus;
-            // Publish diagnostics immediately (bypassing rate limit for this important change)
-            publishBridgeDiagnostics();
-        }
-    }
+    // Display, diagnostics, reconnects, reports, then the log lines they queued
+    schedulerRun();
+    logService();
+    loopProfilerMark(LOOP_SECTION_JOBS);
 
     // Enforce LED off state when activity LED is disabled
     // Only enforce when activity LED is off - power LED just controls HomeSpan status
-    static unsigned long lastDebug = 0;
     if (!activity_led_enabled) {
         digitalWrite(LED_PIN, LOW);  // Keep LED off
-
-        // Debug output every 5 seconds
-        if (millis() - lastDebug > 5000) {
-            Serial.printf("[LOOP] LED enforcement active: power=%d, activity=%d\n",
-                          power_led_enabled, activity_led_enabled);
-            lastDebug = millis();
-        }
     }
-
-    // Small delay to prevent watchdog issues
-    delay(1);
+    loopProfilerMark(LOOP_SECTION_LED);
+    loopProfilerEnd();
+
+    // Block until the radio interrupt or the next job is due, unless events
+    // are still queued. Single-core, a downlink or receiver switch coming up
+    // is polled for, as the net poll would be late for it.
+    bool radio_due = !pipelineIsDualCore() && (downlinkNextDueMs() <= SCHEDULER_NET_POLL_MS ||
+                                               adrNextSwitchMs() <= SCHEDULER_NET_POLL_MS ||
+                                               rxSchedNextSwitchMs() <= SCHEDULER_NET_POLL_MS);
+    bool work_pending = eventBusPending() > 0 || pipelineQueueDepth() > 0 ||
+                        pipeline_run.running || wifi_connect_pending || ap_mode || radio_due;
+    schedulerIdle(work_pending);
 }
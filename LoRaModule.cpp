@@ -7,36 +7,70 @@
 #include <LoRa.h>
 #include <ArduinoJson.h>
 #include "hardware/Display.h"
+#include "hardware/Airtime.h"
+#include "hardware/NoiseMonitor.h"
+#include "hardware/Downlink.h"
+#include "hardware/Adr.h"
+#include "hardware/RxScheduler.h"
 #include "data/Settings.h"
 #include "data/Encryption.h"
 #include "core/Device.h"
-
-// Forward declarations for device management (defined in DeviceManagement module)
-extern Device* registerDevice(const char* id, JsonDocument& doc);
-extern void updateDevice(Device* dev, JsonDocument& doc, int rssi);
+#include "core/BootTimeline.h"
+#include "core/HeapProfiler.h"
+#include "core/Pipeline.h"
+#include "core/Log.h"
+#include "core/Clock.h"
+#include "data/ActivityLog.h"
+#include "data/Capture.h"
+#include "data/Journal.h"
+#include "homekit/DeviceManagement.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
 // External variables
 extern volatile bool activity_led_enabled;
 
 // ============== Statistics ==============
 uint32_t packets_received = 0;
-unsigned long last_packet_time = 0;
-String last_event = "";
+uint32_t last_packet_time = 0;
+FixedString<LAST_EVENT_LEN> last_event;
+volatile uint32_t radio_irqs = 0;
+uint8_t lora_rx_sf = 0;
+
+// ============== Receive Interrupt ==============
+static TaskHandle_t rx_task = nullptr;     // Task that reads the radio
+static volatile bool rx_pending = false;
+
+// Receiver settings as last written to the radio. In a follow window the
+// profile is the main one at the device's SF.
+static uint8_t rx_profile = RX_PROFILE_MAIN;
+static float rx_frequency = 0;
+static uint32_t rx_bw = 0;
+static uint8_t rx_syncword = 0;
+
+// DIO0 rises on RxDone (default mapping in receive mode)
+static void IRAM_ATTR onRadioDio0() {
+    rx_pending = true;
+    radio_irqs++;
+    BaseType_t woken = pdFALSE;
+    if (rx_task) vTaskNotifyGiveFromISR(rx_task, &woken);
+    if (woken) portYIELD_FROM_ISR();
+}
 
 // ============== LoRa Functions ==============
 bool initLoRa() {
     displayProgress("LoRa", "Initializing...", 0);
 
-    Serial.println("[LORA] Starting SPI...");
+    LOG_INFO("[LORA] Starting SPI...");
     SPI.begin(LORA_SCK, LORA_MISO, LORA_MOSI, LORA_CS);
     LoRa.setPins(LORA_CS, LORA_RST, LORA_DIO0);
 
     displayProgress("LoRa", "Starting radio...", 30);
 
-    Serial.printf("[LORA] Trying frequency: %.2f MHz\n", lora_frequency);
+    LOG_INFO("[LORA] Trying frequency: %.2f MHz", lora_frequency);
     if (!LoRa.begin((long)(lora_frequency * 1E6))) {
         displayMessage("ERROR!", "LoRa init failed!", "Check hardware", "");
-        Serial.println("[LORA] ERROR: Init failed!");
+        LOG_ERROR("[LORA] ERROR: Init failed!");
         return false;
     }
 
@@ -45,22 +79,164 @@ bool initLoRa() {
     // LoRa settings must match your sensors!
     LoRa.setSignalBandwidth(lora_bw);
     LoRa.setSpreadingFactor(lora_sf);
+    lora_rx_sf = lora_sf;
     LoRa.setCodingRate4(lora_cr);
     LoRa.setSyncWord(lora_syncword);
     LoRa.setPreambleLength(lora_preamble);
     LoRa.disableCrc();
+    rx_profile = RX_PROFILE_MAIN;
+    rx_frequency = lora_frequency;
+    rx_bw = lora_bw;
+    rx_syncword = lora_syncword;
+    rxSchedBegin();
 
     displayProgress("LoRa", "Ready!", 100);
-    Serial.printf("[LORA] Initialized: %.2f MHz, SF%d, BW:%dkHz, CR:4/%d, Preamble:%d, Sync:0x%02X\n",
-                  lora_frequency, lora_sf, lora_bw/1000, lora_cr, lora_preamble, lora_syncword);
+    LOG_INFO("[LORA] Initialized: %.2f MHz, SF%d, BW:%dkHz, CR:4/%d, Preamble:%d, Sync:0x%02X",
+             lora_frequency, lora_sf, lora_bw/1000, lora_cr, lora_preamble, lora_syncword);
 
-    delay(500);
+    bootDelay(500);
     return true;
 }
 
+uint32_t loraTimeOnAirUs(int len, uint8_t sf, uint32_t bw, uint8_t cr, uint16_t preamble) {
+    if (bw == 0) return 0;
+    uint32_t symbol_us = (uint32_t)(((uint64_t)1000000 << sf) / bw);
+
+    // Low data rate optimisation is mandated above 16 ms per symbol
+    int de = symbol_us > 16000 ? 1 : 0;
+    int bits = 8 * len - 4 * sf + 28;
+    int per_block = 4 * (sf - 2 * de);
+    int blocks = bits > 0 ? (bits + per_block - 1) / per_block : 0;
+    uint32_t payload_symbols = 8 + blocks * cr;
+
+    // Preamble is preamble + 4.25 symbols
+    return (uint32_t)(((uint64_t)(4 * preamble + 17) * symbol_us) / 4) + payload_symbols * symbol_us;
+}
+
+uint32_t loraTimeOnAirUs(int len) {
+    return loraTimeOnAirUs(len, lora_rx_sf ? lora_rx_sf : lora_sf, rx_bw ? rx_bw : lora_bw, lora_cr, lora_preamble);
+}
+
+void startLoRaReceive() {
+    rx_task = xTaskGetCurrentTaskHandle();
+    pinMode(LORA_DIO0, INPUT);
+    attachInterrupt(digitalPinToInterrupt(LORA_DIO0), onRadioDio0, RISING);
+    LoRa.receive();
+    LOG_INFO("[LORA] Continuous receive, DIO0 interrupt");
+}
+
+// Write the settings that differ from the radio's; the caller has put it
+// in standby
+static void applyRadioSettings(const RxProfile& p, uint8_t sf) {
+    if (p.frequency != rx_frequency) {
+        LoRa.setFrequency((long)(p.frequency * 1E6));
+        rx_frequency = p.frequency;
+    }
+    if (p.bw != rx_bw) {
+        LoRa.setSignalBandwidth(p.bw);
+        rx_bw = p.bw;
+    }
+    if (sf != lora_rx_sf) {
+        LoRa.setSpreadingFactor(sf);   // After the bandwidth: both set the LDR flag
+        lora_rx_sf = sf;
+    }
+    if (p.syncword != rx_syncword) {
+        LoRa.setSyncWord(p.syncword);
+        rx_syncword = p.syncword;
+    }
+}
+
+// Profile the receive schedule is charged for (none in a follow window)
+static uint8_t scheduledProfile() {
+    return lora_rx_sf == rx_profiles[rx_profile].sf ? rx_profile : RX_PROFILE_NONE;
+}
+
+void loraSetReceive(uint8_t profile, uint8_t sf) {
+    if (profile == rx_profile && sf == lora_rx_sf) return;
+    uint32_t start_us = clockMicros();
+    LoRa.idle();
+    applyRadioSettings(rx_profiles[profile], sf);
+    rx_profile = profile;
+    LoRa.receive();
+    rxSchedOnProfile(scheduledProfile(), clockElapsedUs(start_us));
+}
+
+uint32_t loraTransmit(const uint8_t* data, size_t len, uint8_t sf, int8_t power) {
+    // Downlinks go out on the main profile, whatever the receiver is on
+    uint8_t profile = rx_profile;
+    uint8_t rx_sf = lora_rx_sf;
+    uint32_t start_us = clockMicros();
+    LoRa.idle();
+    applyRadioSettings(rx_profiles[RX_PROFILE_MAIN], sf);
+    LoRa.setTxPower(power);
+    rxSchedOnProfile(RX_PROFILE_NONE, clockElapsedUs(start_us));
+
+    LoRa.beginPacket();
+    LoRa.write(data, len);
+    LoRa.endPacket();       // Blocks until TxDone
+
+    // DIO0 also rises on TxDone: that was not a frame
+    rx_pending = false;
+    start_us = clockMicros();
+    applyRadioSettings(rx_profiles[profile], rx_sf);
+    LoRa.receive();
+    rxSchedOnProfile(scheduledProfile(), clockElapsedUs(start_us));
+    return loraTimeOnAirUs(len, sf, lora_bw, lora_cr, lora_preamble);
+}
+
+void serviceLoRaRadio() {
+    downlinkService();
+
+    // A follow window takes the main profile to a device's SF; otherwise
+    // the receive schedule decides
+    uint8_t sf = adrReceiveSf();
+    uint8_t profile = RX_PROFILE_MAIN;
+    if (sf == lora_sf) {
+        profile = rxSchedProfile();
+        sf = rx_profiles[profile].sf;
+    }
+    if (profile == rx_profile && sf == lora_rx_sf) return;
+
+    // Never switch away from a frame that is waiting to be read
+    if (rx_pending || digitalRead(LORA_DIO0) != LOW) {
+        rxSchedDeferred();
+        return;
+    }
+    loraSetReceive(profile, sf);
+}
+
+uint32_t loraNextRadioEventMs() {
+    // The noise floor is the main profile's: no samples elsewhere
+    uint32_t next = rx_profile == RX_PROFILE_MAIN ? noiseNextSampleMs() : UINT32_MAX;
+    uint32_t due = downlinkNextDueMs();
+    if (due < next) next = due;
+    due = adrNextSwitchMs();
+    if (due < next) next = due;
+    due = rxSchedNextSwitchMs();
+    return due < next ? due : next;
+}
+
+static uint8_t ingestRadio(uint8_t* buffer, int len, int rssi, bool synthetic, AdrUplink* up);
+
 void processLoRaPacket() {
+    // DIO0 stays high until parsePacket() clears the IRQ flags, so a
+    // missed edge is still picked up here
+    bool sample_due = rx_profile == RX_PROFILE_MAIN && noiseSampleDue();
+    if (!rx_pending && digitalRead(LORA_DIO0) == LOW) {
+        // Still in receive with nothing pending: reading the RSSI register
+        // does not interrupt it
+        if (sample_due) noiseRecordSample(LoRa.rssi());
+        return;
+    }
+    rx_pending = false;
+    uint32_t end_us = clockMicros();    // Downlink windows are timed from here
+    if (sample_due) noiseSampleDeferred();
+
     int packetSize = LoRa.parsePacket();
-    if (packetSize == 0) return;
+    if (packetSize == 0) {
+        LoRa.receive();    // parsePacket() switched to single receive
+        return;
+    }
 
     // Blink LED if enabled, keep off if disabled
     if (activity_led_enabled) {
@@ -69,82 +245,143 @@ void processLoRaPacket() {
         digitalWrite(LED_PIN, LOW);  // Keep OFF
     }
 
-    // Wake OLED on activity
-    wakeOled();
-
     uint8_t buffer[256];
     int len = 0;
     while (LoRa.available() && len < 255) {
         buffer[len++] = LoRa.read();
     }
     buffer[len] = 0;
-
     int rssi = LoRa.packetRssi();
+    float snr = LoRa.packetSnr();
+    RxProfile heard_on = {rx_frequency, lora_rx_sf, rx_bw, rx_syncword};
+    captureFrame(buffer, len, rssi, snr, LoRa.packetFrequencyError(), heard_on, rx_profile);
+    noiseRecordFrame(snr, lora_rx_sf);
+    rxSchedRecordFrame(scheduledProfile(), len);
 
-    // Debug: show raw data before decryption
-    Serial.printf("[LORA] Received %d bytes, RSSI: %d\n", len, rssi);
-    Serial.print("[LORA] Raw hex: ");
-    int showLen = (len < 64) ? len : 64;
-    for (int i = 0; i < showLen; i++) {
-        Serial.printf("%02X ", buffer[i]);
-    }
-    if (len > 64) Serial.print("...");
-    Serial.println();
+    // parsePacket() left the radio in standby: listen again before ingest
+    LoRa.receive();
+
+    AdrUplink up = {nullptr, snr, lora_rx_sf, len, end_us, false, -1, ADR_POWER_UNKNOWN};
+    captureVerdict(ingestRadio(buffer, len, rssi, false, rx_profile == RX_PROFILE_MAIN ? &up : nullptr));
+
+    // Turn LED off after activity
+    digitalWrite(LED_PIN, LOW);
+}
+
+// One line per reading: a format per combination of the fields shown, so
+// the values are logged raw rather than formatted here
+static const char* const reading_formats[8] = {
+    "[LORA] %s RSSI:%d",
+    "[LORA] %s RSSI:%d T:%.1f°C",
+    "[LORA] %s RSSI:%d H:%.0f%%",
+    "[LORA] %s RSSI:%d T:%.1f°C H:%.0f%%",
+    "[LORA] %s RSSI:%d B:%.0f%%",
+    "[LORA] %s RSSI:%d T:%.1f°C B:%.0f%%",
+    "[LORA] %s RSSI:%d H:%.0f%% B:%.0f%%",
+    "[LORA] %s RSSI:%d T:%.1f°C H:%.0f%% B:%.0f%%",
+};
+
+static void logReading(const DeviceReading& r) {
+    float shown[3] = {0, 0, 0};
+    uint8_t n = 0;
+    uint8_t which = 0;
+    if (r.fields & ACT_TEMP) { shown[n++] = r.temperature; which |= 1; }
+    if (r.fields & ACT_HUM) { shown[n++] = r.humidity; which |= 2; }
+    if (r.fields & ACT_BATT) { shown[n++] = r.battery; which |= 4; }
+    LOG_INFO(reading_formats[which], r.id, r.rssi, shown[0], shown[1], shown[2]);
+}
+
+static uint8_t reject(PipelineEvent& ev, uint8_t reason, const char* id) {
+    ev.kind = PIPELINE_EVENT_REJECTED;
+    ev.reject_reason = reason;
+    strncpy(ev.reading.id, id, sizeof(ev.reading.id) - 1);
+    pipelineSubmit(ev);
+    return reason;
+}
 
-    // Decrypt if enabled
-    decryptBuffer(buffer, len);
+static uint8_t ingest(PipelineEvent& ev, uint8_t* buffer, int len, int rssi, bool synthetic, AdrUplink* up) {
+    memset(&ev, 0, sizeof(ev));
+    ev.ingest_us = clockMicros();
 
-    // Debug: show data after decryption
-    Serial.printf("[LORA] Decrypted (%s): %s\n", getEncryptionModeName(encryption_mode), (char*)buffer);
+    // Everything until return is charged to this packet (a no-op on the
+    // ingest task; dual-core fan-out has its own report in pipelineLoop())
+    HeapReportScope heapReport(HEAP_REPORT_PACKET, "(invalid)");
+    HeapScope heapScope(HEAP_SUBSYS_LORA);
+
+    // Synthetic packets are plaintext and skip the per-packet log lines,
+    // which would otherwise cap the rate at what 115200 baud can carry
+    if (!synthetic) {
+        // Raw data before decryption (bridge_replay reads these two lines)
+        LOG_INFO("[LORA] Received %d bytes, RSSI: %d", len, rssi);
+        LOG_INFO("[LORA] Raw hex: %s%s", logBytes(buffer, min(len, LOG_BYTES_MAX)),
+                 len > LOG_BYTES_MAX ? " ..." : "");
+
+        // Decrypt if enabled
+        decryptBuffer(buffer, len);
+        LOG_DEBUG("[LORA] Decrypted (%s): %s", getEncryptionModeName(encryption_mode), (char*)buffer);
+    }
 
     // Parse JSON
     StaticJsonDocument<512> doc;
     DeserializationError error = deserializeJson(doc, (char*)buffer);
 
     if (error) {
-        Serial.printf("[LORA] JSON parse error: %s\n", error.c_str());
-        Serial.printf("[LORA] Check: encryption mode=%s, key length=%d\n",
-                      getEncryptionModeName(encryption_mode), encrypt_key_len);
-        last_event = "ERR: Bad JSON";
-        digitalWrite(LED_PIN, LOW);  // Turn OFF
-        return;
+        LOG_WARN("[LORA] JSON parse error: %s", error.c_str());
+        LOG_WARN("[LORA] Check: encryption mode=%s, key length=%d",
+                 getEncryptionModeName(encryption_mode), encrypt_key_len);
+        return reject(ev, JOURNAL_REJECT_BAD_JSON, "");
     }
 
-    // Check gateway key
-    if (!doc.containsKey("k") || strcmp(doc["k"], gateway_key) != 0) {
-        Serial.println("[LORA] Gateway key mismatch");
-        last_event = "ERR: Wrong key";
-        digitalWrite(LED_PIN, LOW);  // Turn OFF
-        return;
+    // Check gateway key (null if "k" is missing or not a string)
+    const char* key = doc["k"];
+    if (!key || strcmp(key, gateway_key) != 0) {
+        LOG_WARN("[LORA] Gateway key mismatch");
+        return reject(ev, JOURNAL_REJECT_WRONG_KEY, doc["id"] | "");
     }
 
     // Check device ID
-    if (!doc.containsKey("id")) {
-        Serial.println("[LORA] Missing device ID");
-        last_event = "ERR: No device ID";
-        digitalWrite(LED_PIN, LOW);  // Turn OFF
-        return;
+    DeviceReading& r = ev.reading;
+    if (!parseReading(doc, rssi, r)) {
+        LOG_WARN("[LORA] Missing device ID");
+        return reject(ev, JOURNAL_REJECT_NO_ID, "");
     }
+    r.synthetic = synthetic;
 
-    const char* id = doc["id"];
-    packets_received++;
-    last_packet_time = millis();
+    // Downlink capability and what the sensor reports about its radio
+    if (up) {
+        up->downlink = (doc["dl"] | 0) != 0;
+        up->ack = doc["ack"] | -1;
+        int power = doc["pw"] | (int)ADR_POWER_UNKNOWN;
+        up->power = power >= -9 && power <= 22 ? (int8_t)power : ADR_POWER_UNKNOWN;
+    }
+
+    heapReport.setSite(r.id);
+    if (!synthetic) {
+        packets_received++;
+        last_packet_time = clockMillis();
 
-    // Find or register device
-    Device* dev = findDevice(id);
-    if (!dev) {
-        dev = registerDevice(id, doc);
+        logReading(r);
     }
 
-    if (dev) {
-        updateDevice(dev, doc, rssi);
-        Serial.printf("[LORA] %s RSSI:%d", id, rssi);
-        if (doc.containsKey("t")) Serial.printf(" T:%.1f°C", doc["t"].as<float>());
-        if (doc.containsKey("hu")) Serial.printf(" H:%.0f%%", doc["hu"].as<float>());
-        if (doc.containsKey("b")) Serial.printf(" B:%d%%", doc["b"].as<int>());
-        Serial.println();
+    ev.kind = PIPELINE_EVENT_READING;
+    pipelineSubmit(ev);
+    return 0;
+}
+
+static uint8_t ingestRadio(uint8_t* buffer, int len, int rssi, bool synthetic, AdrUplink* up) {
+    PipelineEvent ev;
+    uint8_t verdict = ingest(ev, buffer, len, rssi, synthetic, up);
+
+    // Synthetic load never used the channel; every radio frame did, whether
+    // or not it was for us
+    if (!synthetic) airtimeRecord(ev.reading.id, len, verdict);
+    if (up && verdict == 0) {
+        up->id = ev.reading.id;
+        adrUplink(*up);
     }
+    return verdict;
+}
 
-    // Turn LED off after activity
-    digitalWrite(LED_PIN, LOW);
+uint8_t ingestPacket(uint8_t* buffer, int len, int rssi, bool synthetic) {
+    return ingestRadio(buffer, len, rssi, synthetic, nullptr);
 }
@@ -0,0 +1,417 @@
+/*
+ * Log.cpp - Deferred Logging Implementation
+ */
+
+#include "core/Log.h"
+#include "core/Clock.h"
+#include "core/Scheduler.h"
+#include <freertos/FreeRTOS.h>
+
+// ============== Log State ==============
+// Records in the ring: size (u16), level, argc, ms (u32), format pointer,
+// argument block. Written by the loop and ingest tasks, read by the drain.
+struct LogHeader {
+    uint16_t size;
+    uint8_t level;
+    uint8_t argc;
+    uint32_t at_ms;
+    const char* fmt;
+};
+
+LogStats log_stats;
+
+static uint8_t ring[LOG_RING_SIZE];
+static uint32_t ring_head = 0;                 // Producers, under ring_lock
+static uint32_t ring_tail = 0;                 // Drain, under ring_lock
+static uint32_t dropped_unreported = 0;
+static volatile bool drain_wanted = false;    // A record went into an empty ring
+static portMUX_TYPE ring_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char* const level_names[] = {"off", "error", "warn", "info", "debug"};
+
+const char* getLogLevelName(uint8_t level) {
+    return level <= LOG_LEVEL_DEBUG ? level_names[level] : "unknown";
+}
+
+// ============== Encoding ==============
+void LogEncoder::putValue(uint8_t type, const void* value, size_t n) {
+    if (len + 1 + n > sizeof(args)) return;   // Dropped; printed as '?'
+    args[len++] = type;
+    memcpy(args + len, value, n);             // Little-endian on both targets
+    len += n;
+    argc++;
+}
+
+void LogEncoder::putBlob(uint8_t type, const void* data, size_t n, size_t max) {
+    if (len + 2 > sizeof(args)) return;
+    n = min(n, min(max, sizeof(args) - len - 2));
+    args[len++] = type;
+    args[len++] = (uint8_t)n;
+    memcpy(args + len, data, n);
+    len += n;
+    argc++;
+}
+
+static void ringWrite(uint32_t pos, const void* data, size_t n) {
+    uint32_t at = pos & (LOG_RING_SIZE - 1);
+    size_t first = min(n, (size_t)(LOG_RING_SIZE - at));
+    memcpy(ring + at, data, first);
+    memcpy(ring, (const uint8_t*)data + first, n - first);
+}
+
+static void ringRead(uint32_t pos, void* data, size_t n) {
+    uint32_t at = pos & (LOG_RING_SIZE - 1);
+    size_t first = min(n, (size_t)(LOG_RING_SIZE - at));
+    memcpy(data, ring + at, first);
+    memcpy((uint8_t*)data + first, ring, n - first);
+}
+
+void logCommit(uint8_t level, const char* fmt, const LogEncoder& enc) {
+    LogHeader h;
+    h.size = (uint16_t)(sizeof(h) + enc.len);
+    h.level = level;
+    h.argc = enc.argc;
+    h.at_ms = clockMillis();
+    h.fmt = fmt;
+
+    portENTER_CRITICAL(&ring_lock);
+    uint32_t used = ring_head - ring_tail;
+    if (used + h.size > LOG_RING_SIZE) {
+        log_stats.dropped++;
+        dropped_unreported++;
+    } else {
+        ringWrite(ring_head, &h, sizeof(h));
+        ringWrite(ring_head + sizeof(h), enc.args, enc.len);
+        ring_head += h.size;
+        log_stats.records++;
+        if (used + h.size > log_stats.high_water) log_stats.high_water = used + h.size;
+    }
+    portEXIT_CRITICAL(&ring_lock);
+
+    // A non-empty ring is being drained or has a retry armed already
+    if (used == 0) {
+        drain_wanted = true;
+        schedulerWake();
+    }
+}
+
+// ============== Formatting ==============
+struct LogArg {
+    uint8_t type;
+    uint64_t bits;                             // Integer and double values
+    const uint8_t* data;                       // Strings and byte dumps
+    uint8_t len;
+};
+
+static bool nextArg(const uint8_t*& p, const uint8_t* end, LogArg& a) {
+    if (p >= end) return false;
+    a.type = *p++;
+    a.bits = 0;
+    a.data = nullptr;
+    a.len = 0;
+    size_t n = 0;
+    switch (a.type) {
+        case LOG_ARG_INT:
+        case LOG_ARG_UINT: n = 4; break;
+        case LOG_ARG_INT64:
+        case LOG_ARG_UINT64:
+        case LOG_ARG_DOUBLE: n = 8; break;
+        case LOG_ARG_STR:
+        case LOG_ARG_BYTES:
+            if (p >= end) return false;
+            a.len = *p++;
+            if (p + a.len > end) return false;
+            a.data = p;
+            p += a.len;
+            return true;
+        default: return false;
+    }
+    if (p + n > end) return false;
+    if (n == 4) {
+        uint32_t v;
+        memcpy(&v, p, 4);
+        a.bits = a.type == LOG_ARG_INT ? (uint64_t)(int64_t)(int32_t)v : v;
+    } else {
+        memcpy(&a.bits, p, 8);
+    }
+    p += n;
+    return true;
+}
+
+static int64_t argInt(const LogArg& a) {
+    if (a.type == LOG_ARG_DOUBLE) {
+        double d;
+        memcpy(&d, &a.bits, 8);
+        return (int64_t)d;
+    }
+    if (a.type == LOG_ARG_UINT) return (int64_t)(uint32_t)a.bits;
+    return a.data ? 0 : (int64_t)a.bits;
+}
+
+static double argDouble(const LogArg& a) {
+    if (a.type == LOG_ARG_DOUBLE) {
+        double d;
+        memcpy(&d, &a.bits, 8);
+        return d;
+    }
+    if (a.type == LOG_ARG_UINT64) return (double)a.bits;
+    return (double)argInt(a);
+}
+
+size_t logFormat(char* out, size_t size, const char* fmt, const uint8_t* args, size_t len,
+                 uint8_t argc) {
+    const uint8_t* p = args;
+    const uint8_t* end = args + len;
+    size_t n = 0;
+    uint8_t used = 0;
+
+    auto append = [&](const char* s, size_t k) {
+        if (n + 1 >= size) return;
+        k = min(k, size - 1 - n);
+        memcpy(out + n, s, k);
+        n += k;
+    };
+
+    while (*fmt) {
+        if (*fmt != '%') {
+            const char* lit = fmt;
+            while (*fmt && *fmt != '%') fmt++;
+            append(lit, fmt - lit);
+            continue;
+        }
+        if (fmt[1] == '%') {
+            append("%", 1);
+            fmt += 2;
+            continue;
+        }
+
+        // Rebuild the conversion without its length modifier; the argument
+        // type decides the C type passed to snprintf
+        char spec[24];
+        size_t s = 0;
+        spec[s++] = *fmt++;
+        int star = -1;
+        while (*fmt && strchr("-+ #0123456789.*", *fmt)) {
+            if (*fmt == '*') {
+                LogArg w;
+                star = (used < argc && nextArg(p, end, w)) ? (int)argInt(w) : 0;
+                used++;
+            }
+            if (s < sizeof(spec) - 4) spec[s++] = *fmt;
+            fmt++;
+        }
+        while (*fmt && strchr("hlLqjzt", *fmt)) fmt++;
+        char conv = *fmt ? *fmt++ : 's';
+
+        LogArg a;
+        if (used >= argc || !nextArg(p, end, a)) {
+            append("?", 1);
+            continue;
+        }
+        used++;
+
+        char piece[LOG_LINE_MAX];
+        int k = 0;
+        if (a.type == LOG_ARG_BYTES && conv == 's') {
+            for (uint8_t i = 0; i < a.len && k + 3 < (int)sizeof(piece); i++) {
+                k += snprintf(piece + k, sizeof(piece) - k, i ? " %02X" : "%02X", a.data[i]);
+            }
+        } else if (conv == 's') {
+            char str[LOG_STR_MAX + 1];
+            if (a.type == LOG_ARG_STR) {
+                size_t l = min((size_t)a.len, sizeof(str) - 1);
+                memcpy(str, a.data, l);
+                str[l] = 0;
+            } else if (a.type == LOG_ARG_DOUBLE) {
+                snprintf(str, sizeof(str), "%g", argDouble(a));
+            } else {
+                snprintf(str, sizeof(str), "%lld", (long long)argInt(a));
+            }
+            spec[s++] = 's';
+            spec[s] = 0;
+            k = star >= 0 ? snprintf(piece, sizeof(piece), spec, star, str)
+                          : snprintf(piece, sizeof(piece), spec, str);
+        } else if (strchr("diuxXoc", conv)) {
+            if (conv == 'c') {
+                spec[s++] = 'c';
+            } else {
+                spec[s++] = 'l';
+                spec[s++] = 'l';
+                spec[s++] = conv;
+            }
+            spec[s] = 0;
+            long long v = a.type == LOG_ARG_UINT64 ? (long long)a.bits : (long long)argInt(a);
+            if (conv == 'c') {
+                k = star >= 0 ? snprintf(piece, sizeof(piece), spec, star, (int)v)
+                              : snprintf(piece, sizeof(piece), spec, (int)v);
+            } else {
+                k = star >= 0 ? snprintf(piece, sizeof(piece), spec, star, v)
+                              : snprintf(piece, sizeof(piece), spec, v);
+            }
+        } else if (strchr("fFeEgGaA", conv)) {
+            spec[s++] = conv;
+            spec[s] = 0;
+            double v = argDouble(a);
+            k = star >= 0 ? snprintf(piece, sizeof(piece), spec, star, v)
+                          : snprintf(piece, sizeof(piece), spec, v);
+        } else {
+            k = snprintf(piece, sizeof(piece), "0x%llx", (unsigned long long)a.bits);
+        }
+        if (k > 0) append(piece, min((size_t)k, sizeof(piece) - 1));
+    }
+
+    out[n] = 0;
+    return n;
+}
+
+// ============== Drain ==============
+// Binary output: format strings get small ids as they are first sent
+#ifdef LOG_BINARY
+static const char* format_ids[LOG_MAX_FORMATS];
+static uint8_t format_count = 0;
+static uint32_t formats_sent_ms = 0;
+
+static size_t putFrame(uint8_t* out, uint8_t type, const uint8_t* payload, size_t len) {
+    uint8_t sum = type + (uint8_t)len;
+    out[0] = LOG_SYNC_0;
+    out[1] = LOG_SYNC_1;
+    out[2] = type;
+    out[3] = (uint8_t)len;
+    memcpy(out + 4, payload, len);
+    for (size_t i = 0; i < len; i++) sum += payload[i];
+    out[4 + len] = (uint8_t)~sum;
+    return len + 5;
+}
+
+// Frames for one record (its format's definition first if not yet sent)
+static size_t encodeRecord(uint8_t* out, const LogHeader& h, const uint8_t* args, size_t len) {
+    size_t n = 0;
+    uint8_t payload[255];
+    int id = -1;
+    for (int i = 0; i < format_count; i++) {
+        if (format_ids[i] == h.fmt) {
+            id = i;
+            break;
+        }
+    }
+    if (id < 0) {
+        if (format_count == LOG_MAX_FORMATS) format_count = 0;   // Start over, definitions follow
+        id = format_count;
+        format_ids[format_count++] = h.fmt;
+        size_t flen = min(strlen(h.fmt), sizeof(payload) - 2);
+        payload[0] = (uint8_t)id;
+        payload[1] = (uint8_t)(id >> 8);
+        memcpy(payload + 2, h.fmt, flen);
+        n += putFrame(out, LOG_FRAME_FORMAT, payload, flen + 2);
+    }
+
+    payload[0] = (uint8_t)id;
+    payload[1] = (uint8_t)(id >> 8);
+    payload[2] = h.level;
+    memcpy(payload + 3, &h.at_ms, 4);
+    payload[7] = h.argc;
+    len = min(len, sizeof(payload) - 8);
+    memcpy(payload + 8, args, len);
+    n += putFrame(out + n, LOG_FRAME_RECORD, payload, len + 8);
+    return n;
+}
+#endif
+
+// Write the oldest record if the UART can take it without waiting
+static bool drainOne(bool wait) {
+    portENTER_CRITICAL(&ring_lock);
+    bool empty = ring_head == ring_tail;
+    portEXIT_CRITICAL(&ring_lock);
+    if (empty) return false;
+
+    LogHeader h;
+    uint8_t args[LOG_RECORD_MAX];
+    ringRead(ring_tail, &h, sizeof(h));
+    size_t len = h.size - sizeof(h);
+    ringRead(ring_tail + sizeof(h), args, len);
+
+#ifdef LOG_BINARY
+    static uint8_t out[2 * (255 + 5)];
+    uint8_t formats_before = format_count;
+    size_t n = encodeRecord(out, h, args, len);
+#else
+    static char out[LOG_LINE_MAX + 1];
+    size_t n = logFormat(out, LOG_LINE_MAX, h.fmt, args, len, h.argc);
+    out[n++] = '\n';
+#endif
+    if (!wait && Serial.availableForWrite() < (int)n) {
+#ifdef LOG_BINARY
+        // Take back the id just assigned: its definition was not sent
+        format_count = format_count > formats_before ? formats_before : 0;
+#endif
+        return false;
+    }
+    Serial.write((const uint8_t*)out, n);
+    log_stats.bytes_out += n;
+
+    portENTER_CRITICAL(&ring_lock);
+    ring_tail += h.size;
+    portEXIT_CRITICAL(&ring_lock);
+    return true;
+}
+
+static void reportDropped() {
+    portENTER_CRITICAL(&ring_lock);
+    uint32_t dropped = dropped_unreported;
+    dropped_unreported = 0;
+    portEXIT_CRITICAL(&ring_lock);
+    if (dropped == 0) return;
+
+#ifdef LOG_BINARY
+    uint8_t frame[4 + 5];
+    Serial.write(frame, putFrame(frame, LOG_FRAME_DROPPED, (const uint8_t*)&dropped, 4));
+#else
+    Serial.printf("[LOG] %lu lines dropped (ring full)\n", (unsigned long)dropped);
+#endif
+}
+
+void logDrain() {
+#ifdef LOG_BINARY
+    if (clockElapsedMs(formats_sent_ms) >= LOG_FORMAT_REFRESH_MS) {
+        format_count = 0;
+        formats_sent_ms = clockMillis();
+    }
+#endif
+    while (drainOne(false)) {
+    }
+    reportDropped();
+
+    portENTER_CRITICAL(&ring_lock);
+    bool empty = ring_head == ring_tail;
+    portEXIT_CRITICAL(&ring_lock);
+    if (!empty && schedulerAfter("log", LOG_DRAIN_MS, logDrain) < 0) drain_wanted = true;
+}
+
+void logService() {
+    if (!drain_wanted) return;
+    drain_wanted = false;
+    logDrain();
+}
+
+void logFlush() {
+    while (drainOne(true)) {
+    }
+    reportDropped();
+    Serial.flush();
+}
+
+void appendLogMetrics(String& out) {
+    char line[192];
+    snprintf(line, sizeof(line),
+             "# TYPE lora_bridge_log_records_total counter\n"
+             "lora_bridge_log_records_total %lu\n"
+             "# TYPE lora_bridge_log_dropped_total counter\n"
+             "lora_bridge_log_dropped_total %lu\n",
+             (unsigned long)log_stats.records, (unsigned long)log_stats.dropped);
+    out += line;
+    snprintf(line, sizeof(line),
+             "# TYPE lora_bridge_log_ring_high_water_bytes gauge\n"
+             "lora_bridge_log_ring_high_water_bytes %lu\n",
+             (unsigned long)log_stats.high_water);
+    out += line;
+}
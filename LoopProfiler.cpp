@@ -0,0 +1,199 @@
+/*
+ * LoopProfiler.cpp - Main Loop Latency Profiler Implementation
+ */
+
+#include "core/LoopProfiler.h"
+#include "core/Clock.h"
+#include "core/Log.h"
+
+// ============== Profiler Globals ==============
+LoopSectionStats loop_sections[LOOP_SECTION_COUNT];
+LoopSectionStats loop_total;
+LoopStall loop_worst_stall;
+LoopStall loop_last_stall;
+uint32_t loop_over_budget = 0;
+uint16_t loop_budget_ms = DEFAULT_LOOP_BUDGET_MS;
+
+// Current iteration state
+static uint32_t iter_start_us = 0;
+static uint32_t mark_us = 0;
+static uint32_t iter_section_us[LOOP_SECTION_COUNT];
+
+static const char* const section_names[LOOP_SECTION_COUNT] = {
+    "wifi", "lora", "events", "homespan", "web", "mqtt", "oled", "jobs", "led"
+};
+
+// ============== Helpers ==============
+const char* getLoopSectionName(uint8_t section) {
+    return section < LOOP_SECTION_COUNT ? section_names[section] : "unknown";
+}
+
+static uint8_t histBucket(uint32_t us) {
+    if (us <= 1) return 0;
+    uint8_t b = 32 - __builtin_clz(us - 1);
+    return b < LOOP_HIST_BUCKETS ? b : LOOP_HIST_BUCKETS - 1;
+}
+
+static void recordDuration(LoopSectionStats& stats, uint32_t us) {
+    stats.count++;
+    stats.total_us += us;
+    if (us > stats.max_us) stats.max_us = us;
+    stats.hist[histBucket(us)]++;
+}
+
+uint32_t loopProfilerPercentile(const LoopSectionStats& stats, uint8_t pct) {
+    if (stats.count == 0) return 0;
+
+    uint64_t target = ((uint64_t)stats.count * pct + 99) / 100;
+    uint64_t seen = 0;
+    for (uint8_t b = 0; b < LOOP_HIST_BUCKETS - 1; b++) {
+        seen += stats.hist[b];
+        if (seen >= target) {
+            uint32_t bound = 1UL << b;
+            return bound < stats.max_us ? bound : stats.max_us;
+        }
+    }
+    return stats.max_us;
+}
+
+// ============== Profiler Functions ==============
+void loopProfilerStart() {
+    iter_start_us = clockMicros();
+    mark_us = iter_start_us;
+    memset(iter_section_us, 0, sizeof(iter_section_us));
+}
+
+void loopProfilerMark(LoopSection section) {
+    uint32_t now = clockMicros();
+    uint32_t elapsed = now - mark_us;
+    mark_us = now;
+
+    iter_section_us[section] += elapsed;
+    recordDuration(loop_sections[section], elapsed);
+}
+
+void loopProfilerEnd() {
+    uint32_t total = clockElapsedUs(iter_start_us);
+    recordDuration(loop_total, total);
+
+    // Attribute the iteration to whichever section took longest
+    uint8_t culprit = 0;
+    for (uint8_t i = 1; i < LOOP_SECTION_COUNT; i++) {
+        if (iter_section_us[i] > iter_section_us[culprit]) culprit = i;
+    }
+
+    LoopStall stall = {total, iter_section_us[culprit], culprit, clockMillis()};
+
+    if (total > loop_worst_stall.total_us) {
+        loop_worst_stall = stall;
+    }
+
+    if (total > (uint32_t)loop_budget_ms * 1000UL) {
+        loop_over_budget++;
+        loop_sections[culprit].culprit++;
+        loop_last_stall = stall;
+    }
+}
+
+void loopProfilerReset() {
+    memset(loop_sections, 0, sizeof(loop_sections));
+    memset(&loop_total, 0, sizeof(loop_total));
+    memset(&loop_worst_stall, 0, sizeof(loop_worst_stall));
+    memset(&loop_last_stall, 0, sizeof(loop_last_stall));
+    loop_over_budget = 0;
+    LOG_INFO("[LOOP] Profiler statistics reset");
+}
+
+// ============== Reporting ==============
+void printLoopProfile() {
+    LOG_INFO("[LOOP] %lu iterations, %lu over %u ms budget, p99 %lu us, max %lu us",
+             (unsigned long)loop_total.count, (unsigned long)loop_over_budget,
+             loop_budget_ms, (unsigned long)loopProfilerPercentile(loop_total, 99),
+             (unsigned long)loop_total.max_us);
+
+    if (loop_worst_stall.total_us > 0) {
+        LOG_INFO("[LOOP] Worst stall: %lu us, %lu us in %s (%lu s ago)",
+                 (unsigned long)loop_worst_stall.total_us,
+                 (unsigned long)loop_worst_stall.section_us,
+                 getLoopSectionName(loop_worst_stall.section),
+                 (unsigned long)(clockElapsedMs(loop_worst_stall.at_ms) / 1000));
+    }
+
+    for (uint8_t i = 0; i < LOOP_SECTION_COUNT; i++) {
+        const LoopSectionStats& s = loop_sections[i];
+        if (s.count == 0) continue;
+        LOG_INFO("[LOOP]   %-8s avg %6lu us  p99 %7lu us  max %8lu us  stalls %lu",
+                 section_names[i], (unsigned long)(s.total_us / s.count),
+                 (unsigned long)loopProfilerPercentile(s, 99),
+                 (unsigned long)s.max_us, (unsigned long)s.culprit);
+    }
+}
+
+void appendLoopProfilerMetrics(String& out) {
+    char line[160];
+    uint64_t cumulative = 0;
+
+    // Whole-iteration histogram
+    out += F("# HELP lora_bridge_loop_duration_microseconds Duration of one loop() iteration\n"
+             "# TYPE lora_bridge_loop_duration_microseconds histogram\n");
+    for (uint8_t b = 0; b < LOOP_HIST_BUCKETS - 1; b++) {
+        cumulative += loop_total.hist[b];
+        snprintf(line, sizeof(line), "lora_bridge_loop_duration_microseconds_bucket{le=\"%lu\"} %llu\n",
+                 1UL << b, (unsigned long long)cumulative);
+        out += line;
+    }
+    snprintf(line, sizeof(line), "lora_bridge_loop_duration_microseconds_bucket{le=\"+Inf\"} %lu\n",
+             (unsigned long)loop_total.count);
+    out += line;
+    snprintf(line, sizeof(line), "lora_bridge_loop_duration_microseconds_sum %llu\n",
+             (unsigned long long)loop_total.total_us);
+    out += line;
+    snprintf(line, sizeof(line), "lora_bridge_loop_duration_microseconds_count %lu\n",
+             (unsigned long)loop_total.count);
+    out += line;
+
+    // Per-section summaries (quantiles derived from the on-device histograms)
+    static const uint8_t quantiles[] = {50, 90, 99};
+    out += F("# HELP lora_bridge_loop_section_microseconds Time spent in each loop() section\n"
+             "# TYPE lora_bridge_loop_section_microseconds summary\n");
+    for (uint8_t i = 0; i < LOOP_SECTION_COUNT; i++) {
+        const LoopSectionStats& st = loop_sections[i];
+        for (uint8_t q = 0; q < sizeof(quantiles); q++) {
+            snprintf(line, sizeof(line),
+                     "lora_bridge_loop_section_microseconds{section=\"%s\",quantile=\"0.%02u\"} %lu\n",
+                     section_names[i], quantiles[q],
+                     (unsigned long)loopProfilerPercentile(st, quantiles[q]));
+            out += line;
+        }
+        snprintf(line, sizeof(line), "lora_bridge_loop_section_microseconds_sum{section=\"%s\"} %llu\n",
+                 section_names[i], (unsigned long long)st.total_us);
+        out += line;
+        snprintf(line, sizeof(line), "lora_bridge_loop_section_microseconds_count{section=\"%s\"} %lu\n",
+                 section_names[i], (unsigned long)st.count);
+        out += line;
+    }
+
+    out += F("# HELP lora_bridge_loop_section_max_microseconds Longest single run of each section\n"
+             "# TYPE lora_bridge_loop_section_max_microseconds gauge\n");
+    for (uint8_t i = 0; i < LOOP_SECTION_COUNT; i++) {
+        snprintf(line, sizeof(line), "lora_bridge_loop_section_max_microseconds{section=\"%s\"} %lu\n",
+                 section_names[i], (unsigned long)loop_sections[i].max_us);
+        out += line;
+    }
+
+    out += F("# HELP lora_bridge_loop_stalls_total Over-budget iterations attributed to each section\n"
+             "# TYPE lora_bridge_loop_stalls_total counter\n");
+    for (uint8_t i = 0; i < LOOP_SECTION_COUNT; i++) {
+        snprintf(line, sizeof(line), "lora_bridge_loop_stalls_total{section=\"%s\"} %lu\n",
+                 section_names[i], (unsigned long)loop_sections[i].culprit);
+        out += line;
+    }
+
+    out += F("# TYPE lora_bridge_loop_over_budget_total counter\n");
+    snprintf(line, sizeof(line), "lora_bridge_loop_over_budget_total %lu\n", (unsigned long)loop_over_budget);
+    out += line;
+    out += F("# TYPE lora_bridge_loop_budget_microseconds gauge\n");
+    snprintf(line, sizeof(line), "lora_bridge_loop_budget_microseconds %lu\n",
+             (unsigned long)loop_budget_ms * 1000UL);
+    out += line;
+}
@@ -4,12 +4,19 @@
 
 #include "network/MQTTModule.h"
 #include "data/Settings.h"
+#include "core/LoopProfiler.h"
+#include "core/BootTimeline.h"
+#include "core/HeapProfiler.h"
+#include "core/EventBus.h"
+#include "core/Scheduler.h"
+#include "core/Log.h"
+#include "core/Clock.h"
+#include "data/ActivityLog.h"
 #include <WiFi.h>
 #include <WiFiClientSecure.h>
 #include <HomeSpan.h>
 
 // External variables for diagnostics
-extern unsigned long boot_time;
 extern uint32_t packets_received;
 extern bool homekit_started;
 extern int getActiveDeviceCount();
@@ -18,25 +25,41 @@ extern int getActiveDeviceCount();
 WiFiClient mqttWifiClient;
 WiFiClientSecure mqttSecureClient;
 PubSubClient mqttClient;
-unsigned long lastMqttReconnect = 0;
 
 // Rate limiting for diagnostics publishing
-unsigned long lastDiagnosticsPublish = 0;
+uint32_t lastDiagnosticsPublish = 0;
 #define DIAGNOSTICS_MIN_INTERVAL 30000  // Minimum 30 seconds between publishes
 
 #define MQTT_RECONNECT_INTERVAL 5000
 #define MQTT_BUFFER_SIZE 1024
+#define MQTT_DISCOVERY_PACING_MS 100   // Between device discoveries after a connect
+
+// Next device slot to republish discovery for after a connect
+static int discovery_next = 0;
 
 // Topics
 String bridgeStatusTopic;
 String bridgeLwtTopic;
 
+static void mqttSink(const DeviceEvent &ev);
+static void publishNextDiscovery();
+
+// Gateway MAC without colons, cached after the first call so per-packet
+// topics don't need a String
+static const char *getGatewayMacId() {
+  static char macId[13] = "";
+  if (macId[0] == 0) {
+    uint8_t mac[6];
+    WiFi.macAddress(mac);
+    snprintf(macId, sizeof(macId), "%02x%02x%02x%02x%02x%02x", mac[0], mac[1],
+             mac[2], mac[3], mac[4], mac[5]);
+  }
+  return macId;
+}
+
 // Helper to get gateway MAC without colons
 String getGatewayMac() {
-  String mac = WiFi.macAddress();
-  mac.replace(":", "");
-  mac.toLowerCase();
-  return mac;
+  return String(getGatewayMacId());
 }
 
 // Helper to build topic with prefix
@@ -46,6 +69,8 @@ String buildTopic(String topic) {
 
 // MQTT callback for incoming messages
 void mqttCallback(char* topic, byte* payload, unsigned int length) {
+  schedulerNoteActivity();
+
   String topicStr = String(topic);
   String payloadStr;
 
@@ -53,7 +78,7 @@ void mqttCallback(char* topic, byte* payload, unsigned int length) {
     payloadStr += (char)payload[i];
   }
 
-  Serial.printf("[MQTT] Message received on %s: %s\n", topic, payloadStr.c_str());
+  LOG_INFO("[MQTT] Message received on %s: %s", topic, payloadStr.c_str());
 
   // Handle subscribed topics here
   // Example: if (topicStr.endsWith("/set")) { ... }
@@ -65,6 +90,18 @@ void initMQTT() {
     return;
   }
 
+  static DeviceEvent eventQueue[16];
+  eventBusSubscribe("mqtt", mqttSink,
+                    DEVICE_EVENT_BIT(DEVICE_EVENT_READING) |
+                        DEVICE_EVENT_BIT(DEVICE_EVENT_REGISTERED) |
+                        DEVICE_EVENT_BIT(DEVICE_EVENT_REMOVED) |
+                        DEVICE_EVENT_BIT(DEVICE_EVENT_AVAILABILITY),
+                    1, EVENT_DROP_OLDEST, eventQueue, 16);
+
+  // connectMQTT() blocks on the socket, so the job has no time budget
+  schedulerEvery("mqtt_reconnect", MQTT_RECONNECT_INTERVAL, reconnectMQTT,
+                 SCHED_CATCHUP_DELAY, 0);
+
   // Set up client based on SSL/TLS setting
   if (mqtt_ssl_enabled) {
     mqttSecureClient.setInsecure(); // Accept all certificates (for simplicity)
@@ -82,19 +119,21 @@ void initMQTT() {
   bridgeStatusTopic = buildTopic("bridge/" + gatewayMac + "/status");
   bridgeLwtTopic = bridgeStatusTopic;
 
-  Serial.printf("[MQTT] Configured for %s:%d (SSL: %s, QoS: %d)\n",
-                mqtt_server, mqtt_port,
-                mqtt_ssl_enabled ? "Yes" : "No",
-                mqtt_qos);
+  LOG_INFO("[MQTT] Configured for %s:%d (SSL: %s, QoS: %d)",
+           mqtt_server, mqtt_port,
+           mqtt_ssl_enabled ? "Yes" : "No",
+           mqtt_qos);
 }
 
 // Connect to MQTT broker
 void connectMQTT() {
+  HeapScope heapScope(HEAP_SUBSYS_MQTT);
+
   if (!mqtt_enabled || strlen(mqtt_server) == 0) {
     return;
   }
 
-  Serial.print("[MQTT] Connecting to broker...");
+  LOG_INFO("[MQTT] Connecting to broker...");
 
   // Generate unique client ID using MAC address
   String clientId = "lora-bridge-";
@@ -125,8 +164,8 @@ void connectMQTT() {
   }
 
   if (connected) {
-    Serial.println(" Connected!");
-    Serial.printf("[MQTT] Buffer size: %d bytes\n", mqttClient.getBufferSize());
+    LOG_INFO("[MQTT] Connected");
+    LOG_INFO("[MQTT] Buffer size: %d bytes", mqttClient.getBufferSize());
 
     // Publish online status
     publishBridgeStatus(true);
@@ -140,22 +179,39 @@ void connectMQTT() {
     publishGatewayDiscovery();
 
     // Republish discovery for all existing devices (order matters!)
-    // This ensures devices loaded from flash are properly linked to the gateway
-    extern Device devices[];
-    extern int device_count;
-    for (int i = 0; i < device_count; i++) {
-      if (devices[i].active) {
-        publishHomeAssistantDiscovery(&devices[i], devices[i].id);
-        delay(100);  // Small delay between discoveries to avoid overwhelming MQTT
-      }
-    }
+    // This ensures devices loaded from flash are properly linked to the gateway.
+    // One device per run, so the broker is not flooded and loop() not held up
+    discovery_next = 0;
+    schedulerAfter("mqtt_discovery", 0, publishNextDiscovery);
 
     // Publish initial bridge diagnostics
     // Note: HomeKit pairing status may not be accurate yet if HomeSpan is still loading
     // The main loop will detect pairing status changes and republish
     publishBridgeDiagnostics();
+
+    // Boot timeline is retained; republish after reconnects once boot is done
+    if (isBootComplete()) {
+      publishBootTimeline();
+    }
   } else {
-    Serial.printf(" Failed, rc=%d\n", mqttClient.state());
+    LOG_WARN("[MQTT] Connection failed, rc=%d", mqttClient.state());
+  }
+}
+
+// One-shot job: republish the next active device's discovery, then re-arm
+// while devices remain. A reconnect starts over from the first device.
+static void publishNextDiscovery() {
+  if (!mqttClient.connected()) return;
+
+  while (discovery_next < device_count && !devices[discovery_next].active) {
+    discovery_next++;
+  }
+  if (discovery_next >= device_count) return;
+
+  Device *dev = &devices[discovery_next++];
+  publishHomeAssistantDiscovery(dev, dev->id);
+  if (discovery_next < device_count) {
+    schedulerAfter("mqtt_discovery", MQTT_DISCOVERY_PACING_MS, publishNextDiscovery);
   }
 }
 
@@ -164,21 +220,17 @@ void disconnectMQTT() {
   if (mqttClient.connected()) {
     publishBridgeStatus(false);
     mqttClient.disconnect();
-    Serial.println("[MQTT] Disconnected");
+    LOG_INFO("[MQTT] Disconnected");
   }
 }
 
-// Reconnect to MQTT broker with interval throttling
+// Reconnect to MQTT broker (scheduled every MQTT_RECONNECT_INTERVAL)
 void reconnectMQTT() {
   if (!mqtt_enabled || mqttClient.connected()) {
     return;
   }
 
-  unsigned long now = millis();
-  if (now - lastMqttReconnect > MQTT_RECONNECT_INTERVAL) {
-    lastMqttReconnect = now;
-    connectMQTT();
-  }
+  connectMQTT();
 }
 
 // Helper to check connection status
@@ -190,13 +242,13 @@ bool isMQTTConnected() {
 
 // MQTT loop - call in main loop
 void loopMQTT() {
+  HeapScope heapScope(HEAP_SUBSYS_MQTT);
+
   if (!mqtt_enabled) {
     return;
   }
 
-  if (!mqttClient.connected()) {
-    reconnectMQTT();
-  } else {
+  if (mqttClient.connected()) {
     mqttClient.loop();
   }
 }
@@ -208,7 +260,7 @@ bool testMQTTConnection(const char *server, uint16_t port, const char *username,
   PubSubClient testClient(testWifiClient);
   testClient.setServer(server, port);
 
-  Serial.printf("[MQTT] Testing connection to %s:%d\n", server, port);
+  LOG_INFO("[MQTT] Testing connection to %s:%d", server, port);
 
   bool connected = false;
   if (strlen(username) > 0 && strlen(password) > 0) {
@@ -218,10 +270,10 @@ bool testMQTTConnection(const char *server, uint16_t port, const char *username,
   }
 
   if (connected) {
-    Serial.println("[MQTT] Test connection successful");
+    LOG_INFO("[MQTT] Test connection successful");
     testClient.disconnect();
   } else {
-    Serial.printf("[MQTT] Test connection failed, rc=%d\n", testClient.state());
+    LOG_WARN("[MQTT] Test connection failed, rc=%d", testClient.state());
   }
 
   return connected;
@@ -237,14 +289,16 @@ void publishBridgeStatus(bool online) {
   bool success = mqttClient.publish(bridgeStatusTopic.c_str(), status, mqtt_retain);
 
   if (success) {
-    Serial.printf("[MQTT] Published bridge status: %s\n", status);
+    LOG_INFO("[MQTT] Published bridge status: %s", status);
   } else {
-    Serial.printf("[MQTT] Failed to publish bridge status\n");
+    LOG_WARN("[MQTT] Failed to publish bridge status");
   }
 }
 
 // Publish bridge diagnostics (uptime, wifi signal, etc.)
 void publishBridgeDiagnostics() {
+  HeapScope heapScope(HEAP_SUBSYS_MQTT);
+
   if (!mqtt_enabled || !mqttClient.connected()) {
     return;
   }
@@ -277,7 +331,14 @@ void publishBridgeDiagnostics() {
   payload += "\"stats\":{";
   payload += "\"packets_received\":" + String(packets_received) + ",";
   payload += "\"active_devices\":" + String(getActiveDeviceCount()) + ",";
-  payload += "\"uptime\":" + String((millis() - boot_time) / 1000);
+  payload += "\"uptime\":" + String((unsigned long)clockUptimeSeconds());
+  payload += "},";
+
+  // Boot timing
+  payload += "\"boot\":{";
+  payload += "\"fast_boot\":" + String(fast_boot ? "true" : "false") + ",";
+  payload += "\"lora_ready_ms\":" + String(boot_phases[BOOT_PHASE_LORA].end_ms) + ",";
+  payload += "\"complete_ms\":" + String(boot_complete_ms);
   payload += "},";
 
   // HomeKit status
@@ -294,7 +355,19 @@ void publishBridgeDiagnostics() {
   // System information
   payload += "\"system\":{";
   payload += "\"free_heap\":" + String(ESP.getFreeHeap()) + ",";
-  payload += "\"heap_size\":" + String(ESP.getHeapSize());
+  payload += "\"heap_size\":" + String(ESP.getHeapSize()) + ",";
+  payload += "\"largest_block\":" + String(ESP.getMaxAllocHeap()) + ",";
+  payload += "\"heap_frag\":" + String(getHeapFragmentation());
+  payload += "},";
+
+  // Main loop timing
+  payload += "\"loop\":{";
+  payload += "\"p99_us\":" + String(loopProfilerPercentile(loop_total, 99)) + ",";
+  payload += "\"max_us\":" + String(loop_total.max_us) + ",";
+  payload += "\"budget_ms\":" + String(loop_budget_ms) + ",";
+  payload += "\"over_budget\":" + String(loop_over_budget) + ",";
+  payload += "\"worst_stall_us\":" + String(loop_worst_stall.total_us) + ",";
+  payload += "\"worst_stall_section\":\"" + String(getLoopSectionName(loop_worst_stall.section)) + "\"";
   payload += "}";
 
   payload += "}";
@@ -302,10 +375,43 @@ void publishBridgeDiagnostics() {
   bool success = mqttClient.publish(diagnosticTopic.c_str(), payload.c_str(), mqtt_retain);
 
   if (success) {
-    Serial.println("[MQTT] Published bridge diagnostics");
-    lastDiagnosticsPublish = millis();  // Update timestamp
+    LOG_INFO("[MQTT] Published bridge diagnostics");
+    lastDiagnosticsPublish = clockMillis();  // Update timestamp
   } else {
-    Serial.println("[MQTT] Failed to publish diagnostics");
+    LOG_WARN("[MQTT] Failed to publish diagnostics");
+  }
+}
+
+// Publish the boot timeline (retained) so slow startups can be traced
+void publishBootTimeline() {
+  HeapScope heapScope(HEAP_SUBSYS_MQTT);
+
+  if (!mqtt_enabled || !mqttClient.connected()) {
+    return;
+  }
+
+  String bootTopic = buildTopic("bridge/" + getGatewayMac() + "/boot");
+
+  StaticJsonDocument<768> doc;
+  doc["fast_boot"] = fast_boot;
+  doc["complete_ms"] = boot_complete_ms;
+  doc["lora_ready_ms"] = boot_phases[BOOT_PHASE_LORA].end_ms;
+
+  JsonObject phases = doc.createNestedObject("phases");
+  for (uint8_t i = 0; i < BOOT_PHASE_COUNT; i++) {
+    if (!boot_phases[i].done) continue;
+    JsonObject phase = phases.createNestedObject(getBootPhaseName(i));
+    phase["start_ms"] = boot_phases[i].start_ms;
+    phase["duration_ms"] = getBootPhaseDuration(i);
+  }
+
+  String payload;
+  serializeJson(doc, payload);
+
+  if (mqttClient.publish(bootTopic.c_str(), payload.c_str(), true)) {
+    LOG_INFO("[MQTT] Published boot timeline");
+  } else {
+    LOG_WARN("[MQTT] Failed to publish boot timeline");
   }
 }
 
@@ -315,14 +421,15 @@ void publishBridgeDiagnosticsIfChanged() {
     return;
   }
 
-  unsigned long now = millis();
-  if (now - lastDiagnosticsPublish >= DIAGNOSTICS_MIN_INTERVAL) {
+  if (clockElapsedMs(lastDiagnosticsPublish) >= DIAGNOSTICS_MIN_INTERVAL) {
     publishBridgeDiagnostics();
   }
 }
 
 // Publish Home Assistant auto-discovery for gateway sensors
 void publishGatewayDiscovery() {
+  HeapScope heapScope(HEAP_SUBSYS_MQTT);
+
   if (!mqtt_enabled || !mqttClient.connected()) {
     return;
   }
@@ -330,7 +437,7 @@ void publishGatewayDiscovery() {
   String gatewayMac = getGatewayMac();
   String uniqueId = "lora_bridge_" + gatewayMac;
 
-  Serial.println("[MQTT] Publishing gateway auto-discovery");
+  LOG_INFO("[MQTT] Publishing gateway auto-discovery");
 
   // Device info JSON - shared across all gateway sensors
   String deviceInfo =
@@ -410,11 +517,13 @@ void publishGatewayDiscovery() {
                        "\"entity_category\":\"diagnostic\"," + deviceInfo + "}";
   mqttClient.publish(freqTopic.c_str(), freqPayload.c_str(), mqtt_retain);
 
-  Serial.println("[MQTT] Gateway auto-discovery published");
+  LOG_INFO("[MQTT] Gateway auto-discovery published");
 }
 
 // Publish Home Assistant auto-discovery configuration for a device
 void publishHomeAssistantDiscovery(Device *dev, const char *deviceId) {
+  HeapScope heapScope(HEAP_SUBSYS_MQTT);
+
   if (!mqtt_enabled || !mqttClient.connected()) {
     return;
   }
@@ -422,7 +531,7 @@ void publishHomeAssistantDiscovery(Device *dev, const char *deviceId) {
   String gatewayMac = getGatewayMac();
   String uniquePrefix = gatewayMac + "_" + String(deviceId);
 
-  Serial.printf("[MQTT] Publishing auto-discovery for device: %s\n", deviceId);
+  LOG_INFO("[MQTT] Publishing auto-discovery for device: %s", deviceId);
 
   // Availability topic (shared across all entities)
   String availabilityTopic = buildTopic("sensor/" + uniquePrefix + "/availability");
@@ -450,7 +559,7 @@ void publishHomeAssistantDiscovery(Device *dev, const char *deviceId) {
         availability + "," + deviceInfo + "}";
 
     if (!mqttClient.publish(topic.c_str(), payload.c_str(), mqtt_retain)) {
-      Serial.printf("[MQTT] Failed to publish temperature discovery\n");
+      LOG_WARN("[MQTT] Failed to publish temperature discovery");
     }
   }
 
@@ -465,7 +574,7 @@ void publishHomeAssistantDiscovery(Device *dev, const char *deviceId) {
         availability + "," + deviceInfo + "}";
 
     if (!mqttClient.publish(topic.c_str(), payload.c_str(), mqtt_retain)) {
-      Serial.printf("[MQTT] Failed to publish humidity discovery\n");
+      LOG_WARN("[MQTT] Failed to publish humidity discovery");
     }
   }
 
@@ -481,7 +590,7 @@ void publishHomeAssistantDiscovery(Device *dev, const char *deviceId) {
         availability + "," + deviceInfo + "}";
 
     if (!mqttClient.publish(topic.c_str(), payload.c_str(), mqtt_retain)) {
-      Serial.printf("[MQTT] Failed to publish battery discovery\n");
+      LOG_WARN("[MQTT] Failed to publish battery discovery");
     }
   }
 
@@ -496,7 +605,7 @@ void publishHomeAssistantDiscovery(Device *dev, const char *deviceId) {
         availability + "," + deviceInfo + "}";
 
     if (!mqttClient.publish(topic.c_str(), payload.c_str(), mqtt_retain)) {
-      Serial.printf("[MQTT] Failed to publish lux discovery\n");
+      LOG_WARN("[MQTT] Failed to publish lux discovery");
     }
   }
 
@@ -510,7 +619,7 @@ void publishHomeAssistantDiscovery(Device *dev, const char *deviceId) {
         availability + "," + deviceInfo + "}";
 
     if (!mqttClient.publish(topic.c_str(), payload.c_str(), mqtt_retain)) {
-      Serial.printf("[MQTT] Failed to publish motion discovery\n");
+      LOG_WARN("[MQTT] Failed to publish motion discovery");
     }
   }
 
@@ -526,7 +635,7 @@ void publishHomeAssistantDiscovery(Device *dev, const char *deviceId) {
         availability + "," + deviceInfo + "}";
 
     if (!mqttClient.publish(topic.c_str(), payload.c_str(), mqtt_retain)) {
-      Serial.printf("[MQTT] Failed to publish contact discovery\n");
+      LOG_WARN("[MQTT] Failed to publish contact discovery");
     }
   }
 
@@ -540,106 +649,84 @@ void publishHomeAssistantDiscovery(Device *dev, const char *deviceId) {
                        availability + "," + deviceInfo + "}";
 
   if (!mqttClient.publish(rssiTopic.c_str(), rssiPayload.c_str(), mqtt_retain)) {
-    Serial.printf("[MQTT] Failed to publish RSSI discovery\n");
+    LOG_WARN("[MQTT] Failed to publish RSSI discovery");
   }
 
   // Publish initial availability as online
   if (!mqttClient.publish(availabilityTopic.c_str(), "online", mqtt_retain)) {
-    Serial.printf("[MQTT] Failed to publish availability\n");
+    LOG_WARN("[MQTT] Failed to publish availability");
   }
 
-  Serial.printf("[MQTT] Auto-discovery published for %s\n", deviceId);
+  LOG_INFO("[MQTT] Auto-discovery published for %s", deviceId);
 }
 
 // Publish device sensor data
-void publishDeviceData(Device *dev, JsonDocument &doc, int rssi) {
+// Publish one device state value to <prefix>/<component>/<mac>_<id>/<field>
+static void publishDeviceValue(const Device *dev, const char *component,
+                               const char *field, const char *value) {
+  char topic[128];
+  snprintf(topic, sizeof(topic), "%s/%s/%s_%s/%s", mqtt_topic_prefix, component,
+           getGatewayMacId(), dev->id, field);
+  if (!mqttClient.publish(topic, value, mqtt_retain)) {
+    LOG_WARN("[MQTT] Failed to publish %s", field);
+  }
+}
+
+// Runs for every packet: topics and values are built on the stack
+void publishDeviceData(Device *dev, const DeviceReading &r) {
+  HeapScope heapScope(HEAP_SUBSYS_MQTT);
+
   if (!mqtt_enabled || !mqttClient.connected()) {
     return;
   }
 
-  String gatewayMac = getGatewayMac();
-  String uniquePrefix = gatewayMac + "_" + String(dev->id);
+  char value[16];
 
   // Publish temperature
-  if (doc.containsKey("t") && dev->has_temp) {
-    String topic = buildTopic("sensor/" + uniquePrefix + "/temperature");
-    String value = String(doc["t"].as<float>(), 1);
-    if (!mqttClient.publish(topic.c_str(), value.c_str(), mqtt_retain)) {
-      Serial.printf("[MQTT] Failed to publish temperature\n");
-    }
+  if ((r.fields & ACT_TEMP) && dev->has_temp) {
+    snprintf(value, sizeof(value), "%.1f", r.temperature);
+    publishDeviceValue(dev, "sensor", "temperature", value);
   }
 
   // Publish humidity
-  if (doc.containsKey("hu") && dev->has_hum) {
-    String topic = buildTopic("sensor/" + uniquePrefix + "/humidity");
-    String value = String(doc["hu"].as<float>(), 0);
-    if (!mqttClient.publish(topic.c_str(), value.c_str(), mqtt_retain)) {
-      Serial.printf("[MQTT] Failed to publish humidity\n");
-    }
+  if ((r.fields & ACT_HUM) && dev->has_hum) {
+    snprintf(value, sizeof(value), "%.0f", r.humidity);
+    publishDeviceValue(dev, "sensor", "humidity", value);
   }
 
   // Publish battery
-  if (doc.containsKey("b") && dev->has_batt) {
-    String topic = buildTopic("sensor/" + uniquePrefix + "/battery");
-    String value = String(doc["b"].as<int>());
-    if (!mqttClient.publish(topic.c_str(), value.c_str(), mqtt_retain)) {
-      Serial.printf("[MQTT] Failed to publish battery\n");
-    }
+  if ((r.fields & ACT_BATT) && dev->has_batt) {
+    snprintf(value, sizeof(value), "%d", r.battery);
+    publishDeviceValue(dev, "sensor", "battery", value);
   }
 
   // Publish light/lux
-  if (doc.containsKey("lux") && dev->has_light) {
-    String topic = buildTopic("sensor/" + uniquePrefix + "/lux");
-    String value = String(doc["lux"].as<int>());
-    if (!mqttClient.publish(topic.c_str(), value.c_str(), mqtt_retain)) {
-      Serial.printf("[MQTT] Failed to publish lux\n");
-    }
+  if ((r.fields & ACT_LUX) && dev->has_light) {
+    snprintf(value, sizeof(value), "%d", r.lux);
+    publishDeviceValue(dev, "sensor", "lux", value);
   }
 
   // Publish motion (binary sensor)
-  if (doc.containsKey("m") && dev->has_motion) {
-    String topic = buildTopic("binary_sensor/" + uniquePrefix + "/motion");
-    // Handle both string ("on"/"off") and boolean (true/false) values
-    String value = "off";
-    if (doc["m"].is<bool>()) {
-      value = doc["m"].as<bool>() ? "on" : "off";
-    } else {
-      String mVal = doc["m"].as<String>();
-      mVal.toLowerCase();
-      value = (mVal == "on" || mVal == "1" || mVal == "true") ? "on" : "off";
-    }
-    if (!mqttClient.publish(topic.c_str(), value.c_str(), mqtt_retain)) {
-      Serial.printf("[MQTT] Failed to publish motion\n");
-    }
+  if ((r.fields & ACT_MOTION) && dev->has_motion) {
+    publishDeviceValue(dev, "binary_sensor", "motion",
+                       (r.fields & ACT_MOTION_ON) ? "on" : "off");
   }
 
   // Publish contact (binary sensor)
-  if (doc.containsKey("c") && dev->has_contact) {
-    String topic = buildTopic("binary_sensor/" + uniquePrefix + "/contact");
-    // Handle both string ("on"/"off") and boolean (true/false) values
-    String value = "off";
-    if (doc["c"].is<bool>()) {
-      value = doc["c"].as<bool>() ? "on" : "off";
-    } else {
-      String cVal = doc["c"].as<String>();
-      cVal.toLowerCase();
-      value = (cVal == "on" || cVal == "1" || cVal == "true") ? "on" : "off";
-    }
-    if (!mqttClient.publish(topic.c_str(), value.c_str(), mqtt_retain)) {
-      Serial.printf("[MQTT] Failed to publish contact\n");
-    }
+  if ((r.fields & ACT_CONTACT) && dev->has_contact) {
+    publishDeviceValue(dev, "binary_sensor", "contact",
+                       (r.fields & ACT_CONTACT_CLOSED) ? "on" : "off");
   }
 
   // Publish RSSI
-  String rssiTopic = buildTopic("sensor/" + uniquePrefix + "/rssi");
-  String rssiValue = String(rssi);
-  if (!mqttClient.publish(rssiTopic.c_str(), rssiValue.c_str(), mqtt_retain)) {
-    Serial.printf("[MQTT] Failed to publish RSSI\n");
-  }
+  snprintf(value, sizeof(value), "%d", r.rssi);
+  publishDeviceValue(dev, "sensor", "rssi", value);
 }
 
 // Remove device from MQTT (publish empty configs to remove from Home Assistant)
 void removeDeviceFromMQTT(const char *deviceId) {
+  HeapScope heapScope(HEAP_SUBSYS_MQTT);
+
   if (!mqtt_enabled || !mqttClient.connected()) {
     return;
   }
@@ -647,7 +734,7 @@ void removeDeviceFromMQTT(const char *deviceId) {
   String gatewayMac = getGatewayMac();
   String uniquePrefix = gatewayMac + "_" + String(deviceId);
 
-  Serial.printf("[MQTT] Removing device from MQTT: %s\n", deviceId);
+  LOG_INFO("[MQTT] Removing device from MQTT: %s", deviceId);
 
   // Publish empty payloads to remove entities from Home Assistant
   String topics[] = {
@@ -662,7 +749,7 @@ void removeDeviceFromMQTT(const char *deviceId) {
 
   for (String topic : topics) {
     if (!mqttClient.publish(topic.c_str(), "", mqtt_retain)) {
-      Serial.printf("[MQTT] Failed to remove config: %s\n", topic.c_str());
+      LOG_WARN("[MQTT] Failed to remove config: %s", topic.c_str());
     }
   }
 
@@ -670,5 +757,35 @@ void removeDeviceFromMQTT(const char *deviceId) {
   String availabilityTopic = buildTopic("sensor/" + uniquePrefix + "/availability");
   mqttClient.publish(availabilityTopic.c_str(), "offline", mqtt_retain);
 
-  Serial.printf("[MQTT] Device removed from MQTT: %s\n", deviceId);
+  LOG_INFO("[MQTT] Device removed from MQTT: %s", deviceId);
+}
+
+// Device events arrive here from the event bus
+static void mqttSink(const DeviceEvent &ev) {
+  if (!mqtt_enabled) {
+    return;
+  }
+
+  Device *dev = getEventDevice(ev);
+  switch (ev.type) {
+  case DEVICE_EVENT_READING:
+    if (dev) {
+      publishDeviceData(dev, ev.reading);
+    }
+    break;
+  case DEVICE_EVENT_REGISTERED:
+    publishHomeAssistantDiscovery(&devices[ev.device], ev.reading.id);
+    // Update gateway diagnostics (active_devices count changed)
+    publishBridgeDiagnosticsIfChanged();
+    break;
+  case DEVICE_EVENT_REMOVED:
+    removeDeviceFromMQTT(ev.reading.id);
+    publishBridgeDiagnosticsIfChanged();
+    break;
+  case DEVICE_EVENT_AVAILABILITY:
+    if (dev && mqttClient.connected()) {
+      publishDeviceValue(dev, "sensor", "availability", ev.online ? "online" : "offline");
+    }
+    break;
+  }
 }
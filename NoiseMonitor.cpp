@@ -0,0 +1,296 @@
+/*
+ * NoiseMonitor.cpp - RF Noise Floor and Interference Monitor Implementation
+ */
+
+#include "hardware/NoiseMonitor.h"
+#include "core/Clock.h"
+#include "core/Log.h"
+#include <freertos/FreeRTOS.h>
+
+NoiseStats noise_stats;
+uint16_t noise_sample_ms = NOISE_SAMPLE_MS_DEFAULT;
+
+const float noise_margin_edges[NOISE_MARGIN_BINS - 1] = {0, 3, 6, 10, 15, 20, 25};
+
+// Written by the radio task, read by the loop task
+static portMUX_TYPE noise_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint16_t window_hist[NOISE_BINS];
+static uint32_t window_samples = 0;
+static uint32_t window_start_ms = 0;
+
+static uint16_t slices[NOISE_SLICES][NOISE_BINS];
+static uint8_t slice_index = 0;
+static uint32_t slice_start_ms = 0;
+static uint32_t hour_hist[NOISE_BINS];          // Sum of the slices
+static uint32_t hour_samples = 0;
+static uint32_t boot_hist[NOISE_BINS];
+
+static uint32_t margin_hist[NOISE_MARGIN_BINS];
+static NoiseEpisode episodes[NOISE_EPISODES];   // Ring, newest at episode_index
+static uint8_t episode_index = 0;
+
+static uint32_t last_sample_ms = 0;
+static bool sampled = false;                    // Any sample yet (timers start with it)
+
+// ============== Histograms ==============
+static uint8_t binFor(int rssi) {
+    int bin = rssi - NOISE_MIN_DBM;
+    return bin < 0 ? 0 : (bin >= NOISE_BINS ? NOISE_BINS - 1 : bin);
+}
+
+template <typename T>
+static int percentileOf(const T* hist, uint32_t total, uint8_t percentile) {
+    if (total == 0) return NOISE_MIN_DBM;
+    uint32_t rank = (uint32_t)(((uint64_t)total * percentile + 99) / 100);
+    if (rank == 0) rank = 1;
+    uint32_t seen = 0;
+    for (int i = 0; i < NOISE_BINS; i++) {
+        seen += hist[i];
+        if (seen >= rank) return NOISE_MIN_DBM + i;
+    }
+    return NOISE_MIN_DBM + NOISE_BINS - 1;
+}
+
+int noisePercentile(const uint32_t* hist, uint32_t total, uint8_t percentile) {
+    return percentileOf(hist, total, percentile);
+}
+
+// Start a new slice for each NOISE_SLICE_MS gone by, dropping the oldest
+// from the hour (lock held)
+static void advanceSlices(uint32_t now) {
+    uint32_t elapsed = now - slice_start_ms;
+    if (elapsed < NOISE_SLICE_MS) return;
+    uint32_t steps = elapsed / NOISE_SLICE_MS;
+    slice_start_ms += steps * NOISE_SLICE_MS;
+    if (steps > NOISE_SLICES) steps = NOISE_SLICES;
+
+    for (uint32_t s = 0; s < steps; s++) {
+        slice_index = (slice_index + 1) % NOISE_SLICES;
+        uint16_t* slice = slices[slice_index];
+        for (int i = 0; i < NOISE_BINS; i++) {
+            hour_hist[i] -= slice[i];
+            hour_samples -= slice[i];
+            slice[i] = 0;
+        }
+    }
+}
+
+// ============== Episodes ==============
+enum NoiseChange : uint8_t { NOISE_UNCHANGED, NOISE_STARTED, NOISE_ENDED };
+
+// Close the decision window: its median against the floor (lock held)
+static NoiseChange closeWindow(uint32_t now) {
+    NoiseChange change = NOISE_UNCHANGED;
+    int level = percentileOf(window_hist, window_samples, 50);
+    int floor = percentileOf(hour_hist, hour_samples, NOISE_FLOOR_PERCENTILE);
+    noise_stats.level_dbm = level;
+    noise_stats.floor_dbm = floor;
+    noise_stats.windows++;
+
+    NoiseEpisode& ep = episodes[episode_index];
+    if (noise_stats.interference) {
+        if (level > ep.peak_dbm) ep.peak_dbm = level;
+        if (level < floor + NOISE_INTERFERENCE_DB - NOISE_HYSTERESIS_DB) {
+            ep.duration_ms = now - ep.start_ms;
+            if (ep.duration_ms == 0) ep.duration_ms = 1;
+            noise_stats.interference_ms += ep.duration_ms;
+            noise_stats.interference = false;
+            change = NOISE_ENDED;
+        }
+    } else if (noise_stats.windows > NOISE_BASELINE_WINDOWS && level >= floor + NOISE_INTERFERENCE_DB) {
+        episode_index = (episode_index + 1) % NOISE_EPISODES;
+        NoiseEpisode& next = episodes[episode_index];
+        next.start_ms = now ? now : 1;
+        next.duration_ms = 0;
+        next.floor_dbm = floor;
+        next.peak_dbm = level;
+        noise_stats.interference = true;
+        noise_stats.episodes++;
+        change = NOISE_STARTED;
+    }
+
+    memset(window_hist, 0, sizeof(window_hist));
+    window_samples = 0;
+    window_start_ms = now;
+    return change;
+}
+
+// ============== Sampling ==============
+bool noiseSampleDue() {
+    return noise_sample_ms != 0 && (!sampled || clockElapsedMs(last_sample_ms) >= noise_sample_ms);
+}
+
+uint32_t noiseNextSampleMs() {
+    if (noise_sample_ms == 0) return UINT32_MAX;
+    if (!sampled) return 0;
+    uint32_t elapsed = clockElapsedMs(last_sample_ms);
+    return elapsed >= noise_sample_ms ? 0 : noise_sample_ms - elapsed;
+}
+
+void noiseSampleDeferred() {
+    portENTER_CRITICAL(&noise_lock);
+    noise_stats.deferred++;
+    portEXIT_CRITICAL(&noise_lock);
+}
+
+void noiseRecordSample(int rssi) {
+    uint32_t now = clockMillis();
+    uint8_t bin = binFor(rssi);
+    NoiseChange change = NOISE_UNCHANGED;
+
+    portENTER_CRITICAL(&noise_lock);
+    if (!sampled) {
+        window_start_ms = now;
+        slice_start_ms = now;
+        sampled = true;
+    }
+    last_sample_ms = now;
+
+    advanceSlices(now);
+    if (now - window_start_ms >= NOISE_WINDOW_MS) {
+        // A window with nothing in it (sampling was off) decides nothing
+        if (window_samples > 0) change = closeWindow(now);
+        else window_start_ms = now;
+    }
+
+    if (window_hist[bin] < UINT16_MAX) window_hist[bin]++;
+    window_samples++;
+    if (slices[slice_index][bin] < UINT16_MAX) {
+        slices[slice_index][bin]++;
+        hour_hist[bin]++;
+        hour_samples++;
+    }
+    boot_hist[bin]++;
+    noise_stats.samples++;
+
+    NoiseEpisode ep = episodes[episode_index];
+    portEXIT_CRITICAL(&noise_lock);
+
+    if (change == NOISE_STARTED) {
+        LOG_WARN("[NOISE] Interference: %d dBm, %d dB over the %d dBm floor", ep.peak_dbm,
+                 ep.peak_dbm - ep.floor_dbm, ep.floor_dbm);
+    } else if (change == NOISE_ENDED) {
+        LOG_INFO("[NOISE] Interference over after %lu s, peak %d dBm",
+                 (unsigned long)(ep.duration_ms / 1000), ep.peak_dbm);
+    }
+}
+
+// ============== Frames ==============
+float noiseSnrLimitDb(uint8_t sf) {
+    return -7.5f - 2.5f * ((int)sf - 7);
+}
+
+void noiseRecordFrame(float snr, uint8_t sf) {
+    float margin = snr - noiseSnrLimitDb(sf);
+    uint8_t bin = 0;
+    while (bin < NOISE_MARGIN_BINS - 1 && margin > noise_margin_edges[bin]) bin++;
+
+    portENTER_CRITICAL(&noise_lock);
+    margin_hist[bin]++;
+    noise_stats.frames++;
+    noise_stats.margin_sum_db += margin;
+    noise_stats.last_margin_db = margin;
+    portEXIT_CRITICAL(&noise_lock);
+}
+
+// ============== Reporting ==============
+void noiseSnapshot(NoiseSnapshot& out) {
+    portENTER_CRITICAL(&noise_lock);
+    out.stats = noise_stats;
+    memcpy(out.hour, hour_hist, sizeof(out.hour));
+    out.hour_samples = hour_samples;
+    memcpy(out.boot, boot_hist, sizeof(out.boot));
+    memcpy(out.margin, margin_hist, sizeof(out.margin));
+    for (uint8_t i = 0; i < NOISE_EPISODES; i++) {
+        out.episodes[i] = episodes[(episode_index + NOISE_EPISODES - i) % NOISE_EPISODES];
+    }
+    portEXIT_CRITICAL(&noise_lock);
+
+    // Time in the episode still running
+    if (out.stats.interference) out.stats.interference_ms += clockElapsedMs(out.episodes[0].start_ms);
+}
+
+void appendNoiseMetrics(String& out) {
+    static NoiseSnapshot snap;
+    noiseSnapshot(snap);
+    const NoiseStats& s = snap.stats;
+    char line[256];
+
+    snprintf(line, sizeof(line),
+             "# TYPE lora_bridge_noise_samples_total counter\n"
+             "lora_bridge_noise_samples_total %lu\n"
+             "# TYPE lora_bridge_noise_samples_deferred_total counter\n"
+             "lora_bridge_noise_samples_deferred_total %lu\n",
+             (unsigned long)s.samples, (unsigned long)s.deferred);
+    out += line;
+    if (s.windows > 0) {
+        snprintf(line, sizeof(line),
+                 "# HELP lora_bridge_noise_floor_dbm Channel RSSI, low percentile of the last hour\n"
+                 "# TYPE lora_bridge_noise_floor_dbm gauge\n"
+                 "lora_bridge_noise_floor_dbm %d\n",
+                 s.floor_dbm);
+        out += line;
+        snprintf(line, sizeof(line),
+                 "# HELP lora_bridge_noise_level_dbm Median channel RSSI of the last 10 s\n"
+                 "# TYPE lora_bridge_noise_level_dbm gauge\n"
+                 "lora_bridge_noise_level_dbm %d\n",
+                 s.level_dbm);
+        out += line;
+    }
+    snprintf(line, sizeof(line),
+             "# TYPE lora_bridge_interference_active gauge\n"
+             "lora_bridge_interference_active %d\n",
+             s.interference ? 1 : 0);
+    out += line;
+    snprintf(line, sizeof(line),
+             "# TYPE lora_bridge_interference_episodes_total counter\n"
+             "lora_bridge_interference_episodes_total %lu\n"
+             "# TYPE lora_bridge_interference_seconds_total counter\n"
+             "lora_bridge_interference_seconds_total %.1f\n",
+             (unsigned long)s.episodes, s.interference_ms / 1000.0);
+    out += line;
+
+    // Channel RSSI since boot, in 5 dB buckets
+    out += F("# HELP lora_bridge_noise_rssi_dbm Channel RSSI samples between frames\n"
+             "# TYPE lora_bridge_noise_rssi_dbm histogram\n");
+    uint32_t cumulative = 0;
+    double sum = 0;
+    int bin = 0;
+    for (int le = NOISE_MIN_DBM + 5; le < NOISE_MIN_DBM + NOISE_BINS; le += 5) {
+        for (; bin <= le - NOISE_MIN_DBM; bin++) {
+            cumulative += snap.boot[bin];
+            sum += (double)snap.boot[bin] * (NOISE_MIN_DBM + bin);
+        }
+        snprintf(line, sizeof(line), "lora_bridge_noise_rssi_dbm_bucket{le=\"%d\"} %lu\n", le,
+                 (unsigned long)cumulative);
+        out += line;
+    }
+    for (; bin < NOISE_BINS; bin++) {
+        cumulative += snap.boot[bin];
+        sum += (double)snap.boot[bin] * (NOISE_MIN_DBM + bin);
+    }
+    snprintf(line, sizeof(line),
+             "lora_bridge_noise_rssi_dbm_bucket{le=\"+Inf\"} %lu\n"
+             "lora_bridge_noise_rssi_dbm_sum %.0f\n"
+             "lora_bridge_noise_rssi_dbm_count %lu\n",
+             (unsigned long)cumulative, sum, (unsigned long)cumulative);
+    out += line;
+
+    out += F("# HELP lora_bridge_snr_margin_db Received frames' SNR over the demodulation limit\n"
+             "# TYPE lora_bridge_snr_margin_db histogram\n");
+    cumulative = 0;
+    for (int i = 0; i < NOISE_MARGIN_BINS - 1; i++) {
+        cumulative += snap.margin[i];
+        snprintf(line, sizeof(line), "lora_bridge_snr_margin_db_bucket{le=\"%g\"} %lu\n",
+                 noise_margin_edges[i], (unsigned long)cumulative);
+        out += line;
+    }
+    cumulative += snap.margin[NOISE_MARGIN_BINS - 1];
+    snprintf(line, sizeof(line),
+             "lora_bridge_snr_margin_db_bucket{le=\"+Inf\"} %lu\n"
+             "lora_bridge_snr_margin_db_sum %.1f\n"
+             "lora_bridge_snr_margin_db_count %lu\n",
+             (unsigned long)cumulative, s.margin_sum_db, (unsigned long)s.frames);
+    out += line;
+}
@@ -0,0 +1,345 @@
+/*
+ * Pipeline.cpp - Packet Ingest / Fan-Out Pipeline Implementation
+ */
+
+#include "core/Pipeline.h"
+#include "core/SpscQueue.h"
+#include "core/FixedString.h"
+#include "core/HeapProfiler.h"
+#include "core/Scheduler.h"
+#include "core/Log.h"
+#include "core/Clock.h"
+#include "data/ActivityLog.h"
+#include "data/Journal.h"
+#include "data/Settings.h"
+#include "hardware/Display.h"
+#include "hardware/LoRaModule.h"
+#include "homekit/DeviceManagement.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// ============== Pipeline State ==============
+bool dual_core = false;
+uint8_t pipeline_policy = PIPELINE_DROP_NEWEST;
+PipelineStats pipeline_stats;
+PipelineRun pipeline_run;
+CpuLoad ingest_load;
+
+static SpscQueue<PipelineEvent, PIPELINE_QUEUE_DEPTH> fanout_queue;
+static TaskHandle_t ingest_task = nullptr;
+
+// Generator state, owned by the ingest stage
+static uint32_t run_start_us = 0;
+static int run_next_device = 0;
+
+static const char* const policy_names[PIPELINE_POLICY_COUNT] = {
+    "drop_newest", "block"
+};
+
+const char* getPipelinePolicyName(uint8_t policy) {
+    return policy < PIPELINE_POLICY_COUNT ? policy_names[policy] : "unknown";
+}
+
+// ============== Fan-Out Stage ==============
+static const char* getRejectMessage(uint8_t reason) {
+    switch (reason) {
+        case JOURNAL_REJECT_BAD_JSON: return "ERR: Bad JSON";
+        case JOURNAL_REJECT_WRONG_KEY: return "ERR: Wrong key";
+        case JOURNAL_REJECT_NO_ID: return "ERR: No device ID";
+        default: return "ERR: Rejected";
+    }
+}
+
+static void fanOut(const PipelineEvent& ev) {
+    uint32_t start = clockMicros();
+    const DeviceReading& r = ev.reading;
+
+    // Wake OLED on activity
+    if (!r.synthetic) wakeOled();
+
+    if (ev.kind == PIPELINE_EVENT_REJECTED) {
+        last_event = getRejectMessage(ev.reject_reason);
+        journalLogEvent(JOURNAL_REJECTED, r.id, ev.reject_reason);
+    } else {
+        // Registration happens here, not in ingest: it touches HomeKit,
+        // NVS and MQTT, which all belong to loop()
+        Device* dev = findDevice(r.id);
+        if (!dev) {
+            dev = registerDevice(r);
+        }
+        if (dev) {
+            if (!ev.applied) applyReading(dev, r);
+            publishReading(dev, r);
+        }
+    }
+
+    uint32_t end = clockMicros();
+    uint32_t latency = end - ev.ingest_us;
+    pipeline_stats.fanned_out++;
+    pipeline_stats.fanout_us += end - start;
+    if (latency > pipeline_stats.max_latency_us) pipeline_stats.max_latency_us = latency;
+
+    if (r.synthetic) {
+        pipeline_run.delivered++;
+        pipeline_run.last_delivery_ms = clockMillis();
+        if (latency > pipeline_run.max_latency_us) pipeline_run.max_latency_us = latency;
+    }
+}
+
+static void reportRun() {
+    PipelineRun& run = pipeline_run;
+    if (run.reported || run.running || run.generated == 0) return;
+    if (run.delivered + run.dropped < run.generated) return;   // Still in the queue
+
+    uint32_t offered = run.generated + run.overrun;
+    uint32_t elapsed_ms = run.last_delivery_ms - run.started_ms;
+    LOG_INFO("[PIPE] Synthetic load (%s, %u/s for %u s): %lu offered, %lu delivered, "
+             "%lu lost (%lu overrun, %lu dropped), %.1f/s, max latency %lu us",
+             run.dual_core ? "dual-core" : "single-core", run.rate_hz, run.seconds,
+             (unsigned long)offered, (unsigned long)run.delivered,
+             (unsigned long)(offered - run.delivered), (unsigned long)run.overrun,
+             (unsigned long)run.dropped,
+             elapsed_ms ? run.delivered * 1000.0f / elapsed_ms : 0.0f,
+             (unsigned long)run.max_latency_us);
+    run.reported = true;
+}
+
+// ============== Ingest Stage ==============
+static void dropEvent(const PipelineEvent& ev) {
+    pipeline_stats.dropped++;
+    if (ev.reading.synthetic) pipeline_run.dropped++;
+}
+
+void pipelineSubmit(PipelineEvent& ev) {
+    // Device state is updated at ingest so the table is current even when
+    // fan-out falls behind; new devices are registered by fan-out
+    if (ev.kind == PIPELINE_EVENT_READING) {
+        Device* dev = findDevice(ev.reading.id);
+        if (dev) {
+            applyReading(dev, ev.reading);
+            ev.applied = true;
+        }
+    }
+    pipeline_stats.ingested++;
+    pipeline_stats.ingest_us += clockElapsedUs(ev.ingest_us);
+
+    if (!ingest_task) {
+        fanOut(ev);
+        return;
+    }
+
+    if (!fanout_queue.push(ev)) {
+        if (pipeline_policy != PIPELINE_BLOCK) {
+            dropEvent(ev);
+            return;
+        }
+
+        pipeline_stats.blocked++;
+        uint32_t start = clockMillis();
+        while (!fanout_queue.push(ev)) {
+            if (clockElapsedMs(start) >= PIPELINE_BLOCK_MS) {
+                dropEvent(ev);
+                return;
+            }
+            vTaskDelay(1);
+        }
+    }
+
+    size_t depth = fanout_queue.size();
+    if (depth > pipeline_stats.high_water) pipeline_stats.high_water = depth;
+    schedulerWake();
+}
+
+static void ingestTask(void* arg) {
+    (void)arg;
+    LOG_INFO("[PIPE] Ingest task running on core %d", xPortGetCoreID());
+    cpuLoadBegin(ingest_load, "ingest");
+    startLoRaReceive();
+
+    for (;;) {
+        processLoRaPacket();
+        serviceLoRaRadio();
+        pipelineGeneratorTick();
+
+        // Block until the radio interrupt or the next timed radio event; a
+        // synthetic run needs every tick
+        uint32_t idle_ms = loraNextRadioEventMs();
+        if (idle_ms > PIPELINE_IDLE_MS) idle_ms = PIPELINE_IDLE_MS;
+        TickType_t ticks = pdMS_TO_TICKS(idle_ms);
+        if (pipeline_run.running || ticks == 0) ticks = 1;
+        uint32_t start = clockMicros();
+        ulTaskNotifyTake(pdTRUE, ticks);
+        cpuLoadAddIdle(ingest_load, clockElapsedUs(start));
+    }
+}
+
+// ============== Pipeline Functions ==============
+void pipelineBegin() {
+    if (ingest_task) return;
+    if (!dual_core) {
+        startLoRaReceive();    // Radio interrupt wakes loop()
+        return;
+    }
+
+    if (xTaskCreatePinnedToCore(ingestTask, "ingest", PIPELINE_TASK_STACK, nullptr,
+                                PIPELINE_TASK_PRIORITY, &ingest_task,
+                                PIPELINE_INGEST_CORE) != pdPASS) {
+        ingest_task = nullptr;
+        LOG_WARN("[PIPE] Failed to start ingest task - running single-core");
+        startLoRaReceive();
+        return;
+    }
+    LOG_INFO("[PIPE] Dual-core mode: ingest on core %d, fan-out in loop(), queue %d, %s",
+             PIPELINE_INGEST_CORE, PIPELINE_QUEUE_DEPTH, getPipelinePolicyName(pipeline_policy));
+}
+
+bool pipelineIsDualCore() {
+    return ingest_task != nullptr;
+}
+
+void pipelineLoop() {
+    if (!ingest_task) {
+        processLoRaPacket();
+        serviceLoRaRadio();
+        pipelineGeneratorTick();
+    } else {
+        PipelineEvent ev;
+        for (uint8_t i = 0; i < PIPELINE_DRAIN_MAX && fanout_queue.pop(ev); i++) {
+            // Everything until the end of the iteration is charged to this packet
+            HeapReportScope heapReport(HEAP_REPORT_PACKET,
+                                       ev.kind == PIPELINE_EVENT_READING ? ev.reading.id : "(invalid)");
+            HeapScope heapScope(HEAP_SUBSYS_LORA);
+            fanOut(ev);
+        }
+    }
+    reportRun();
+}
+
+size_t pipelineQueueDepth() {
+    return fanout_queue.size();
+}
+
+void pipelineResetStats() {
+    memset(&pipeline_stats, 0, sizeof(pipeline_stats));
+    LOG_INFO("[PIPE] Statistics reset");
+}
+
+// ============== Synthetic Load ==============
+bool pipelineStartRun(uint16_t rate_hz, uint16_t seconds) {
+    if (pipeline_run.running || getActiveDeviceCount() == 0) return false;
+
+    PipelineRun& run = pipeline_run;
+    memset(&run, 0, sizeof(run));
+    run.dual_core = ingest_task != nullptr;
+    run.rate_hz = constrain(rate_hz, 1, PIPELINE_GEN_MAX_RATE);
+    run.seconds = constrain(seconds, 1, PIPELINE_GEN_MAX_SECONDS);
+    run.started_ms = clockMillis();
+    run_start_us = clockMicros();
+
+    LOG_INFO("[PIPE] Synthetic load: %u packets/s for %u s (%s)",
+             run.rate_hz, run.seconds, run.dual_core ? "dual-core" : "single-core");
+    run.running = true;   // Last: the ingest task may pick it up immediately
+    if (ingest_task) xTaskNotifyGive(ingest_task);
+    return true;
+}
+
+static Device* nextSyntheticDevice() {
+    for (int n = 0; n < device_count; n++) {
+        int i = (run_next_device + n) % device_count;
+        if (devices[i].active) {
+            run_next_device = i + 1;
+            return &devices[i];
+        }
+    }
+    return nullptr;
+}
+
+void pipelineGeneratorTick() {
+    PipelineRun& run = pipeline_run;
+    if (!run.running) return;
+
+    uint32_t elapsed_us = clockElapsedUs(run_start_us);
+    if (elapsed_us >= run.seconds * 1000000UL) {
+        run.running = false;
+        return;
+    }
+
+    // Packet k is due at k / rate. A radio holds one packet, so anything
+    // that came due beyond that while ingest was busy would have been lost.
+    uint32_t due = (uint32_t)((uint64_t)elapsed_us * run.rate_hz / 1000000ULL) + 1;
+    uint32_t sent = run.generated + run.overrun;
+    if (due <= sent) return;
+    run.overrun += due - sent - 1;
+
+    Device* dev = nextSyntheticDevice();
+    if (!dev) {
+        run.running = false;
+        return;
+    }
+
+    // Current values, so HomeKit and MQTT see no spurious changes
+    FixedString<192> packet;
+    packet.appendf("{\"k\":\"%s\",\"id\":\"%s\"", gateway_key, dev->id);
+    if (dev->has_temp) packet.appendf(",\"t\":%.1f", dev->temperature);
+    if (dev->has_hum) packet.appendf(",\"hu\":%.0f", dev->humidity);
+    if (dev->has_batt) packet.appendf(",\"b\":%d", dev->battery);
+    if (dev->has_light) packet.appendf(",\"l\":%d", dev->lux);
+    if (dev->has_motion) packet.appendf(",\"m\":%d", dev->motion);
+    if (dev->has_contact) packet.appendf(",\"c\":%d", dev->contact);
+    packet.append("}");
+
+    uint8_t buffer[256];
+    memcpy(buffer, packet.c_str(), packet.length() + 1);
+    run.generated++;
+    ingestPacket(buffer, packet.length(), dev->rssi, true);
+}
+
+// ============== Metrics ==============
+void appendPipelineMetrics(String& out) {
+    char line[160];
+
+    out += F("# HELP lora_bridge_pipeline_events_total Events through each pipeline stage\n"
+             "# TYPE lora_bridge_pipeline_events_total counter\n");
+    snprintf(line, sizeof(line), "lora_bridge_pipeline_events_total{stage=\"ingest\"} %lu\n",
+             (unsigned long)pipeline_stats.ingested);
+    out += line;
+    snprintf(line, sizeof(line), "lora_bridge_pipeline_events_total{stage=\"fanout\"} %lu\n",
+             (unsigned long)pipeline_stats.fanned_out);
+    out += line;
+
+    out += F("# HELP lora_bridge_pipeline_stage_microseconds_total Time spent in each pipeline stage\n"
+             "# TYPE lora_bridge_pipeline_stage_microseconds_total counter\n");
+    snprintf(line, sizeof(line), "lora_bridge_pipeline_stage_microseconds_total{stage=\"ingest\"} %llu\n",
+             (unsigned long long)pipeline_stats.ingest_us);
+    out += line;
+    snprintf(line, sizeof(line), "lora_bridge_pipeline_stage_microseconds_total{stage=\"fanout\"} %llu\n",
+             (unsigned long long)pipeline_stats.fanout_us);
+    out += line;
+
+    out += F("# TYPE lora_bridge_pipeline_dropped_total counter\n");
+    snprintf(line, sizeof(line), "lora_bridge_pipeline_dropped_total %lu\n",
+             (unsigned long)pipeline_stats.dropped);
+    out += line;
+    out += F("# TYPE lora_bridge_pipeline_blocked_total counter\n");
+    snprintf(line, sizeof(line), "lora_bridge_pipeline_blocked_total %lu\n",
+             (unsigned long)pipeline_stats.blocked);
+    out += line;
+    out += F("# TYPE lora_bridge_pipeline_queue_depth gauge\n");
+    snprintf(line, sizeof(line), "lora_bridge_pipeline_queue_depth %u\n", (unsigned)fanout_queue.size());
+    out += line;
+    out += F("# TYPE lora_bridge_pipeline_queue_high_water gauge\n");
+    snprintf(line, sizeof(line), "lora_bridge_pipeline_queue_high_water %lu\n",
+             (unsigned long)pipeline_stats.high_water);
+    out += line;
+    out += F("# TYPE lora_bridge_pipeline_max_latency_microseconds gauge\n");
+    snprintf(line, sizeof(line), "lora_bridge_pipeline_max_latency_microseconds %lu\n",
+             (unsigned long)pipeline_stats.max_latency_us);
+    out += line;
+    out += F("# TYPE lora_bridge_pipeline_dual_core gauge\n");
+    snprintf(line, sizeof(line), "lora_bridge_pipeline_dual_core %d\n", ingest_task != nullptr);
+    out += line;
+    out += F("# TYPE lora_bridge_device_snapshot_retries_total counter\n");
+    snprintf(line, sizeof(line), "lora_bridge_device_snapshot_retries_total %lu\n",
+             (unsigned long)device_snapshot_retries);
+    out += line;
+}
@@ -0,0 +1,267 @@
+/*
+ * RxScheduler.cpp - Multi-Profile Receive Scheduler Implementation
+ */
+
+#include "hardware/RxScheduler.h"
+#include "hardware/LoRaModule.h"
+#include "data/Settings.h"
+#include "core/Clock.h"
+#include "core/Log.h"
+#include <freertos/FreeRTOS.h>
+
+RxProfile rx_profiles[RX_PROFILES_MAX];
+uint8_t rx_profile_count = 1;
+char rx_profiles_text[RX_PROFILES_TEXT_LEN] = "";
+
+// Everything below is written by the radio task; the snapshot brings the
+// listening totals up to date, so it takes the lock as well
+static portMUX_TYPE rx_sched_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static RxProfileStats profile_stats[RX_PROFILES_MAX];
+static RxSchedStats sched_stats;
+
+static float heard_w[RX_PROFILES_MAX];    // Frames, decayed over RX_SCHED_MEMORY_MS
+static float usable_w[RX_PROFILES_MAX];   // Usable milliseconds, decayed alike
+
+static uint8_t planned = RX_PROFILE_MAIN; // Dwell in progress
+static uint32_t dwell_end_ms = 0;
+static uint32_t cycle_start_ms = 0;
+
+static uint8_t on_profile = RX_PROFILE_NONE;   // Where the receiver actually is
+static uint32_t usable_from_ms = 0;       // A frame started before this was lost
+static uint32_t last_flush_ms = 0;
+
+// ============== Profiles ==============
+static const uint32_t profile_bandwidths[] = {125000, 250000, 500000};
+
+bool rxSchedParseProfiles(const char* text, RxProfile* out, uint8_t max, uint8_t& count) {
+    RxProfile parsed[RX_PROFILES_MAX];
+    uint8_t n = 0;
+    const char* p = text;
+
+    while (*p) {
+        while (*p == ' ' || *p == ';') p++;
+        if (!*p) break;
+        float mhz;
+        unsigned sf, khz, sync;
+        int used = 0;
+        if (n >= max || n >= RX_PROFILES_MAX ||
+            sscanf(p, "%f/%u/%u/%x%n", &mhz, &sf, &khz, &sync, &used) != 4) {
+            return false;
+        }
+        bool bw_ok = false;
+        for (uint32_t bw : profile_bandwidths) bw_ok |= bw == khz * 1000;
+        // Written so that NaN fails too
+        if (!(mhz >= 137.0f && mhz <= 1020.0f) || sf < 6 || sf > 12 || !bw_ok || sync > 0xFF) return false;
+        parsed[n++] = {mhz, (uint8_t)sf, khz * 1000, (uint8_t)sync};
+
+        p += used;
+        while (*p == ' ') p++;
+        if (*p && *p != ';') return false;
+    }
+
+    memcpy(out, parsed, n * sizeof(RxProfile));
+    count = n;
+    return true;
+}
+
+// Time on air of this profile's typical frame, rounded up
+static uint32_t frameMs(uint8_t profile) {
+    const RxProfile& p = rx_profiles[profile];
+    return loraTimeOnAirUs(profile_stats[profile].frame_len, p.sf, p.bw, lora_cr, lora_preamble) / 1000 + 1;
+}
+
+// ============== Accounting ==============
+// Charge the time since the last flush to the profile the receiver is on
+static void flushLocked(uint32_t now) {
+    uint32_t elapsed = now - last_flush_ms;
+    sched_stats.elapsed_ms += elapsed;
+
+    if (on_profile < rx_profile_count) {
+        RxProfileStats& p = profile_stats[on_profile];
+        p.listen_ms += elapsed;
+        uint32_t from = clockReached(usable_from_ms, last_flush_ms) ? last_flush_ms : usable_from_ms;
+        if (clockReached(from, now)) {
+            p.usable_ms += now - from;
+            usable_w[on_profile] += now - from;
+        }
+    }
+    last_flush_ms = now;
+}
+
+// Start of a cycle: traffic rates from the decayed counts, then the dwells
+static void planLocked(uint32_t now) {
+    flushLocked(now);
+    uint32_t cycle_ms = now - cycle_start_ms;
+    cycle_start_ms = now;
+    sched_stats.cycles++;
+
+    float keep = cycle_ms >= RX_SCHED_MEMORY_MS ? 0.0f : 1.0f - (float)cycle_ms / RX_SCHED_MEMORY_MS;
+    float total = 0;
+    for (uint8_t i = 0; i < rx_profile_count; i++) {
+        RxProfileStats& p = profile_stats[i];
+        p.rate_per_h = usable_w[i] > 0 ? heard_w[i] * 3600000.0f / usable_w[i] : 0;
+        total += p.rate_per_h;
+        heard_w[i] *= keep;
+        usable_w[i] *= keep;
+    }
+
+    float spare = 1.0f - rx_profile_count * RX_SCHED_FLOOR_PCT / 100.0f;
+    for (uint8_t i = 0; i < rx_profile_count; i++) {
+        RxProfileStats& p = profile_stats[i];
+        float share = RX_SCHED_FLOOR_PCT / 100.0f +
+                      spare * (total > 0 ? p.rate_per_h / total : 1.0f / rx_profile_count);
+        uint32_t dwell = (uint32_t)(share * RX_SCHED_CYCLE_MS);
+        uint32_t least = RX_SCHED_MIN_FRAMES * frameMs(i);
+        p.dwell_ms = dwell > least ? dwell : least;
+    }
+}
+
+// ============== Scheduler Functions ==============
+void rxSchedBegin() {
+    rx_profiles[RX_PROFILE_MAIN] = {lora_frequency, lora_sf, lora_bw, lora_syncword};
+    uint8_t extra = 0;
+    if (!rxSchedParseProfiles(rx_profiles_text, &rx_profiles[1], RX_PROFILES_MAX - 1, extra)) {
+        LOG_WARN("[RXS] Ignoring receive profiles \"%s\"", rx_profiles_text);
+        extra = 0;
+    }
+
+    uint32_t now = clockMillis();
+    portENTER_CRITICAL(&rx_sched_lock);
+    rx_profile_count = 1 + extra;
+    memset(profile_stats, 0, sizeof(profile_stats));
+    memset(&sched_stats, 0, sizeof(sched_stats));
+    for (uint8_t i = 0; i < RX_PROFILES_MAX; i++) {
+        profile_stats[i].frame_len = RX_SCHED_DEFAULT_LEN;
+        heard_w[i] = 0;
+        usable_w[i] = 0;
+    }
+    cycle_start_ms = now;
+    last_flush_ms = now;
+    planLocked(now);
+    sched_stats.cycles = 0;
+
+    planned = RX_PROFILE_MAIN;
+    dwell_end_ms = now + profile_stats[planned].dwell_ms;
+    profile_stats[planned].dwells++;
+    on_profile = RX_PROFILE_MAIN;          // initLoRa() set it up
+    usable_from_ms = now;
+    portEXIT_CRITICAL(&rx_sched_lock);
+
+    for (uint8_t i = 1; i < rx_profile_count; i++) {
+        const RxProfile& p = rx_profiles[i];
+        LOG_INFO("[RXS] Profile %u: %.3f MHz, SF%u, BW:%lukHz, Sync:0x%02X", i, p.frequency, p.sf,
+                 (unsigned long)(p.bw / 1000), p.syncword);
+    }
+}
+
+uint8_t rxSchedProfile() {
+    if (rx_profile_count < 2) return RX_PROFILE_MAIN;
+    uint32_t now = clockMillis();
+    if (!clockReached(dwell_end_ms, now)) return planned;
+
+    portENTER_CRITICAL(&rx_sched_lock);
+    planned = (planned + 1) % rx_profile_count;
+    if (planned == RX_PROFILE_MAIN) planLocked(now);
+    dwell_end_ms = now + profile_stats[planned].dwell_ms;
+    profile_stats[planned].dwells++;
+    portEXIT_CRITICAL(&rx_sched_lock);
+    return planned;
+}
+
+uint32_t rxSchedNextSwitchMs() {
+    if (rx_profile_count < 2) return UINT32_MAX;
+    uint32_t now = clockMillis();
+    return clockReached(dwell_end_ms, now) ? 0 : dwell_end_ms - now;
+}
+
+void rxSchedOnProfile(uint8_t profile, uint32_t switch_us) {
+    uint32_t now = clockMillis();
+    portENTER_CRITICAL(&rx_sched_lock);
+    flushLocked(now);
+    on_profile = profile;
+    if (profile < rx_profile_count) usable_from_ms = now + frameMs(profile);
+    sched_stats.switches++;
+    sched_stats.switch_us += switch_us;
+    if (switch_us > sched_stats.switch_max_us) sched_stats.switch_max_us = switch_us;
+    portEXIT_CRITICAL(&rx_sched_lock);
+}
+
+void rxSchedDeferred() {
+    portENTER_CRITICAL(&rx_sched_lock);
+    sched_stats.deferred++;
+    portEXIT_CRITICAL(&rx_sched_lock);
+}
+
+void rxSchedRecordFrame(uint8_t profile, int len) {
+    if (profile >= rx_profile_count) return;
+    portENTER_CRITICAL(&rx_sched_lock);
+    RxProfileStats& p = profile_stats[profile];
+    p.frames++;
+    p.frame_len = (uint16_t)((7 * p.frame_len + len) / 8);
+    heard_w[profile] += 1.0f;
+    portEXIT_CRITICAL(&rx_sched_lock);
+}
+
+// ============== Reporting ==============
+uint8_t rxSchedSnapshot(RxProfileStats* out, RxSchedStats& stats) {
+    uint32_t now = clockMillis();
+    portENTER_CRITICAL(&rx_sched_lock);
+    flushLocked(now);
+    uint8_t n = rx_profile_count;
+    for (uint8_t i = 0; i < n; i++) {
+        RxProfileStats& p = profile_stats[i];
+        double sent = p.usable_ms ? (double)p.frames * sched_stats.elapsed_ms / p.usable_ms : p.frames;
+        p.missed = (uint32_t)(sent - p.frames + 0.5);
+        out[i] = p;
+    }
+    stats = sched_stats;
+    portEXIT_CRITICAL(&rx_sched_lock);
+    return n;
+}
+
+void appendRxSchedMetrics(String& out) {
+    RxProfileStats p[RX_PROFILES_MAX];
+    RxSchedStats s;
+    uint8_t n = rxSchedSnapshot(p, s);
+
+    char line[512];
+    snprintf(line, sizeof(line),
+             "# TYPE lora_bridge_rx_switches_total counter\n"
+             "lora_bridge_rx_switches_total %lu\n"
+             "# TYPE lora_bridge_rx_switch_seconds_total counter\n"
+             "lora_bridge_rx_switch_seconds_total %.6f\n"
+             "# TYPE lora_bridge_rx_switch_seconds_max gauge\n"
+             "lora_bridge_rx_switch_seconds_max %.6f\n"
+             "# HELP lora_bridge_rx_switches_deferred_total Switches held back by a frame being read\n"
+             "# TYPE lora_bridge_rx_switches_deferred_total counter\n"
+             "lora_bridge_rx_switches_deferred_total %lu\n",
+             (unsigned long)s.switches, s.switch_us / 1e6, s.switch_max_us / 1e6, (unsigned long)s.deferred);
+    out += line;
+
+    out += "# TYPE lora_bridge_rx_profile_frames_total counter\n";
+    for (uint8_t i = 0; i < n; i++) {
+        snprintf(line, sizeof(line), "lora_bridge_rx_profile_frames_total{profile=\"%u\"} %lu\n", i,
+                 (unsigned long)p[i].frames);
+        out += line;
+    }
+    out += "# TYPE lora_bridge_rx_profile_listen_seconds_total counter\n";
+    for (uint8_t i = 0; i < n; i++) {
+        snprintf(line, sizeof(line), "lora_bridge_rx_profile_listen_seconds_total{profile=\"%u\"} %.3f\n", i,
+                 p[i].listen_ms / 1e3);
+        out += line;
+    }
+    out += "# TYPE lora_bridge_rx_profile_dwell_seconds gauge\n";
+    for (uint8_t i = 0; i < n; i++) {
+        snprintf(line, sizeof(line), "lora_bridge_rx_profile_dwell_seconds{profile=\"%u\"} %.3f\n", i,
+                 p[i].dwell_ms / 1e3);
+        out += line;
+    }
+    out += "# HELP lora_bridge_rx_profile_missed_frames Frames estimated sent while the profile was not heard\n"
+           "# TYPE lora_bridge_rx_profile_missed_frames gauge\n";
+    for (uint8_t i = 0; i < n; i++) {
+        snprintf(line, sizeof(line), "lora_bridge_rx_profile_missed_frames{profile=\"%u\"} %lu\n", i,
+                 (unsigned long)p[i].missed);
+        out += line;
+    }
+}
@@ -0,0 +1,313 @@
+/*
+ * Scheduler.cpp - Cooperative Timer Scheduler Implementation
+ */
+
+#include "core/Scheduler.h"
+#include "core/Clock.h"
+#include "core/Log.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// ============== Scheduler State ==============
+SchedulerJob scheduler_jobs[SCHEDULER_MAX_JOBS];
+SchedulerIdleStats scheduler_idle;
+CpuLoad loop_load;
+CpuLoad* cpu_loads[CPU_LOAD_MAX_TASKS];
+uint8_t cpu_load_count = 0;
+
+static TaskHandle_t loop_task = nullptr;
+static volatile uint32_t active_until_ms = 0;
+
+static const char* const catchup_names[SCHED_CATCHUP_COUNT] = {
+    "skip", "burst", "delay"
+};
+
+const char* getSchedulerCatchUpName(uint8_t catchup) {
+    return catchup < SCHED_CATCHUP_COUNT ? catchup_names[catchup] : "unknown";
+}
+
+// ============== Helpers ==============
+static bool isDue(const SchedulerJob& job, uint32_t now) {
+    return clockReached(job.due_ms, now);
+}
+
+static int findJob(const char* name) {
+    for (int i = 0; i < SCHEDULER_MAX_JOBS; i++) {
+        if (scheduler_jobs[i].active && strcmp(scheduler_jobs[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+static int addJob(const char* name, uint32_t period_ms, uint32_t delay_ms, SchedulerJobFn fn,
+                  SchedulerCatchUp catchup, uint32_t budget_us) {
+    for (int i = 0; i < SCHEDULER_MAX_JOBS; i++) {
+        SchedulerJob& job = scheduler_jobs[i];
+        if (job.active) continue;
+
+        memset(&job, 0, sizeof(job));
+        job.name = name;
+        job.fn = fn;
+        job.period_ms = period_ms;
+        job.due_ms = clockMillis() + delay_ms;
+        job.budget_us = budget_us;
+        job.catchup = catchup;
+        job.active = true;
+        return i;
+    }
+    LOG_ERROR("[SCHED] Cannot add %s - job table full", name);
+    return -1;
+}
+
+// Set the next deadline of a periodic job after a run that started late
+static void reschedule(SchedulerJob& job, uint32_t now) {
+    uint32_t behind = now - job.due_ms;          // Time past the deadline just served
+    uint32_t missed = behind / job.period_ms;    // Whole periods that went by as well
+
+    if (job.catchup == SCHED_CATCHUP_DELAY) {
+        job.due_ms = clockMillis() + job.period_ms;
+    } else if (job.catchup == SCHED_CATCHUP_BURST && missed <= SCHEDULER_MAX_BURST) {
+        job.due_ms += job.period_ms;
+    } else {
+        // SKIP, or a BURST job too far behind to catch up: keep the phase
+        job.due_ms += (missed + 1) * job.period_ms;
+        job.stats.skipped += missed;
+    }
+}
+
+static void runJob(SchedulerJob& job, uint32_t now) {
+    uint32_t late_ms = now - job.due_ms;
+    job.stats.runs++;
+    job.stats.total_late_ms += late_ms;
+    if (late_ms > job.stats.max_late_ms) job.stats.max_late_ms = late_ms;
+    if (late_ms > SCHEDULER_LATE_MS) job.stats.late++;
+
+    // One-shots free their slot first so fn() can re-arm itself
+    if (job.period_ms == 0) job.active = false;
+
+    uint32_t start = clockMicros();
+    job.fn();
+    uint32_t elapsed = clockElapsedUs(start);
+
+    job.stats.total_us += elapsed;
+    if (elapsed > job.stats.max_us) job.stats.max_us = elapsed;
+    if (job.budget_us && elapsed > job.budget_us) job.stats.over_budget++;
+
+    if (job.period_ms) reschedule(job, now);
+}
+
+// ============== Scheduler Functions ==============
+void schedulerBegin() {
+    loop_task = xTaskGetCurrentTaskHandle();
+    cpuLoadBegin(loop_load, "loop");
+}
+
+int schedulerEvery(const char* name, uint32_t period_ms, SchedulerJobFn fn,
+                   SchedulerCatchUp catchup, uint32_t budget_us) {
+    int id = findJob(name);
+    if (id >= 0) return id;
+    if (period_ms == 0) return -1;
+    return addJob(name, period_ms, period_ms, fn, catchup, budget_us);
+}
+
+int schedulerAfter(const char* name, uint32_t delay_ms, SchedulerJobFn fn, uint32_t budget_us) {
+    int id = findJob(name);
+    if (id >= 0 && scheduler_jobs[id].period_ms == 0) {
+        scheduler_jobs[id].due_ms = clockMillis() + delay_ms;
+        return id;
+    }
+    if (id >= 0) return -1;                      // Name taken by a periodic job
+    return addJob(name, 0, delay_ms, fn, SCHED_CATCHUP_SKIP, budget_us);
+}
+
+void schedulerCancel(int id) {
+    if (id >= 0 && id < SCHEDULER_MAX_JOBS) {
+        scheduler_jobs[id].active = false;
+    }
+}
+
+void schedulerTrigger(int id) {
+    if (id >= 0 && id < SCHEDULER_MAX_JOBS && scheduler_jobs[id].active) {
+        scheduler_jobs[id].due_ms = clockMillis();
+    }
+}
+
+void schedulerRun() {
+    uint32_t pass_start = clockMicros();
+    bool ran = false;
+
+    for (;;) {
+        uint32_t now = clockMillis();
+
+        // Earliest due job first
+        int next = -1;
+        for (int i = 0; i < SCHEDULER_MAX_JOBS; i++) {
+            const SchedulerJob& job = scheduler_jobs[i];
+            if (!job.active || !isDue(job, now)) continue;
+            if (next < 0 || (int32_t)(job.due_ms - scheduler_jobs[next].due_ms) < 0) next = i;
+        }
+        if (next < 0) return;
+
+        // Always make progress, then stop once the pass is over budget
+        if (ran && clockElapsedUs(pass_start) > SCHEDULER_PASS_BUDGET_US) {
+            for (int i = 0; i < SCHEDULER_MAX_JOBS; i++) {
+                if (scheduler_jobs[i].active && isDue(scheduler_jobs[i], now)) {
+                    scheduler_jobs[i].stats.deferred++;
+                }
+            }
+            return;
+        }
+
+        runJob(scheduler_jobs[next], now);
+        ran = true;
+    }
+}
+
+uint32_t schedulerNextDueMs() {
+    uint32_t now = clockMillis();
+    uint32_t wait = UINT32_MAX;
+    for (int i = 0; i < SCHEDULER_MAX_JOBS; i++) {
+        const SchedulerJob& job = scheduler_jobs[i];
+        if (!job.active) continue;
+        if (isDue(job, now)) return 0;
+        if (job.due_ms - now < wait) wait = job.due_ms - now;
+    }
+    return wait;
+}
+
+void schedulerIdle(bool work_pending) {
+    bool net_active = !clockReached(active_until_ms, clockMillis());
+
+    uint32_t wait = 1;
+    if (work_pending || net_active) {
+        scheduler_idle.short_polls++;
+    } else {
+        wait = schedulerNextDueMs();
+        if (wait > SCHEDULER_NET_POLL_MS) wait = SCHEDULER_NET_POLL_MS;
+    }
+
+    // Always give up at least one tick (watchdog, idle task)
+    TickType_t ticks = pdMS_TO_TICKS(wait);
+    if (ticks == 0) ticks = 1;
+
+    uint32_t start = clockMicros();
+    bool woken = false;
+    if (loop_task) {
+        woken = ulTaskNotifyTake(pdTRUE, ticks) > 0;
+    } else {
+        vTaskDelay(ticks);
+    }
+
+    scheduler_idle.sleeps++;
+    if (woken) scheduler_idle.woken++;
+    cpuLoadAddIdle(loop_load, clockElapsedUs(start));
+}
+
+void schedulerWake() {
+    if (loop_task) xTaskNotifyGive(loop_task);
+}
+
+void schedulerNoteActivity() {
+    active_until_ms = clockMillis() + SCHEDULER_ACTIVE_HOLD_MS;
+}
+
+// ============== CPU Load ==============
+void cpuLoadBegin(CpuLoad& load, const char* task) {
+    memset(&load, 0, sizeof(load));
+    load.task = task;
+    load.window_start_ms = clockMillis();
+
+    for (uint8_t i = 0; i < cpu_load_count; i++) {
+        if (cpu_loads[i] == &load) return;
+    }
+    if (cpu_load_count < CPU_LOAD_MAX_TASKS) {
+        cpu_loads[cpu_load_count++] = &load;
+    }
+}
+
+void cpuLoadAddIdle(CpuLoad& load, uint32_t idle_us) {
+    load.idle_us += idle_us;
+    load.window_idle_us += idle_us;
+
+    uint32_t elapsed_ms = clockElapsedMs(load.window_start_ms);
+    if (elapsed_ms < CPU_LOAD_WINDOW_MS) return;
+
+    uint32_t idle_ms = load.window_idle_us / 1000;
+    if (idle_ms > elapsed_ms) idle_ms = elapsed_ms;
+    load.busy_pct = (uint8_t)(100 * (elapsed_ms - idle_ms) / elapsed_ms);
+    if (load.busy_pct > load.peak_pct) load.peak_pct = load.busy_pct;
+
+    load.window_start_ms = clockMillis();
+    load.window_idle_us = 0;
+}
+
+void schedulerResetStats() {
+    for (int i = 0; i < SCHEDULER_MAX_JOBS; i++) {
+        memset(&scheduler_jobs[i].stats, 0, sizeof(SchedulerJobStats));
+    }
+    memset(&scheduler_idle, 0, sizeof(scheduler_idle));
+    for (uint8_t i = 0; i < cpu_load_count; i++) {
+        cpu_loads[i]->peak_pct = 0;
+    }
+    LOG_INFO("[SCHED] Statistics reset");
+}
+
+// ============== Metrics ==============
+void appendSchedulerMetrics(String& out) {
+    char line[160];
+
+    out += F("# HELP lora_bridge_job_runs_total Scheduler job executions\n"
+             "# TYPE lora_bridge_job_runs_total counter\n");
+    for (int i = 0; i < SCHEDULER_MAX_JOBS; i++) {
+        const SchedulerJob& job = scheduler_jobs[i];
+        if (!job.active) continue;
+        snprintf(line, sizeof(line), "lora_bridge_job_runs_total{job=\"%s\"} %lu\n",
+                 job.name, (unsigned long)job.stats.runs);
+        out += line;
+    }
+
+    out += F("# HELP lora_bridge_job_late_total Runs started more than 50 ms after the deadline\n"
+             "# TYPE lora_bridge_job_late_total counter\n");
+    for (int i = 0; i < SCHEDULER_MAX_JOBS; i++) {
+        const SchedulerJob& job = scheduler_jobs[i];
+        if (!job.active) continue;
+        snprintf(line, sizeof(line), "lora_bridge_job_late_total{job=\"%s\"} %lu\n",
+                 job.name, (unsigned long)job.stats.late);
+        out += line;
+    }
+
+    out += F("# HELP lora_bridge_job_max_lateness_ms Longest delay past a deadline\n"
+             "# TYPE lora_bridge_job_max_lateness_ms gauge\n");
+    for (int i = 0; i < SCHEDULER_MAX_JOBS; i++) {
+        const SchedulerJob& job = scheduler_jobs[i];
+        if (!job.active) continue;
+        snprintf(line, sizeof(line), "lora_bridge_job_max_lateness_ms{job=\"%s\"} %lu\n",
+                 job.name, (unsigned long)job.stats.max_late_ms);
+        out += line;
+    }
+
+    out += F("# HELP lora_bridge_job_microseconds_total Time spent in each job\n"
+             "# TYPE lora_bridge_job_microseconds_total counter\n");
+    for (int i = 0; i < SCHEDULER_MAX_JOBS; i++) {
+        const SchedulerJob& job = scheduler_jobs[i];
+        if (!job.active) continue;
+        snprintf(line, sizeof(line), "lora_bridge_job_microseconds_total{job=\"%s\"} %llu\n",
+                 job.name, (unsigned long long)job.stats.total_us);
+        out += line;
+    }
+
+    out += F("# HELP lora_bridge_task_busy_percent CPU time used by each task (last second)\n"
+             "# TYPE lora_bridge_task_busy_percent gauge\n");
+    for (uint8_t i = 0; i < cpu_load_count; i++) {
+        snprintf(line, sizeof(line), "lora_bridge_task_busy_percent{task=\"%s\"} %u\n",
+                 cpu_loads[i]->task, cpu_loads[i]->busy_pct);
+        out += line;
+    }
+
+    out += F("# HELP lora_bridge_task_idle_microseconds_total Time each task spent blocked\n"
+             "# TYPE lora_bridge_task_idle_microseconds_total counter\n");
+    for (uint8_t i = 0; i < cpu_load_count; i++) {
+        snprintf(line, sizeof(line), "lora_bridge_task_idle_microseconds_total{task=\"%s\"} %llu\n",
+                 cpu_loads[i]->task, (unsigned long long)cpu_loads[i]->idle_us);
+        out += line;
+    }
+}
@@ -5,6 +5,13 @@
 #include "data/Settings.h"
 #include "data/Encryption.h"
 #include "hardware/Display.h"
+#include "core/LoopProfiler.h"
+#include "core/BootTimeline.h"
+#include "core/Pipeline.h"
+#include "data/Capture.h"
+#include "hardware/NoiseMonitor.h"
+#include "hardware/Adr.h"
+#include "hardware/RxScheduler.h"
 #include <esp_random.h>
 #include <mbedtls/sha256.h>
 
@@ -119,6 +126,7 @@ void loadSettings() {
   lora_cr = prefs.getUChar("lora_cr", DEFAULT_LORA_CR);
   lora_preamble = prefs.getUShort("lora_pre", DEFAULT_LORA_PREAMBLE);
   lora_syncword = prefs.getUChar("lora_sync", DEFAULT_LORA_SYNCWORD);
+  prefs.getString("rx_prof", rx_profiles_text, sizeof(rx_profiles_text));
 
   // Hardware settings
   power_led_enabled = prefs.getBool("pwr_led", true);
@@ -126,6 +134,15 @@ void loadSettings() {
   oled_enabled = prefs.getBool("oled_en", true);
   oled_brightness = prefs.getUChar("oled_br", 255);
   oled_timeout = prefs.getUShort("oled_to", 60);
+  loop_budget_ms = prefs.getUShort("loop_bud", DEFAULT_LOOP_BUDGET_MS);
+  fast_boot = prefs.getBool("fast_boot", false);
+  dual_core = prefs.getBool("dual_core", false);
+  pipeline_policy = prefs.getUChar("pipe_policy", PIPELINE_DROP_NEWEST);
+  capture_enabled = prefs.getBool("capture", false);
+  noise_sample_ms = prefs.getUShort("noise_ms", NOISE_SAMPLE_MS_DEFAULT);
+  adr_mode = prefs.getUChar("adr_mode", ADR_MODE_RECOMMEND);
+  if (adr_mode >= ADR_MODE_COUNT)
+    adr_mode = ADR_MODE_RECOMMEND;
 
   // HomeKit pairing code - generate if not exists
   if (prefs.isKey("hk_code")) {
@@ -192,12 +209,20 @@ void saveSettings() {
   prefs.putUChar("lora_cr", lora_cr);
   prefs.putUShort("lora_pre", lora_preamble);
   prefs.putUChar("lora_sync", lora_syncword);
+  prefs.putString("rx_prof", rx_profiles_text);
   // Hardware settings
   prefs.putBool("pwr_led", power_led_enabled);
   prefs.putBool("act_led", activity_led_enabled);
   prefs.putBool("oled_en", oled_enabled);
   prefs.putUChar("oled_br", oled_brightness);
   prefs.putUShort("oled_to", oled_timeout);
+  prefs.putUShort("loop_bud", loop_budget_ms);
+  prefs.putBool("fast_boot", fast_boot);
+  prefs.putBool("dual_core", dual_core);
+  prefs.putUChar("pipe_policy", pipeline_policy);
+  prefs.putBool("capture", capture_enabled);
+  prefs.putUShort("noise_ms", noise_sample_ms);
+  prefs.putUChar("adr_mode", adr_mode);
   // HTTP Authentication
   prefs.putBool("auth_en", auth_enabled);
   if (auth_enabled) {
@@ -300,6 +325,8 @@ void saveDevices() {
   Serial.printf("[DEVICES] Saved %d devices to NVS\n", saveIndex);
 }
 
+static void loadDeviceIntervals();
+
 void loadDevices() {
   prefs.begin(NVS_NAMESPACE, true);
 
@@ -334,5 +361,86 @@ void loadDevices() {
                   dev->name, dev->contact_type, dev->motion_type);
   }
 
+  loadDeviceIntervals();
+  prefs.end();
+}
+
+// ============== Learned Intervals ==============
+static uint32_t hashDeviceId(const char *id) {
+  uint32_t h = 2166136261u;
+  while (*id) {
+    h ^= (uint8_t)*id++;
+    h *= 16777619u;
+  }
+  return h;
+}
+
+// Called with prefs open
+static void loadDeviceIntervals() {
+  DeviceIntervalRecord records[MAX_DEVICES];
+  size_t n = prefs.getBytes("dev_ivl", records, sizeof(records)) /
+             sizeof(DeviceIntervalRecord);
+
+  int loaded = 0;
+  for (int i = 0; i < device_count; i++) {
+    Device *dev = &devices[i];
+    uint32_t h = hashDeviceId(dev->id);
+    for (size_t j = 0; j < n; j++) {
+      if (records[j].id_hash != h)
+        continue;
+      dev->interval.period_ms = records[j].period_ms;
+      dev->interval.jitter_ms = records[j].jitter_ds * 100UL;
+      dev->interval.samples = records[j].samples;
+      dev->interval_saved_ms = records[j].period_ms;
+      loaded++;
+      break;
+    }
+  }
+  if (loaded > 0) {
+    Serial.printf("[DEVICES] Loaded learned intervals for %d devices\n", loaded);
+  }
+}
+
+void saveDeviceIntervals() {
+  DeviceIntervalRecord records[MAX_DEVICES];
+  size_t n = 0;
+  bool changed = false;
+
+  for (int i = 0; i < device_count; i++) {
+    Device *dev = &devices[i];
+    if (!dev->active)
+      continue;
+    DeviceSnapshot snap;
+    snapshotDevice(dev, snap);
+    const DeviceInterval &iv = snap.interval;
+    if (iv.samples < DEVICE_INTERVAL_MIN_SAMPLES)
+      continue;
+
+    uint32_t saved = dev->interval_saved_ms;
+    uint32_t moved = iv.period_ms > saved ? iv.period_ms - saved : saved - iv.period_ms;
+    if (saved == 0 || moved > saved / 10)
+      changed = true;
+
+    DeviceIntervalRecord &rec = records[n++];
+    rec.id_hash = hashDeviceId(dev->id);
+    rec.period_ms = iv.period_ms;
+    rec.jitter_ds = (uint16_t)min(iv.jitter_ms / 100, (uint32_t)UINT16_MAX);
+    rec.samples = iv.samples;
+    rec.reserved = 0;
+  }
+  if (!changed)
+    return;
+
+  prefs.begin(NVS_NAMESPACE, false);
+  prefs.putBytes("dev_ivl", records, n * sizeof(DeviceIntervalRecord));
   prefs.end();
+
+  for (int i = 0; i < device_count; i++) {
+    Device *dev = &devices[i];
+    DeviceSnapshot snap;
+    snapshotDevice(dev, snap);
+    if (snap.interval.samples >= DEVICE_INTERVAL_MIN_SAMPLES)
+      dev->interval_saved_ms = snap.interval.period_ms;
+  }
+  Serial.printf("[DEVICES] Saved learned intervals for %u devices\n", (unsigned)n);
 }
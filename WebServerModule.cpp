@@ -6,10 +6,26 @@
 #include "network/WebServerModule.h"
 #include "core/Config.h"
 #include "core/Device.h"
+#include "core/LoopProfiler.h"
+#include "core/BootTimeline.h"
+#include "core/HeapProfiler.h"
+#include "core/Pipeline.h"
+#include "core/EventBus.h"
+#include "core/Scheduler.h"
+#include "core/Log.h"
+#include "core/Clock.h"
+#include "data/ActivityLog.h"
+#include "data/Capture.h"
 #include "data/Encryption.h"
+#include "data/Journal.h"
 #include "data/Settings.h"
+#include "hardware/Airtime.h"
 #include "hardware/Display.h"
 #include "hardware/LoRaModule.h"
+#include "hardware/NoiseMonitor.h"
+#include "hardware/Adr.h"
+#include "hardware/Downlink.h"
+#include "hardware/RxScheduler.h"
 #include "homekit/DeviceManagement.h"
 #include "network/MQTTModule.h"
 #include "network/WiFiModule.h"
@@ -19,35 +35,30 @@
 #include <mbedtls/base64.h>
 
 // External global variables
-extern unsigned long boot_time;
 extern uint32_t packets_received;
 extern int device_count;
 
-// ============== Activity Log ==============
-#define MAX_ACTIVITY_LOG 20
-
-struct ActivityEntry {
-  unsigned long timestamp;
-  char device_name[32];
-  char message[64];
-};
-
-ActivityEntry activityLog[MAX_ACTIVITY_LOG];
-int activityLogCount = 0;
-int activityLogIndex = 0; // Circular buffer index
+// Restart shortly after the response went out, without blocking loop()
+static void restartNow() {
+  logFlush();
+  ESP.restart();
+}
 
-void logActivity(const char *deviceName, const char *message) {
-  ActivityEntry *entry = &activityLog[activityLogIndex];
-  entry->timestamp = millis();
-  strncpy(entry->device_name, deviceName, 31);
-  entry->device_name[31] = 0;
-  strncpy(entry->message, message, 63);
-  entry->message[63] = 0;
+static void scheduleRestart(uint32_t delay_ms) {
+  schedulerAfter("restart", delay_ms, restartNow);
+}
 
-  activityLogIndex = (activityLogIndex + 1) % MAX_ACTIVITY_LOG;
-  if (activityLogCount < MAX_ACTIVITY_LOG) {
-    activityLogCount++;
+// Format a microsecond duration for display ("850 us", "12.4 ms", "1.83 s")
+static String formatMicros(uint32_t us) {
+  char buf[16];
+  if (us < 1000) {
+    snprintf(buf, sizeof(buf), "%lu us", (unsigned long)us);
+  } else if (us < 1000000) {
+    snprintf(buf, sizeof(buf), "%.1f ms", us / 1000.0);
+  } else {
+    snprintf(buf, sizeof(buf), "%.2f s", us / 1000000.0);
   }
+  return String(buf);
 }
 
 // ============== Authentication Middleware ==============
@@ -56,11 +67,11 @@ bool authenticateRequest() {
     return true; // Auth disabled, allow all
   }
 
-  Serial.println("[AUTH] Checking authentication...");
+  LOG_DEBUG("[AUTH] Checking authentication...");
 
   String authHeader = webServer.header("Authorization");
   if (authHeader.length() == 0 || !authHeader.startsWith("Basic ")) {
-    Serial.println("[AUTH] No valid Authorization header");
+    LOG_WARN("[AUTH] No valid Authorization header");
     return false;
   }
 
@@ -74,8 +85,8 @@ bool authenticateRequest() {
                                   authHeader.length());
 
   if (ret != 0 || decodedLen == 0) {
-    Serial.printf("[AUTH] Base64 decode failed: ret=%d, len=%d\n", ret,
-                  decodedLen);
+    LOG_WARN("[AUTH] Base64 decode failed: ret=%d, len=%u", ret,
+             (unsigned)decodedLen);
     return false; // Base64 decode failed
   }
 
@@ -85,24 +96,24 @@ bool authenticateRequest() {
   String credentials = String((char *)decoded);
   int colonIndex = credentials.indexOf(':');
   if (colonIndex <= 0) {
-    Serial.println("[AUTH] Invalid credentials format");
+    LOG_WARN("[AUTH] Invalid credentials format");
     return false;
   }
 
   String username = credentials.substring(0, colonIndex);
   String password = credentials.substring(colonIndex + 1);
 
-  Serial.printf("[AUTH] Username: %s (expected: %s)\n", username.c_str(),
-                auth_username);
+  LOG_DEBUG("[AUTH] Username: %s (expected: %s)", username.c_str(),
+            auth_username);
 
   // Verify credentials
   if (strcmp(username.c_str(), auth_username) != 0) {
-    Serial.println("[AUTH] Username mismatch");
+    LOG_WARN("[AUTH] Username mismatch");
     return false;
   }
 
   bool passValid = verifyPassword(password.c_str(), auth_password_hash);
-  Serial.printf("[AUTH] Password valid: %s\n", passValid ? "YES" : "NO");
+  LOG_INFO("[AUTH] Password valid: %s", passValid ? "YES" : "NO");
   return passValid;
 }
 
@@ -164,7 +175,7 @@ void handleRoot() {
   bool isPaired = homekit_started && (homeSpan.controllerListBegin() !=
                                       homeSpan.controllerListEnd());
   int activeDevices = getActiveDeviceCount();
-  unsigned long uptime = (millis() - boot_time) / 1000;
+  unsigned long uptime = clockUptimeSeconds();
   String uptimeStr =
       (uptime >= 3600)
           ? String(uptime / 3600) + "h " + String((uptime % 3600) / 60) + "m"
@@ -393,7 +404,360 @@ void handleRoot() {
         "class=\"status-label\">Uptime</span><span class=\"status-value\">");
   html += uptimeStr;
   html += F("</span></div>");
-  html += F("</div></div></div></div>");
+  html += F("</div></div></div>");
+
+  // Radio noise card
+  static NoiseSnapshot noise;    // Kept off the loop task stack
+  noiseSnapshot(noise);
+  html += F("<div class=\"card\"><div class=\"card-header\"><h3 "
+            "class=\"card-title\"><svg fill=\"none\" stroke=\"currentColor\" "
+            "stroke-width=\"2\" viewBox=\"0 0 24 24\"><path d=\"M2 12h3l3-8 4 "
+            "16 4-12 2 4h4\"/></svg>Radio Noise</h3>");
+  if (noise_sample_ms == 0)
+    html += F("<span class=\"badge warning\">Off</span>");
+  else if (noise.stats.interference)
+    html += F("<span class=\"badge warning\">Interference</span>");
+  else
+    html += F("<span class=\"badge success\">Quiet</span>");
+  html += F("</div><div class=\"status-grid\">");
+  html += F("<div class=\"status-item\"><span class=\"status-label\">Noise "
+            "Floor</span><span class=\"status-value hl\">");
+  html += noise.stats.windows ? String(noise.stats.floor_dbm) + " dBm" : String("-");
+  html += F("</span></div>");
+  html += F("<div class=\"status-item\"><span class=\"status-label\">Level "
+            "(10 s)</span><span class=\"status-value\">");
+  html += noise.stats.windows ? String(noise.stats.level_dbm) + " dBm" : String("-");
+  html += F("</span></div>");
+  html += F("<div class=\"status-item\"><span class=\"status-label\">"
+            "Interference</span><span class=\"status-value\">");
+  html += String(noise.stats.episodes);
+  html += F(" episodes, ");
+  html += String((uint32_t)(noise.stats.interference_ms / 60000));
+  html += F(" min</span></div>");
+  html += F("<div class=\"status-item\"><span class=\"status-label\">Last "
+            "Episode</span><span class=\"status-value\">");
+  const NoiseEpisode &lastEp = noise.episodes[0];
+  if (lastEp.start_ms) {
+    uint32_t secondsAgo = clockElapsedMs(lastEp.start_ms) / 1000;
+    if (secondsAgo < 3600)
+      html += String(secondsAgo / 60) + "m ago";
+    else
+      html += String(secondsAgo / 3600) + "h ago";
+    html += F(", ");
+    html += lastEp.duration_ms ? String(lastEp.duration_ms / 1000) + " s"
+                               : String("ongoing");
+    html += F(", peak ");
+    html += String(lastEp.peak_dbm);
+    html += F(" dBm");
+  } else {
+    html += F("-");
+  }
+  html += F("</span></div>");
+  html += F("<div class=\"status-item\"><span class=\"status-label\">SNR "
+            "Margin avg / last</span><span class=\"status-value\">");
+  if (noise.stats.frames) {
+    html += String(noise.stats.margin_sum_db / noise.stats.frames, 1);
+    html += F(" / ");
+    html += String(noise.stats.last_margin_db, 1);
+    html += F(" dB");
+  } else {
+    html += F("-");
+  }
+  html += F("</span></div></div>");
+
+  // Last hour's channel RSSI, over the bins in use
+  int firstBin = NOISE_BINS, lastBin = -1;
+  uint32_t peakCount = 1;
+  for (int i = 0; i < NOISE_BINS; i++) {
+    if (!noise.hour[i])
+      continue;
+    if (firstBin == NOISE_BINS)
+      firstBin = i;
+    lastBin = i;
+    if (noise.hour[i] > peakCount)
+      peakCount = noise.hour[i];
+  }
+  if (lastBin >= 0) {
+    html += F("<div style=\"display:flex;align-items:flex-end;gap:1px;"
+              "height:48px;margin-top:14px\">");
+    for (int i = firstBin; i <= lastBin; i++) {
+      html += F("<div title=\"");
+      html += String(NOISE_MIN_DBM + i);
+      html += F(" dBm: ");
+      html += String(noise.hour[i]);
+      html += F("\" style=\"flex:1;min-height:1px;background:var(--accent-"
+                "primary);border-radius:2px 2px 0 0;height:");
+      html += String(noise.hour[i] * 100.0f / peakCount, 1);
+      html += F("%\"></div>");
+    }
+    html += F("</div><div style=\"display:flex;justify-content:space-between;"
+              "font-size:11px;color:var(--text-secondary)\"><span>");
+    html += String(NOISE_MIN_DBM + firstBin);
+    html += F(" dBm</span><span>last hour</span><span>");
+    html += String(NOISE_MIN_DBM + lastBin);
+    html += F(" dBm</span></div>");
+  }
+
+  // SNR margin of received frames
+  uint32_t peakFrames = 1;
+  for (uint8_t i = 0; i < NOISE_MARGIN_BINS; i++) {
+    if (noise.margin[i] > peakFrames)
+      peakFrames = noise.margin[i];
+  }
+  if (noise.stats.frames) {
+    html += F("<div style=\"margin-top:12px\">");
+    for (uint8_t i = 0; i < NOISE_MARGIN_BINS; i++) {
+      html += F("<div style=\"display:flex;align-items:center;gap:8px;"
+                "font-size:11px;margin-bottom:6px\"><span style=\"width:64px;"
+                "color:var(--text-secondary)\">");
+      if (i == 0)
+        html += F("&le; 0 dB");
+      else if (i == NOISE_MARGIN_BINS - 1)
+        html += "&gt; " + String((int)noise_margin_edges[i - 1]) + " dB";
+      else
+        html += String((int)noise_margin_edges[i - 1]) + "-" +
+                String((int)noise_margin_edges[i]) + " dB";
+      html += F("</span><div style=\"flex:1;height:8px;background:var(--bg-"
+                "tertiary);border-radius:4px;position:relative\"><div "
+                "style=\"position:absolute;height:100%;min-width:2px;"
+                "background:var(--accent-primary);border-radius:4px;width:");
+      html += String(noise.margin[i] * 100.0f / peakFrames, 1);
+      html += F("%\"></div></div><span style=\"width:64px;text-align:right;"
+                "font-family:monospace\">");
+      html += String(noise.margin[i]);
+      html += F("</span></div>");
+    }
+    html += F("</div>");
+  }
+
+  html += F("<div class=\"form-group\" style=\"margin:14px 0 0\"><label "
+            "class=\"form-label\">Sample Interval</label><select "
+            "class=\"form-select\" onchange=\"setNoiseInterval(this.value)\">");
+  static const uint16_t noiseIntervals[] = {0, 50, 100, 250, 500, 1000, 5000};
+  for (uint8_t i = 0; i < sizeof(noiseIntervals) / sizeof(noiseIntervals[0]); i++) {
+    html += F("<option value=\"");
+    html += String(noiseIntervals[i]);
+    html += '"';
+    if (noise_sample_ms == noiseIntervals[i])
+      html += F(" selected");
+    html += '>';
+    if (noiseIntervals[i] == 0)
+      html += F("Off");
+    else
+      html += String(noiseIntervals[i]) + F(" ms");
+    html += F("</option>");
+  }
+  html += F("</select></div>");
+
+  // Adaptive data rate (hardware/Adr.h)
+  html += F("<div class=\"form-group\" style=\"margin:14px 0 0\"><label "
+            "class=\"form-label\">Data Rate (ADR)</label><select "
+            "class=\"form-select\" onchange=\"setAdrMode(this.value)\">");
+  for (uint8_t m = 0; m < ADR_MODE_COUNT; m++) {
+    html += F("<option value=\"");
+    html += String(m);
+    html += '"';
+    if (adr_mode == m)
+      html += F(" selected");
+    html += '>';
+    html += getAdrModeName(m);
+    html += F("</option>");
+  }
+  html += F("</select>");
+  AdrStats adrStats;
+  adrSnapshot(nullptr, 0, adrStats);
+  html += F("<div style=\"font-size:11px;color:var(--text-muted);margin-top:4px\">");
+  html += String(adrStats.acks) + F(" changes applied, ");
+  html += String((int32_t)(adrStats.saved_us / 1000000)) + F(" s airtime saved");
+  html += F("</div></div>");
+
+  // Receive schedule across profiles (hardware/RxScheduler.h)
+  if (rx_profile_count > 1) {
+    RxProfileStats rxProfiles[RX_PROFILES_MAX];
+    RxSchedStats rxStats;
+    uint8_t n = rxSchedSnapshot(rxProfiles, rxStats);
+    uint32_t missed = 0;
+    for (uint8_t i = 0; i < n; i++)
+      missed += rxProfiles[i].missed;
+    html += F("<div style=\"font-size:11px;color:var(--text-muted);margin-top:8px\">");
+    html += String(n) + F(" receive profiles, ");
+    html += String(rxStats.switches) + F(" switches, ~");
+    html += String(missed) + F(" frames missed");
+    html += F("</div>");
+  }
+  html += F("</div>");
+
+  // Loop timing card
+  html += F("<div class=\"card\"><div class=\"card-header\"><h3 "
+            "class=\"card-title\"><svg fill=\"none\" stroke=\"currentColor\" "
+            "stroke-width=\"2\" viewBox=\"0 0 24 24\"><circle cx=\"12\" "
+            "cy=\"12\" r=\"10\"/><path d=\"M12 6v6l4 2\"/></svg>Loop "
+            "Timing</h3>");
+  html += loop_over_budget == 0
+              ? F("<span class=\"badge success\">Within Budget</span>")
+              : F("<span class=\"badge warning\">Stalls</span>");
+  html += F("</div><div class=\"status-grid\">");
+  html += F("<div class=\"status-item\"><span "
+            "class=\"status-label\">Iterations</span><span "
+            "class=\"status-value\">");
+  html += String(loop_total.count);
+  html += F("</span></div>");
+  html += F("<div class=\"status-item\"><span class=\"status-label\">p99 / "
+            "Max</span><span class=\"status-value\">");
+  html += formatMicros(loopProfilerPercentile(loop_total, 99));
+  html += F(" / ");
+  html += formatMicros(loop_total.max_us);
+  html += F("</span></div>");
+  html += F("<div class=\"status-item\"><span class=\"status-label\">Over "
+            "Budget</span><span class=\"status-value hl\">");
+  html += String(loop_over_budget);
+  html += F("</span></div>");
+  html += F("<div class=\"status-item\"><span class=\"status-label\">Worst "
+            "Stall</span><span class=\"status-value\">");
+  if (loop_worst_stall.total_us > 0) {
+    html += formatMicros(loop_worst_stall.total_us);
+    html += F(" (");
+    html += getLoopSectionName(loop_worst_stall.section);
+    html += F(")");
+  } else {
+    html += F("-");
+  }
+  html += F("</span></div>");
+  for (uint8_t i = 0; i < LOOP_SECTION_COUNT; i++) {
+    html += F("<div class=\"status-item\"><span class=\"status-label\">");
+    html += getLoopSectionName(i);
+    html += F(" p99 / max</span><span class=\"status-value\">");
+    html += formatMicros(loopProfilerPercentile(loop_sections[i], 99));
+    html += F(" / ");
+    html += formatMicros(loop_sections[i].max_us);
+    html += F("</span></div>");
+  }
+  html += F("</div><div style=\"display:flex;gap:8px;align-items:flex-end;"
+            "margin-top:14px\"><div class=\"form-group\" "
+            "style=\"flex:1;margin-bottom:0\"><label class=\"form-label\">Stall "
+            "Budget</label><select class=\"form-select\" "
+            "onchange=\"setLoopBudget(this.value)\">");
+  static const uint16_t budgets[] = {10, 20, 50, 100, 250, 500};
+  for (uint8_t i = 0; i < sizeof(budgets) / sizeof(budgets[0]); i++) {
+    html += F("<option value=\"");
+    html += String(budgets[i]);
+    html += '"';
+    if (loop_budget_ms == budgets[i])
+      html += F(" selected");
+    html += '>';
+    html += String(budgets[i]);
+    html += F(" ms</option>");
+  }
+  html += F("</select></div><button class=\"btn btn-secondary\" "
+            "onclick=\"resetLoopStats()\">Reset</button></div></div>");
+
+  // Boot timeline card
+  html += F("<div class=\"card\"><div class=\"card-header\"><h3 "
+            "class=\"card-title\"><svg fill=\"none\" stroke=\"currentColor\" "
+            "stroke-width=\"2\" viewBox=\"0 0 24 24\"><path d=\"M13 2 3 "
+            "14h9l-1 8 10-12h-9z\"/></svg>Boot Timeline</h3>");
+  html += fast_boot ? F("<span class=\"badge success\">Fast Boot</span>")
+                    : F("<span class=\"badge warning\">Normal Boot</span>");
+  html += F("</div><div class=\"status-grid\">");
+  html += F("<div class=\"status-item\"><span class=\"status-label\">LoRa "
+            "Ready</span><span class=\"status-value hl\">");
+  html += String(boot_phases[BOOT_PHASE_LORA].end_ms);
+  html += F(" ms</span></div>");
+  html += F("<div class=\"status-item\"><span class=\"status-label\">Boot "
+            "Complete</span><span class=\"status-value\">");
+  if (isBootComplete()) {
+    html += String(boot_complete_ms);
+    html += F(" ms");
+  } else {
+    html += F("In progress");
+  }
+  html += F("</span></div></div><div style=\"margin-top:12px\">");
+  uint32_t bootSpan = 1;
+  for (uint8_t i = 0; i < BOOT_PHASE_COUNT; i++) {
+    if (boot_phases[i].done && boot_phases[i].end_ms > bootSpan)
+      bootSpan = boot_phases[i].end_ms;
+  }
+  for (uint8_t i = 0; i < BOOT_PHASE_COUNT; i++) {
+    if (!boot_phases[i].done)
+      continue;
+    html += F("<div style=\"display:flex;align-items:center;gap:8px;"
+              "font-size:11px;margin-bottom:6px\"><span style=\"width:64px;"
+              "color:var(--text-secondary)\">");
+    html += getBootPhaseName(i);
+    html += F("</span><div style=\"flex:1;height:8px;background:var(--bg-"
+              "tertiary);border-radius:4px;position:relative\"><div "
+              "style=\"position:absolute;height:100%;min-width:2px;"
+              "background:var(--accent-primary);border-radius:4px;left:");
+    html += String(boot_phases[i].start_ms * 100.0f / bootSpan, 1);
+    html += F("%;width:");
+    html += String(getBootPhaseDuration(i) * 100.0f / bootSpan, 1);
+    html += F("%\"></div></div><span style=\"width:64px;text-align:right;"
+              "font-family:monospace\">");
+    html += String(getBootPhaseDuration(i));
+    html += F(" ms</span></div>");
+  }
+  html += F("</div></div>");
+
+  // Memory card
+  html += F("<div class=\"card\"><div class=\"card-header\"><h3 "
+            "class=\"card-title\"><svg fill=\"none\" stroke=\"currentColor\" "
+            "stroke-width=\"2\" viewBox=\"0 0 24 24\"><rect x=\"4\" y=\"6\" "
+            "width=\"16\" height=\"12\" rx=\"2\"/><path d=\"M8 6V3m4 3V3m4 "
+            "3V3M8 21v-3m4 3v-3m4 3v-3\"/></svg>Memory</h3>");
+  html += heap_alloc_tracking
+              ? F("<span class=\"badge success\">Tracking Allocations</span>")
+              : F("<span class=\"badge warning\">Free Heap Only</span>");
+  html += F("</div><div class=\"status-grid\">");
+  html += F("<div class=\"status-item\"><span class=\"status-label\">Free / "
+            "Min</span><span class=\"status-value hl\">");
+  html += String(ESP.getFreeHeap() / 1024);
+  html += F(" / ");
+  html += String(ESP.getMinFreeHeap() / 1024);
+  html += F(" KB</span></div>");
+  html += F("<div class=\"status-item\"><span class=\"status-label\">Largest "
+            "Block</span><span class=\"status-value\">");
+  html += String(ESP.getMaxAllocHeap() / 1024);
+  html += F(" KB (");
+  html += String(getHeapFragmentation());
+  html += F("% frag)</span></div>");
+  const HeapReport *worstReports[] = {&heap_worst_packet, &heap_worst_http};
+  for (uint8_t i = 0; i < 2; i++) {
+    const HeapReport &r = *worstReports[i];
+    html += F("<div class=\"status-item\"><span class=\"status-label\">");
+    html += i == 0 ? F("Worst Packet") : F("Worst Request");
+    html += F("</span><span class=\"status-value\">");
+    if (r.at_ms == 0) {
+      html += F("-");
+    } else {
+      html += r.site;
+      html += F(" (");
+      if (heap_alloc_tracking) {
+        html += String(r.allocs);
+        html += F(" allocs, ");
+        html += String(r.bytes);
+        html += F(" B)");
+      } else {
+        html += String(r.free_delta);
+        html += F(" B net)");
+      }
+    }
+    html += F("</span></div>");
+  }
+  if (heap_alloc_tracking) {
+    for (uint8_t i = 0; i < HEAP_SUBSYS_COUNT; i++) {
+      html += F("<div class=\"status-item\"><span class=\"status-label\">");
+      html += getHeapSubsystemName(i);
+      html += F(" allocs</span><span class=\"status-value\">");
+      html += String(heap_subsys[i].allocs);
+      html += F("</span></div>");
+    }
+  }
+  html += F("</div><div style=\"display:flex;gap:8px;margin-top:14px\">"
+            "<button class=\"btn btn-secondary\" onclick=\"setHeapVerbose(");
+  html += heap_report_verbose ? F("0)\">Stop Serial Reports") : F("1)\">Serial Reports");
+  html += F("</button><button class=\"btn btn-secondary\" "
+            "onclick=\"resetHeapStats()\">Reset</button></div></div>");
+  html += F("</div>");
 
   // HomeKit Page
   html += F(
@@ -451,11 +815,10 @@ void handleRoot() {
         continue;
 
       // Debug logging
-      Serial.printf("[WEB] Device %s: has_contact=%d, has_motion=%d, "
-                    "contact_type=%d, motion_type=%d\n",
-                    devices[i].id, devices[i].has_contact,
-                    devices[i].has_motion, devices[i].contact_type,
-                    devices[i].motion_type);
+      LOG_DEBUG("[WEB] Device %s: has_contact=%d, has_motion=%d, "
+                "contact_type=%d, motion_type=%d",
+                devices[i].id, devices[i].has_contact, devices[i].has_motion,
+                devices[i].contact_type, devices[i].motion_type);
 
       // Determine device type label
       String deviceType = "Sensor";
@@ -473,13 +836,17 @@ void handleRoot() {
         deviceType = "Light Sensor";
       }
 
+      // Readings may be written concurrently by the ingest task
+      DeviceSnapshot snap;
+      snapshotDevice(&devices[i], snap);
+
       // Calculate signal bars based on RSSI
       int signalBars = 4;
-      if (devices[i].rssi < -80)
+      if (snap.rssi < -80)
         signalBars = 1;
-      else if (devices[i].rssi < -70)
+      else if (snap.rssi < -70)
         signalBars = 2;
-      else if (devices[i].rssi < -60)
+      else if (snap.rssi < -60)
         signalBars = 3;
 
       html += F("<div class=\"device-card\"><div class=\"device-icon\"><svg "
@@ -491,9 +858,24 @@ void handleRoot() {
       html += devices[i].name;
       html += F("</div><div class=\"device-meta\">");
       html += deviceType;
-      html += " • RSSI: " + String(devices[i].rssi) + "dBm";
+      html += " • RSSI: " + String(snap.rssi) + "dBm";
       if (devices[i].has_batt) {
-        html += " • " + String((int)devices[i].battery) + "%";
+        html += " • " + String(snap.battery) + "%";
+      }
+      if (snap.interval.samples >= DEVICE_INTERVAL_MIN_SAMPLES) {
+        html += " • every " + String((snap.interval.period_ms + 500) / 1000) + "s";
+        float onTime = deviceOnTimeRatio(snap.interval);
+        if (onTime >= 0)
+          html += ", " + String((int)(onTime * 100 + 0.5f)) + "% on time";
+      }
+      AdrDevice adr;
+      if (adr_mode != ADR_MODE_OFF && adrDevice(devices[i].id, adr)) {
+        html += " • SF" + String(adr.sf) + " · " + String(adr.power) + " dBm";
+        if (adr.rec_sf && (adr.rec_sf != adr.sf || adr.rec_power != adr.power)) {
+          html += " → SF" + String(adr.rec_sf) + " · " + String(adr.rec_power) + " dBm";
+          if (adr.cmd_pending)
+            html += " (sent)";
+        }
       }
       html += F("</div>");
 
@@ -577,10 +959,7 @@ void handleRoot() {
   // Count valid (non-deleted) entries
   int validCount = 0;
   for (int i = 0; i < activityLogCount; i++) {
-    int idx = (activityLogIndex - 1 - i + MAX_ACTIVITY_LOG) % MAX_ACTIVITY_LOG;
-    if (idx < 0)
-      idx += MAX_ACTIVITY_LOG;
-    if (activityLog[idx].device_name[0] != 0) {
+    if (activityLog[getActivitySlot(i)].device != ACTIVITY_NO_DEVICE) {
       validCount++;
     }
   }
@@ -593,20 +972,15 @@ void handleRoot() {
     // Show entries in reverse order (newest first)
     int displayCount = min(activityLogCount, 10); // Show last 10 entries
     for (int i = 0; i < displayCount; i++) {
-      // Calculate index for reverse chronological order
-      int idx =
-          (activityLogIndex - 1 - i + MAX_ACTIVITY_LOG) % MAX_ACTIVITY_LOG;
-      if (idx < 0)
-        idx += MAX_ACTIVITY_LOG;
-
+      int idx = getActivitySlot(i);
       ActivityEntry *entry = &activityLog[idx];
 
-      // Skip empty entries (deleted)
-      if (entry->device_name[0] == 0)
+      // Skip deleted entries
+      if (entry->device == ACTIVITY_NO_DEVICE)
         continue;
 
       // Calculate time ago
-      unsigned long secondsAgo = (millis() - entry->timestamp) / 1000;
+      unsigned long secondsAgo = clockElapsedMs(entry->timestamp) / 1000;
       String timeStr;
       if (secondsAgo < 60) {
         timeStr = String(secondsAgo) + "s ago";
@@ -619,9 +993,11 @@ void handleRoot() {
       html += F("<div class=\"activity-entry\"><span class=\"activity-time\">");
       html += timeStr;
       html += F("</span><span class=\"activity-device\">");
-      html += entry->device_name;
+      char message[64];
+      formatActivity(*entry, message, sizeof(message));
+      html += getActivityDeviceName(*entry);
       html += F("</span><span class=\"activity-msg\">");
-      html += entry->message;
+      html += message;
       html += F(
           "</span><button class=\"activity-delete\" onclick=\"removeActivity(");
       html += String(idx);
@@ -785,8 +1161,15 @@ void handleRoot() {
   html += syncHex;
   html +=
       F("\" maxlength=\"2\"><p class=\"form-hint\">Network identifier - must "
-        "match all devices</p></div></div><button type=\"submit\" class=\"btn "
-        "btn-primary\">Save & Restart</button></form></div></div>");
+        "match all devices</p></div><div class=\"form-group\"><label "
+        "class=\"form-label\">More Receive Profiles</label><input type=\"text\" "
+        "class=\"form-input\" name=\"rx_prof\" value=\"");
+  html += rx_profiles_text;
+  html += F("\" maxlength=\"95\" placeholder=\"869.525/9/125/34\"><p "
+            "class=\"form-hint\">MHz/SF/kHz/sync, up to 3, separated by ; - "
+            "the radio takes turns listening on each</p></div></div><button "
+            "type=\"submit\" class=\"btn btn-primary\">Save & "
+            "Restart</button></form></div></div>");
 
   // Encryption Page
   html += F("<div class=\"page\" id=\"page-encryption\"><div "
@@ -871,7 +1254,27 @@ void handleRoot() {
             "id=\"oledBr\" min=\"1\" max=\"255\" value=\"");
   html += String(oled_brightness);
   html += F("\" style=\"width:100%;accent-color:var(--accent-primary)\" "
-            "onchange=\"setHwVal('oled_br',this.value)\"></div></div></div>");
+            "onchange=\"setHwVal('oled_br',this.value)\"></div></div>");
+  html += F("<div class=\"card\"><div class=\"card-header\"><h3 "
+            "class=\"card-title\">Startup</h3></div>");
+  html += F("<div class=\"toggle-group\"><div class=\"toggle-info\"><span "
+            "class=\"toggle-title\">Fast Boot</span><span "
+            "class=\"toggle-desc\">Skip splash delays, start LoRa first and "
+            "connect WiFi in the background</span></div><div "
+            "class=\"toggle-btn");
+  if (fast_boot)
+    html += " active";
+  html += F("\" id=\"fastBoot\" onclick=\"toggleHw('fast_boot')\"></div>"
+            "</div>");
+  html += F("<div class=\"toggle-group\"><div class=\"toggle-info\"><span "
+            "class=\"toggle-title\">Dual-Core Pipeline</span><span "
+            "class=\"toggle-desc\">Receive and decode packets on core 0, "
+            "HomeKit/MQTT/web on core 1 (applies after restart)</span></div>"
+            "<div class=\"toggle-btn");
+  if (dual_core)
+    html += " active";
+  html += F("\" id=\"dualCore\" onclick=\"toggleHw('dual_core')\"></div>"
+            "</div></div></div>");
 
   // MQTT Page
   html +=
@@ -1129,8 +1532,20 @@ void handleRoot() {
         "document.getElementById('pwrLed').classList.toggle('active',d.pwr_led)"
         ";if(k==='act_led')document.getElementById('actLed').classList.toggle('"
         "active',d.act_led);if(k==='oled_en')document.getElementById('oledEn')."
-        "classList.toggle('active',d.oled_en);});}");
+        "classList.toggle('active',d.oled_en);if(k==='fast_boot')document."
+        "getElementById('fastBoot').classList.toggle('active',d.fast_boot);"
+        "if(k==='dual_core')document.getElementById('dualCore').classList."
+        "toggle('active',d.dual_core);});}");
   html += F("function setHwVal(k,v){fetch('/api/hardware?'+k+'='+v);}");
+  html += F("function setLoopBudget(v){fetch('/api/loop?budget='+v);}");
+  html += F("function setNoiseInterval(v){fetch('/api/noise?interval='+v);}");
+  html += F("function setAdrMode(v){fetch('/api/adr?mode='+v);}");
+  html += F("function resetLoopStats(){fetch('/api/loop?reset=1').then(()=>"
+            "location.reload());}");
+  html += F("function setHeapVerbose(v){fetch('/api/heap?verbose='+v).then(()=>"
+            "location.reload());}");
+  html += F("function resetHeapStats(){fetch('/api/heap?reset=1').then(()=>"
+            "location.reload());}");
   html += F("function clearAllActivity(){if(confirm('Clear all "
             "activity?')){fetch('/api/activity/"
             "clear').then(r=>r.json()).then(d=>{if(d.success)location.reload();"
@@ -1207,6 +1622,22 @@ void handleSave() {
     return;
   }
 
+  // Checked before anything is applied, so a typo saves nothing
+  if (webServer.hasArg("rx_prof")) {
+    String text = webServer.arg("rx_prof");
+    RxProfile parsed[RX_PROFILES_MAX];
+    uint8_t n = 0;
+    if (text.length() >= sizeof(rx_profiles_text) ||
+        !rxSchedParseProfiles(text.c_str(), parsed, RX_PROFILES_MAX - 1, n)) {
+      webServer.send(400, "text/plain",
+                     "Invalid receive profiles \"" + text +
+                         "\": expected MHz/SF/kHz/sync, up to 3, separated "
+                         "by ; (137-1020 MHz, SF6-12, 125/250/500 kHz, sync "
+                         "in hex). Nothing was saved.");
+      return;
+    }
+  }
+
   bool needsRestart = false;
 
   if (webServer.hasArg("ssid") && webServer.arg("ssid").length() > 0) {
@@ -1270,6 +1701,14 @@ void handleSave() {
     }
   }
 
+  if (webServer.hasArg("rx_prof")) {
+    String text = webServer.arg("rx_prof");    // Validated above
+    if (text != rx_profiles_text) {
+      strcpy(rx_profiles_text, text.c_str());
+      needsRestart = true;
+    }
+  }
+
   if (webServer.hasArg("gw_key")) {
     strncpy(gateway_key, webServer.arg("gw_key").c_str(), 31);
     gateway_key[31] = 0;
@@ -1334,10 +1773,8 @@ void handleSave() {
 
   webServer.send(200, "text/html", html);
 
-  delay(1000);
-
   if (needsRestart || ap_mode) {
-    ESP.restart();
+    scheduleRestart(1000);
   }
 }
 
@@ -1379,8 +1816,7 @@ void handleReset() {
 
   webServer.send(200, "text/html", html);
 
-  delay(1000);
-  ESP.restart();
+  scheduleRestart(1000);
 }
 
 void handleScan() {
@@ -1393,7 +1829,7 @@ void handleScan() {
 
   int n = WiFi.scanNetworks();
 
-  StaticJsonDocument<1024> doc;
+  StaticJsonDocument<384> doc;
   JsonArray networks = doc.createNestedArray("networks");
 
   for (int i = 0; i < n && i < 15; i++) {
@@ -1467,7 +1903,9 @@ void handleTestDevice() {
         // Create JSON document with new values
         StaticJsonDocument<256> updateDoc;
         updateDoc["id"] = devices[i].id;
-        updateDoc["b"] = devices[i].battery; // Keep existing battery
+        DeviceSnapshot snap;
+        snapshotDevice(&devices[i], snap);
+        updateDoc["b"] = snap.battery; // Keep existing battery
 
         if (devices[i].has_temp) {
           updateDoc["t"] = 20.0 + (random(0, 100) / 10.0);
@@ -1486,7 +1924,9 @@ void handleTestDevice() {
         }
 
         // Use updateDevice to properly update and log activity
-        updateDevice(&devices[i], updateDoc, -50);
+        DeviceReading reading;
+        parseReading(updateDoc, -50, reading);
+        updateDevice(&devices[i], reading);
         updatedCount++;
         Serial.printf("[TEST] Updated device: %s\n", devices[i].id);
       }
@@ -1506,16 +1946,19 @@ void handleTestDevice() {
   }
 
   // Find or register the device (simulating LoRa packet processing)
+  DeviceReading reading;
+  parseReading(doc, -50, reading); // Fake RSSI of -50
   Device *dev = findDevice(deviceId.c_str());
   if (!dev) {
-    dev = registerDevice(deviceId.c_str(), doc);
+    dev = registerDevice(reading);
   }
 
   if (dev) {
-    updateDevice(dev, doc, -50); // Fake RSSI of -50
+    updateDevice(dev, reading);
     packets_received++;
-    last_packet_time = millis();
-    last_event = "Test: " + deviceId;
+    last_packet_time = clockMillis();
+    last_event = "Test: ";
+    last_event.append(deviceId.c_str());
 
     responseDoc["success"] = true;
     responseDoc["message"] = "Created " + deviceId + " - check Home app!";
@@ -1544,8 +1987,7 @@ void handleUnpair() {
   webServer.send(200, "application/json",
                  "{\"success\":true,\"message\":\"Unpaired. Restarting...\"}");
 
-  delay(1000);
-  ESP.restart();
+  scheduleRestart(1000);
 }
 
 // Rename device handler
@@ -1624,8 +2066,7 @@ void handleRestart() {
 
   webServer.send(200, "application/json",
                  "{\"success\":true,\"message\":\"Restarting...\"}");
-  delay(500);
-  ESP.restart();
+  scheduleRestart(500);
 }
 
 // Set sensor type handler
@@ -1805,18 +2246,830 @@ void handleHardwareSettings() {
     saveSettings();
   }
 
+  if (webServer.hasArg("fast_boot")) {
+    if (webServer.arg("fast_boot") == "toggle") {
+      fast_boot = !fast_boot;
+    } else {
+      fast_boot = webServer.arg("fast_boot") == "1";
+    }
+    Serial.printf("[WEB] Fast boot set to: %d (applies on next boot)\n",
+                  fast_boot);
+    saveSettings();
+  }
+
+  if (webServer.hasArg("dual_core")) {
+    if (webServer.arg("dual_core") == "toggle") {
+      dual_core = !dual_core;
+    } else {
+      dual_core = webServer.arg("dual_core") == "1";
+    }
+    Serial.printf("[WEB] Dual-core pipeline set to: %d (applies on next boot)\n",
+                  dual_core);
+    saveSettings();
+  }
+
   StaticJsonDocument<256> doc;
   doc["pwr_led"] = power_led_enabled;
   doc["act_led"] = activity_led_enabled;
   doc["oled_en"] = oled_enabled;
   doc["oled_br"] = oled_brightness;
   doc["oled_to"] = oled_timeout;
+  doc["fast_boot"] = fast_boot;
+  doc["dual_core"] = dual_core;
+
+  String response;
+  serializeJson(doc, response);
+  webServer.send(200, "application/json", response);
+}
+
+// Loop profiler statistics handler
+void handleLoopStats() {
+  if (!authenticateRequest()) {
+    requireAuth();
+    return;
+  }
+
+  if (webServer.hasArg("budget")) {
+    int budget = webServer.arg("budget").toInt();
+    if (budget > 0 && budget <= 10000) {
+      loop_budget_ms = budget;
+      saveSettings();
+    }
+  }
+
+  if (webServer.hasArg("reset")) {
+    loopProfilerReset();
+  }
+
+  StaticJsonDocument<2048> doc;
+  doc["budget_ms"] = loop_budget_ms;
+  doc["iterations"] = loop_total.count;
+  doc["over_budget"] = loop_over_budget;
+  doc["p50_us"] = loopProfilerPercentile(loop_total, 50);
+  doc["p99_us"] = loopProfilerPercentile(loop_total, 99);
+  doc["max_us"] = loop_total.max_us;
+
+  JsonObject worst = doc.createNestedObject("worst_stall");
+  worst["total_us"] = loop_worst_stall.total_us;
+  worst["section"] = getLoopSectionName(loop_worst_stall.section);
+  worst["section_us"] = loop_worst_stall.section_us;
+  worst["age_s"] = clockElapsedMs(loop_worst_stall.at_ms) / 1000;
+
+  JsonObject last = doc.createNestedObject("last_stall");
+  last["total_us"] = loop_last_stall.total_us;
+  last["section"] = getLoopSectionName(loop_last_stall.section);
+  last["section_us"] = loop_last_stall.section_us;
+  last["age_s"] = clockElapsedMs(loop_last_stall.at_ms) / 1000;
+
+  JsonObject sections = doc.createNestedObject("sections");
+  for (uint8_t i = 0; i < LOOP_SECTION_COUNT; i++) {
+    const LoopSectionStats &st = loop_sections[i];
+    JsonObject sec = sections.createNestedObject(getLoopSectionName(i));
+    sec["avg_us"] = st.count ? (uint32_t)(st.total_us / st.count) : 0;
+    sec["p99_us"] = loopProfilerPercentile(st, 99);
+    sec["max_us"] = st.max_us;
+    sec["stalls"] = st.culprit;
+  }
+
+  String response;
+  serializeJson(doc, response);
+  webServer.send(200, "application/json", response);
+}
+
+// Noise floor and interference handler
+void handleNoiseStats() {
+  if (!authenticateRequest()) {
+    requireAuth();
+    return;
+  }
+
+  if (webServer.hasArg("interval")) {
+    int interval = webServer.arg("interval").toInt();
+    if (interval == 0 ||
+        (interval >= NOISE_SAMPLE_MS_MIN && interval <= NOISE_SAMPLE_MS_MAX)) {
+      noise_sample_ms = interval;
+      saveSettings();
+    }
+  }
+
+  static NoiseSnapshot noise;
+  noiseSnapshot(noise);
+  const NoiseStats &st = noise.stats;
+
+  DynamicJsonDocument doc(4096);
+  doc["interval_ms"] = noise_sample_ms;
+  doc["samples"] = st.samples;
+  doc["deferred"] = st.deferred;
+  if (st.windows) {
+    doc["floor_dbm"] = st.floor_dbm;
+    doc["level_dbm"] = st.level_dbm;
+  }
+  doc["interference"] = st.interference;
+  doc["episodes"] = st.episodes;
+  doc["interference_s"] = (uint32_t)(st.interference_ms / 1000);
+
+  JsonArray recent = doc.createNestedArray("recent");
+  for (uint8_t i = 0; i < NOISE_EPISODES; i++) {
+    const NoiseEpisode &ep = noise.episodes[i];
+    if (!ep.start_ms)
+      break;
+    JsonObject e = recent.createNestedObject();
+    e["age_s"] = clockElapsedMs(ep.start_ms) / 1000;
+    e["duration_s"] = ep.duration_ms / 1000;
+    e["ongoing"] = ep.duration_ms == 0;
+    e["floor_dbm"] = ep.floor_dbm;
+    e["peak_dbm"] = ep.peak_dbm;
+  }
+
+  // Rolling hour in 1 dB bins, from the lowest to the highest in use
+  JsonObject hour = doc.createNestedObject("hour");
+  hour["samples"] = noise.hour_samples;
+  int firstBin = 0, lastBin = NOISE_BINS - 1;
+  while (firstBin < NOISE_BINS && !noise.hour[firstBin])
+    firstBin++;
+  while (lastBin > firstBin && !noise.hour[lastBin])
+    lastBin--;
+  JsonArray bins = hour.createNestedArray("counts");
+  if (firstBin < NOISE_BINS) {
+    hour["from_dbm"] = NOISE_MIN_DBM + firstBin;
+    for (int i = firstBin; i <= lastBin; i++)
+      bins.add(noise.hour[i]);
+  }
+
+  JsonObject margin = doc.createNestedObject("snr_margin");
+  margin["frames"] = st.frames;
+  if (st.frames) {
+    margin["avg_db"] = st.margin_sum_db / st.frames;
+    margin["last_db"] = st.last_margin_db;
+  }
+  JsonArray counts = margin.createNestedArray("counts");
+  JsonArray edges = margin.createNestedArray("edges_db");
+  for (uint8_t i = 0; i < NOISE_MARGIN_BINS; i++) {
+    counts.add(noise.margin[i]);
+    if (i < NOISE_MARGIN_BINS - 1)
+      edges.add(noise_margin_edges[i]);
+  }
+
+  String response;
+  serializeJson(doc, response);
+  webServer.send(200, "application/json", response);
+}
+
+// Adaptive data rate handler
+void handleAdr() {
+  if (!authenticateRequest()) {
+    requireAuth();
+    return;
+  }
+
+  if (webServer.hasArg("mode")) {
+    int mode = webServer.arg("mode").toInt();
+    if (mode >= 0 && mode < ADR_MODE_COUNT) {
+      adr_mode = mode;
+      saveSettings();
+    }
+  }
+
+  static AdrDevice table[ADR_MAX_DEVICES];
+  AdrStats st;
+  uint8_t n = adrSnapshot(table, ADR_MAX_DEVICES, st);
+  DownlinkStats dl;
+  downlinkSnapshot(dl);
+
+  DynamicJsonDocument doc(6144);
+  doc["mode"] = getAdrModeName(adr_mode);
+  doc["bridge_sf"] = lora_sf;
+  doc["uplinks"] = st.uplinks;
+  doc["commands"] = st.commands;
+  doc["keepalives"] = st.keepalives;
+  doc["acks"] = st.acks;
+  doc["gave_up"] = st.gave_up;
+  doc["reverts"] = st.reverts;
+  doc["follow_windows"] = st.follow_windows;
+  doc["follow_misses"] = st.follow_misses;
+  doc["followed_frames"] = st.followed_frames;
+  doc["airtime_saved_ms"] = (int32_t)(st.saved_us / 1000);
+
+  JsonObject down = doc.createNestedObject("downlinks");
+  down["sent"] = dl.sent;
+  down["busy"] = dl.busy;
+  down["missed"] = dl.missed;
+  down["airtime_ms"] = (uint32_t)(dl.airtime_us / 1000);
+  down["late_max_us"] = dl.late_max_us;
+  if (dl.sent)
+    down["late_avg_us"] = (uint32_t)(dl.late_sum_us / dl.sent);
+
+  JsonArray list = doc.createNestedArray("devices");
+  for (uint8_t i = 0; i < n; i++) {
+    const AdrDevice &a = table[i];
+    JsonObject d = list.createNestedObject();
+    d["id"] = a.id;
+    d["sf"] = a.sf;
+    d["power_dbm"] = a.power;
+    d["downlink"] = a.downlink;
+    d["followable"] = a.followable;
+    d["snr_samples"] = a.snr_count;
+    if (a.rec_sf) {
+      d["rec_sf"] = a.rec_sf;
+      d["rec_power_dbm"] = a.rec_power;
+    }
+    if (a.cmd_pending) {
+      d["cmd_seq"] = a.cmd_seq;
+      d["cmd_attempts"] = a.cmd_attempts;
+    }
+    d["uplinks"] = a.uplinks;
+    d["acks"] = a.acks;
+    d["airtime_saved_ms"] = (int32_t)(a.saved_us / 1000);
+  }
+
+  String response;
+  serializeJson(doc, response);
+  webServer.send(200, "application/json", response);
+}
+
+// Receive schedule across radio profiles handler
+void handleRxSchedule() {
+  if (!authenticateRequest()) {
+    requireAuth();
+    return;
+  }
+
+  RxProfileStats profiles[RX_PROFILES_MAX];
+  RxSchedStats st;
+  uint8_t n = rxSchedSnapshot(profiles, st);
+
+  DynamicJsonDocument doc(2048);
+  doc["switches"] = st.switches;
+  doc["switch_us_total"] = (uint32_t)st.switch_us;
+  doc["switch_us_max"] = st.switch_max_us;
+  if (st.switches)
+    doc["switch_us_avg"] = (uint32_t)(st.switch_us / st.switches);
+  doc["deferred"] = st.deferred;
+  doc["cycles"] = st.cycles;
+  doc["elapsed_s"] = (uint32_t)(st.elapsed_ms / 1000);
+
+  JsonArray list = doc.createNestedArray("profiles");
+  for (uint8_t i = 0; i < n; i++) {
+    const RxProfile &rp = rx_profiles[i];
+    const RxProfileStats &p = profiles[i];
+    JsonObject o = list.createNestedObject();
+    o["frequency_mhz"] = rp.frequency;
+    o["sf"] = rp.sf;
+    o["bw_khz"] = rp.bw / 1000;
+    o["syncword"] = rp.syncword;
+    o["frames"] = p.frames;
+    o["dwells"] = p.dwells;
+    o["dwell_ms"] = p.dwell_ms;
+    o["listen_s"] = (uint32_t)(p.listen_ms / 1000);
+    o["usable_s"] = (uint32_t)(p.usable_ms / 1000);
+    o["rate_per_h"] = p.rate_per_h;
+    o["missed"] = p.missed;
+  }
+
+  String response;
+  serializeJson(doc, response);
+  webServer.send(200, "application/json", response);
+}
+
+// Ingest/fan-out pipeline handler
+void handlePipeline() {
+  if (!authenticateRequest()) {
+    requireAuth();
+    return;
+  }
+
+  if (webServer.hasArg("policy")) {
+    String policy = webServer.arg("policy");
+    for (uint8_t i = 0; i < PIPELINE_POLICY_COUNT; i++) {
+      if (policy == getPipelinePolicyName(i)) {
+        pipeline_policy = i;
+        saveSettings();
+      }
+    }
+  }
+
+  if (webServer.hasArg("reset")) {
+    pipelineResetStats();
+  }
+
+  if (webServer.hasArg("generate")) {
+    int seconds = webServer.hasArg("seconds") ? webServer.arg("seconds").toInt() : 10;
+    if (!pipelineStartRun(webServer.arg("generate").toInt(), seconds)) {
+      if (pipeline_run.running) {
+        webServer.send(409, "application/json", "{\"error\":\"Run in progress\"}");
+      } else {
+        webServer.send(400, "application/json", "{\"error\":\"No devices to simulate\"}");
+      }
+      return;
+    }
+  }
+
+  const PipelineStats &st = pipeline_stats;
+  StaticJsonDocument<1024> doc;
+  doc["mode"] = pipelineIsDualCore() ? "dual-core" : "single-core";
+  doc["restart_required"] = dual_core != pipelineIsDualCore();
+  doc["policy"] = getPipelinePolicyName(pipeline_policy);
+  doc["queue_depth"] = pipelineQueueDepth();
+  doc["queue_capacity"] = PIPELINE_QUEUE_DEPTH;
+  doc["high_water"] = st.high_water;
+  doc["ingested"] = st.ingested;
+  doc["fanned_out"] = st.fanned_out;
+  doc["dropped"] = st.dropped;
+  doc["blocked"] = st.blocked;
+  doc["avg_ingest_us"] = st.ingested ? (uint32_t)(st.ingest_us / st.ingested) : 0;
+  doc["avg_fanout_us"] = st.fanned_out ? (uint32_t)(st.fanout_us / st.fanned_out) : 0;
+  doc["max_latency_us"] = st.max_latency_us;
+  doc["snapshot_retries"] = device_snapshot_retries;
+
+  const PipelineRun &run = pipeline_run;
+  if (run.started_ms) {
+    uint32_t offered = run.generated + run.overrun;
+    uint32_t elapsed_ms = run.last_delivery_ms - run.started_ms;
+    JsonObject r = doc.createNestedObject("run");
+    r["running"] = (bool)run.running;
+    r["mode"] = run.dual_core ? "dual-core" : "single-core";
+    r["rate_hz"] = run.rate_hz;
+    r["seconds"] = run.seconds;
+    r["offered"] = offered;
+    r["overrun"] = run.overrun;
+    r["dropped"] = run.dropped;
+    r["delivered"] = run.delivered;
+    r["lost"] = offered - run.delivered;
+    r["loss_pct"] = offered ? 100.0f * (offered - run.delivered) / offered : 0.0f;
+    r["throughput_hz"] = elapsed_ms ? run.delivered * 1000.0f / elapsed_ms : 0.0f;
+    r["max_latency_us"] = run.max_latency_us;
+  }
+
+  String response;
+  serializeJson(doc, response);
+  webServer.send(200, "application/json", response);
+}
+
+// Event bus sink statistics handler
+void handleEventBus() {
+  if (!authenticateRequest()) {
+    requireAuth();
+    return;
+  }
+
+  if (webServer.hasArg("reset")) {
+    eventBusResetStats();
+  }
+
+  StaticJsonDocument<2048> doc;
+  doc["pending"] = eventBusPending();
+
+  JsonArray sinks = doc.createNestedArray("sinks");
+  for (uint8_t i = 0; i < event_sink_count; i++) {
+    const EventSink &s = event_sinks[i];
+    JsonObject o = sinks.createNestedObject();
+    o["name"] = s.name;
+    o["priority"] = s.priority;
+    o["policy"] = getEventPolicyName(s.policy);
+
+    JsonArray types = o.createNestedArray("events");
+    for (uint8_t t = 0; t < DEVICE_EVENT_TYPE_COUNT; t++) {
+      if (s.mask & DEVICE_EVENT_BIT(t)) {
+        types.add(getDeviceEventTypeName(t));
+      }
+    }
+
+    o["queued"] = s.count;
+    o["capacity"] = s.capacity;
+    o["high_water"] = s.stats.high_water;
+    o["delivered"] = s.stats.delivered;
+    o["dropped"] = s.stats.dropped;
+    o["coalesced"] = s.stats.coalesced;
+    o["avg_us"] = s.stats.delivered ? (uint32_t)(s.stats.total_us / s.stats.delivered) : 0;
+    o["max_us"] = s.stats.max_us;
+  }
+
+  String response;
+  serializeJson(doc, response);
+  webServer.send(200, "application/json", response);
+}
+
+// Scheduler job statistics handler
+void handleScheduler() {
+  if (!authenticateRequest()) {
+    requireAuth();
+    return;
+  }
+
+  if (webServer.hasArg("reset")) {
+    schedulerResetStats();
+  }
+
+  StaticJsonDocument<3072> doc;
+  doc["next_due_ms"] = schedulerNextDueMs();
+  doc["sleeps"] = scheduler_idle.sleeps;
+  doc["woken"] = scheduler_idle.woken;
+  doc["short_polls"] = scheduler_idle.short_polls;
+  doc["radio_irqs"] = radio_irqs;
+
+  JsonArray cpu = doc.createNestedArray("cpu");
+  for (uint8_t i = 0; i < cpu_load_count; i++) {
+    JsonObject o = cpu.createNestedObject();
+    o["task"] = cpu_loads[i]->task;
+    o["busy_pct"] = cpu_loads[i]->busy_pct;
+    o["peak_pct"] = cpu_loads[i]->peak_pct;
+  }
+
+  JsonArray jobs = doc.createNestedArray("jobs");
+  for (int i = 0; i < SCHEDULER_MAX_JOBS; i++) {
+    const SchedulerJob &job = scheduler_jobs[i];
+    if (!job.active) continue;
+
+    JsonObject o = jobs.createNestedObject();
+    o["name"] = job.name;
+    if (job.period_ms) {
+      o["period_ms"] = job.period_ms;
+      o["catchup"] = getSchedulerCatchUpName(job.catchup);
+    } else {
+      o["once"] = true;
+    }
+    o["due_in_ms"] = (int32_t)(job.due_ms - clockMillis());
+    o["budget_us"] = job.budget_us;
+    o["runs"] = job.stats.runs;
+    o["late"] = job.stats.late;
+    o["avg_late_ms"] = job.stats.runs ? (uint32_t)(job.stats.total_late_ms / job.stats.runs) : 0;
+    o["max_late_ms"] = job.stats.max_late_ms;
+    o["skipped"] = job.stats.skipped;
+    o["deferred"] = job.stats.deferred;
+    o["over_budget"] = job.stats.over_budget;
+    o["avg_us"] = job.stats.runs ? (uint32_t)(job.stats.total_us / job.stats.runs) : 0;
+    o["max_us"] = job.stats.max_us;
+  }
+
+  String response;
+  serializeJson(doc, response);
+  webServer.send(200, "application/json", response);
+}
+
+// Heap profiler handler
+void handleHeapStats() {
+  if (!authenticateRequest()) {
+    requireAuth();
+    return;
+  }
+
+  if (webServer.hasArg("verbose")) {
+    heap_report_verbose = webServer.arg("verbose").toInt() != 0;
+  }
+
+  if (webServer.hasArg("reset")) {
+    heapProfilerReset();
+  }
+
+  // Too large for the loop task stack with a full trend ring
+  DynamicJsonDocument doc(6144);
+  doc["tracking"] = heap_alloc_tracking;
+  doc["verbose"] = heap_report_verbose;
+  doc["free"] = ESP.getFreeHeap();
+  doc["min_free"] = ESP.getMinFreeHeap();
+  doc["largest_block"] = ESP.getMaxAllocHeap();
+  doc["fragmentation"] = getHeapFragmentation();
+
+  JsonObject subsystems = doc.createNestedObject("subsystems");
+  for (uint8_t i = 0; i < HEAP_SUBSYS_COUNT; i++) {
+    JsonObject sub = subsystems.createNestedObject(getHeapSubsystemName(i));
+    sub["allocs"] = heap_subsys[i].allocs;
+    sub["frees"] = heap_subsys[i].frees;
+    sub["bytes"] = heap_subsys[i].bytes;
+  }
+
+  const char *reportNames[] = {"last_packet", "worst_packet", "last_http",
+                               "worst_http"};
+  const HeapReport *reports[] = {&heap_last_packet, &heap_worst_packet,
+                                 &heap_last_http, &heap_worst_http};
+  for (uint8_t i = 0; i < 4; i++) {
+    const HeapReport &r = *reports[i];
+    JsonObject rep = doc.createNestedObject(reportNames[i]);
+    rep["site"] = r.site;
+    rep["age_s"] = r.at_ms ? clockElapsedMs(r.at_ms) / 1000 : 0;
+    rep["allocs"] = r.allocs;
+    rep["bytes"] = r.bytes;
+    rep["free_delta"] = r.free_delta;
+    rep["largest_block"] = r.largest_block;
+    JsonObject by = rep.createNestedObject("by_subsystem");
+    for (uint8_t j = 0; j < HEAP_SUBSYS_COUNT; j++) {
+      if (r.subsys_allocs[j])
+        by[getHeapSubsystemName(j)] = r.subsys_allocs[j];
+    }
+  }
+
+  // Trend samples, oldest first
+  doc["trend_interval_s"] = HEAP_TREND_INTERVAL_MS / 1000;
+  JsonArray trendFree = doc.createNestedArray("trend_free");
+  JsonArray trendLargest = doc.createNestedArray("trend_largest");
+  uint8_t start = (heap_trend_index + HEAP_TREND_SAMPLES - heap_trend_count) %
+                  HEAP_TREND_SAMPLES;
+  for (uint8_t i = 0; i < heap_trend_count; i++) {
+    const HeapSample &hs = heap_trend[(start + i) % HEAP_TREND_SAMPLES];
+    trendFree.add(hs.free_heap);
+    trendLargest.add(hs.largest_block);
+  }
+
+  String response;
+  serializeJson(doc, response);
+  webServer.send(200, "application/json", response);
+}
+
+// Prometheus metrics handler
+void handleMetrics() {
+  if (!authenticateRequest()) {
+    requireAuth();
+    return;
+  }
+
+  String out;
+  out.reserve(8192);
+
+  char line[160];
+  out += F("# TYPE lora_bridge_uptime_seconds gauge\n");
+  snprintf(line, sizeof(line), "lora_bridge_uptime_seconds %lu\n",
+           (unsigned long)clockUptimeSeconds());
+  out += line;
+  out += F("# TYPE lora_bridge_packets_received_total counter\n");
+  snprintf(line, sizeof(line), "lora_bridge_packets_received_total %lu\n",
+           (unsigned long)packets_received);
+  out += line;
+  out += F("# TYPE lora_bridge_active_devices gauge\n");
+  snprintf(line, sizeof(line), "lora_bridge_active_devices %d\n",
+           getActiveDeviceCount());
+  out += line;
+
+  appendHeapProfilerMetrics(out);
+  appendLoopProfilerMetrics(out);
+  appendPipelineMetrics(out);
+  appendEventBusMetrics(out);
+  appendSchedulerMetrics(out);
+  appendLogMetrics(out);
+  appendAirtimeMetrics(out);
+  appendDeviceIntervalMetrics(out);
+  appendNoiseMetrics(out);
+  appendDownlinkMetrics(out);
+  appendAdrMetrics(out);
+  appendRxSchedMetrics(out);
+
+  webServer.send(200, "text/plain; version=0.0.4", out);
+}
+
+// Activity log handler (newest first, streamed one entry at a time)
+void handleActivity() {
+  if (!authenticateRequest()) {
+    requireAuth();
+    return;
+  }
+
+  int limit = MAX_ACTIVITY_LOG;
+  if (webServer.hasArg("limit")) {
+    limit = constrain(webServer.arg("limit").toInt(), 1, MAX_ACTIVITY_LOG);
+  }
+
+  webServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  webServer.send(200, "application/json", "");
+  webServer.sendContent("[");
+
+  char line[256];
+  bool first = true;
+  for (int i = 0; i < activityLogCount && limit > 0; i++) {
+    const ActivityEntry &entry = activityLog[getActivitySlot(i)];
+    if (entry.device == ACTIVITY_NO_DEVICE)
+      continue;
+    limit--;
+
+    StaticJsonDocument<384> doc;
+    char message[64];
+    formatActivity(entry, message, sizeof(message));
+    doc["index"] = getActivitySlot(i);
+    doc["age_s"] = clockElapsedMs(entry.timestamp) / 1000;
+    doc["device"] = getActivityDeviceName(entry);
+    doc["message"] = message;
+    if (entry.fields & ACT_TEMP)
+      doc["t"] = entry.temp_x10 / 10.0f;
+    if (entry.fields & ACT_HUM)
+      doc["hu"] = entry.humidity;
+    if (entry.fields & ACT_BATT)
+      doc["b"] = entry.battery;
+    if (entry.fields & ACT_LUX)
+      doc["l"] = entry.lux;
+    if (entry.fields & ACT_MOTION)
+      doc["m"] = (entry.fields & ACT_MOTION_ON) != 0;
+    if (entry.fields & ACT_CONTACT)
+      doc["c"] = (entry.fields & ACT_CONTACT_CLOSED) != 0;
+
+    size_t n = 0;
+    if (!first)
+      line[n++] = ',';
+    n += serializeJson(doc, line + n, sizeof(line) - n);
+    webServer.sendContent(line, n);
+    first = false;
+  }
+
+  webServer.sendContent("]");
+  webServer.sendContent("");
+}
+
+// Write one journal record as a JSON array element
+static bool sendJournalRecord(const JournalRecord &rec, void *ctx) {
+  bool *first = (bool *)ctx;
+  static const char *const rejectReasons[] = {"", "bad_json", "wrong_key",
+                                              "no_id"};
+
+  StaticJsonDocument<384> doc;
+  doc["seq"] = rec.seq;
+  doc["boot"] = rec.boot;
+  doc["uptime_ms"] = rec.uptime_ms;
+  doc["type"] = getJournalTypeName(rec.type);
+
+  char device[JOURNAL_DEVICE_LEN + 1];
+  memcpy(device, rec.device, JOURNAL_DEVICE_LEN);
+  device[JOURNAL_DEVICE_LEN] = 0;
+  if (device[0])
+    doc["device"] = device;
+
+  char message[64];
+  if (rec.type == JOURNAL_READING) {
+    ActivityEntry entry = {rec.uptime_ms, 0,           rec.detail,  rec.temp_x10,
+                           rec.lux,       rec.humidity, rec.battery};
+    formatActivity(entry, message, sizeof(message));
+    doc["message"] = message;
+    doc["rssi"] = rec.rssi;
+  } else if (rec.type == JOURNAL_BOOT) {
+    doc["reset_reason"] = rec.detail;
+  } else if (rec.type == JOURNAL_REJECTED && rec.detail < 4) {
+    doc["reason"] = rejectReasons[rec.detail];
+  }
+
+  char line[256];
+  size_t n = 0;
+  if (!*first)
+    line[n++] = ',';
+  n += serializeJson(doc, line + n, sizeof(line) - n);
+  webServer.sendContent(line, n);
+  *first = false;
+  return true;
+}
+
+// Flash journal query handler (paged, streamed straight from flash)
+void handleJournal() {
+  if (!authenticateRequest()) {
+    requireAuth();
+    return;
+  }
+
+  if (!journal_available) {
+    webServer.send(503, "application/json",
+                   "{\"error\":\"No journal partition\"}");
+    return;
+  }
+
+  JournalFilter filter = {0, nullptr, 0, -1, 0, UINT32_MAX};
+  if (webServer.hasArg("after")) {
+    filter.after_seq = strtoul(webServer.arg("after").c_str(), nullptr, 10);
+  } else if (webServer.hasArg("last")) {
+    uint32_t last = strtoul(webServer.arg("last").c_str(), nullptr, 10);
+    uint32_t newest = journalNewestSeq();
+    filter.after_seq = newest > last ? newest - last : 0;
+  }
+
+  String device = webServer.arg("device");
+  if (device.length() > 0)
+    filter.device = device.c_str();
+
+  if (webServer.hasArg("type")) {
+    filter.type = getJournalTypeByName(webServer.arg("type").c_str());
+    if (filter.type == 0) {
+      webServer.send(400, "application/json",
+                     "{\"error\":\"Unknown type\"}");
+      return;
+    }
+  }
+
+  if (webServer.hasArg("boot")) {
+    filter.boot = webServer.arg("boot").toInt();
+    if (webServer.hasArg("from_ms"))
+      filter.from_ms = strtoul(webServer.arg("from_ms").c_str(), nullptr, 10);
+    if (webServer.hasArg("to_ms"))
+      filter.to_ms = strtoul(webServer.arg("to_ms").c_str(), nullptr, 10);
+  }
+
+  uint16_t limit = 100;
+  if (webServer.hasArg("limit")) {
+    limit = constrain(webServer.arg("limit").toInt(), 1, 500);
+  }
+
+  webServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  webServer.send(200, "application/json", "");
+
+  char buf[160];
+  snprintf(buf, sizeof(buf),
+           "{\"oldest\":%lu,\"newest\":%lu,\"capacity\":%lu,\"boot\":%u,"
+           "\"records\":[",
+           (unsigned long)journalOldestSeq(), (unsigned long)journalNewestSeq(),
+           (unsigned long)journalCapacity(), journal_boot);
+  webServer.sendContent(buf);
+
+  bool first = true;
+  bool more = false;
+  uint32_t next = journalRead(filter, limit, sendJournalRecord, &first, &more);
+
+  snprintf(buf, sizeof(buf), "],\"next\":%lu,\"more\":%s}",
+           (unsigned long)next, more ? "true" : "false");
+  webServer.sendContent(buf);
+  webServer.sendContent("");
+}
+
+// Raw frame capture status / control handler
+void handleCapture() {
+  if (!authenticateRequest()) {
+    requireAuth();
+    return;
+  }
+
+  if (webServer.hasArg("enable")) {
+    if (!captureEnable(webServer.arg("enable").toInt() != 0)) {
+      webServer.send(503, "application/json", "{\"error\":\"Out of memory\"}");
+      return;
+    }
+    saveSettings();
+  }
+
+  if (webServer.hasArg("clear")) {
+    captureClear();
+  }
+
+  StaticJsonDocument<384> doc;
+  doc["enabled"] = capture_enabled;
+  doc["frames"] = captureCount();
+  doc["capacity"] = CAPTURE_RAM_FRAMES;
+  doc["total"] = capture_total;
+  doc["flash"] = capture_flash_available;
+  doc["flash_used"] = captureFlashUsed();
+  doc["flash_capacity"] = captureFlashCapacity();
+  doc["lost"] = capture_lost;
 
   String response;
   serializeJson(doc, response);
   webServer.send(200, "application/json", response);
 }
 
+static bool sendCaptureLine(const CapturedFrame& frame, void* ctx) {
+  char* line = (char*)ctx;
+  formatCapturedFrame(frame, line, CAPTURE_LINE_MAX);
+  webServer.sendContent(line);
+  return true;
+}
+
+static void sendCaptureChunk(const uint8_t* data, size_t len, void* ctx) {
+  webServer.sendContent((const char*)data, len);
+}
+
+// Captured frames, oldest first: the capture text format (from flash when
+// the partition exists, else the RAM ring), or ?format=bin for the raw
+// flash sectors
+void handleCaptureDownload() {
+  if (!authenticateRequest()) {
+    requireAuth();
+    return;
+  }
+
+  captureFlush();
+  bool binary = webServer.arg("format") == "bin";
+  if (binary && !capture_flash_available) {
+    webServer.send(404, "application/json", "{\"error\":\"No capture partition\"}");
+    return;
+  }
+
+  webServer.sendHeader("Content-Disposition", binary ? "attachment; filename=\"lora-capture.bin\""
+                                                     : "attachment; filename=\"lora-capture.txt\"");
+  webServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  webServer.send(200, binary ? "application/octet-stream" : "text/plain", "");
+
+  if (binary) {
+    captureDumpFlash(sendCaptureChunk, nullptr);
+    webServer.sendContent("");
+    return;
+  }
+
+  char line[CAPTURE_LINE_MAX];
+  formatCaptureHeader(line, sizeof(line));
+  webServer.sendContent(line);
+
+  if (capture_flash_available) {
+    captureReadFlash(sendCaptureLine, line);
+  } else {
+    // Frames overwritten while streaming are skipped
+    CapturedFrame frame;
+    uint16_t count = captureCount();
+    for (uint16_t i = 0; i < count; i++) {
+      if (captureRead(i, frame)) sendCaptureLine(frame, line);
+    }
+  }
+  webServer.sendContent("");
+}
+
 // Clear all activity handler
 void handleClearActivity() {
   if (!authenticateRequest()) {
@@ -1824,8 +3077,7 @@ void handleClearActivity() {
     return;
   }
 
-  activityLogCount = 0;
-  activityLogIndex = 0;
+  clearActivityLog();
 
   StaticJsonDocument<128> doc;
   doc["success"] = true;
@@ -1856,10 +3108,8 @@ void handleRemoveActivity() {
     return;
   }
 
-  int idx = indexStr.toInt();
-
-  // Validate index
-  if (idx < 0 || idx >= MAX_ACTIVITY_LOG) {
+  // Mark entry as removed
+  if (!removeActivity(indexStr.toInt())) {
     doc["success"] = false;
     doc["message"] = "Invalid index";
     String response;
@@ -1868,10 +3118,6 @@ void handleRemoveActivity() {
     return;
   }
 
-  // Mark entry as empty by clearing the device name
-  activityLog[idx].device_name[0] = 0;
-  activityLog[idx].message[0] = 0;
-
   doc["success"] = true;
   doc["message"] = "Activity entry removed";
 
@@ -2097,28 +3343,59 @@ void handleNotFound() {
 }
 
 // ============== Setup Function ==============
+// Register a route whose handler gets a per-request heap report
+static void addRoute(const char *uri, WebServer::THandlerFunction handler) {
+  webServer.on(uri, [uri, handler]() {
+    HeapReportScope heapReport(HEAP_REPORT_HTTP, uri);
+    schedulerNoteActivity();
+    handler();
+  });
+}
+
+static void addRoute(const char *uri, HTTPMethod method,
+                     WebServer::THandlerFunction handler) {
+  webServer.on(uri, method, [uri, handler]() {
+    HeapReportScope heapReport(HEAP_REPORT_HTTP, uri);
+    schedulerNoteActivity();
+    handler();
+  });
+}
+
 void setupWebServer() {
   // Main page
-  webServer.on("/", handleRoot);
-  webServer.on("/favicon.svg", handleFavicon);
-  webServer.on("/favicon.ico", handleFavicon); // Handle both requests
+  addRoute("/", handleRoot);
+  addRoute("/favicon.svg", handleFavicon);
+  addRoute("/favicon.ico", handleFavicon); // Handle both requests
 
   // API endpoints
-  webServer.on("/save", HTTP_POST, handleSave);
-  webServer.on("/reset", HTTP_POST, handleReset);
-  webServer.on("/api/scan", handleScan);
-  webServer.on("/api/test", handleTestDevice);
-  webServer.on("/api/unpair", handleUnpair);
-  webServer.on("/api/rename", handleRenameDevice);
-  webServer.on("/api/remove", handleRemoveDevice);
-  webServer.on("/api/restart", handleRestart);
-  webServer.on("/api/settype", handleSetSensorType);
-  webServer.on("/api/hardware", handleHardwareSettings);
-  webServer.on("/api/activity/clear", handleClearActivity);
-  webServer.on("/api/activity/remove", handleRemoveActivity);
-  webServer.on("/api/auth", handleAuthSettings);
-  webServer.on("/api/mqtt", HTTP_POST, handleMQTTSettings);
-  webServer.on("/api/mqtt/test", handleMQTTTest);
+  addRoute("/save", HTTP_POST, handleSave);
+  addRoute("/reset", HTTP_POST, handleReset);
+  addRoute("/api/scan", handleScan);
+  addRoute("/api/test", handleTestDevice);
+  addRoute("/api/unpair", handleUnpair);
+  addRoute("/api/rename", handleRenameDevice);
+  addRoute("/api/remove", handleRemoveDevice);
+  addRoute("/api/restart", handleRestart);
+  addRoute("/api/settype", handleSetSensorType);
+  addRoute("/api/hardware", handleHardwareSettings);
+  addRoute("/api/activity", handleActivity);
+  addRoute("/api/journal", handleJournal);
+  addRoute("/api/capture", handleCapture);
+  addRoute("/api/capture/download", handleCaptureDownload);
+  addRoute("/api/activity/clear", handleClearActivity);
+  addRoute("/api/activity/remove", handleRemoveActivity);
+  addRoute("/api/auth", handleAuthSettings);
+  addRoute("/api/mqtt", HTTP_POST, handleMQTTSettings);
+  addRoute("/api/mqtt/test", handleMQTTTest);
+  addRoute("/api/loop", handleLoopStats);
+  addRoute("/api/noise", handleNoiseStats);
+  addRoute("/api/adr", handleAdr);
+  addRoute("/api/rxsched", handleRxSchedule);
+  addRoute("/api/heap", handleHeapStats);
+  addRoute("/api/pipeline", handlePipeline);
+  addRoute("/api/events", handleEventBus);
+  addRoute("/api/scheduler", handleScheduler);
+  addRoute("/metrics", handleMetrics);
   webServer.onNotFound(handleNotFound);
   webServer.begin();
 
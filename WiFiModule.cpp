@@ -6,16 +6,19 @@
 #include <WiFi.h>
 #include "hardware/Display.h"
 #include "data/Settings.h"
+#include "core/BootTimeline.h"
+#include "core/Clock.h"
+#include "core/Log.h"
 
 // ============== Global Objects ==============
 DNSServer dnsServer;
 
 // ============== Mode Flags ==============
 bool ap_mode = false;
+bool wifi_connect_pending = false;
 
-// ============== WiFi Reconnection ==============
-unsigned long lastWiFiReconnect = 0;
-#define WIFI_RECONNECT_INTERVAL 30000  // Try to reconnect every 30 seconds
+// ============== Background Connect ==============
+static uint32_t wifi_connect_started = 0;
 
 // ============== WiFi Functions ==============
 bool connectWiFi() {
@@ -44,16 +47,47 @@ bool connectWiFi() {
     if (WiFi.status() == WL_CONNECTED) {
         displayProgress("WiFi", ("Connected: " + WiFi.localIP().toString()).c_str(), 100);
         Serial.printf("[WIFI] Connected: %s\n", WiFi.localIP().toString().c_str());
-        delay(1000);
+        bootDelay(1000);
         return true;
     }
 
     displayMessage("WiFi Failed!", "Could not connect to:", wifi_ssid, "Starting setup mode...");
     Serial.println("[WIFI] Connection failed!");
-    delay(2000);
+    bootDelay(2000);
     return false;
 }
 
+// Start connecting without waiting - poll with pollWiFiConnect() from loop()
+void beginWiFi() {
+    Serial.printf("[WIFI] Connecting to: %s (background)\n", wifi_ssid);
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(wifi_ssid, wifi_password);
+
+    wifi_connect_started = clockMillis();
+    wifi_connect_pending = true;
+}
+
+WiFiConnectState pollWiFiConnect() {
+    if (!wifi_connect_pending) {
+        return WiFi.status() == WL_CONNECTED ? WIFI_CONNECT_OK : WIFI_CONNECT_FAILED;
+    }
+
+    if (WiFi.status() == WL_CONNECTED) {
+        wifi_connect_pending = false;
+        LOG_INFO("[WIFI] Connected: %s (%lu ms)", WiFi.localIP().toString(),
+                 (unsigned long)clockElapsedMs(wifi_connect_started));
+        return WIFI_CONNECT_OK;
+    }
+
+    if (clockElapsedMs(wifi_connect_started) > WIFI_CONNECT_TIMEOUT) {
+        wifi_connect_pending = false;
+        LOG_WARN("[WIFI] Connection failed!");
+        return WIFI_CONNECT_FAILED;
+    }
+
+    return WIFI_CONNECT_PENDING;
+}
+
 void startAPMode() {
     displayProgress("Setup Mode", "Starting AP...", 0);
 
@@ -75,26 +109,17 @@ void startAPMode() {
     Serial.printf("[AP] Started: %s / %s\n", AP_SSID, AP_PASSWORD);
     Serial.printf("[AP] IP: %s\n", WiFi.softAPIP().toString().c_str());
 
-    delay(500);
+    bootDelay(500);
 }
 
 bool attemptWiFiReconnect() {
-    // Only attempt reconnection if:
-    // 1. We're in AP mode
-    // 2. WiFi is configured
-    // 3. Enough time has passed since last attempt
+    // Only attempt reconnection if we're in AP mode and WiFi is configured
+    // (called every WIFI_RECONNECT_INTERVAL by the scheduler)
     if (!ap_mode || strlen(wifi_ssid) == 0) {
         return false;
     }
 
-    unsigned long now = millis();
-    if (now - lastWiFiReconnect < WIFI_RECONNECT_INTERVAL) {
-        return false;
-    }
-
-    lastWiFiReconnect = now;
-
-    Serial.println("[WIFI] Attempting reconnection...");
+    LOG_INFO("[WIFI] Attempting reconnection...");
 
     // Try to connect to WiFi (shorter timeout than initial connection)
     WiFi.mode(WIFI_STA);
@@ -103,12 +128,10 @@ bool attemptWiFiReconnect() {
     int timeout = 20; // 10 seconds (20 * 500ms)
     while (WiFi.status() != WL_CONNECTED && timeout-- > 0) {
         delay(500);
-        Serial.print(".");
     }
-    Serial.println();
 
     if (WiFi.status() == WL_CONNECTED) {
-        Serial.printf("[WIFI] Reconnected: %s\n", WiFi.localIP().toString().c_str());
+        LOG_INFO("[WIFI] Reconnected: %s", WiFi.localIP().toString());
 
         // Stop AP mode
         dnsServer.stop();
@@ -118,7 +141,7 @@ bool attemptWiFiReconnect() {
     }
 
     // Reconnection failed, restart AP mode
-    Serial.println("[WIFI] Reconnection failed, resuming AP mode...");
+    LOG_WARN("[WIFI] Reconnection failed, resuming AP mode...");
     WiFi.mode(WIFI_AP);
     WiFi.softAP(AP_SSID, AP_PASSWORD);
     dnsServer.start(DNS_PORT, "*", WiFi.softAPIP());
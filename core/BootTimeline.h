@@ -0,0 +1,50 @@
+/*
+ * BootTimeline.h - Boot Phase Timeline and Fast-Boot Mode
+ * Timestamps each startup phase so slow boots can be traced
+ */
+
+#ifndef BOOT_TIMELINE_H
+#define BOOT_TIMELINE_H
+
+#include <Arduino.h>
+
+// ============== Boot Phases ==============
+enum BootPhase : uint8_t {
+    BOOT_PHASE_DISPLAY = 0,   // OLED init + splash
+    BOOT_PHASE_SETTINGS,      // NVS settings + saved devices
+    BOOT_PHASE_LORA,          // Radio init, packets accepted once this ends
+    BOOT_PHASE_WIFI,          // STA connect attempt
+    BOOT_PHASE_AP,            // Setup-mode access point (only on WiFi failure)
+    BOOT_PHASE_HOMEKIT,       // HomeSpan + accessory creation
+    BOOT_PHASE_WEB,           // Web server start
+    BOOT_PHASE_MQTT,          // MQTT init + first connect
+    BOOT_PHASE_COUNT
+};
+
+struct BootPhaseTime {
+    uint32_t start_ms;
+    uint32_t end_ms;
+    bool started;
+    bool done;
+};
+
+// ============== Timeline State ==============
+extern BootPhaseTime boot_phases[BOOT_PHASE_COUNT];
+extern uint32_t boot_complete_ms;     // 0 until all startup work has finished
+extern bool fast_boot;                // Persisted in NVS
+
+// ============== Timeline Functions ==============
+void bootPhaseBegin(BootPhase phase);
+void bootPhaseEnd(BootPhase phase);
+void bootComplete();
+bool isBootComplete();
+
+const char* getBootPhaseName(uint8_t phase);
+uint32_t getBootPhaseDuration(uint8_t phase);
+
+// Cosmetic wait (splash screens, "Ready!" messages) - skipped in fast-boot mode
+void bootDelay(uint32_t ms);
+
+void printBootTimeline();
+
+#endif // BOOT_TIMELINE_H
@@ -0,0 +1,62 @@
+/*
+ * Clock.h - Injectable Time Source
+ * Every timeout, rate limit and interval in the bridge reads the time
+ * through here rather than calling millis()/micros() directly, so host
+ * tools can pin or fast-forward it. Timestamps are uint32_t on every
+ * target and elapsed times are always taken as a 32-bit difference, which
+ * stays correct across the millis() wrap (~49.7 days) and the micros()
+ * wrap (~71.6 minutes) as long as the interval itself is shorter. Uptime
+ * can be longer, so it is kept on the 64-bit microsecond count.
+ */
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <Arduino.h>
+
+// ============== Sources ==============
+typedef uint32_t (*ClockReadFn)();
+typedef uint64_t (*ClockRead64Fn)();
+
+struct ClockSource {
+    const char* name;
+    ClockReadFn millis;
+    ClockReadFn micros;
+    ClockRead64Fn micros64;              // Never wraps
+};
+
+extern const ClockSource clock_system;   // Arduino millis()/micros(), esp_timer_get_time()
+extern const ClockSource clock_virtual;  // Stands still until clockVirtualAdvance()
+extern const ClockSource* clock_source;
+
+// nullptr selects clock_system
+void setClockSource(const ClockSource* source);
+
+// ============== Virtual Clock ==============
+// Deterministic time for host tools and timing tests: only these calls
+// move it (delay() does not), so a test decides exactly when deadlines and
+// timeouts come due. Kept as 64-bit microseconds; both reads wrap like
+// the hardware counters do.
+void clockVirtualSet(uint64_t us);
+void clockVirtualAdvance(uint64_t us);
+uint64_t clockVirtualMicros();
+
+// ============== Reading the Time ==============
+inline uint32_t clockMillis() { return clock_source->millis(); }
+inline uint32_t clockMicros() { return clock_source->micros(); }
+inline uint64_t clockMicros64() { return clock_source->micros64(); }
+
+// Time since a timestamp taken from the same clock (wrap-safe)
+inline uint32_t clockElapsedMs(uint32_t since_ms) { return clockMillis() - since_ms; }
+inline uint32_t clockElapsedUs(uint32_t since_us) { return clockMicros() - since_us; }
+
+// Deadline reached (wrap-safe for deadlines less than ~24.8 days away)
+inline bool clockReached(uint32_t deadline_ms, uint32_t now_ms) {
+    return (int32_t)(now_ms - deadline_ms) >= 0;
+}
+
+// ============== Uptime ==============
+void clockMarkBoot();                    // Called once from setup()
+uint32_t clockUptimeSeconds();           // 64-bit underneath: no wrap at 49.7 days
+
+#endif // CLOCK_H
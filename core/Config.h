@@ -29,12 +29,32 @@
 // ============== Configuration ==============
 #define MAX_DEVICES 20
 #define NVS_NAMESPACE "lora_hk"
-#define DEVICE_TIMEOUT_MS (60 * 60 * 1000)
+#define DEVICE_TIMEOUT_MS (60 * 60 * 1000)        // Until a device's interval is learned
+#define DEVICE_MISSED_INTERVALS 3                 // Learned: offline after this many missed reports
+#define DEVICE_TIMEOUT_MIN_MS (2 * 60 * 1000)
+#define DEVICE_TIMEOUT_MAX_MS (24UL * 60 * 60 * 1000)
+#define DEVICE_INTERVAL_MIN_SAMPLES 3             // Intervals before the learned timeout applies
+#define DEVICE_INTERVAL_SAVE_MS (15 * 60 * 1000)  // Changed intervals are written to NVS
+#define LAST_EVENT_LEN 32           // Status line shown on the OLED
 
+#define WIFI_CONNECT_TIMEOUT 15000     // Background connect; same limit as the blocking connect
+#define WIFI_RECONNECT_INTERVAL 30000  // AP mode: try the configured network every 30 seconds
 #define AP_SSID "LoRa-Bridge-Setup"
 #define AP_PASSWORD "12345678"
 #define DNS_PORT 53
 
+// Count heap allocations per subsystem (needs an ESP-IDF build with
+// CONFIG_HEAP_USE_HOOKS, e.g. Arduino core 3.x with a custom sdkconfig)
+// #define HEAP_PROFILER_HOOKS
+
+// Log lines above LOG_LEVEL are compiled out (0 off, 1 error, 2 warn,
+// 3 info, 4 debug). LOG_BINARY sends compact frames over Serial instead of
+// text; decode them with bridge_logdecode from the host build.
+#ifndef LOG_LEVEL
+#define LOG_LEVEL 3
+#endif
+// #define LOG_BINARY
+
 // Default settings
 #define DEFAULT_WIFI_SSID ""
 #define DEFAULT_WIFI_PASSWORD ""
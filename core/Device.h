@@ -9,13 +9,35 @@
 #include <HomeSpan.h>
 #include "Config.h"
 
+// ============== Reporting Interval ==============
+// Learned online from inter-arrival times, like a TCP retransmission timer:
+// a smoothed period and its mean deviation, each moved 1/8 of the way
+// towards every new sample. A gap of about k periods counts as k-1 missed
+// reports and teaches the period gap/k. Gaps under half a period are
+// event-driven reports (motion, contact) and teach nothing. Deviations are
+// clamped, so one outlier moves the estimate a bounded amount.
+struct DeviceInterval {
+    uint32_t period_ms;    // 0 until the first interval
+    uint32_t jitter_ms;    // Mean absolute deviation from period_ms
+    uint8_t samples;       // Intervals learned from (saturates at 255)
+    bool heard;            // Reported since boot; intervals start here
+    uint32_t expected;     // Reports predicted since boot, missed ones included
+    uint32_t on_time;      // Of those, arrived within the tolerance
+    uint32_t candidate_ms; // Off-period gap seen repeatedly: the period may have changed
+    uint8_t candidate_count;
+};
+
 // ============== Device Structure ==============
 struct Device {
     char id[32];           // Original device ID from LoRa
     char name[32];         // Custom display name (can be renamed)
     bool active;
+    uint32_t seq;          // Snapshot version, odd while a reading is written
     int rssi;
-    unsigned long last_seen;
+    uint32_t last_seen;
+    bool offline;          // Silent past deviceOfflineTimeout() (not persisted)
+    DeviceInterval interval;   // Learned period persisted separately, counters not
+    uint32_t interval_saved_ms;   // period_ms as last written to NVS (loop task only)
 
     bool has_temp;
     bool has_hum;
@@ -46,6 +68,52 @@ struct Device {
     SpanCharacteristic* nameChar;  // For updating name in HomeKit
 };
 
+// ============== Device Reading ==============
+// One decoded sensor packet. Passed by value between the ingest and fan-out
+// stages, so sinks see the values of this packet even if a newer one has
+// already been applied to the Device.
+struct DeviceReading {
+    char id[32];
+    uint8_t fields;        // ActivityField bits (data/ActivityLog.h)
+    bool synthetic;        // Pipeline load generator, kept out of the journal
+    int rssi;
+    float temperature;
+    float humidity;
+    int battery;
+    int lux;
+};
+
+// ============== Device Snapshots ==============
+// rssi, last_seen, interval and the sensor values are written by the ingest stage,
+// which is its own task on core 0 in dual-core mode. They are guarded by a
+// per-device sequence lock: writers make 'seq' odd for the duration of the
+// update, and readers on other tasks copy the fields and retry if the
+// sequence was odd or changed meanwhile. Readers never block the writer.
+struct DeviceSnapshot {
+    uint32_t seq;          // Version the copy was taken at (always even)
+    int rssi;
+    uint32_t last_seen;
+    float temperature;
+    float humidity;
+    int battery;
+    int lux;
+    bool motion;
+    bool contact;
+    DeviceInterval interval;
+};
+
+#define DEVICE_SNAPSHOT_SPINS 64   // Retries before a reader yields
+
+extern uint32_t device_snapshot_retries;   // Reads that overlapped a write
+
+// Bracket every write of the guarded fields. Writers on different tasks
+// exclude each other (registration applies a first reading from loop()).
+void deviceWriteBegin(Device* dev);
+void deviceWriteEnd(Device* dev);
+
+// Consistent copy of the guarded fields
+void snapshotDevice(const Device* dev, DeviceSnapshot& out);
+
 // ============== Global Device Array ==============
 extern Device devices[MAX_DEVICES];
 extern int device_count;
@@ -63,4 +131,20 @@ const char* getMotionTypeName(uint8_t type);
 // Find device by ID
 Device* findDevice(const char* id);
 
+// ============== Reporting Interval Functions ==============
+// Learn from a report arriving at 'now' (inside deviceWriteBegin/End)
+void deviceIntervalObserve(DeviceInterval& iv, uint32_t last_seen, uint32_t now);
+
+// Silence after which the device is offline: DEVICE_MISSED_INTERVALS
+// periods plus four deviations once learned, else DEVICE_TIMEOUT_MS
+uint32_t deviceOfflineTimeout(const DeviceInterval& iv);
+
+// Milliseconds until the next report is due (negative if overdue), and the
+// share of predicted reports that arrived on time (-1 before any)
+int32_t deviceNextReportIn(const DeviceInterval& iv, uint32_t last_seen);
+float deviceOnTimeRatio(const DeviceInterval& iv);
+
+// Append Prometheus text-format metrics for each device's interval
+void appendDeviceIntervalMetrics(String& out);
+
 #endif // DEVICE_H
@@ -0,0 +1,106 @@
+/*
+ * EventBus.h - Device Event Bus
+ * Typed publish/subscribe for device-layer events. Publishing only copies
+ * the event into each subscriber's queue; sinks run later from
+ * eventBusDispatch() in priority order, so a slow sink delays nobody else.
+ * Publish and dispatch both run on the loop task.
+ */
+
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "Device.h"
+
+#define EVENT_BUS_MAX_SINKS 8
+#define EVENT_SINK_BUDGET 4             // Events each sink handles per dispatch
+
+// ============== Events ==============
+enum DeviceEventType : uint8_t {
+    DEVICE_EVENT_READING = 0,
+    DEVICE_EVENT_REGISTERED,
+    DEVICE_EVENT_REMOVED,
+    DEVICE_EVENT_RENAMED,
+    DEVICE_EVENT_AVAILABILITY,          // 'online' says which way
+    DEVICE_EVENT_TYPE_COUNT
+};
+
+#define DEVICE_EVENT_BIT(type) (1 << (type))
+#define DEVICE_EVENTS_ALL ((1 << DEVICE_EVENT_TYPE_COUNT) - 1)
+
+struct DeviceEvent {
+    uint8_t type;                       // DeviceEventType
+    uint8_t device;                     // Index into devices[]
+    bool online;                        // AVAILABILITY only
+    uint32_t at_ms;                     // millis() when published
+    DeviceReading reading;              // Values for READING; id is set for every type
+};
+
+// ============== Sinks ==============
+// What a full queue does with an incoming reading. Lifecycle events
+// (everything but READING) are never coalesced and always evict the oldest
+// queued reading; they are only dropped when the queue holds nothing else.
+enum EventDropPolicy : uint8_t {
+    EVENT_DROP_OLDEST = 0,              // Evict the oldest queued reading
+    EVENT_DROP_NEWEST,                  // Discard the incoming reading
+    EVENT_COALESCE,                     // Merge into the device's queued reading, else drop oldest
+    EVENT_POLICY_COUNT
+};
+
+typedef void (*DeviceEventHandler)(const DeviceEvent& ev);
+
+struct EventSinkStats {
+    uint32_t delivered;
+    uint32_t dropped;
+    uint32_t coalesced;
+    uint32_t high_water;                // Deepest queue occupancy seen
+    uint32_t max_us;                    // Longest single handler call
+    uint64_t total_us;
+};
+
+struct EventSink {
+    const char* name;
+    DeviceEventHandler handler;
+    uint8_t mask;                       // DEVICE_EVENT_BIT()s to receive
+    uint8_t priority;                   // Higher runs first
+    uint8_t policy;                     // EventDropPolicy
+    DeviceEvent* queue;                 // Storage owned by the subscriber
+    uint8_t capacity;
+    uint8_t head;                       // Oldest queued event
+    uint8_t count;
+    EventSinkStats stats;
+};
+
+extern EventSink event_sinks[EVENT_BUS_MAX_SINKS];   // Sorted by priority
+extern uint8_t event_sink_count;
+
+// ============== Bus Functions ==============
+// Register a sink with its own queue. Subscribing the same name again is a
+// no-op, so module init functions can be called more than once.
+bool eventBusSubscribe(const char* name, DeviceEventHandler handler, uint8_t mask,
+                       uint8_t priority, EventDropPolicy policy,
+                       DeviceEvent* queue, uint8_t capacity);
+
+// Fill in type/device/id/timestamp for 'dev' (reading values left zero)
+void initDeviceEvent(DeviceEvent& ev, DeviceEventType type, const Device* dev);
+
+void eventBusPublish(const DeviceEvent& ev);
+
+// The device an event was published for, or nullptr if it has been removed
+// since (its slot may already hold a new device)
+Device* getEventDevice(const DeviceEvent& ev);
+
+// Run queued events through their sinks (called from loop())
+void eventBusDispatch();
+
+size_t eventBusPending();
+void eventBusResetStats();
+
+const char* getDeviceEventTypeName(uint8_t type);
+const char* getEventPolicyName(uint8_t policy);
+
+// Append Prometheus text-format metrics for the event bus
+void appendEventBusMetrics(String& out);
+
+#endif // EVENT_BUS_H
@@ -0,0 +1,57 @@
+/*
+ * FixedString.h - Fixed-Capacity String Builder
+ * Stack/static replacement for String on paths that must not allocate.
+ * Appends past the capacity are truncated, never reallocated.
+ */
+
+#ifndef FIXED_STRING_H
+#define FIXED_STRING_H
+
+#include <Arduino.h>
+#include <stdarg.h>
+
+template <size_t N>
+class FixedString {
+public:
+    FixedString() : len_(0) { buf_[0] = 0; }
+    FixedString(const char* s) : len_(0) { buf_[0] = 0; append(s); }
+
+    FixedString& operator=(const char* s) {
+        clear();
+        return append(s);
+    }
+
+    void clear() {
+        len_ = 0;
+        buf_[0] = 0;
+    }
+
+    FixedString& append(const char* s) {
+        while (*s && len_ < N - 1) {
+            buf_[len_++] = *s++;
+        }
+        buf_[len_] = 0;
+        return *this;
+    }
+
+    FixedString& appendf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+        va_list ap;
+        va_start(ap, fmt);
+        int n = vsnprintf(buf_ + len_, N - len_, fmt, ap);
+        va_end(ap);
+        if (n > 0) {
+            len_ += (size_t)n < N - 1 - len_ ? (size_t)n : N - 1 - len_;
+        }
+        return *this;
+    }
+
+    const char* c_str() const { return buf_; }
+    size_t length() const { return len_; }
+    static constexpr size_t capacity() { return N - 1; }
+
+private:
+    char buf_[N];
+    size_t len_;
+};
+
+#endif // FIXED_STRING_H
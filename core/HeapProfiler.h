@@ -0,0 +1,120 @@
+/*
+ * HeapProfiler.h - Heap Allocation Profiler
+ * Attributes allocations to subsystems, reports per packet and per HTTP
+ * request, and keeps a free-heap / largest-block trend for fragmentation
+ */
+
+#ifndef HEAP_PROFILER_H
+#define HEAP_PROFILER_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+// Per-allocation counts need allocator hooks (HEAP_PROFILER_HOOKS in Config.h
+// on the device, malloc wrappers in a host build). Without them only
+// free-heap and largest-block deltas are reported.
+
+// ============== Subsystems ==============
+enum HeapSubsystem : uint8_t {
+    HEAP_SUBSYS_OTHER = 0,    // Loop code outside any scope
+    HEAP_SUBSYS_LORA,         // Packet receive, decrypt, JSON parse
+    HEAP_SUBSYS_DEVICE,       // Register/update devices, activity log
+    HEAP_SUBSYS_HOMEKIT,      // homeSpan.poll() and accessory changes
+    HEAP_SUBSYS_MQTT,         // Topics, payloads, discovery
+    HEAP_SUBSYS_WEB,          // Request parsing and handlers
+    HEAP_SUBSYS_DISPLAY,      // OLED status rendering
+    HEAP_SUBSYS_TASKS,        // Other FreeRTOS tasks (WiFi, lwIP, HomeSpan, ingest)
+    HEAP_SUBSYS_COUNT
+};
+
+#define HEAP_TREND_SAMPLES 72           // 6 hours at the default interval
+#define HEAP_TREND_INTERVAL_MS 300000   // 5 minutes
+
+struct HeapCounters {
+    uint32_t allocs;
+    uint32_t frees;
+    uint64_t bytes;           // Total bytes requested
+};
+
+struct HeapReport {
+    char site[24];            // URI or device ID
+    uint32_t at_ms;
+    uint32_t allocs;
+    uint32_t bytes;
+    int32_t free_delta;       // Free heap after minus before (negative = retained)
+    uint32_t largest_block;   // Largest free block afterwards
+    uint16_t subsys_allocs[HEAP_SUBSYS_COUNT];
+};
+
+struct HeapSample {
+    uint32_t free_heap;
+    uint32_t largest_block;
+};
+
+enum HeapReportKind : uint8_t {
+    HEAP_REPORT_PACKET = 0,
+    HEAP_REPORT_HTTP
+};
+
+// ============== Profiler State ==============
+extern HeapCounters heap_subsys[HEAP_SUBSYS_COUNT];
+extern volatile uint8_t heap_current_subsys;
+extern bool heap_alloc_tracking;        // True once an allocator hook has fired
+extern bool heap_report_verbose;        // Print every packet/request report
+extern HeapReport heap_last_packet, heap_worst_packet;
+extern HeapReport heap_last_http, heap_worst_http;
+extern HeapSample heap_trend[HEAP_TREND_SAMPLES];
+extern uint8_t heap_trend_count;
+extern uint8_t heap_trend_index;
+
+// ============== Scopes ==============
+// Scopes only apply on the loop task; allocations made by other tasks are
+// charged to HEAP_SUBSYS_TASKS, so a scope there is a no-op
+bool heapProfilerOnLoopTask();
+
+// Tags allocations made while in scope with a subsystem (nests)
+class HeapScope {
+public:
+    explicit HeapScope(HeapSubsystem subsys)
+        : active_(heapProfilerOnLoopTask()), prev_(heap_current_subsys) {
+        if (active_) heap_current_subsys = subsys;
+    }
+    ~HeapScope() {
+        if (active_) heap_current_subsys = prev_;
+    }
+
+private:
+    bool active_;
+    uint8_t prev_;
+};
+
+// Snapshots the counters and free heap, then records a HeapReport on exit
+class HeapReportScope {
+public:
+    HeapReportScope(HeapReportKind kind, const char* site);
+    ~HeapReportScope();
+    void setSite(const char* site);
+
+private:
+    bool active_;
+    HeapReportKind kind_;
+    char site_[24];
+    uint32_t free_before_;
+    HeapCounters before_[HEAP_SUBSYS_COUNT];
+};
+
+// ============== Profiler Functions ==============
+void heapProfilerInit();
+void heapProfilerReset();
+void heapProfilerSample();              // Append a trend sample
+
+// Allocator hook entry points
+void heapProfilerRecordAlloc(size_t size, uint8_t subsys);
+void heapProfilerRecordFree(uint8_t subsys);
+
+const char* getHeapSubsystemName(uint8_t subsys);
+uint8_t getHeapFragmentation();         // 0-100 %, 100 - largest/free
+
+void appendHeapProfilerMetrics(String& out);
+
+#endif // HEAP_PROFILER_H
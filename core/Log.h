@@ -0,0 +1,170 @@
+/*
+ * Log.h - Deferred Logging
+ * LOG_ERROR/LOG_WARN/LOG_INFO/LOG_DEBUG() store the format string's address
+ * and the raw arguments in a RAM ring. Nothing is formatted or written to
+ * the UART on the calling task. A record landing in an empty ring wakes the
+ * loop, which drains the ring (logService()); while the UART is full a
+ * one-shot "log" job retries, so an idle bridge is not woken for logging.
+ * Output is either the same text lines Serial.printf() gave or, with LOG_BINARY,
+ * as compact frames that bridge_logdecode (host/LogDecode.cpp) turns back
+ * into text. Lines above LOG_LEVEL (Config.h) compile to nothing, arguments
+ * included.
+ *
+ * Formats take printf conversions. Arguments are stored with their type, so
+ * a mismatched conversion prints the value converted rather than garbage.
+ * %s also prints a logBytes() argument as hex. Lines still printed with
+ * Serial directly are not queued and can overtake earlier log lines.
+ */
+
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+#include <type_traits>
+#include "Config.h"
+
+#define LOG_LEVEL_OFF 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#define LOG_RING_SIZE 4096             // Queued records, bytes (power of two)
+#define LOG_RECORD_MAX 176             // Header plus encoded arguments
+#define LOG_STR_MAX 64                 // Longer %s arguments are cut
+#define LOG_BYTES_MAX 64               // Longer byte dumps are cut
+#define LOG_LINE_MAX 256               // Formatted line, text output
+#define LOG_DRAIN_MS 10                // Retry while the UART is full
+#define LOG_UART_TX_BUFFER 1024        // Serial TX buffer, so a drain never waits on the FIFO
+#define LOG_MAX_FORMATS 64             // Format ids the binary drain keeps
+#define LOG_FORMAT_REFRESH_MS 60000    // Re-send format definitions so a late reader catches up
+
+// ============== Wire Format (LOG_BINARY) ==============
+// Frame: LOG_SYNC_0, LOG_SYNC_1, type, payload length, payload, checksum
+// (one's complement of the 8-bit sum of type, length and payload). Bytes
+// outside valid frames are plain Serial text and are passed through.
+#define LOG_SYNC_0 0xA5
+#define LOG_SYNC_1 0x5A
+
+enum LogFrameType : uint8_t {
+    LOG_FRAME_FORMAT = 1,              // id (u16), format string
+    LOG_FRAME_RECORD,                  // id (u16), level, ms (u32), argc, arguments
+    LOG_FRAME_DROPPED                  // records lost to a full ring (u32)
+};
+
+// Each argument is a type byte and its little-endian value
+enum LogArgType : uint8_t {
+    LOG_ARG_INT = 1,                   // int32
+    LOG_ARG_UINT,                      // uint32
+    LOG_ARG_INT64,
+    LOG_ARG_UINT64,
+    LOG_ARG_DOUBLE,                    // float arguments are promoted
+    LOG_ARG_STR,                       // length (u8), bytes
+    LOG_ARG_BYTES                      // length (u8), bytes; hex with %s
+};
+
+// ============== Records ==============
+struct LogBytes {
+    const uint8_t* data;
+    size_t len;
+};
+
+inline LogBytes logBytes(const void* data, size_t len) {
+    return LogBytes{(const uint8_t*)data, len};
+}
+
+// Builds one record's argument block on the caller's stack
+class LogEncoder {
+public:
+    uint8_t args[LOG_RECORD_MAX];
+    size_t len = 0;
+    uint8_t argc = 0;
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+    void put(T v) {
+        if (sizeof(T) > 4) {
+            uint64_t x = (uint64_t)v;
+            putValue(std::is_signed<T>::value ? LOG_ARG_INT64 : LOG_ARG_UINT64, &x, 8);
+        } else {
+            uint32_t x = (uint32_t)v;
+            putValue(std::is_signed<T>::value ? LOG_ARG_INT : LOG_ARG_UINT, &x, 4);
+        }
+    }
+    template <typename T, typename std::enable_if<std::is_enum<T>::value, int>::type = 0>
+    void put(T v) { put((int)v); }
+    void put(double v) { putValue(LOG_ARG_DOUBLE, &v, 8); }
+    void put(const char* s) { putBlob(LOG_ARG_STR, s ? s : "(null)", s ? strlen(s) : 6, LOG_STR_MAX); }
+    void put(const String& s) { putBlob(LOG_ARG_STR, s.c_str(), s.length(), LOG_STR_MAX); }
+    void put(const LogBytes& b) { putBlob(LOG_ARG_BYTES, b.data, b.len, LOG_BYTES_MAX); }
+    void put(const void* p) { put((uint64_t)(uintptr_t)p); }
+
+private:
+    void putValue(uint8_t type, const void* value, size_t n);
+    void putBlob(uint8_t type, const void* data, size_t n, size_t max);
+};
+
+// ============== Statistics ==============
+struct LogStats {
+    uint32_t records;                  // Queued
+    uint32_t dropped;                  // Lost to a full ring
+    uint32_t high_water;               // Most bytes queued at once
+    uint64_t bytes_out;                // Written to Serial by the drain
+};
+
+extern LogStats log_stats;
+
+// ============== Log Functions ==============
+void logCommit(uint8_t level, const char* fmt, const LogEncoder& enc);
+
+template <typename... Args>
+inline void logWrite(uint8_t level, const char* fmt, const Args&... args) {
+    LogEncoder enc;
+    int expand[] = {0, (enc.put(args), 0)...};
+    (void)expand;
+    logCommit(level, fmt, enc);
+}
+
+// Drain from loop() if records were queued since the last drain
+void logService();
+// Write queued records as long as the UART has room; re-arms itself as a
+// one-shot job while records remain
+void logDrain();
+// Write everything queued, waiting on the UART (before a restart)
+void logFlush();
+
+// Format a record's arguments as printf would. Shared with the host
+// decoder; 'args' is the encoded argument block. Returns the text length.
+size_t logFormat(char* out, size_t size, const char* fmt, const uint8_t* args, size_t len,
+                 uint8_t argc);
+
+const char* getLogLevelName(uint8_t level);
+
+// Append Prometheus text-format metrics for the log ring
+void appendLogMetrics(String& out);
+
+// ============== Macros ==============
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(fmt, ...) logWrite(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(fmt, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(fmt, ...) logWrite(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#else
+#define LOG_WARN(fmt, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(fmt, ...) logWrite(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#else
+#define LOG_INFO(fmt, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(fmt, ...) logWrite(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(fmt, ...) do {} while (0)
+#endif
+
+#endif // LOG_H
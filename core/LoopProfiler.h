@@ -0,0 +1,73 @@
+/*
+ * LoopProfiler.h - Main Loop Latency Profiler
+ * Per-section duration histograms, stall attribution and budget tracking
+ */
+
+#ifndef LOOP_PROFILER_H
+#define LOOP_PROFILER_H
+
+#include <Arduino.h>
+
+// ============== Loop Sections ==============
+// One entry per step of loop(), in call order
+enum LoopSection : uint8_t {
+    LOOP_SECTION_WIFI = 0,    // DNS captive portal + WiFi reconnect
+    LOOP_SECTION_LORA,        // pipelineLoop(): packet ingest and/or fan-out
+    LOOP_SECTION_EVENTS,      // eventBusDispatch()
+    LOOP_SECTION_HOMESPAN,    // homeSpan.poll()
+    LOOP_SECTION_WEB,         // webServer.handleClient()
+    LOOP_SECTION_MQTT,        // loopMQTT()
+    LOOP_SECTION_OLED,        // checkOledTimeout()
+    LOOP_SECTION_JOBS,        // schedulerRun(): display, diagnostics, reconnects
+    LOOP_SECTION_LED,         // LED enforcement
+    LOOP_SECTION_COUNT
+};
+
+// Histogram bucket b counts durations <= 2^b us (and above the previous
+// bucket). The last bucket is unbounded and catches everything over ~1 s.
+#define LOOP_HIST_BUCKETS 22
+
+#define DEFAULT_LOOP_BUDGET_MS 50        // Iterations longer than this are stalls
+#define LOOP_PROFILE_REPORT_MS 300000    // Serial summary interval (5 minutes)
+
+// ============== Statistics ==============
+struct LoopSectionStats {
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t total_us;
+    uint32_t culprit;                    // Over-budget iterations this section dominated
+    uint32_t hist[LOOP_HIST_BUCKETS];
+};
+
+struct LoopStall {
+    uint32_t total_us;                   // Whole iteration duration
+    uint32_t section_us;                 // Time spent in the culprit section
+    uint8_t section;                     // LoopSection that took longest
+    uint32_t at_ms;                      // millis() when the iteration ended
+};
+
+extern LoopSectionStats loop_sections[LOOP_SECTION_COUNT];
+extern LoopSectionStats loop_total;
+extern LoopStall loop_worst_stall;
+extern LoopStall loop_last_stall;        // Most recent over-budget iteration
+extern uint32_t loop_over_budget;
+extern uint16_t loop_budget_ms;          // Persisted in NVS
+
+// ============== Profiler Functions ==============
+void loopProfilerStart();
+void loopProfilerMark(LoopSection section);
+void loopProfilerEnd();
+void loopProfilerReset();
+
+const char* getLoopSectionName(uint8_t section);
+
+// Approximate percentile (upper bound of the matching histogram bucket)
+uint32_t loopProfilerPercentile(const LoopSectionStats& stats, uint8_t pct);
+
+// Print the periodic summary to Serial
+void printLoopProfile();
+
+// Append Prometheus text-format metrics for the loop profiler
+void appendLoopProfilerMetrics(String& out);
+
+#endif // LOOP_PROFILER_H
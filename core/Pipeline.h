@@ -0,0 +1,111 @@
+/*
+ * Pipeline.h - Packet Ingest / Fan-Out Pipeline
+ * Ingest (radio, decrypt, parse, device state) feeds fan-out (registration
+ * and publishing to the event bus). In dual-core mode ingest runs on its own
+ * task on core 0 and hands events to loop() on core 1 through a bounded
+ * lock-free queue; in single-core mode both stages run inline in loop().
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "Device.h"
+#include "Scheduler.h"
+
+#define PIPELINE_QUEUE_DEPTH 32         // Fan-out queue slots (power of two)
+#define PIPELINE_INGEST_CORE 0          // loop() runs on core 1
+#define PIPELINE_TASK_STACK 6144
+#define PIPELINE_TASK_PRIORITY 2
+#define PIPELINE_DRAIN_MAX 8            // Events fanned out per loop() iteration
+#define PIPELINE_BLOCK_MS 50            // Longest ingest wait under PIPELINE_BLOCK
+#define PIPELINE_IDLE_MS 1000           // Ingest wakes at least this often without interrupts
+
+#define PIPELINE_GEN_MAX_RATE 500       // Synthetic packets per second
+#define PIPELINE_GEN_MAX_SECONDS 60
+
+// ============== Events ==============
+enum PipelineEventKind : uint8_t {
+    PIPELINE_EVENT_READING = 1,
+    PIPELINE_EVENT_REJECTED           // reject_reason says why
+};
+
+struct PipelineEvent {
+    uint8_t kind;                     // PipelineEventKind
+    uint8_t reject_reason;            // JournalRejectReason
+    bool applied;                     // Reading already stored in the device table
+    uint32_t ingest_us;               // micros() when the packet was picked up
+    DeviceReading reading;            // id only for rejected packets
+};
+
+// What ingest does when the fan-out queue is full
+enum PipelineBackpressure : uint8_t {
+    PIPELINE_DROP_NEWEST = 0,         // Discard the new event, keep polling the radio
+    PIPELINE_BLOCK,                   // Wait up to PIPELINE_BLOCK_MS, then discard
+    PIPELINE_POLICY_COUNT
+};
+
+// ============== Statistics ==============
+// Each field has a single writer: ingest counters are written by the ingest
+// stage, fan-out counters by loop()
+struct PipelineStats {
+    uint32_t ingested;                // Events produced by ingest
+    uint32_t fanned_out;              // Events consumed by fan-out
+    uint32_t dropped;                 // Discarded because the queue was full
+    uint32_t blocked;                 // Times ingest had to wait for space
+    uint32_t high_water;              // Deepest queue occupancy seen
+    uint32_t max_latency_us;          // Longest pickup -> fan-out complete
+    uint64_t ingest_us;               // Total time spent in each stage
+    uint64_t fanout_us;
+};
+
+// Synthetic load run: offered = generated + overrun, lost = offered - delivered
+struct PipelineRun {
+    volatile bool running;            // Generator still producing
+    bool reported;                    // Summary printed
+    bool dual_core;                   // Mode the run was measured in
+    uint16_t rate_hz;
+    uint16_t seconds;
+    uint32_t started_ms;
+    uint32_t generated;               // Packets handed to ingest
+    uint32_t overrun;                 // Packets a real radio would have lost while ingest was busy
+    uint32_t dropped;                 // Lost to a full fan-out queue
+    uint32_t delivered;               // Fanned out
+    uint32_t last_delivery_ms;
+    uint32_t max_latency_us;
+};
+
+extern bool dual_core;                // Persisted in NVS, applies on next boot
+extern uint8_t pipeline_policy;       // PipelineBackpressure, persisted in NVS
+extern PipelineStats pipeline_stats;
+extern PipelineRun pipeline_run;
+extern CpuLoad ingest_load;           // Dual-core mode only
+
+// ============== Pipeline Functions ==============
+// Start the ingest task if dual-core mode is enabled (after initLoRa)
+void pipelineBegin();
+bool pipelineIsDualCore();            // Ingest task actually running
+
+// Ingest side: apply the reading to the device table, then fan out inline
+// (single-core) or queue it for loop() (dual-core)
+void pipelineSubmit(PipelineEvent& ev);
+
+// Called from loop(): ingest + fan-out, or drain the queue in dual-core mode
+void pipelineLoop();
+
+size_t pipelineQueueDepth();
+void pipelineResetStats();
+
+// ============== Synthetic Load ==============
+// Feed generated packets for the saved devices through the whole pipeline.
+// Returns false if a run is in progress or there are no devices.
+bool pipelineStartRun(uint16_t rate_hz, uint16_t seconds);
+void pipelineGeneratorTick();         // Runs in the ingest stage
+
+const char* getPipelinePolicyName(uint8_t policy);
+
+// Append Prometheus text-format metrics for the pipeline
+void appendPipelineMetrics(String& out);
+
+#endif // PIPELINE_H
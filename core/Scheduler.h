@@ -0,0 +1,126 @@
+/*
+ * Scheduler.h - Cooperative Timer Scheduler
+ * Periodic and one-shot jobs run from loop() in deadline order, with a time
+ * budget per pass and per-job lateness statistics. Between passes the loop
+ * task blocks on a task notification until the next deadline, the radio
+ * interrupt or another task wakes it.
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+
+#define SCHEDULER_MAX_JOBS 16
+#define SCHEDULER_PASS_BUDGET_US 20000   // Due jobs past this are deferred to the next pass
+#define SCHEDULER_DEFAULT_BUDGET_US 10000
+#define SCHEDULER_LATE_MS 50             // Runs started later than this count as late
+#define SCHEDULER_MAX_BURST 4            // Missed periods a BURST job will still run
+#define SCHEDULER_NET_POLL_MS 20         // Longest sleep: HomeSpan/web/MQTT sockets are polled
+#define SCHEDULER_ACTIVE_HOLD_MS 250     // Poll every tick this long after network activity
+#define CPU_LOAD_WINDOW_MS 1000
+
+// ============== Jobs ==============
+typedef void (*SchedulerJobFn)();
+
+// What a periodic job does when it was held up past one or more deadlines
+enum SchedulerCatchUp : uint8_t {
+    SCHED_CATCHUP_SKIP = 0,              // Run once, drop missed periods, keep the phase
+    SCHED_CATCHUP_BURST,                 // Run once per missed period (up to SCHEDULER_MAX_BURST)
+    SCHED_CATCHUP_DELAY,                 // Next run one period after this one finished
+    SCHED_CATCHUP_COUNT
+};
+
+struct SchedulerJobStats {
+    uint32_t runs;
+    uint32_t late;                       // Started more than SCHEDULER_LATE_MS after the deadline
+    uint32_t skipped;                    // Periods dropped by SKIP (or an overlong BURST)
+    uint32_t deferred;                   // Passes that ran out of budget before this job
+    uint32_t over_budget;                // Runs longer than the job's budget
+    uint32_t max_late_ms;
+    uint64_t total_late_ms;
+    uint32_t max_us;
+    uint64_t total_us;
+};
+
+struct SchedulerJob {
+    const char* name;
+    SchedulerJobFn fn;
+    uint32_t period_ms;                  // 0 = one-shot
+    uint32_t due_ms;                     // millis() deadline
+    uint32_t budget_us;                  // 0 = unbounded (blocking network calls)
+    uint8_t catchup;                     // SchedulerCatchUp
+    bool active;                         // Slot in use (one-shots free it after running)
+    SchedulerJobStats stats;
+};
+
+struct SchedulerIdleStats {
+    uint32_t sleeps;
+    uint32_t woken;                      // Sleeps cut short by a notification
+    uint32_t short_polls;                // One-tick yields (work pending or network active)
+};
+
+// ============== CPU Load ==============
+// Busy share of a task, measured from the time it spends blocked in its
+// idle wait. Updated by the task itself; read from anywhere.
+struct CpuLoad {
+    const char* task;
+    uint32_t window_start_ms;
+    uint32_t window_idle_us;
+    uint64_t idle_us;                    // Total time blocked
+    uint8_t busy_pct;                    // Last complete window
+    uint8_t peak_pct;                    // Busiest window since reset
+};
+
+#define CPU_LOAD_MAX_TASKS 4
+
+extern SchedulerJob scheduler_jobs[SCHEDULER_MAX_JOBS];
+extern SchedulerIdleStats scheduler_idle;
+extern CpuLoad loop_load;
+extern CpuLoad* cpu_loads[CPU_LOAD_MAX_TASKS];
+extern uint8_t cpu_load_count;
+
+// ============== Scheduler Functions ==============
+// Remember the loop task so other tasks can wake it (call from setup())
+void schedulerBegin();
+
+// Register a periodic job; the first run is one period from now. Registering
+// an existing name returns its id unchanged. Returns -1 if the table is full.
+int schedulerEvery(const char* name, uint32_t period_ms, SchedulerJobFn fn,
+                   SchedulerCatchUp catchup = SCHED_CATCHUP_SKIP,
+                   uint32_t budget_us = SCHEDULER_DEFAULT_BUDGET_US);
+
+// Run fn once after delay_ms. Re-arming a pending one-shot moves its deadline.
+int schedulerAfter(const char* name, uint32_t delay_ms, SchedulerJobFn fn,
+                   uint32_t budget_us = SCHEDULER_DEFAULT_BUDGET_US);
+
+void schedulerCancel(int id);
+void schedulerTrigger(int id);           // Make the job due now
+
+// Run due jobs, earliest deadline first (called from loop())
+void schedulerRun();
+
+// Block until the next deadline (at most SCHEDULER_NET_POLL_MS) or a task
+// notification (radio interrupt, fan-out queue). With work_pending, or shortly after network activity, the
+// loop only yields for one tick.
+void schedulerIdle(bool work_pending);
+
+// Cut the current idle sleep short (from another task)
+void schedulerWake();
+
+// A request or message was handled: keep polling the network stacks quickly
+void schedulerNoteActivity();
+
+// Track a task's CPU load (listed in /api/scheduler and /metrics)
+void cpuLoadBegin(CpuLoad& load, const char* task);
+void cpuLoadAddIdle(CpuLoad& load, uint32_t idle_us);
+
+uint32_t schedulerNextDueMs();           // ms until the earliest deadline
+void schedulerResetStats();
+
+const char* getSchedulerCatchUpName(uint8_t catchup);
+
+// Append Prometheus text-format metrics for the scheduler
+void appendSchedulerMetrics(String& out);
+
+#endif // SCHEDULER_H
@@ -0,0 +1,52 @@
+/*
+ * SpscQueue.h - Lock-Free Single-Producer/Single-Consumer Queue
+ * Bounded ring for handing items between two tasks without a mutex.
+ * Exactly one task may push and exactly one (other) task may pop.
+ */
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+template <typename T, size_t N>
+class SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SpscQueue() : head_(0), tail_(0) {}
+
+    // Producer side. Returns false (and leaves the queue untouched) when full.
+    bool push(const T& item) {
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == N) return false;
+        slots_[head & (N - 1)] = item;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false when empty.
+    bool pop(T& item) {
+        uint32_t tail = tail_.load(std::memory_order_relaxed);
+        if (head_.load(std::memory_order_acquire) == tail) return false;
+        item = slots_[tail & (N - 1)];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called from a third task
+    size_t size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+    static constexpr size_t capacity() { return N; }
+
+private:
+    T slots_[N];
+    std::atomic<uint32_t> head_;   // Next slot to write, owned by the producer
+    std::atomic<uint32_t> tail_;   // Next slot to read, owned by the consumer
+};
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,65 @@
+/*
+ * ActivityLog.h - Device Activity Log
+ * Compact binary ring of received readings, formatted only when read
+ */
+
+#ifndef ACTIVITY_LOG_H
+#define ACTIVITY_LOG_H
+
+#include "../core/Config.h"
+#include "../core/Device.h"
+#include "../core/EventBus.h"
+#include <Arduino.h>
+
+#define MAX_ACTIVITY_LOG 200
+#define ACTIVITY_NO_DEVICE 0xFF     // Entry removed from the web UI
+
+// ============== Activity Fields ==============
+// Which readings a packet carried, plus the two binary sensor values
+enum ActivityField : uint8_t {
+    ACT_TEMP = 0x01,
+    ACT_HUM = 0x02,
+    ACT_BATT = 0x04,
+    ACT_LUX = 0x08,
+    ACT_MOTION = 0x10,
+    ACT_CONTACT = 0x20,
+    ACT_MOTION_ON = 0x40,
+    ACT_CONTACT_CLOSED = 0x80
+};
+
+// ============== Activity Entry ==============
+struct ActivityEntry {
+    uint32_t timestamp;      // millis()
+    uint8_t device;          // Index into devices[]
+    uint8_t fields;          // ActivityField bits
+    int16_t temp_x10;        // 0.1 °C
+    uint16_t lux;            // Saturates at 65535
+    uint8_t humidity;        // %
+    uint8_t battery;         // %
+};
+
+static_assert(sizeof(ActivityEntry) == 12, "ActivityEntry should stay 12 bytes");
+
+extern ActivityEntry activityLog[MAX_ACTIVITY_LOG];
+extern int activityLogCount;
+extern int activityLogIndex;   // Next slot to write
+
+// ============== Activity Log Functions ==============
+// Record the values carried by one reading of 'dev'
+void logActivity(const Device* dev, const DeviceReading& r);
+void clearActivityLog();
+bool removeActivity(int idx);
+void forgetActivityDevice(int device);   // Hide a removed device's entries (its slot is reused)
+
+// Ring slot of the n-th newest entry (0 = newest)
+int getActivitySlot(int n);
+
+const char* getActivityDeviceName(const ActivityEntry& entry);
+
+// Human-readable readings, e.g. "21.5°C 40% bat 90%"
+size_t formatActivity(const ActivityEntry& entry, char* out, size_t len);
+
+// Log readings from the event bus
+void subscribeActivityEvents();
+
+#endif // ACTIVITY_LOG_H
@@ -0,0 +1,147 @@
+/*
+ * Capture.h - Raw Frame Capture
+ * Records received frames as they came off the radio (before decryption)
+ * with their signal data, the receiver settings they were heard on (the
+ * receive profile and SF: the receiver hops between profiles and follows
+ * devices to other SFs) and whether the bridge accepted them. The radio
+ * task only copies each frame into a small RAM ring; a scheduler job appends
+ * the ring to a circular flash partition, so capture can stay on in
+ * production. Without the partition only the RAM ring is kept.
+ *
+ * Capture text format (what /api/capture/download returns):
+ *   # lora-capture v2 freq=868.000 sf=8 bw=125000 cr=5 pre=8 sync=0x12 enc=xor
+ *   <millis> <rssi> <snr> <len> <hex bytes> <MHz>/<SF>/<kHz>/<sync> <profile>
+ *
+ * The header has the main profile's settings; each frame line ends with the
+ * receiver's, in the receive profile format (RxScheduler.h).
+ *
+ * Binary flash format (/api/capture/download?format=bin streams the used
+ * part of each sector, oldest first): every 4 KB sector starts with a
+ * CaptureSectorHeader, followed by CaptureRecords, each directly followed
+ * by its payload. A blank (0xFF) mark byte ends the sector.
+ */
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <Arduino.h>
+#include "../core/Config.h"
+#include "../hardware/RxScheduler.h"
+
+// Partition is declared in partitions.csv (data, subtype 0x41)
+#define CAPTURE_PARTITION_LABEL "capture"
+#define CAPTURE_PARTITION_SUBTYPE 0x41
+
+#define CAPTURE_RAM_FRAMES 32
+#define CAPTURE_FRAME_MAX 255
+#define CAPTURE_LINE_MAX (64 + 2 * CAPTURE_FRAME_MAX)   // One formatted frame
+#define CAPTURE_SECTOR_SIZE 4096
+#define CAPTURE_MAX_SECTORS 32
+#define CAPTURE_FLUSH_MS 250         // RAM ring -> flash (the ring holds 32 frames)
+
+#define CAPTURE_MAGIC 0x5041434C     // "LCAP"
+#define CAPTURE_VERSION 2
+#define CAPTURE_RECORD_MARK 0xA0     // High nibble of CaptureRecord.mark
+#define CAPTURE_ACCEPTED 0           // Verdict; otherwise a JournalRejectReason
+
+// ============== Captured Frame ==============
+struct CapturedFrame {
+    uint32_t seq;                    // 2 * frame number + 1 while written, + 2 when complete
+    uint32_t at_ms;                  // millis() when read from the radio
+    int16_t rssi;
+    int16_t freq_err;                // Hz, clamped to int16
+    int8_t snr_x4;                   // SX127x reports SNR in 0.25 dB steps
+    uint8_t verdict;                 // CAPTURE_ACCEPTED or JournalRejectReason
+    uint8_t len;
+    uint8_t profile;                 // Receive profile the receiver was on
+    uint8_t sf;                      // Its SF, or a followed device's
+    uint8_t bw_125k;                 // Bandwidth in 125 kHz steps
+    uint8_t sync;
+    uint32_t freq_hz;
+    uint8_t data[CAPTURE_FRAME_MAX];
+};
+
+// ============== Flash Format ==============
+struct CaptureSectorHeader {
+    uint32_t magic;                  // CAPTURE_MAGIC
+    uint16_t version;
+    uint16_t boot;                   // journal_boot when the sector was started
+    uint32_t seq;                    // Sector sequence number, monotonic across reboots
+    uint32_t freq_hz;                // Main profile settings (records carry the receiver's)
+    uint32_t bw_hz;
+    uint8_t sf;
+    uint8_t cr;
+    uint8_t sync;
+    uint8_t enc;                     // EncryptMode
+    uint16_t preamble;
+    uint8_t reserved[5];
+    uint8_t crc;                     // CRC-8 of the preceding 31 bytes
+};
+
+struct CaptureRecord {
+    uint8_t mark;                    // CAPTURE_RECORD_MARK | verdict, 0xFF = end of sector
+    uint8_t len;                     // Payload bytes that follow
+    int8_t snr_x4;
+    uint8_t crc;                     // CRC-8 of the other 19 header bytes and the payload
+    uint32_t at_ms;
+    int16_t rssi;
+    int16_t freq_err;
+    uint32_t freq_hz;                // Receiver settings the frame was heard on
+    uint8_t sf;
+    uint8_t bw_125k;                 // Bandwidth in 125 kHz steps (as LoRaTap)
+    uint8_t sync;
+    uint8_t profile;                 // Receive profile; sf differs from its own in a follow window
+};
+
+static_assert(sizeof(CaptureSectorHeader) == 32, "CaptureSectorHeader is 32 bytes on flash");
+static_assert(sizeof(CaptureRecord) == 20, "CaptureRecord is 20 bytes on flash");
+
+// Return false to stop reading
+typedef bool (*CaptureVisitor)(const CapturedFrame& frame, void* ctx);
+
+extern bool capture_enabled;         // Persisted in NVS
+extern bool capture_flash_available;
+extern uint32_t capture_total;       // Frames recorded since boot (written by the radio task only)
+extern uint32_t capture_lost;        // Frames overwritten in RAM before reaching flash
+
+// ============== Capture Functions ==============
+// Mount the partition, find the newest sector and start the flush job.
+// Allocates the RAM ring if capture was left enabled.
+void captureInit();
+
+// Start or stop recording. Returns false if the ring cannot be allocated.
+// Frames already captured stay readable until cleared.
+bool captureEnable(bool enable);
+void captureClear();                 // Forget captured frames and erase the partition
+
+// Record one frame in two steps (called by whichever task reads the radio):
+// captureFrame() before ingest decrypts the buffer in place, with the
+// receiver's settings ('rx', on receive profile 'profile'); captureVerdict()
+// with the outcome of ingestPacket()
+void captureFrame(const uint8_t* data, int len, int rssi, float snr, long freq_err, const RxProfile& rx,
+                  uint8_t profile);
+void captureVerdict(uint8_t verdict);
+
+// Append completed RAM frames to flash (scheduler job, also run before downloads)
+void captureFlush();
+
+uint16_t captureCount();             // Frames in the RAM ring
+uint32_t captureFlashUsed();         // Bytes of flash holding records
+uint32_t captureFlashCapacity();
+
+// Copy the n-th oldest frame in the RAM ring. Returns false if the radio
+// task overwrote it in the meantime.
+bool captureRead(uint16_t n, CapturedFrame& out);
+
+// Visit the frames in flash, oldest first (seq is unused)
+void captureReadFlash(CaptureVisitor visit, void* ctx);
+
+// Stream the used part of each flash sector, oldest first
+typedef void (*CaptureChunkWriter)(const uint8_t* data, size_t len, void* ctx);
+void captureDumpFlash(CaptureChunkWriter write, void* ctx);
+
+// Text format: the header line (main profile settings) and one line per frame
+size_t formatCaptureHeader(char* out, size_t len);
+size_t formatCapturedFrame(const CapturedFrame& frame, char* out, size_t len);
+
+#endif // CAPTURE_H
@@ -18,6 +18,10 @@ extern uint8_t encrypt_key_len;
 void xorBuffer(uint8_t* data, size_t len);
 void aesDecrypt(uint8_t* data, size_t len);
 void decryptBuffer(uint8_t* data, size_t len);
+void aesEncrypt(uint8_t* data, size_t len);
+// Encrypt in place for transmission; AES pads to a whole block, so 'data'
+// holds 'size' bytes. Returns the length to send, 0 if it does not fit.
+size_t encryptBuffer(uint8_t* data, size_t len, size_t size);
 const char* getEncryptionModeName(uint8_t mode);
 
 #endif // ENCRYPTION_H
@@ -0,0 +1,105 @@
+/*
+ * Journal.h - Flash Event Journal
+ * Append-only log of device events in a dedicated flash partition that
+ * survives reboots. Used as a circular log of 4 KB sectors, so every
+ * sector is erased once per pass over the partition.
+ */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "../core/Config.h"
+#include "../core/Device.h"
+#include "../core/EventBus.h"
+#include <Arduino.h>
+
+// Partition is declared in partitions.csv (data, subtype 0x40)
+#define JOURNAL_PARTITION_LABEL "journal"
+#define JOURNAL_PARTITION_SUBTYPE 0x40
+
+#define JOURNAL_SECTOR_SIZE 4096
+#define JOURNAL_RECORD_SIZE 32
+#define JOURNAL_RECORDS_PER_SECTOR (JOURNAL_SECTOR_SIZE / JOURNAL_RECORD_SIZE - 1)  // Slot 0 is the header
+#define JOURNAL_MAX_SECTORS 64
+#define JOURNAL_DEVICE_LEN 10        // Device ID prefix kept per record (see JournalFilter)
+
+// ============== Event Types ==============
+enum JournalEventType : uint8_t {
+    JOURNAL_BOOT = 1,         // detail = esp_reset_reason()
+    JOURNAL_READING,          // detail = ActivityField bits
+    JOURNAL_REGISTERED,
+    JOURNAL_REMOVED,
+    JOURNAL_RENAMED,
+    JOURNAL_REJECTED,         // detail = JournalRejectReason
+    JOURNAL_AVAILABILITY,     // detail = 1 online, 0 offline
+    JOURNAL_TYPE_COUNT
+};
+
+enum JournalRejectReason : uint8_t {
+    JOURNAL_REJECT_BAD_JSON = 1,
+    JOURNAL_REJECT_WRONG_KEY,
+    JOURNAL_REJECT_NO_ID
+};
+
+// ============== Records ==============
+// One flash write per record; never straddles a sector
+struct JournalRecord {
+    uint32_t seq;             // Monotonic across reboots, 0xFFFFFFFF = blank
+    uint32_t uptime_ms;       // millis() when written
+    uint16_t boot;            // Increments on every boot
+    uint8_t type;             // JournalEventType
+    uint8_t detail;           // Type-specific, see JournalEventType
+    char device[JOURNAL_DEVICE_LEN];  // Not terminated when the ID is this long or longer
+    uint16_t device_hash;     // journalDeviceHash() of the full ID, 0 = no device
+    int16_t temp_x10;         // Readings, valid per ActivityField bits
+    uint16_t lux;
+    uint8_t humidity;
+    uint8_t battery;
+    int8_t rssi;
+    uint8_t crc;              // CRC-8 of the preceding 31 bytes
+};
+
+static_assert(sizeof(JournalRecord) == JOURNAL_RECORD_SIZE, "JournalRecord must fill one slot");
+
+// A device filter matches the stored prefix and the hash of the full ID, so
+// IDs that share their first JOURNAL_DEVICE_LEN characters stay apart unless
+// their hashes collide (1 in 65536)
+struct JournalFilter {
+    uint32_t after_seq;       // Exclusive start (0 = oldest)
+    const char* device;       // nullptr = any
+    uint8_t type;             // 0 = any
+    int32_t boot;             // -1 = any
+    uint32_t from_ms;         // Uptime window, only meaningful with 'boot'
+    uint32_t to_ms;
+};
+
+// Return false to stop reading
+typedef bool (*JournalVisitor)(const JournalRecord& rec, void* ctx);
+
+extern bool journal_available;
+extern uint16_t journal_boot;
+
+// ============== Journal Functions ==============
+// Mount the partition, rebuild the sequence index, log a boot record and
+// subscribe to device events
+bool journalInit();
+
+void journalLogReading(const DeviceReading& r);
+void journalLogEvent(JournalEventType type, const char* device, uint8_t detail = 0);
+
+uint16_t journalDeviceHash(const char* device);
+
+uint32_t journalOldestSeq();
+uint32_t journalNewestSeq();
+uint32_t journalCapacity();
+
+// Visit matching records in sequence order, reading flash in small batches.
+// Stops after 'limit' matches. Returns the last sequence number examined,
+// which is the 'after_seq' cursor for the next page.
+uint32_t journalRead(const JournalFilter& filter, uint16_t limit, JournalVisitor visit, void* ctx,
+                     bool* more = nullptr);
+
+const char* getJournalTypeName(uint8_t type);
+uint8_t getJournalTypeByName(const char* name);
+
+#endif // JOURNAL_H
@@ -68,4 +68,18 @@ bool verifyPassword(const char *password, const uint8_t *hash);
 void saveDevices();
 void loadDevices();
 
+// Learned reporting intervals, one blob of DeviceIntervalRecords matched to
+// devices by a hash of their id. loadDevices() reads it.
+struct DeviceIntervalRecord {
+  uint32_t id_hash;       // FNV-1a of the device id
+  uint32_t period_ms;
+  uint16_t jitter_ds;     // Deciseconds
+  uint8_t samples;
+  uint8_t reserved;
+};
+
+// Scheduler job: write the blob if a device's learned period is new or
+// moved by more than 10% since it was last written
+void saveDeviceIntervals();
+
 #endif // SETTINGS_H
@@ -0,0 +1,155 @@
+/*
+ * Adr.h - Adaptive Data Rate
+ * Each device's spreading factor and TX power are worked out from the SNR
+ * of its recent uplinks, as LoRaWAN network servers do: the best SNR of
+ * the last ADR_HISTORY uplinks, less the demodulation limit at the
+ * device's SF and an installation margin, gives the headroom. Every
+ * ADR_STEP_DB of headroom lowers the SF by one (down to SF7), then the
+ * power by ADR_STEP_DB. Negative headroom raises the power, then the SF.
+ * Decisions wait for ADR_MIN_SAMPLES uplinks at the current settings.
+ *
+ * In "recommend" mode the result is only shown. In "auto" mode it is sent
+ * to devices that open receive windows (hardware/Downlink.h), retried up
+ * to ADR_MAX_ATTEMPTS times until the device acknowledges it.
+ *
+ * The bridge listens on lora_sf. To hear a device it moved to another SF
+ * it switches the receiver to that SF for a window around the device's
+ * next expected uplink, using the learned reporting interval (core/Device.h).
+ * Only devices with a learned, regular interval are moved off lora_sf:
+ * their window may take at most ADR_FOLLOW_SHARE_PCT of the period, and
+ * all windows together at most ADR_FOLLOW_BUDGET_PCT of the time, as
+ * uplinks on lora_sf are missed while the receiver is elsewhere. Event-
+ * driven devices (motion, contact) only get power changes.
+ *
+ * Sensors return to lora_sf at full power after ADR_REVERT_UPLINKS uplinks
+ * without a downlink, so moved devices get a keepalive every
+ * ADR_KEEPALIVE_UPLINKS uplinks. A device heard back on lora_sf has
+ * reverted; one missed in ADR_FOLLOW_MISS_LIMIT windows in a row is
+ * assumed to have.
+ */
+
+#ifndef ADR_H
+#define ADR_H
+
+#include <Arduino.h>
+#include "../core/Config.h"
+
+#define ADR_HISTORY 20                   // Uplink SNRs kept per device
+#define ADR_MIN_SAMPLES 10               // Before a decision
+#define ADR_MARGIN_DB 10                 // Installation margin over the demodulation limit
+#define ADR_STEP_DB 3                    // Headroom per SF or power step
+#define ADR_SF_MIN 7
+#define ADR_SF_MAX 12
+#define ADR_POWER_MIN 2                  // dBm
+#define ADR_POWER_MAX 20                 // Sensor default, assumed when not reported
+#define ADR_POWER_UNKNOWN INT8_MIN
+#define ADR_MAX_ATTEMPTS 3               // Downlinks per command before backing off
+#define ADR_BACKOFF_UPLINKS 32           // Uplinks before a command that failed is tried again
+#define ADR_KEEPALIVE_UPLINKS 8
+#define ADR_REVERT_UPLINKS 16            // Sensor side: uplinks without a downlink before it reverts
+#define ADR_FOLLOW_GUARD_MS 500          // Window either side of an expected uplink, plus 4 deviations
+#define ADR_FOLLOW_MIN_INTERVALS 8       // Learned intervals before a device is followed
+#define ADR_FOLLOW_SHARE_PCT 5           // Largest window per period for a device to leave lora_sf
+#define ADR_FOLLOW_BUDGET_PCT 10         // All windows together
+#define ADR_FOLLOW_MISS_LIMIT 3
+#define ADR_MAX_DEVICES MAX_DEVICES
+
+enum AdrMode : uint8_t {
+    ADR_MODE_OFF = 0,
+    ADR_MODE_RECOMMEND,                  // Work out settings, send nothing
+    ADR_MODE_AUTO,                       // Send them to devices that listen
+    ADR_MODE_COUNT
+};
+
+// ============== Devices ==============
+struct AdrDevice {
+    char id[32];                         // "" = free
+    int8_t snr_q[ADR_HISTORY];           // Quarter dB, ring
+    uint8_t snr_count;
+    uint8_t snr_head;
+    uint8_t sf;                          // As last heard
+    int8_t power;                        // dBm, ADR_POWER_MAX until reported
+    bool downlink;                       // Opens receive windows ("dl":1)
+    bool followable;                     // May leave lora_sf
+    uint8_t rec_sf;                      // Recommendation (0 = none yet)
+    int8_t rec_power;
+
+    // Command in flight
+    bool cmd_pending;
+    uint8_t cmd_seq;
+    uint8_t cmd_sf;
+    int8_t cmd_power;
+    uint8_t cmd_attempts;
+    uint8_t backoff;                     // Uplinks left before trying again
+    uint8_t since_downlink;              // Uplinks heard since the last downlink
+
+    // Follow window (receiver on this device's SF), clockMillis()
+    uint32_t period_ms;                  // 0 = not followed
+    uint32_t window_start_ms;
+    uint32_t window_ms;
+    uint32_t deaf_ms;                    // Window plus a cut-off lora_sf frame, for the budget
+    uint8_t window_sf;
+    uint8_t misses;                      // Windows in a row without the device
+
+    uint32_t uplinks;
+    uint32_t acks;
+    int64_t saved_us;                    // Airtime against lora_sf (negative if above it)
+    uint32_t last_heard_ms;
+};
+
+struct AdrStats {
+    uint32_t uplinks;
+    uint32_t commands;                   // Downlinks carrying a change
+    uint32_t keepalives;
+    uint32_t acks;
+    uint32_t gave_up;                    // Commands never acknowledged
+    uint32_t reverts;                    // Devices back on lora_sf without a command
+    uint32_t follow_windows;             // Receiver switched for a device
+    uint32_t follow_misses;              // Window closed without the device
+    uint32_t followed_frames;            // Uplinks heard off lora_sf
+    int64_t saved_us;
+};
+
+// What the radio task knows about an accepted uplink
+struct AdrUplink {
+    const char* id;
+    float snr;
+    uint8_t sf;                          // Receiver SF when it arrived
+    int len;
+    uint32_t end_us;                     // Picked up by the radio task, clockMicros()
+    bool downlink;                       // "dl":1
+    int ack;                             // "ack", -1 if absent
+    int8_t power;                        // "pw", ADR_POWER_UNKNOWN if absent
+};
+
+extern AdrStats adr_stats;
+extern uint8_t adr_mode;                 // AdrMode; persisted in NVS
+
+// ============== ADR Functions ==============
+// Record an accepted uplink; may schedule a downlink (radio task)
+void adrUplink(const AdrUplink& up);
+
+// Open and close follow windows: returns the SF the receiver should be on
+// now (radio task)
+uint8_t adrReceiveSf();
+
+// Milliseconds until the receiver must change SF (UINT32_MAX if never)
+uint32_t adrNextSwitchMs();
+
+// Recommendation for a device at 'sf' and 'power' from its best recent
+// SNR; 'move_sf' false keeps the SF. Pure, for the tools as well.
+void adrRecommend(float snr_max, uint8_t sf, int8_t power, bool move_sf, uint8_t& out_sf, int8_t& out_power);
+
+// Consistent copy of the table and stats for reporting; returns the
+// number of devices copied
+uint8_t adrSnapshot(AdrDevice* out, uint8_t max, AdrStats& stats);
+
+// Copy of one device's entry; false if it has none
+bool adrDevice(const char* id, AdrDevice& out);
+
+const char* getAdrModeName(uint8_t mode);
+
+// Append Prometheus text-format metrics
+void appendAdrMetrics(String& out);
+
+#endif // ADR_H
@@ -0,0 +1,80 @@
+/*
+ * Airtime.h - Time-on-Air Accounting
+ * Every frame the radio hands over, accepted or not, is charged its time on
+ * air at the current radio settings. Totals are kept for the channel and
+ * per sender, and a scheduler job closes one-minute windows for the
+ * channel utilisation figures.
+ *
+ * Collision estimate (pure ALOHA): with offered load G (transmit time per
+ * unit time from every sender on the channel) a frame survives only if
+ * nothing else starts within one frame time either side, so
+ * P(collision) = 1 - e^(-2G). The bridge only hears the survivors, so the
+ * measured utilisation S is the throughput G * e^(-2G); G is solved from S
+ * on the stable side of the curve. S cannot exceed 1/(2e) (18.4%): at or
+ * near that the channel is saturated and G is reported as 0.5. The capture
+ * effect lets the stronger of two overlapping frames through, so real
+ * losses below saturation are lower than the estimate (bridge_fleet
+ * prints both).
+ */
+
+#ifndef AIRTIME_H
+#define AIRTIME_H
+
+#include <Arduino.h>
+#include "../core/Config.h"
+
+#define AIRTIME_WINDOW_MS 60000          // Utilisation window
+#define AIRTIME_HISTORY 60               // Windows kept for the peak (one hour)
+#define AIRTIME_MAX_SOURCES (MAX_DEVICES + 4)
+#define AIRTIME_SOURCE_IDLE_MS (24UL * 60 * 60 * 1000)   // Idle senders may be replaced
+#define AIRTIME_OTHER_ID "(other)"       // Frames without an id, or with the table full
+
+// ============== Statistics ==============
+struct AirtimeSource {
+    char id[32];                         // Id from the frame, sanitised ("" = free)
+    uint64_t total_us;
+    uint32_t frames;
+    uint32_t rejected;                   // Frames from this id the bridge refused
+    uint32_t window_us;                  // Current window
+    uint32_t last_window_us;             // Last complete window
+    uint32_t last_heard_ms;
+};
+
+struct AirtimeStats {
+    uint64_t total_us;                   // Every frame received since boot
+    uint64_t rejected_us;                // Of which rejected (foreign, bad key, garbage)
+    uint32_t frames;
+    uint32_t window_us;                  // Current window
+    uint32_t last_window_us;             // Last complete window
+    uint32_t last_window_ms;             // Its length (the job may run late)
+    uint32_t windows;                    // Complete windows since boot
+};
+
+extern AirtimeStats airtime_stats;
+extern AirtimeSource airtime_sources[AIRTIME_MAX_SOURCES];
+
+// ============== Airtime Functions ==============
+// Start the first window (when the radio starts listening)
+void airtimeBegin();
+
+// Charge one received frame. 'verdict' is 0 if accepted, else the
+// JournalRejectReason; 'id' may be empty. Called from the ingest task.
+void airtimeRecord(const char* id, int len, uint8_t verdict);
+
+// Scheduler job: close the current window
+void airtimeRollWindow();
+
+// Fraction of the last complete window the channel carried frames, and the
+// highest over the last AIRTIME_HISTORY windows
+float airtimeUtilisation();
+float airtimePeakUtilisation();
+
+// Offered load G behind a measured utilisation S (see above), and the
+// chance a frame collides at that load
+float airtimeOfferedLoad(float utilisation);
+float airtimeCollisionProbability(float utilisation);
+
+// Append Prometheus text-format metrics for the channel and each sender
+void appendAirtimeMetrics(String& out);
+
+#endif // AIRTIME_H
@@ -17,12 +17,13 @@ extern bool display_available;
 extern bool oled_enabled;
 extern uint8_t oled_brightness;
 extern uint16_t oled_timeout;  // seconds, 0 = always on
-extern unsigned long oled_last_activity;
+extern uint32_t oled_last_activity;
 extern bool oled_is_off;
 
 // Mode and status flags
 extern bool ap_mode;
 extern bool wifi_configured;
+extern bool wifi_connect_pending;
 extern bool homekit_started;
 extern char homekit_code_display[10];
 extern char homekit_qr_uri[25];
@@ -37,4 +38,7 @@ void wakeOled();
 void checkOledTimeout();
 void feedWatchdog();
 
+// Update the status line from device events
+void subscribeDisplayEvents();
+
 #endif // DISPLAY_H
@@ -0,0 +1,74 @@
+/*
+ * Downlink.h - Commands to Sensors
+ * Sensors that put "dl":1 in an uplink open a receive window
+ * DOWNLINK_RX_DELAY_MS after that uplink ends, on the SF it was sent at.
+ * A command for the sensor is sent in that window. It is a JSON frame,
+ * encrypted like the uplinks:
+ *
+ *   {"k":"<gateway key>","id":"<device id>","q":17,"sf":9,"pw":11}
+ *
+ * "q" is the command sequence (1-255). "sf" and "pw" (TX power, dBm) are
+ * only present when they change. With neither present the frame is a
+ * keepalive. The sensor applies the command and reports "ack":<q> in its
+ * following uplinks. The radio task transmits at the window time. It
+ * uses the ingest task's timestamp for the end of the uplink, so timing
+ * is tightest in dual-core mode.
+ */
+
+#ifndef DOWNLINK_H
+#define DOWNLINK_H
+
+#include <Arduino.h>
+#include "../core/Config.h"
+
+#define DOWNLINK_RX_DELAY_MS 1000        // Uplink end to the sensor's receive window
+#define DOWNLINK_RX_WINDOW_MS 100        // Sensor listens this long for a preamble
+#define DOWNLINK_MAX_LATE_MS 50          // Later than this, the preamble would miss the window
+#define DOWNLINK_TX_POWER 17             // Bridge TX power, dBm
+#define DOWNLINK_FRAME_MAX 128
+#define DOWNLINK_POWER_KEEP INT8_MIN     // Command leaves the TX power alone
+
+// ============== Commands ==============
+struct DownlinkCommand {
+    char id[32];
+    uint8_t seq;                         // 1-255
+    uint8_t sf;                          // 0 = unchanged
+    int8_t power;                        // DOWNLINK_POWER_KEEP = unchanged
+};
+
+// ============== Statistics ==============
+struct DownlinkStats {
+    uint32_t scheduled;
+    uint32_t sent;
+    uint32_t busy;                       // Another downlink already held the transmitter
+    uint32_t missed;                     // Window already past when the radio got to it
+    uint64_t airtime_us;
+    uint32_t late_max_us;                // Latest start after the window opened
+    uint64_t late_sum_us;
+};
+
+extern DownlinkStats downlink_stats;
+
+// ============== Downlink Functions ==============
+// Send 'cmd' in the receive window after an uplink the radio task picked up
+// at 'uplink_end_us', on spreading factor 'sf'. One downlink is pending at
+// a time; false if the transmitter is already booked. Radio task only.
+bool downlinkSchedule(const DownlinkCommand& cmd, uint8_t sf, uint32_t uplink_end_us);
+
+// Transmit the pending downlink once its window opens (radio task)
+void downlinkService();
+
+// Milliseconds until the pending downlink is due (UINT32_MAX if none)
+uint32_t downlinkNextDueMs();
+
+// Build the frame for 'cmd', encrypted; returns its length (0 if it does
+// not fit in 'size')
+size_t downlinkEncode(const DownlinkCommand& cmd, uint8_t* out, size_t size);
+
+// Consistent copy of the stats
+void downlinkSnapshot(DownlinkStats& out);
+
+// Append Prometheus text-format metrics
+void appendDownlinkMetrics(String& out);
+
+#endif // DOWNLINK_H
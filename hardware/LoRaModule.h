@@ -8,14 +8,50 @@
 
 #include <Arduino.h>
 #include "../core/Config.h"
+#include "../core/FixedString.h"
 
 // ============== Statistics ==============
 extern uint32_t packets_received;
-extern unsigned long last_packet_time;
-extern String last_event;
+extern uint32_t last_packet_time;
+extern FixedString<LAST_EVENT_LEN> last_event;
+extern volatile uint32_t radio_irqs;  // DIO0 interrupts
+extern uint8_t lora_rx_sf;            // SF the receiver is on (its profile's unless following a device)
 
 // ============== LoRa Functions ==============
 bool initLoRa();
+
+// Put the radio in continuous receive; RxDone (DIO0) notifies the calling
+// task, which must be the one that calls processLoRaPacket()
+void startLoRaReceive();
+
+// Read the received packet (if DIO0 signalled one) and hand it to ingestPacket()
 void processLoRaPacket();
 
+// Switch the receiver to a receive profile (hardware/RxScheduler.h) at
+// 'sf' (radio task)
+void loraSetReceive(uint8_t profile, uint8_t sf);
+
+// Transmit a frame on the main profile at 'sf' and 'power' dBm, then listen
+// again where the receiver was. Blocks for the time on air, which it
+// returns. Radio task.
+uint32_t loraTransmit(const uint8_t* data, size_t len, uint8_t sf, int8_t power);
+
+// Pending downlink, follow windows (hardware/Adr.h) and the receive
+// schedule. Called by the radio task after processLoRaPacket().
+void serviceLoRaRadio();
+
+// Milliseconds until the radio task has timed work: a channel sample, a
+// downlink or a receiver switch (UINT32_MAX if none)
+uint32_t loraNextRadioEventMs();
+
+// Time on air of a len-byte frame (Semtech AN1200.13), explicit header and
+// CRC off as set up by initLoRa(). cr is the denominator (5-8) as in lora_cr.
+uint32_t loraTimeOnAirUs(int len, uint8_t sf, uint32_t bw, uint8_t cr, uint16_t preamble);
+uint32_t loraTimeOnAirUs(int len);   // With the current receive settings
+
+// Ingest stage: decrypt, parse and validate a packet, then submit it to the
+// pipeline. 'buffer' must hold len + 1 bytes; synthetic packets are plaintext.
+// Returns 0 if accepted, else the JournalRejectReason.
+uint8_t ingestPacket(uint8_t* buffer, int len, int rssi, bool synthetic);
+
 #endif // LORA_MODULE_H
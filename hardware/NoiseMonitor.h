@@ -0,0 +1,112 @@
+/*
+ * NoiseMonitor.h - RF Noise Floor and Interference Monitor
+ * While the radio sits in continuous receive with nothing pending, the task
+ * that reads it samples the instantaneous channel RSSI every
+ * noise_sample_ms. Reading the RSSI register does not leave receive mode, so
+ * no frame is missed, and a frame arriving always takes precedence over a
+ * sample.
+ *
+ * Samples go into 1 dB histograms: one per 10 s window, and five-minute
+ * slices kept for an hour. The noise floor is a low percentile of the last
+ * hour. Frames on the air inflate the upper percentiles, not the floor. A
+ * window whose median is NOISE_INTERFERENCE_DB or more above the floor
+ * starts an interference episode. The episode ends once a window's median
+ * falls back below the threshold less NOISE_HYSTERESIS_DB. Interference
+ * that lasts most of an hour becomes the new floor.
+ *
+ * Each received frame's SNR margin (its SNR over the demodulation limit
+ * for the current SF) is kept as a histogram as well. Falling margins with
+ * a steady floor point at the sensors; a rising floor points at the channel.
+ */
+
+#ifndef NOISE_MONITOR_H
+#define NOISE_MONITOR_H
+
+#include <Arduino.h>
+#include "../core/Config.h"
+
+#define NOISE_SAMPLE_MS_DEFAULT 100      // Channel RSSI sample period
+#define NOISE_SAMPLE_MS_MIN 50           // loop() polls the radio every 20 ms at most
+#define NOISE_SAMPLE_MS_MAX 10000
+#define NOISE_MIN_DBM -140               // Lowest histogram bin (and everything below)
+#define NOISE_BINS 70                    // 1 dB each: -140 .. -71 dBm and above
+#define NOISE_WINDOW_MS 10000            // Interference decision window
+#define NOISE_SLICE_MS 300000            // Rolling histogram slice
+#define NOISE_SLICES 12                  // Slices kept (one hour)
+#define NOISE_FLOOR_PERCENTILE 20
+#define NOISE_BASELINE_WINDOWS 6         // Windows seen before episodes are flagged
+#define NOISE_INTERFERENCE_DB 6          // Window median over the floor that starts an episode
+#define NOISE_HYSTERESIS_DB 3
+#define NOISE_EPISODES 8                 // Recent episodes kept
+#define NOISE_MARGIN_BINS 8              // SNR margin histogram (see noise_margin_edges)
+
+// ============== Statistics ==============
+struct NoiseEpisode {
+    uint32_t start_ms;
+    uint32_t duration_ms;                // 0 while it lasts
+    int8_t floor_dbm;                    // Floor when it started
+    int8_t peak_dbm;                     // Highest window median
+};
+
+struct NoiseStats {
+    uint32_t samples;                    // Since boot
+    uint32_t deferred;                   // Samples put off for a frame being read
+    uint32_t windows;                    // Complete windows since boot
+    int8_t floor_dbm;                    // Last hour, NOISE_FLOOR_PERCENTILE
+    int8_t level_dbm;                    // Median of the last complete window
+    bool interference;                   // Episode in progress
+    uint32_t episodes;                   // Started since boot
+    uint64_t interference_ms;            // Time in finished episodes
+    uint32_t frames;                     // Frames with an SNR margin
+    double margin_sum_db;
+    float last_margin_db;
+};
+
+extern NoiseStats noise_stats;
+extern uint16_t noise_sample_ms;        // 0 = off; persisted in NVS
+
+// Upper edges of the SNR margin bins (the last bin is open)
+extern const float noise_margin_edges[NOISE_MARGIN_BINS - 1];
+
+// Consistent copy for reporting
+struct NoiseSnapshot {
+    NoiseStats stats;
+    uint32_t hour[NOISE_BINS];           // Rolling hour histogram
+    uint32_t hour_samples;
+    uint32_t boot[NOISE_BINS];           // Since boot
+    uint32_t margin[NOISE_MARGIN_BINS];  // Frames per SNR margin bin
+    NoiseEpisode episodes[NOISE_EPISODES];   // Newest first, start_ms 0 = unused
+};
+
+// ============== Noise Functions ==============
+// True when a channel sample is due. Called from the radio task when the
+// radio is in receive with no frame pending.
+bool noiseSampleDue();
+
+// Record a channel RSSI sample (dBm)
+void noiseRecordSample(int rssi);
+
+// A sample came due while a frame was being read
+void noiseSampleDeferred();
+
+// Record a received frame's SNR (dB) at the given spreading factor
+void noiseRecordFrame(float snr, uint8_t sf);
+
+// Milliseconds until the next sample is due (UINT32_MAX when sampling is off),
+// so the radio task can bound its wait
+uint32_t noiseNextSampleMs();
+
+// Demodulation limit of the SX127x at a spreading factor (-7.5 dB at SF7,
+// 2.5 dB lower per step)
+float noiseSnrLimitDb(uint8_t sf);
+
+// Histogram percentile (dBm); 'total' samples in 'hist'
+int noisePercentile(const uint32_t* hist, uint32_t total, uint8_t percentile);
+
+void noiseSnapshot(NoiseSnapshot& out);
+
+// Append Prometheus text-format metrics: floor, level, episodes and both
+// histograms
+void appendNoiseMetrics(String& out);
+
+#endif // NOISE_MONITOR_H
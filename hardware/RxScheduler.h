@@ -0,0 +1,102 @@
+/*
+ * RxScheduler.h - Multi-Profile Receive Scheduler
+ * The SX127x demodulates one frequency, bandwidth, SF and sync word at a
+ * time. Profile 0 is the radio settings (lora_*); up to RX_PROFILES_MAX - 1
+ * more may be configured for sensors set up differently. With more than one
+ * profile the receiver is time-sliced across them, one dwell per profile
+ * per cycle.
+ *
+ * A frame is only heard if it starts and ends within a dwell, so a dwell is
+ * at least RX_SCHED_MIN_FRAMES frames long, and of each stretch on a profile
+ * the first frame time is "usable" for nothing. Each profile's traffic rate
+ * is frames heard per usable second, decayed over RX_SCHED_MEMORY_MS, so a
+ * profile given little time does not look quiet for it. Every profile gets
+ * RX_SCHED_FLOOR_PCT of the cycle; the rest is shared by traffic rate.
+ *
+ * Missed frames are estimated per profile: if a profile was usable for a
+ * fraction u of the time and F frames were heard on it, about F / u were
+ * sent. Follow windows (hardware/Adr.h) and downlinks take the receiver
+ * from the schedule; that time counts as usable for no profile.
+ */
+
+#ifndef RX_SCHEDULER_H
+#define RX_SCHEDULER_H
+
+#include <Arduino.h>
+#include "../core/Config.h"
+
+#define RX_PROFILES_MAX 4                // Including profile 0
+#define RX_PROFILE_MAIN 0
+#define RX_PROFILE_NONE 0xFF             // Receiver not on a profile's settings
+#define RX_SCHED_CYCLE_MS 8000           // Target time through all profiles
+#define RX_SCHED_FLOOR_PCT 10            // Least share of a cycle per profile
+#define RX_SCHED_MIN_FRAMES 2            // Least dwell, in typical frames
+#define RX_SCHED_MEMORY_MS 3600000UL     // Traffic rate averaging
+#define RX_SCHED_DEFAULT_LEN 48          // Typical frame length before any is heard
+#define RX_PROFILES_TEXT_LEN 96          // "MHz/SF/kHz/sync" for the extra profiles, ';' separated
+
+struct RxProfile {
+    float frequency;                     // MHz
+    uint8_t sf;
+    uint32_t bw;                         // Hz
+    uint8_t syncword;
+};
+
+// ============== Statistics ==============
+struct RxProfileStats {
+    uint32_t frames;                     // Heard on this profile
+    uint32_t dwells;
+    uint64_t listen_ms;
+    uint64_t usable_ms;                  // Of which a typical frame could start and end
+    uint16_t frame_len;                  // Typical frame (running average)
+    uint32_t dwell_ms;                   // Planned for this cycle
+    float rate_per_h;                    // Traffic estimate behind the plan
+    uint32_t missed;                     // Estimated frames sent while not usable
+};
+
+struct RxSchedStats {
+    uint32_t switches;                   // Receiver reconfigured: profiles, follow windows, transmissions
+    uint64_t switch_us;                  // Time spent reconfiguring
+    uint32_t switch_max_us;
+    uint32_t deferred;                   // Switch held back by a frame being read
+    uint32_t cycles;
+    uint64_t elapsed_ms;                 // Since the schedule started
+};
+
+extern RxProfile rx_profiles[RX_PROFILES_MAX];
+extern uint8_t rx_profile_count;
+extern char rx_profiles_text[RX_PROFILES_TEXT_LEN];   // Extra profiles; persisted in NVS
+
+// ============== Scheduler Functions ==============
+// Profile 0 from the radio settings, the rest from rx_profiles_text; starts
+// the first cycle (initLoRa)
+void rxSchedBegin();
+
+// Parse "MHz/SF/kHz/sync[;...]" (sync in hex) into 'out'; false, with 'count'
+// unchanged, on the first bad entry. Empty text is no profiles.
+bool rxSchedParseProfiles(const char* text, RxProfile* out, uint8_t max, uint8_t& count);
+
+// Profile the receiver should be on now (radio task)
+uint8_t rxSchedProfile();
+
+// Milliseconds until the schedule moves on (UINT32_MAX with one profile)
+uint32_t rxSchedNextSwitchMs();
+
+// The receiver is now on 'profile' (RX_PROFILE_NONE off the schedule's
+// settings); 'switch_us' is how long reconfiguring took (radio task)
+void rxSchedOnProfile(uint8_t profile, uint32_t switch_us);
+
+// A switch came due while a frame was being read
+void rxSchedDeferred();
+
+// A frame was heard on 'profile'
+void rxSchedRecordFrame(uint8_t profile, int len);
+
+// Consistent copy for reporting; 'out' holds RX_PROFILES_MAX entries.
+// Returns rx_profile_count.
+uint8_t rxSchedSnapshot(RxProfileStats* out, RxSchedStats& stats);
+
+// Append Prometheus text-format metrics
+void appendRxSchedMetrics(String& out);
+
+#endif // RX_SCHEDULER_H
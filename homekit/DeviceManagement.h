@@ -17,9 +17,27 @@ void setupHomeKit();
 
 // ============== Device Management Functions ==============
 void createHomekitAccessory(Device* dev);
-Device* registerDevice(const char* id, JsonDocument& doc);
+Device* registerDevice(const DeviceReading& r);
 bool removeDevice(const char* id);
 bool renameDevice(const char* id, const char* newName);
-void updateDevice(Device* dev, JsonDocument& doc, int rssi);
+
+// ============== Readings ==============
+// Decode a sensor packet; false if it has no device ID
+bool parseReading(JsonDocument& doc, int rssi, DeviceReading& r);
+
+// Store the reading in the device table (ingest stage)
+void applyReading(Device* dev, const DeviceReading& r);
+
+// Publish the reading on the event bus (fan-out stage)
+void publishReading(Device* dev, const DeviceReading& r);
+
+// Both of the above, for callers that are not part of the pipeline
+void updateDevice(Device* dev, const DeviceReading& r);
+
+// Publish availability events for devices silent past deviceOfflineTimeout()
+void checkDeviceAvailability();
+
+// Attach the HomeKit characteristic updater to the event bus
+void subscribeHomeKitEvents();
 
 #endif // DEVICE_MANAGEMENT_H
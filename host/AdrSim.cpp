@@ -0,0 +1,402 @@
+/*
+ * AdrSim.cpp - Downlink timing and adaptive data rate on the mock radio
+ * Runs the bridge against sensors that behave as hardware/Downlink.h and
+ * hardware/Adr.h expect: each uplink opens a receive window, commands are
+ * applied and acknowledged, and a sensor without a downlink for
+ * ADR_REVERT_UPLINKS uplinks goes back to the bridge's SF at full power.
+ * The radio mock only hears a frame if the bridge was listening on its SF
+ * for all of it, and a transmission takes its time on air, so follow
+ * windows and downlink timing are exercised as on the board.
+ *
+ *   bridge_adr [options]
+ *     --sensors N         Sensors (default 20)
+ *     --hours H           Simulated time (default 24)
+ *     --interval S        Mean report interval (default 300 s)
+ *     --spread F          Per-sensor interval varies by +-F (default 0.2)
+ *     --jitter MS         Transmissions vary by +-MS (default 200)
+ *     --drift PPM         Crystal error, +-PPM per sensor (default 50)
+ *     --bridge-sf SF      Bridge spreading factor (default 10)
+ *     --rssi MIN,MAX      Range of sensor mean RSSI at full power (default -125,-80)
+ *     --motion N          Every Nth sensor reports motion (event-driven; default 5, 0 = none)
+ *     --mode M            off, recommend or auto (default auto)
+ *     --min-delivery F    Uplinks that must reach the bridge (default 0.95)
+ *     --seed N            Random seed (default 1)
+ *
+ * Checked: every downlink starts inside the addressed sensor's receive
+ * window, on the SF the sensor is on, and at most once per window. The exit
+ * status is 1 if any was violated, or if fewer than --min-delivery of the
+ * uplinks the bridge could have heard (strong enough, not collided) were
+ * delivered.
+ *
+ * Link model: SNR is RSSI over a -117 dBm noise floor, +-3 dB fading per
+ * frame, the same path both ways (the bridge transmits at
+ * DOWNLINK_TX_POWER). A frame that starts while the radio is taking another
+ * counts as collided and is left out of the delivery figure, which is
+ * about what ADR and the downlinks cost; bridge_fleet models collisions.
+ */
+
+#include "../LoRa-HomeKit-Bridge.ino"
+#include "../hardware/Adr.h"
+#include "../hardware/Downlink.h"
+
+#include <ArduinoJson.h>
+#include <LoRa.h>
+#include <Preferences.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#define SIM_NOISE_FLOOR_DBM -117.0
+#define SIM_FADING_DB 3.0
+#define SIM_US_PER_HOUR (3600ULL * 1000000ULL)
+
+// ============== Options ==============
+struct AdrOptions {
+    uint32_t sensors = 20;
+    double hours = 24.0;
+    double interval_s = 300.0;
+    double spread = 0.2;
+    uint32_t jitter_ms = 200;
+    double drift_ppm = 50.0;
+    int bridge_sf = 10;
+    double rssi_min = -125.0;
+    double rssi_max = -80.0;
+    uint32_t motion_every = 5;
+    uint8_t mode = ADR_MODE_AUTO;
+    double min_delivery = 0.95;
+    uint32_t seed = 1;
+};
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [--sensors N] [--hours H] [--interval S] [--spread F] [--jitter MS]\n"
+                    "       [--drift PPM] [--bridge-sf SF] [--rssi MIN,MAX] [--motion N]\n"
+                    "       [--mode off|recommend|auto] [--min-delivery F] [--seed N]\n", argv0);
+}
+
+static bool parseOptions(int argc, char** argv, AdrOptions& opt) {
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        if (i + 1 >= argc) return false;
+        const char* v = argv[++i];
+        if (strcmp(a, "--sensors") == 0) {
+            opt.sensors = (uint32_t)strtoul(v, nullptr, 10);
+        } else if (strcmp(a, "--hours") == 0) {
+            opt.hours = atof(v);
+        } else if (strcmp(a, "--interval") == 0) {
+            opt.interval_s = atof(v);
+        } else if (strcmp(a, "--spread") == 0) {
+            opt.spread = atof(v);
+        } else if (strcmp(a, "--jitter") == 0) {
+            opt.jitter_ms = (uint32_t)strtoul(v, nullptr, 10);
+        } else if (strcmp(a, "--drift") == 0) {
+            opt.drift_ppm = atof(v);
+        } else if (strcmp(a, "--bridge-sf") == 0) {
+            opt.bridge_sf = atoi(v);
+        } else if (strcmp(a, "--rssi") == 0) {
+            if (sscanf(v, "%lf,%lf", &opt.rssi_min, &opt.rssi_max) != 2) return false;
+        } else if (strcmp(a, "--motion") == 0) {
+            opt.motion_every = (uint32_t)strtoul(v, nullptr, 10);
+        } else if (strcmp(a, "--mode") == 0) {
+            uint8_t m = 0;
+            while (m < ADR_MODE_COUNT && strcmp(v, getAdrModeName(m)) != 0) m++;
+            if (m == ADR_MODE_COUNT) return false;
+            opt.mode = m;
+        } else if (strcmp(a, "--min-delivery") == 0) {
+            opt.min_delivery = atof(v);
+        } else if (strcmp(a, "--seed") == 0) {
+            opt.seed = (uint32_t)strtoul(v, nullptr, 10);
+        } else {
+            return false;
+        }
+    }
+    return opt.sensors > 0 && opt.sensors <= MAX_DEVICES && opt.hours > 0 && opt.interval_s > 0 &&
+           opt.bridge_sf >= ADR_SF_MIN && opt.bridge_sf <= ADR_SF_MAX;
+}
+
+// ============== Sensors ==============
+struct Sensor {
+    char id[24];
+    bool motion;
+    double rssi;                      // Mean RSSI at the bridge at ADR_POWER_MAX
+    double period_us;                 // Interval including crystal drift
+    uint64_t next_us;                 // Next transmission
+    uint64_t end_us;                  // ... and when it ends
+    std::string frame;
+    uint32_t n;                       // Transmissions
+
+    // Radio state, as the sensor firmware keeps it
+    uint8_t sf;
+    int8_t power;
+    uint8_t ack;                      // Last command applied (0 = none)
+    uint8_t since_downlink;
+
+    // Receive window after the last uplink
+    uint64_t window_us;
+    bool window_used;
+};
+
+struct SimResult {
+    uint32_t offered = 0;             // Uplinks sent
+    uint32_t weak = 0;                // Below sensitivity at the sensor's SF
+    uint32_t collided = 0;            // Started while the radio took another frame
+    uint32_t not_listening = 0;       // Bridge on another SF or transmitting
+    uint32_t delivered = 0;
+    uint64_t airtime_first_us = 0;    // Uplink airtime, first and last hour
+    uint64_t airtime_last_us = 0;
+    uint32_t downlinks = 0;
+    uint32_t downlinks_lost = 0;      // Too weak at the sensor
+    uint32_t applied = 0;             // Commands that changed something
+    uint32_t reverts = 0;
+    uint32_t early = 0, late = 0, wrong_sf = 0, twice = 0, unknown = 0;
+    double offset_sum_us = 0;
+    uint32_t offset_max_us = 0;
+    uint32_t sf_count[ADR_SF_MAX + 1] = {0};
+    uint32_t power_sum = 0;
+};
+
+// SX127x sensitivity at 125 kHz; wider bandwidth costs 10*log10(bw/125k)
+static double sensitivityDbm(uint8_t sf, uint32_t bw) {
+    static const double at125[] = {-118, -121, -123, -126, -129, -132, -134.5, -137};   // SF5..SF12
+    double base = at125[constrain(sf, 5, 12) - 5];
+    return base + 10.0 * log10((double)bw / 125000.0);
+}
+
+static std::string payload(const Sensor& s) {
+    char extra[48];
+    int n = snprintf(extra, sizeof(extra), ",\"dl\":1,\"pw\":%d", s.power);
+    if (s.ack) snprintf(extra + n, sizeof(extra) - n, ",\"ack\":%u", s.ack);
+
+    char buf[192];
+    if (s.motion) {
+        snprintf(buf, sizeof(buf), "{\"k\":\"%s\",\"id\":\"%s\",\"m\":%s,\"b\":%u%s}", gateway_key, s.id,
+                 s.n % 2 ? "true" : "false", 100 - s.n % 20, extra);
+    } else {
+        snprintf(buf, sizeof(buf), "{\"k\":\"%s\",\"id\":\"%s\",\"t\":%.1f,\"hu\":%u,\"b\":%u%s}", gateway_key,
+                 s.id, 20.0 + (s.n % 30) / 10.0, 40 + s.n % 20, 95 - s.n % 20, extra);
+    }
+    return buf;
+}
+
+// ============== Downlinks ==============
+static std::vector<Sensor>* sim_fleet = nullptr;
+static SimResult* sim_result = nullptr;
+static std::mt19937* sim_rng = nullptr;
+
+static double fading() {
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    return unit(*sim_rng) * SIM_FADING_DB;
+}
+
+// The bridge transmitted: check it against the addressed sensor's window,
+// then let the sensor act on it
+static void onTransmit(const uint8_t* data, size_t len) {
+    SimResult& res = *sim_result;
+    uint8_t buf[DOWNLINK_FRAME_MAX + 1];
+    if (len > DOWNLINK_FRAME_MAX) len = DOWNLINK_FRAME_MAX;
+    memcpy(buf, data, len);
+    decryptBuffer(buf, len);
+    buf[len] = 0;
+
+    StaticJsonDocument<256> doc;
+    const char* id = deserializeJson(doc, (char*)buf) ? nullptr : doc["id"].as<const char*>();
+    Sensor* s = nullptr;
+    for (Sensor& f : *sim_fleet) {
+        if (id && strcmp(f.id, id) == 0) s = &f;
+    }
+    if (!s) {
+        res.unknown++;
+        return;
+    }
+    res.downlinks++;
+
+    int64_t offset_us = (int64_t)(LoRa.tx_start_us - s->window_us);
+    if (s->window_used) {
+        res.twice++;
+        return;
+    }
+    if (offset_us < 0) {
+        res.early++;
+        return;
+    }
+    if (offset_us >= DOWNLINK_RX_WINDOW_MS * 1000LL) {
+        res.late++;
+        return;
+    }
+    if (LoRa.tx_sf != s->sf) {
+        res.wrong_sf++;
+        return;
+    }
+    res.offset_sum_us += offset_us;
+    if ((uint32_t)offset_us > res.offset_max_us) res.offset_max_us = (uint32_t)offset_us;
+
+    s->window_used = true;
+    double rssi = s->rssi + (DOWNLINK_TX_POWER - ADR_POWER_MAX) + fading();
+    if (rssi < sensitivityDbm(s->sf, lora_bw)) {
+        res.downlinks_lost++;
+        return;
+    }
+
+    s->since_downlink = 0;
+    s->ack = doc["q"] | 0;
+    int sf = doc["sf"] | 0;
+    int pw = doc["pw"] | (int)INT8_MIN;
+    if (sf >= ADR_SF_MIN && sf <= ADR_SF_MAX) s->sf = (uint8_t)sf;
+    if (pw != INT8_MIN) s->power = (int8_t)constrain(pw, ADR_POWER_MIN, ADR_POWER_MAX);
+    if (sf || pw != INT8_MIN) res.applied++;
+}
+
+// ============== Simulation ==============
+static void seedSettings(const AdrOptions& opt) {
+    Preferences p;
+    p.begin(NVS_NAMESPACE, false);
+    p.putString("wifi_ssid", "adr");
+    p.putString("wifi_pass", "adr");
+    p.putUChar("lora_sf", (uint8_t)opt.bridge_sf);
+    p.putUChar("adr_mode", opt.mode);
+    p.end();
+}
+
+static void runUntilUs(uint64_t until_us) {
+    while (hostMicros64() < until_us) loop();
+}
+
+static std::vector<Sensor> makeFleet(const AdrOptions& opt, uint64_t t0, std::mt19937& rng) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<Sensor> fleet(opt.sensors);
+    for (uint32_t i = 0; i < opt.sensors; i++) {
+        Sensor& s = fleet[i];
+        snprintf(s.id, sizeof(s.id), "adr_%03u", i);
+        s.motion = opt.motion_every && i % opt.motion_every == opt.motion_every - 1;
+        s.rssi = opt.rssi_min + unit(rng) * (opt.rssi_max - opt.rssi_min);
+        double interval = opt.interval_s * 1e6 * (1.0 + opt.spread * (2 * unit(rng) - 1));
+        s.period_us = interval * (1.0 + opt.drift_ppm * 1e-6 * (2 * unit(rng) - 1));
+        s.next_us = t0 + (uint64_t)(unit(rng) * interval);
+        s.sf = (uint8_t)opt.bridge_sf;
+        s.power = ADR_POWER_MAX;
+    }
+    return fleet;
+}
+
+int main(int argc, char** argv) {
+    AdrOptions opt;
+    if (!parseOptions(argc, argv, opt)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    hostSetSerialEnabled(false);
+    seedSettings(opt);
+    setup();
+
+    std::mt19937 rng(opt.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    SimResult res;
+    uint64_t t0 = hostMicros64() + 1000000ULL;
+    uint64_t end_us = t0 + (uint64_t)(opt.hours * SIM_US_PER_HOUR);
+    std::vector<Sensor> fleet = makeFleet(opt, t0, rng);
+    uint64_t rx_busy_until_us = 0;     // End of the last frame the radio took
+    sim_fleet = &fleet;
+    sim_result = &res;
+    sim_rng = &rng;
+    LoRa.on_transmit = onTransmit;
+
+    printf("Bridge: SF%u, BW %lu kHz, ADR %s\n", lora_sf, (unsigned long)(lora_bw / 1000), getAdrModeName(adr_mode));
+    printf("Fleet: %u sensors, interval %.0f s +-%.0f%%, jitter +-%u ms, %.1f h\n\n", opt.sensors, opt.interval_s,
+           opt.spread * 100, opt.jitter_ms, opt.hours);
+
+    for (;;) {
+        // Frames reach the radio in the order they end
+        for (Sensor& f : fleet) {
+            // No downlink for too long: back to the defaults
+            if (f.since_downlink >= ADR_REVERT_UPLINKS && (f.sf != lora_sf || f.power != ADR_POWER_MAX)) {
+                f.sf = lora_sf;
+                f.power = ADR_POWER_MAX;
+                f.since_downlink = 0;
+                res.reverts++;
+            }
+            f.frame = payload(f);
+            f.end_us = f.next_us + loraTimeOnAirUs((int)f.frame.size(), f.sf, lora_bw, lora_cr, lora_preamble);
+        }
+        Sensor* s = &fleet[0];
+        for (Sensor& f : fleet) {
+            if (f.end_us < s->end_us) s = &f;
+        }
+        if (s->next_us >= end_us) break;
+
+        uint64_t start = s->next_us;
+        uint8_t buf[256];
+        size_t len = s->frame.size() < sizeof(buf) ? s->frame.size() : sizeof(buf) - 1;
+        memcpy(buf, s->frame.data(), len);
+        len = encryptBuffer(buf, len, sizeof(buf));
+        uint32_t toa = (uint32_t)(s->end_us - start);
+        res.offered++;
+        if (start - t0 < SIM_US_PER_HOUR) res.airtime_first_us += toa;
+        if (end_us - start <= SIM_US_PER_HOUR) res.airtime_last_us += toa;
+
+        runUntilUs(start + toa);
+        double rssi = s->rssi + (s->power - ADR_POWER_MAX) + fading();
+        double snr = constrain(rssi - SIM_NOISE_FLOOR_DBM, -20.0, 10.0);
+        if (rssi < sensitivityDbm(s->sf, lora_bw)) {
+            res.weak++;
+        } else if (start < rx_busy_until_us) {
+            // The radio was taking another frame: a collision, not ADR's doing
+            res.collided++;
+        } else if (!LoRa.injectFrame(buf, len, (int)lround(rssi), (float)snr, s->sf, start)) {
+            res.not_listening++;
+        } else {
+            rx_busy_until_us = start + toa;
+            uint32_t before = packets_received;
+            loop();
+            res.delivered += packets_received - before;
+        }
+
+        s->window_us = start + toa + DOWNLINK_RX_DELAY_MS * 1000ULL;
+        s->window_used = false;
+        if (s->since_downlink < UINT8_MAX) s->since_downlink++;
+        s->n++;
+        double jitter = (2 * unit(rng) - 1) * opt.jitter_ms * 1000.0;
+        s->next_us = start + (uint64_t)(s->period_us + jitter);
+    }
+    runUntilUs(end_us + 5000000ULL);
+
+    for (const Sensor& s : fleet) {
+        res.sf_count[s.sf]++;
+        res.power_sum += s.power;
+    }
+
+    // ============== Report ==============
+    printf("SF now:   ");
+    for (uint8_t sf = ADR_SF_MIN; sf <= ADR_SF_MAX; sf++) printf(" SF%u:%-3u", sf, res.sf_count[sf]);
+    printf("  mean power %.1f dBm\n", (double)res.power_sum / opt.sensors);
+
+    double saving = res.airtime_first_us ? 1.0 - (double)res.airtime_last_us / res.airtime_first_us : 0;
+    printf("Airtime:   first hour %.2f s, last hour %.2f s (%+.1f%%); bridge counts %.1f s saved\n",
+           res.airtime_first_us / 1e6, res.airtime_last_us / 1e6, -saving * 100, adr_stats.saved_us / 1e6);
+
+    uint32_t audible = res.offered - res.weak - res.collided;
+    double delivery = audible ? (double)res.delivered / audible : 1.0;
+    printf("Uplinks:   %u sent, %u too weak, %u collided, %u while the bridge was not listening, "
+           "%u delivered (%.2f%% of the rest)\n", res.offered, res.weak, res.collided, res.not_listening,
+           res.delivered, delivery * 100);
+
+    DownlinkStats dl;
+    downlinkSnapshot(dl);
+    printf("Downlinks: %u sent (%u commands, %u keepalives), %u missed, %u busy, %.2f s on air\n", dl.sent,
+           adr_stats.commands, adr_stats.keepalives, dl.missed, dl.busy, dl.airtime_us / 1e6);
+    uint32_t timed = res.downlinks - res.early - res.late - res.wrong_sf - res.twice;
+    printf("Timing:    %u in window, start %.2f ms avg / %.2f ms max after it opened; %u early, %u late, "
+           "%u wrong SF, %u twice\n", timed, timed ? res.offset_sum_us / timed / 1000.0 : 0.0,
+           res.offset_max_us / 1000.0, res.early, res.late, res.wrong_sf, res.twice);
+    printf("Sensors:   %u commands applied, %u downlinks too weak, %u reverted to SF%u\n", res.applied,
+           res.downlinks_lost, res.reverts, lora_sf);
+    printf("Bridge:    %u acks, %u gave up, %u reverts seen, %u follow windows, %u missed, %u frames off SF%u\n",
+           adr_stats.acks, adr_stats.gave_up, adr_stats.reverts, adr_stats.follow_windows, adr_stats.follow_misses,
+           adr_stats.followed_frames, lora_sf);
+
+    uint32_t violations = res.early + res.late + res.wrong_sf + res.twice + res.unknown;
+    bool ok = violations == 0 && delivery >= opt.min_delivery;
+    printf("\n%s: %u timing violations, delivery %.2f%% (minimum %.2f%%)\n", ok ? "PASS" : "FAIL", violations,
+           delivery * 100, opt.min_delivery * 100);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+/*
+ * AllocCheck.cpp - The steady-state ingest path must not allocate
+ * Counts heap allocations (through the allocator hooks in the shims) while
+ * frames from known devices go through ingestPacket() and every event sink:
+ * decrypt, JSON parse, device update, HomeKit, MQTT publish, activity log,
+ * journal and display. Registration and MQTT discovery may allocate, so
+ * each device is heard a few times before counting starts.
+ *
+ *   bridge_alloccheck [--frames N] [--warmup N]
+ *
+ * Exits 1 if any counted frame allocated, printing the first such frame
+ * and the allocations by subsystem.
+ */
+
+#include <Arduino.h>
+#include "core/Config.h"
+#include "core/Device.h"
+#include "core/EventBus.h"
+#include "core/HeapProfiler.h"
+#include "core/Log.h"
+#include "data/ActivityLog.h"
+#include "data/Encryption.h"
+#include "data/Journal.h"
+#include "data/Settings.h"
+#include "hardware/Display.h"
+#include "hardware/LoRaModule.h"
+#include "homekit/DeviceManagement.h"
+#include "network/MQTTModule.h"
+
+// Defined by the sketch, which this tool replaces
+uint32_t boot_time = 0;
+
+// ============== Fixtures ==============
+// One frame per sensor type, with values that change from frame to frame
+static const char* const frame_formats[] = {
+    "{\"k\":\"xy\",\"id\":\"bedroom_th\",\"t\":%.1f,\"hu\":%d,\"b\":92}",
+    "{\"k\":\"xy\",\"id\":\"hallway_pir\",\"m\":%s,\"b\":100}",
+    "{\"k\":\"xy\",\"id\":\"front_door\",\"c\":%s,\"b\":87}",
+    "{\"k\":\"xy\",\"id\":\"outdoor\",\"t\":%.1f,\"hu\":%d,\"l\":8500,\"b\":65,\"m\":\"off\",\"c\":\"on\"}",
+};
+#define FRAME_KINDS (sizeof(frame_formats) / sizeof(frame_formats[0]))
+
+static int makeFrame(uint32_t n, char* out, size_t size) {
+    const char* fmt = frame_formats[n % FRAME_KINDS];
+    const char* flag = (n / FRAME_KINDS) % 2 ? "true" : "false";
+    float t = 15.0f + (float)(n % 97) / 10;
+    int hu = 40 + (int)(n % 31);
+    switch (n % FRAME_KINDS) {
+        case 1:
+        case 2:
+            return snprintf(out, size, fmt, flag);
+        default:
+            return snprintf(out, size, fmt, t, hu);
+    }
+}
+
+// Sinks subscribed and the MQTT client connected, as after a normal boot
+static void setupBridge() {
+    strcpy(gateway_key, "xy");
+    encryption_mode = ENCRYPT_NONE;
+    mqtt_enabled = true;
+    strcpy(mqtt_server, "broker.alloccheck");
+    strcpy(mqtt_topic_prefix, "lora");
+
+    journalInit();
+    subscribeHomeKitEvents();
+    subscribeActivityEvents();
+    subscribeDisplayEvents();
+    setupHomeKit();
+    initMQTT();
+    connectMQTT();
+}
+
+static uint32_t totalAllocs(uint32_t* by_subsys) {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < HEAP_SUBSYS_COUNT; i++) {
+        by_subsys[i] = heap_subsys[i].allocs;
+        total += heap_subsys[i].allocs;
+    }
+    return total;
+}
+
+// One radio frame through ingest and fan-out; returns allocations made
+static uint32_t ingestFrame(uint32_t n, uint32_t* by_subsys) {
+    char frame[160];
+    int len = makeFrame(n, frame, sizeof(frame));
+
+    uint32_t before[HEAP_SUBSYS_COUNT], after[HEAP_SUBSYS_COUNT];
+    uint32_t start = totalAllocs(before);
+    ingestPacket((uint8_t*)frame, len, -72, false);
+    while (eventBusPending() > 0) eventBusDispatch();
+    uint32_t allocs = totalAllocs(after) - start;
+
+    for (uint8_t i = 0; i < HEAP_SUBSYS_COUNT; i++) by_subsys[i] = after[i] - before[i];
+    logDrain();                             // Serial output is not part of ingest
+    return allocs;
+}
+
+// ============== Main ==============
+int main(int argc, char** argv) {
+    uint32_t frames = 10000;
+    uint32_t warmup = 4 * FRAME_KINDS;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            warmup = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "usage: %s [--frames N] [--warmup N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    hostSetSerialEnabled(false);
+    setupBridge();
+
+    uint32_t by_subsys[HEAP_SUBSYS_COUNT];
+    for (uint32_t n = 0; n < warmup; n++) ingestFrame(n, by_subsys);
+    if (!heap_alloc_tracking) {
+        printf("FAIL: no allocator hooks in this build, nothing was counted\n");
+        return 1;
+    }
+
+    uint64_t total = 0;
+    uint32_t allocating = 0;
+    for (uint32_t n = warmup; n < warmup + frames; n++) {
+        uint32_t allocs = ingestFrame(n, by_subsys);
+        if (!allocs) continue;
+        if (!allocating) {
+            char frame[160];
+            makeFrame(n, frame, sizeof(frame));
+            printf("Frame %lu allocated %lu times: %s\n  ", (unsigned long)(n - warmup),
+                   (unsigned long)allocs, frame);
+            for (uint8_t i = 0; i < HEAP_SUBSYS_COUNT; i++) {
+                if (by_subsys[i]) printf("%s %lu  ", getHeapSubsystemName(i), (unsigned long)by_subsys[i]);
+            }
+            printf("\n");
+        }
+        allocating++;
+        total += allocs;
+    }
+
+    printf("%s: %lu of %lu frames allocated (%llu allocations), %d devices\n", allocating ? "FAIL" : "PASS",
+           (unsigned long)allocating, (unsigned long)frames, (unsigned long long)total, device_count);
+    return allocating ? 1 : 0;
+}
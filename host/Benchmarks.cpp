@@ -0,0 +1,330 @@
+/*
+ * Benchmarks.cpp - Microbenchmarks for the packet ingest hot path
+ * Times the firmware functions a packet passes through, on the host build.
+ * Results go to stdout (or --out) as JSON so runs can be compared between
+ * releases:
+ *
+ *   bridge_bench [--filter substring] [--min-time ms] [--repetitions n] [--out file]
+ *
+ * Each benchmark is run in batches until a repetition has taken at least
+ * min-time / repetitions; ns_per_op is the median repetition, min_ns_per_op
+ * the fastest.
+ */
+
+#include <Arduino.h>
+#include "core/Clock.h"
+#include "core/Config.h"
+#include "core/Device.h"
+#include "core/EventBus.h"
+#include "data/ActivityLog.h"
+#include "data/Encryption.h"
+#include "data/Journal.h"
+#include "data/Settings.h"
+#include "hardware/Display.h"
+#include "hardware/LoRaModule.h"
+#include "homekit/DeviceManagement.h"
+#include "network/MQTTModule.h"
+#include <ArduinoJson.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+#ifndef HOST_BUILD_TYPE
+#define HOST_BUILD_TYPE "unknown"
+#endif
+
+extern PubSubClient mqttClient;
+
+// Defined by the sketch, which this tool replaces
+uint32_t boot_time = 0;
+
+// ============== Harness ==============
+struct BenchOptions {
+    const char* filter = nullptr;
+    uint32_t min_time_ms = 500;
+    uint32_t repetitions = 5;
+    const char* out = nullptr;
+};
+
+struct BenchResult {
+    std::string name;
+    uint64_t iterations;            // Total over all repetitions
+    double ns_per_op;               // Median repetition
+    double min_ns_per_op;
+    uint32_t bytes;                 // Input size per op, 0 if not meaningful
+};
+
+static BenchOptions opt;
+static std::vector<BenchResult> results;
+
+// Keep the compiler from discarding a result
+template <typename T> static inline void keep(T const& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+static uint64_t nowNs() {
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static void bench(const std::string& name, uint32_t bytes, const std::function<void()>& fn) {
+    if (opt.filter && name.find(opt.filter) == std::string::npos) return;
+
+    // Grow the batch until one batch takes about 1 ms
+    uint64_t batch = 1;
+    for (;;) {
+        uint64_t start = nowNs();
+        for (uint64_t i = 0; i < batch; i++) fn();
+        if (nowNs() - start >= 1000000ULL || batch >= (1ULL << 30)) break;
+        batch *= 2;
+    }
+
+    uint64_t rep_ns = (uint64_t)opt.min_time_ms * 1000000ULL / opt.repetitions;
+    std::vector<double> samples;
+    uint64_t total = 0;
+    for (uint32_t rep = 0; rep < opt.repetitions; rep++) {
+        uint64_t iters = 0;
+        uint64_t start = nowNs();
+        uint64_t elapsed;
+        do {
+            for (uint64_t i = 0; i < batch; i++) fn();
+            iters += batch;
+            elapsed = nowNs() - start;
+        } while (elapsed < rep_ns);
+        samples.push_back((double)elapsed / (double)iters);
+        total += iters;
+    }
+    std::sort(samples.begin(), samples.end());
+
+    results.push_back({name, total, samples[samples.size() / 2], samples.front(), bytes});
+    fprintf(stderr, "%-36s %12.1f ns/op\n", name.c_str(), samples[samples.size() / 2]);
+}
+
+static void writeResults(FILE* f) {
+    fprintf(f, "{\n  \"context\": {\n");
+    fprintf(f, "    \"compiler\": \"%s\",\n", __VERSION__);
+    fprintf(f, "    \"build_type\": \"%s\",\n", HOST_BUILD_TYPE);
+    fprintf(f, "    \"min_time_ms\": %lu,\n", (unsigned long)opt.min_time_ms);
+    fprintf(f, "    \"repetitions\": %lu\n", (unsigned long)opt.repetitions);
+    fprintf(f, "  },\n  \"benchmarks\": [");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        fprintf(f, "%s\n    {\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.2f, "
+                   "\"min_ns_per_op\": %.2f, \"bytes\": %lu}",
+                i ? "," : "", r.name.c_str(), (unsigned long long)r.iterations,
+                r.ns_per_op, r.min_ns_per_op, (unsigned long)r.bytes);
+    }
+    fprintf(f, "\n  ]\n}\n");
+}
+
+// ============== Fixtures ==============
+// Example packets from the README, plus the longest realistic frame
+static const char* const frames[][2] = {
+    {"temp_hum", "{\"k\":\"xy\",\"id\":\"bedroom_th\",\"t\":21.5,\"hu\":48,\"b\":92}"},
+    {"motion", "{\"k\":\"xy\",\"id\":\"hallway_pir\",\"m\":true,\"b\":100}"},
+    {"contact", "{\"k\":\"xy\",\"id\":\"front_door\",\"c\":false,\"b\":87}"},
+    {"multi", "{\"k\":\"xy\",\"id\":\"outdoor\",\"t\":15.2,\"hu\":72,\"l\":8500,\"b\":65,\"m\":\"off\",\"c\":\"on\"}"},
+};
+
+static DeviceReading makeReading(const char* id) {
+    DeviceReading r;
+    memset(&r, 0, sizeof(r));
+    snprintf(r.id, sizeof(r.id), "%.*s", (int)sizeof(r.id) - 1, id);
+    r.fields = ACT_TEMP | ACT_HUM | ACT_BATT;
+    r.rssi = -72;
+    r.temperature = 21.5f;
+    r.humidity = 48;
+    r.battery = 92;
+    return r;
+}
+
+// A full table of temperature/humidity sensors, sinks subscribed and the
+// MQTT client connected, as after a normal boot
+static void setupBridge() {
+    strcpy(gateway_key, "xy");
+    mqtt_enabled = true;
+    strcpy(mqtt_server, "broker.bench");
+    strcpy(mqtt_topic_prefix, "lora");
+
+    journalInit();
+    subscribeHomeKitEvents();
+    subscribeActivityEvents();
+    subscribeDisplayEvents();
+    setupHomeKit();
+    initMQTT();
+    connectMQTT();
+
+    char id[32];
+    for (int i = 0; i < MAX_DEVICES; i++) {
+        snprintf(id, sizeof(id), "sensor_%02d", i);
+        registerDevice(makeReading(id));
+    }
+    while (eventBusPending() > 0) eventBusDispatch();
+}
+
+// ============== Benchmarks ==============
+static void benchDecrypt() {
+    static const size_t sizes[] = {32, 64, 128, 240};
+    uint8_t buf[256];
+    memset(buf, 0x5A, sizeof(buf));
+
+    for (size_t len : sizes) {
+        bench("xor_buffer/" + std::to_string(len), len, [&] {
+            xorBuffer(buf, len);
+            keep(buf[0]);
+        });
+    }
+    for (size_t len : sizes) {
+        bench("aes_decrypt/" + std::to_string(len), len, [&] {
+            aesDecrypt(buf, len);
+            keep(buf[0]);
+        });
+    }
+}
+
+static void benchParse() {
+    for (auto& frame : frames) {
+        const char* json = frame[1];
+        size_t len = strlen(json);
+
+        bench(std::string("json_parse/") + frame[0], len, [&] {
+            StaticJsonDocument<512> doc;
+            DeserializationError err = deserializeJson(doc, json, len);
+            keep(err);
+        });
+
+        bench(std::string("parse_reading/") + frame[0], len, [&] {
+            StaticJsonDocument<512> doc;
+            deserializeJson(doc, json, len);
+            DeviceReading r;
+            parseReading(doc, -72, r);
+            keep(r);
+        });
+    }
+}
+
+static void benchFindDevice() {
+    static const int fleet_sizes[] = {1, 5, 10, MAX_DEVICES};
+    int saved = device_count;
+    char id[32];
+
+    for (int n : fleet_sizes) {
+        device_count = n;
+        snprintf(id, sizeof(id), "sensor_%02d", n - 1);
+        bench("find_device/last_of_" + std::to_string(n), 0, [&] { keep(findDevice(id)); });
+        bench("find_device/miss_of_" + std::to_string(n), 0, [&] { keep(findDevice("unknown_sensor")); });
+    }
+    device_count = saved;
+}
+
+static void benchFanOut() {
+    Device* dev = &devices[0];
+    DeviceReading r = makeReading(dev->id);
+
+    bench("apply_reading", 0, [&] { applyReading(dev, r); });
+
+    // Every sink runs once per reading (the queues never fill)
+    bench("update_device/dispatch", 0, [&] {
+        r.temperature += 0.1f;
+        updateDevice(dev, r);
+        eventBusDispatch();
+    });
+
+    bench("ingest_packet/temp_hum", (uint32_t)strlen(frames[0][1]), [&] {
+        uint8_t buf[128];
+        size_t len = strlen(frames[0][1]);
+        memcpy(buf, frames[0][1], len + 1);
+        ingestPacket(buf, (int)len, -72, true);
+        eventBusDispatch();
+    });
+}
+
+static void benchMQTT() {
+    Device* dev = &devices[0];
+    DeviceReading r = makeReading(dev->id);
+
+    bench("mqtt_publish_device_data", 0, [&] { publishDeviceData(dev, r); });
+    bench("mqtt_discovery", 0, [&] { publishHomeAssistantDiscovery(dev, dev->id); });
+}
+
+// Time-dependent paths on the virtual clock, pinned ten seconds past the
+// millis() wrap with every device last heard ten seconds before it. Nothing
+// may go offline and the diagnostics rate limit must hold.
+static bool benchTiming() {
+    const uint64_t wrap_us = (1ULL << 32) * 1000ULL;
+    bool ok = true;
+
+    setClockSource(&clock_virtual);
+    clockVirtualSet(wrap_us - 10000000ULL);
+    for (int i = 0; i < device_count; i++) {
+        updateDevice(&devices[i], makeReading(devices[i].id));
+    }
+    eventBusDispatch();
+    publishBridgeDiagnostics();
+    clockVirtualAdvance(20000000ULL);
+
+    bench("availability_sweep/across_wrap", 0, [&] { checkDeviceAvailability(); });
+    for (int i = 0; i < device_count; i++) {
+        if (devices[i].offline) {
+            fprintf(stderr, "availability_sweep: %s offline %lu ms after its last reading\n",
+                    devices[i].id, (unsigned long)clockElapsedMs(devices[i].last_seen));
+            ok = false;
+        }
+    }
+
+    uint32_t published = mqttClient.published;
+    bench("mqtt_diagnostics/rate_limited", 0, [&] { publishBridgeDiagnosticsIfChanged(); });
+    if (mqttClient.published != published) {
+        fprintf(stderr, "mqtt_diagnostics: published inside DIAGNOSTICS_MIN_INTERVAL across the wrap\n");
+        ok = false;
+    }
+
+    setClockSource(nullptr);
+    return ok;
+}
+
+// ============== Main ==============
+static bool parseOptions(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            opt.filter = argv[++i];
+        } else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            opt.min_time_ms = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+            opt.repetitions = max((uint32_t)1, (uint32_t)strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            opt.out = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--filter substring] [--min-time ms] [--repetitions n] [--out file]\n",
+                    argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (!parseOptions(argc, argv)) return 2;
+
+    hostSetSerialEnabled(false);
+    setupBridge();
+
+    benchDecrypt();
+    benchParse();
+    benchFindDevice();
+    benchFanOut();
+    benchMQTT();
+    bool timing_ok = benchTiming();
+
+    FILE* f = opt.out ? fopen(opt.out, "w") : stdout;
+    if (!f) {
+        perror(opt.out);
+        return 1;
+    }
+    writeResults(f);
+    if (f != stdout) fclose(f);
+    return timing_ok ? 0 : 1;
+}
@@ -0,0 +1,264 @@
+/*
+ * CaptureToPcap.cpp - Convert a flash capture to pcapng for Wireshark
+ * Reads the binary capture from /api/capture/download?format=bin and writes
+ * one packet per frame with the LoRaTap link type (270), so Wireshark shows
+ * the frequency, bandwidth, SF and sync word the receiver was on for that
+ * frame, RSSI and SNR. The payload is the frame as received (still
+ * encrypted unless the bridge runs without encryption). The accept/reject
+ * verdict, boot number, receive profile and frequency error go in each
+ * packet's comment; filter with frame.comment contains "rejected" or
+ * "profile 1".
+ *
+ *   bridge_pcap [--classic] lora-capture.bin out.pcapng
+ *
+ * Timestamps are bridge uptime. Each reboot continues one second after the
+ * last frame of the previous boot. --classic writes a plain pcap file, which
+ * has no room for the comments.
+ */
+
+#include <Arduino.h>
+#include "data/Capture.h"
+#include "data/Journal.h"
+
+#include <vector>
+
+#define LINKTYPE_LORATAP 270
+#define LORATAP_HEADER_LEN 15
+
+// ============== Capture Input ==============
+struct PcapFrame {
+    uint64_t ts_us;                   // Uptime, continued across reboots
+    uint16_t boot;
+    CaptureRecord rec;                // Includes the receiver settings
+    const uint8_t* payload;
+    bool crc_ok;
+};
+
+static uint8_t crc8(uint8_t crc, const uint8_t* data, size_t len) {
+    while (len--) {
+        crc ^= *data++;
+        for (uint8_t i = 0; i < 8; i++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+// Same coverage as the firmware: header without the crc byte, then payload
+static bool recordCrcOk(const CaptureRecord& rec, const uint8_t* payload) {
+    const uint8_t* hdr = (const uint8_t*)&rec;
+    size_t at = offsetof(CaptureRecord, crc);
+    uint8_t crc = crc8(0, hdr, at);
+    crc = crc8(crc, hdr + at + 1, sizeof(rec) - at - 1);
+    return crc8(crc, payload, rec.len) == rec.crc;
+}
+
+static bool readFile(const char* path, std::vector<uint8_t>& out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out.insert(out.end(), buf, buf + n);
+    fclose(f);
+    return true;
+}
+
+// Sectors arrive oldest first, each trimmed after its last record. A record
+// mark never looks like the first byte of CAPTURE_MAGIC, so the next
+// sector header is recognised by its magic.
+static bool parseCapture(const std::vector<uint8_t>& in, std::vector<PcapFrame>& frames, uint32_t& bad) {
+    size_t pos = 0;
+    uint64_t boot_offset_us = 0;
+    uint64_t last_us = 0;
+    int32_t boot = -1;
+
+    while (pos + sizeof(CaptureSectorHeader) <= in.size()) {
+        CaptureSectorHeader hdr;
+        memcpy(&hdr, &in[pos], sizeof(hdr));
+        if (hdr.magic != CAPTURE_MAGIC || hdr.version != CAPTURE_VERSION ||
+            hdr.crc != crc8(0, (const uint8_t*)&hdr, sizeof(hdr) - 1)) {
+            fprintf(stderr, "Not a capture sector at offset %zu\n", pos);
+            return false;
+        }
+        pos += sizeof(hdr);
+
+        if (boot >= 0 && hdr.boot != (uint16_t)boot) {
+            boot_offset_us = last_us + 1000000ULL;
+        }
+        boot = hdr.boot;
+
+        while (pos + sizeof(CaptureRecord) <= in.size()) {
+            CaptureRecord rec;
+            memcpy(&rec, &in[pos], sizeof(rec));
+            if ((rec.mark & 0xF0) != CAPTURE_RECORD_MARK) break;
+            if (pos + sizeof(rec) + rec.len > in.size()) {
+                bad++;
+                return true;
+            }
+
+            PcapFrame fr;
+            fr.rec = rec;
+            fr.payload = &in[pos + sizeof(rec)];
+            fr.crc_ok = recordCrcOk(rec, fr.payload);
+            fr.boot = hdr.boot;
+            fr.ts_us = boot_offset_us + (uint64_t)rec.at_ms * 1000ULL;
+            pos += sizeof(rec) + rec.len;
+
+            if (!fr.crc_ok) {
+                bad++;
+                continue;
+            }
+            last_us = fr.ts_us;
+            frames.push_back(fr);
+        }
+    }
+    return true;
+}
+
+// ============== Output ==============
+static void put16(std::vector<uint8_t>& b, uint16_t v) { b.insert(b.end(), (uint8_t*)&v, (uint8_t*)&v + 2); }
+static void put32(std::vector<uint8_t>& b, uint32_t v) { b.insert(b.end(), (uint8_t*)&v, (uint8_t*)&v + 4); }
+static void pad4(std::vector<uint8_t>& b) { while (b.size() % 4) b.push_back(0); }
+
+// LoRaTap v0: big-endian fields, RSSI as dBm + 139
+static void loraTapHeader(const PcapFrame& fr, std::vector<uint8_t>& b) {
+    const CaptureRecord& r = fr.rec;
+    uint8_t rssi = (uint8_t)constrain(r.rssi + 139, 0, 255);
+    uint8_t hdr[LORATAP_HEADER_LEN] = {
+        0, 0, 0, LORATAP_HEADER_LEN,
+        (uint8_t)(r.freq_hz >> 24), (uint8_t)(r.freq_hz >> 16), (uint8_t)(r.freq_hz >> 8), (uint8_t)r.freq_hz,
+        r.bw_125k, r.sf,
+        rssi, rssi, rssi, (uint8_t)r.snr_x4,
+        r.sync,
+    };
+    b.insert(b.end(), hdr, hdr + sizeof(hdr));
+}
+
+static const char* verdictName(uint8_t verdict) {
+    switch (verdict) {
+        case CAPTURE_ACCEPTED: return "accepted";
+        case JOURNAL_REJECT_BAD_JSON: return "rejected: bad json";
+        case JOURNAL_REJECT_WRONG_KEY: return "rejected: wrong key";
+        case JOURNAL_REJECT_NO_ID: return "rejected: no id";
+    }
+    return "rejected";
+}
+
+static void writeBlock(FILE* f, uint32_t type, std::vector<uint8_t>& body) {
+    pad4(body);
+    uint32_t len = (uint32_t)body.size() + 12;
+    fwrite(&type, 4, 1, f);
+    fwrite(&len, 4, 1, f);
+    fwrite(body.data(), 1, body.size(), f);
+    fwrite(&len, 4, 1, f);
+}
+
+static void writePcapng(FILE* f, const std::vector<PcapFrame>& frames) {
+    std::vector<uint8_t> b;
+    put32(b, 0x1A2B3C4D);             // Section header: byte-order magic, v1.0, length unknown
+    put16(b, 1);
+    put16(b, 0);
+    put32(b, 0xFFFFFFFF);
+    put32(b, 0xFFFFFFFF);
+    writeBlock(f, 0x0A0D0D0A, b);
+
+    b.clear();                        // Interface description, microsecond timestamps
+    put16(b, LINKTYPE_LORATAP);
+    put16(b, 0);
+    put32(b, 0);
+    writeBlock(f, 0x00000001, b);
+
+    for (const PcapFrame& fr : frames) {
+        std::vector<uint8_t> pkt;
+        loraTapHeader(fr, pkt);
+        pkt.insert(pkt.end(), fr.payload, fr.payload + fr.rec.len);
+
+        b.clear();
+        put32(b, 0);
+        put32(b, (uint32_t)(fr.ts_us >> 32));
+        put32(b, (uint32_t)fr.ts_us);
+        put32(b, (uint32_t)pkt.size());
+        put32(b, (uint32_t)pkt.size());
+        b.insert(b.end(), pkt.begin(), pkt.end());
+        pad4(b);
+
+        char comment[112];
+        int n = snprintf(comment, sizeof(comment), "boot %u, %s, profile %u, freq error %d Hz", fr.boot,
+                         verdictName(fr.rec.mark & 0x0F), fr.rec.profile, fr.rec.freq_err);
+        put16(b, 1);                  // opt_comment
+        put16(b, (uint16_t)n);
+        b.insert(b.end(), comment, comment + n);
+        pad4(b);
+        put32(b, 0);                  // opt_endofopt
+        writeBlock(f, 0x00000006, b);
+    }
+}
+
+static void writePcap(FILE* f, const std::vector<PcapFrame>& frames) {
+    std::vector<uint8_t> b;
+    put32(b, 0xA1B2C3D4);
+    put16(b, 2);
+    put16(b, 4);
+    put32(b, 0);
+    put32(b, 0);
+    put32(b, 65535);
+    put32(b, LINKTYPE_LORATAP);
+    fwrite(b.data(), 1, b.size(), f);
+
+    for (const PcapFrame& fr : frames) {
+        std::vector<uint8_t> pkt;
+        loraTapHeader(fr, pkt);
+        pkt.insert(pkt.end(), fr.payload, fr.payload + fr.rec.len);
+
+        b.clear();
+        put32(b, (uint32_t)(fr.ts_us / 1000000ULL));
+        put32(b, (uint32_t)(fr.ts_us % 1000000ULL));
+        put32(b, (uint32_t)pkt.size());
+        put32(b, (uint32_t)pkt.size());
+        fwrite(b.data(), 1, b.size(), f);
+        fwrite(pkt.data(), 1, pkt.size(), f);
+    }
+}
+
+// ============== Main ==============
+int main(int argc, char** argv) {
+    bool classic = false;
+    const char* paths[2] = {nullptr, nullptr};
+    int npaths = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--classic") == 0) classic = true;
+        else if (argv[i][0] != '-' && npaths < 2) paths[npaths++] = argv[i];
+        else npaths = 3;
+    }
+    if (npaths != 2) {
+        fprintf(stderr, "usage: %s [--classic] lora-capture.bin out.pcapng\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<uint8_t> in;
+    if (!readFile(paths[0], in)) return 1;
+
+    std::vector<PcapFrame> frames;
+    uint32_t bad = 0;
+    if (!parseCapture(in, frames, bad)) return 1;
+
+    FILE* f = fopen(paths[1], "wb");
+    if (!f) {
+        perror(paths[1]);
+        return 1;
+    }
+    if (classic) writePcap(f, frames);
+    else writePcapng(f, frames);
+    fclose(f);
+
+    uint32_t rejected = 0;
+    for (const PcapFrame& fr : frames) {
+        if ((fr.rec.mark & 0x0F) != CAPTURE_ACCEPTED) rejected++;
+    }
+    fprintf(stderr, "%zu frames (%lu rejected), %lu damaged records skipped\n", frames.size(),
+            (unsigned long)rejected, (unsigned long)bad);
+    return 0;
+}
@@ -0,0 +1,104 @@
+/*
+ * EventBusCheck.cpp - Coalescing sinks must not lose reading fields
+ * HomeKit and the display subscribe with EVENT_COALESCE and only apply the
+ * fields whose bits are set, so two readings from one device queued before
+ * a dispatch must arrive as one reading holding the newest value of every
+ * field either carried. Each case publishes to a coalescing test sink and
+ * compares what the handler received.
+ *
+ *   bridge_eventbus_check
+ *
+ * Exits 1 on the first case whose delivered events differ.
+ */
+
+#include <Arduino.h>
+#include "core/Device.h"
+#include "core/EventBus.h"
+#include "data/ActivityLog.h"
+
+#include <vector>
+
+// Defined by the sketch, which this tool replaces
+uint32_t boot_time = 0;
+
+// ============== Test Sink ==============
+static DeviceEvent check_queue[4];
+static std::vector<DeviceEvent> delivered;
+
+static void onCheckEvent(const DeviceEvent& ev) {
+    delivered.push_back(ev);
+}
+
+static DeviceEvent reading(uint8_t fields, float t, float hu, int batt) {
+    DeviceEvent ev;
+    initDeviceEvent(ev, DEVICE_EVENT_READING, &devices[0]);
+    ev.reading.fields = fields;
+    ev.reading.temperature = t;
+    ev.reading.humidity = hu;
+    ev.reading.battery = batt;
+    return ev;
+}
+
+static void run(std::initializer_list<DeviceEvent> events) {
+    delivered.clear();
+    for (const DeviceEvent& ev : events) eventBusPublish(ev);
+    while (eventBusPending() > 0) eventBusDispatch();
+}
+
+// ============== Cases ==============
+static bool expectReading(const char* name, uint8_t fields, float t, float hu, int batt) {
+    bool ok = delivered.size() == 1 && delivered[0].type == DEVICE_EVENT_READING;
+    if (ok) {
+        const DeviceReading& r = delivered[0].reading;
+        ok = r.fields == fields && (!(fields & ACT_TEMP) || r.temperature == t) &&
+             (!(fields & ACT_HUM) || r.humidity == hu) && (!(fields & ACT_BATT) || r.battery == batt);
+    }
+    if (ok) return true;
+
+    printf("FAIL: %s: expected one reading, fields 0x%02X t %.1f hu %.1f b %d; got %zu event(s)", name, fields, t,
+           hu, batt, delivered.size());
+    if (!delivered.empty()) {
+        const DeviceReading& r = delivered[0].reading;
+        printf(", first: fields 0x%02X t %.1f hu %.1f b %d", r.fields, r.temperature, r.humidity, r.battery);
+    }
+    printf("\n");
+    return false;
+}
+
+int main() {
+    hostSetSerialEnabled(false);
+    snprintf(devices[0].id, sizeof(devices[0].id), "check");
+    devices[0].active = true;
+    device_count = 1;
+    eventBusSubscribe("check", onCheckEvent, DEVICE_EVENT_BIT(DEVICE_EVENT_READING) |
+                      DEVICE_EVENT_BIT(DEVICE_EVENT_REGISTERED), 1, EVENT_COALESCE, check_queue, 4);
+
+    uint32_t failed = 0;
+
+    // Temperature/humidity, then a motion-only reading
+    run({reading(ACT_TEMP | ACT_HUM, 21.5f, 48, 0), reading(ACT_MOTION | ACT_MOTION_ON, 0, 0, 0)});
+    failed += !expectReading("temp/hum then motion", ACT_TEMP | ACT_HUM | ACT_MOTION | ACT_MOTION_ON, 21.5f, 48, 0);
+
+    // A field both carry takes the newer value; the others survive
+    run({reading(ACT_TEMP | ACT_BATT, 20.0f, 0, 90), reading(ACT_TEMP, 22.0f, 0, 0)});
+    failed += !expectReading("temp twice", ACT_TEMP | ACT_BATT, 22.0f, 0, 90);
+
+    // State bits follow the newer reading that has the field
+    run({reading(ACT_MOTION | ACT_MOTION_ON | ACT_CONTACT, 0, 0, 0), reading(ACT_MOTION, 0, 0, 0)});
+    failed += !expectReading("motion on then off", ACT_MOTION | ACT_CONTACT, 0, 0, 0);
+    run({reading(ACT_CONTACT | ACT_CONTACT_CLOSED, 0, 0, 0), reading(ACT_HUM, 0, 55, 0)});
+    failed += !expectReading("contact kept", ACT_CONTACT | ACT_CONTACT_CLOSED | ACT_HUM, 0, 55, 0);
+
+    // Never merged across a lifecycle event for the same device
+    DeviceEvent registered;
+    initDeviceEvent(registered, DEVICE_EVENT_REGISTERED, &devices[0]);
+    run({reading(ACT_TEMP, 19.0f, 0, 0), registered, reading(ACT_HUM, 0, 60, 0)});
+    if (delivered.size() != 3) {
+        printf("FAIL: lifecycle in between: expected 3 events, got %zu\n", delivered.size());
+        failed++;
+    }
+
+    printf("%s: %lu case(s) failed, %lu coalesced\n", failed ? "FAIL" : "PASS", (unsigned long)failed,
+           (unsigned long)event_sinks[0].stats.coalesced);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,440 @@
+/*
+ * FleetSim.cpp - Sensor fleet simulator with airtime and collisions
+ * Answers "how many sensors can one channel take": for each fleet size it
+ * schedules every sensor's transmissions, works out which frames survive
+ * the air, and delivers the survivors through the real bridge (radio mock,
+ * ingest, pipeline and sinks) to count what actually arrives.
+ *
+ *   bridge_fleet [options]
+ *     --sensors LIST      Fleet sizes to simulate (default 5,10,20,50,100,200)
+ *     --formats LIST      json,compact (default both)
+ *     --hours H           Simulated time per fleet size (default 1)
+ *     --interval S        Mean report interval (default 60 s)
+ *     --spread F          Per-sensor interval varies by +-F (default 0.2)
+ *     --jitter MS         Random delay added to every transmission (default 0)
+ *     --drift PPM         Crystal error, +-PPM per sensor (default 50)
+ *     --sf LIST           Sensor spreading factors, assigned round robin (default: the bridge's)
+ *     --bridge-sf SF      Bridge spreading factor (default: settings, SF8)
+ *     --capture-db DB     Power margin for a frame to survive an overlap (default 6)
+ *     --rssi MIN,MAX      Range of sensor mean RSSI (default -125,-70)
+ *     --seed N            Random seed (default 1)
+ *     --csv FILE          Write the curve data as CSV
+ *
+ * Air model: a frame is lost if it is below the sensitivity of its SF, if
+ * the bridge listens on another SF, or if a frame on the same SF overlaps
+ * it without being at least --capture-db weaker (capture effect). Frames on
+ * other spreading factors are treated as orthogonal. Per-frame fading is
+ * +-3 dB around the sensor's mean RSSI.
+ *
+ * The bridge only understands JSON. The compact format models a binary
+ * payload of the same readings (see compactLength()) for airtime and
+ * collisions; its surviving frames are delivered as the equivalent JSON.
+ *
+ * Each fleet size runs in a forked child, so every point starts from a
+ * freshly booted bridge.
+ */
+
+#include "../LoRa-HomeKit-Bridge.ino"
+
+#include <LoRa.h>
+#include <Preferences.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// ============== Options ==============
+enum PayloadFormat : uint8_t { FORMAT_JSON = 0, FORMAT_COMPACT, FORMAT_COUNT };
+static const char* const format_names[FORMAT_COUNT] = {"json", "compact"};
+
+struct FleetOptions {
+    std::vector<uint32_t> sensors = {5, 10, 20, 50, 100, 200};
+    std::vector<uint8_t> formats = {FORMAT_JSON, FORMAT_COMPACT};
+    double hours = 1.0;
+    double interval_s = 60.0;
+    double spread = 0.2;
+    uint32_t jitter_ms = 0;
+    double drift_ppm = 50.0;
+    std::vector<uint8_t> sfs;         // Empty = the bridge's
+    int bridge_sf = 0;                // 0 = from settings
+    double capture_db = 6.0;
+    double rssi_min = -125.0;
+    double rssi_max = -70.0;
+    uint32_t seed = 1;
+    const char* csv = nullptr;
+};
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [--sensors N,N..] [--formats json,compact] [--hours H] [--interval S]\n"
+                    "       [--spread F] [--jitter MS] [--drift PPM] [--sf SF,SF..] [--bridge-sf SF]\n"
+                    "       [--capture-db DB] [--rssi MIN,MAX] [--seed N] [--csv FILE]\n", argv0);
+}
+
+static std::vector<double> parseList(const char* s) {
+    std::vector<double> out;
+    while (*s) {
+        char* end;
+        out.push_back(strtod(s, &end));
+        if (end == s) break;
+        s = *end == ',' ? end + 1 : end;
+    }
+    return out;
+}
+
+static bool parseOptions(int argc, char** argv, FleetOptions& opt) {
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        if (i + 1 >= argc) return false;
+        const char* v = argv[++i];
+        if (strcmp(a, "--sensors") == 0) {
+            opt.sensors.clear();
+            for (double n : parseList(v)) opt.sensors.push_back((uint32_t)n);
+        } else if (strcmp(a, "--formats") == 0) {
+            opt.formats.clear();
+            if (strstr(v, "json")) opt.formats.push_back(FORMAT_JSON);
+            if (strstr(v, "compact")) opt.formats.push_back(FORMAT_COMPACT);
+        } else if (strcmp(a, "--hours") == 0) {
+            opt.hours = atof(v);
+        } else if (strcmp(a, "--interval") == 0) {
+            opt.interval_s = atof(v);
+        } else if (strcmp(a, "--spread") == 0) {
+            opt.spread = atof(v);
+        } else if (strcmp(a, "--jitter") == 0) {
+            opt.jitter_ms = (uint32_t)strtoul(v, nullptr, 10);
+        } else if (strcmp(a, "--drift") == 0) {
+            opt.drift_ppm = atof(v);
+        } else if (strcmp(a, "--sf") == 0) {
+            for (double sf : parseList(v)) opt.sfs.push_back((uint8_t)sf);
+        } else if (strcmp(a, "--bridge-sf") == 0) {
+            opt.bridge_sf = atoi(v);
+        } else if (strcmp(a, "--capture-db") == 0) {
+            opt.capture_db = atof(v);
+        } else if (strcmp(a, "--rssi") == 0) {
+            std::vector<double> r = parseList(v);
+            if (r.size() != 2) return false;
+            opt.rssi_min = r[0];
+            opt.rssi_max = r[1];
+        } else if (strcmp(a, "--seed") == 0) {
+            opt.seed = (uint32_t)strtoul(v, nullptr, 10);
+        } else if (strcmp(a, "--csv") == 0) {
+            opt.csv = v;
+        } else {
+            return false;
+        }
+    }
+    return !opt.sensors.empty() && !opt.formats.empty() && opt.interval_s > 0 && opt.hours > 0;
+}
+
+// ============== Sensors and Payloads ==============
+enum SensorKind : uint8_t { KIND_TEMP_HUM = 0, KIND_MOTION, KIND_CONTACT, KIND_MULTI, KIND_COUNT };
+
+struct Sensor {
+    char id[24];
+    SensorKind kind;
+    uint8_t sf;
+    double rssi;                      // Mean RSSI at the bridge
+    double period_ms;                 // Interval including crystal drift
+    double phase_ms;                  // First transmission
+};
+
+static std::string jsonPayload(const Sensor& s, uint32_t n) {
+    char buf[160];
+    switch (s.kind) {
+        case KIND_MOTION:
+            snprintf(buf, sizeof(buf), "{\"k\":\"%s\",\"id\":\"%s\",\"m\":%s,\"b\":%u}", gateway_key, s.id,
+                     n % 2 ? "true" : "false", 100 - n % 20);
+            break;
+        case KIND_CONTACT:
+            snprintf(buf, sizeof(buf), "{\"k\":\"%s\",\"id\":\"%s\",\"c\":%s,\"b\":%u}", gateway_key, s.id,
+                     n % 2 ? "true" : "false", 90 - n % 20);
+            break;
+        case KIND_MULTI:
+            snprintf(buf, sizeof(buf), "{\"k\":\"%s\",\"id\":\"%s\",\"t\":%.1f,\"hu\":%u,\"l\":%u,\"b\":%u}",
+                     gateway_key, s.id, 15.0 + (n % 50) / 10.0, 60 + n % 20, 8000 + n % 1000, 80 - n % 20);
+            break;
+        default:
+            snprintf(buf, sizeof(buf), "{\"k\":\"%s\",\"id\":\"%s\",\"t\":%.1f,\"hu\":%u,\"b\":%u}", gateway_key,
+                     s.id, 20.0 + (n % 30) / 10.0, 40 + n % 20, 95 - n % 20);
+            break;
+    }
+    return buf;
+}
+
+// Binary encoding of the same readings: 1 byte type/version, 2 byte key
+// check, 4 byte device hash, 1 byte sequence, then 2 bytes temperature,
+// 1 humidity, 2 lux, 1 battery, 1 motion/contact flags as present
+static int compactLength(SensorKind kind) {
+    const int header = 1 + 2 + 4 + 1;
+    switch (kind) {
+        case KIND_MOTION:
+        case KIND_CONTACT: return header + 1 + 1;
+        case KIND_MULTI: return header + 2 + 1 + 2 + 1;
+        default: return header + 2 + 1 + 1;
+    }
+}
+
+// SX127x sensitivity at 125 kHz; wider bandwidth costs 10*log10(bw/125k)
+static double sensitivityDbm(uint8_t sf, uint32_t bw) {
+    static const double at125[] = {-118, -121, -123, -126, -129, -132, -134.5, -137};   // SF5..SF12
+    double base = at125[constrain(sf, 5, 12) - 5];
+    return base + 10.0 * log10((double)bw / 125000.0);
+}
+
+// ============== Air Model ==============
+struct Frame {
+    uint64_t start_us;
+    uint64_t end_us;
+    uint32_t sensor;
+    uint32_t n;                       // Sensor's transmission count
+    double rssi;
+    bool survives;
+};
+
+struct PointResult {
+    uint32_t sensors;
+    uint8_t format;
+    uint32_t offered;                 // Frames transmitted
+    uint32_t other_sf;                // Bridge listening on another SF
+    uint32_t weak;                    // Below sensitivity
+    uint32_t collided;
+    uint32_t overrun;                 // Radio still held the previous frame
+    uint32_t delivered;               // Accepted by ingestPacket()
+    uint32_t devices;                 // Registered on the bridge
+    uint64_t airtime_us;              // On the bridge's SF
+    uint32_t avg_toa_us;
+    double duration_s;
+    double est_collision;             // The bridge's own estimate (hardware/Airtime.h)
+};
+
+static std::vector<Sensor> makeFleet(const FleetOptions& opt, uint32_t count, std::mt19937& rng) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<Sensor> fleet(count);
+    for (uint32_t i = 0; i < count; i++) {
+        Sensor& s = fleet[i];
+        snprintf(s.id, sizeof(s.id), "fleet_%03u", i);
+        s.kind = (SensorKind)(i % KIND_COUNT);
+        s.sf = opt.sfs.empty() ? lora_sf : opt.sfs[i % opt.sfs.size()];
+        s.rssi = opt.rssi_min + unit(rng) * (opt.rssi_max - opt.rssi_min);
+        double interval = opt.interval_s * 1000.0 * (1.0 + opt.spread * (2 * unit(rng) - 1));
+        double drift = opt.drift_ppm * 1e-6 * (2 * unit(rng) - 1);
+        s.period_ms = interval * (1.0 + drift);
+        s.phase_ms = unit(rng) * interval;
+    }
+    return fleet;
+}
+
+static uint32_t airLength(const Sensor& s, uint8_t format, uint32_t n) {
+    return format == FORMAT_COMPACT ? compactLength(s.kind) : (uint32_t)jsonPayload(s, n).size();
+}
+
+static void resolveAir(std::vector<Frame>& frames, const std::vector<Sensor>& fleet, double capture_db,
+                       PointResult& res) {
+    std::sort(frames.begin(), frames.end(),
+              [](const Frame& a, const Frame& b) { return a.start_us < b.start_us; });
+
+    double sensitivity = sensitivityDbm(lora_sf, lora_bw);
+    for (size_t i = 0; i < frames.size(); i++) {
+        Frame& f = frames[i];
+        const Sensor& s = fleet[f.sensor];
+        f.survives = false;
+        if (s.sf != lora_sf) {
+            res.other_sf++;
+            continue;
+        }
+        if (f.rssi < sensitivity) {
+            res.weak++;
+            continue;
+        }
+
+        // Overlapping frames on the same SF; earlier ones can still be on air
+        bool lost = false;
+        for (size_t j = i; j-- > 0 && !lost;) {
+            const Frame& o = frames[j];
+            if (fleet[o.sensor].sf != s.sf || o.end_us <= f.start_us) continue;
+            lost = f.rssi - o.rssi < capture_db;
+        }
+        for (size_t j = i + 1; j < frames.size() && frames[j].start_us < f.end_us && !lost; j++) {
+            const Frame& o = frames[j];
+            if (fleet[o.sensor].sf != s.sf) continue;
+            lost = f.rssi - o.rssi < capture_db;
+        }
+        if (lost) res.collided++;
+        else f.survives = true;
+    }
+}
+
+// ============== Bridge ==============
+static void seedSettings(const FleetOptions& opt) {
+    Preferences p;
+    p.begin(NVS_NAMESPACE, false);
+    p.putString("wifi_ssid", "fleet");
+    p.putString("wifi_pass", "fleet");
+    if (opt.bridge_sf) p.putUChar("lora_sf", (uint8_t)opt.bridge_sf);
+    p.end();
+}
+
+static void runUntilUs(uint64_t until_us) {
+    while (hostMicros64() < until_us) loop();
+}
+
+static PointResult simulatePoint(const FleetOptions& opt, uint32_t count, uint8_t format) {
+    PointResult res;
+    memset(&res, 0, sizeof(res));
+    res.sensors = count;
+    res.format = format;
+    res.duration_s = opt.hours * 3600.0;
+
+    hostSetSerialEnabled(false);
+    seedSettings(opt);
+    setup();
+
+    // Same fleet for both formats
+    std::mt19937 rng(opt.seed * 7919 + count);
+    std::vector<Sensor> fleet = makeFleet(opt, count, rng);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    uint64_t t0 = hostMicros64() + 1000000ULL;
+    uint64_t duration_us = (uint64_t)(res.duration_s * 1e6);
+    std::vector<Frame> frames;
+    uint64_t toa_sum = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        const Sensor& s = fleet[i];
+        uint32_t n = 0;
+        for (double t = s.phase_ms; t * 1000.0 < duration_us; t += s.period_ms, n++) {
+            uint32_t len = airLength(s, format, n);
+            uint32_t toa = loraTimeOnAirUs(len, s.sf, lora_bw, lora_cr, lora_preamble);
+            uint64_t start = t0 + (uint64_t)(t * 1000.0) + (uint64_t)(unit(rng) * opt.jitter_ms * 1000.0);
+            double fading = (unit(rng) * 2 - 1) * 3.0;
+            frames.push_back({start, start + toa, i, n, s.rssi + fading, false});
+            if (s.sf == lora_sf) {
+                res.airtime_us += toa;
+                toa_sum += toa;
+            }
+        }
+    }
+    res.offered = (uint32_t)frames.size();
+    resolveAir(frames, fleet, opt.capture_db, res);
+
+    // The radio raises RxDone at the end of each surviving frame
+    std::sort(frames.begin(), frames.end(), [](const Frame& a, const Frame& b) { return a.end_us < b.end_us; });
+    uint32_t accepted_before = packets_received;
+    for (const Frame& f : frames) {
+        if (!f.survives) continue;
+        runUntilUs(f.end_us);
+        if (LoRa.hasPendingPacket()) res.overrun++;
+
+        const Sensor& s = fleet[f.sensor];
+        std::string json = jsonPayload(s, f.n);
+        uint8_t buf[256];
+        size_t len = min(json.size(), sizeof(buf) - 1);
+        memcpy(buf, json.data(), len);
+        if (encryption_mode == ENCRYPT_XOR) xorBuffer(buf, len);
+        double snr = constrain(f.rssi - sensitivityDbm(lora_sf, lora_bw) - 10.0, -20.0, 10.0);
+        LoRa.injectPacket(buf, len, (int)lround(f.rssi), (float)snr);
+        loop();
+    }
+    runUntilUs(t0 + duration_us + 5000000ULL);
+
+    res.delivered = packets_received - accepted_before;
+    res.devices = device_count;
+    res.est_collision = airtimeCollisionProbability((float)(airtime_stats.total_us / (double)duration_us));
+    uint32_t on_sf = res.offered - res.other_sf;
+    res.avg_toa_us = on_sf ? (uint32_t)(toa_sum / on_sf) : 0;
+    return res;
+}
+
+// Run one point in a child, so each starts from a fresh bridge
+static bool runPoint(const FleetOptions& opt, uint32_t count, uint8_t format, PointResult& res) {
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+    fflush(stdout);
+    fflush(stderr);
+
+    pid_t pid = fork();
+    if (pid < 0) return false;
+    if (pid == 0) {
+        close(fds[0]);
+        PointResult r = simulatePoint(opt, count, format);
+        ssize_t w = write(fds[1], &r, sizeof(r));
+        _exit(w == (ssize_t)sizeof(r) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    ssize_t got = read(fds[0], &res, sizeof(res));
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return got == (ssize_t)sizeof(res) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// ============== Main ==============
+int main(int argc, char** argv) {
+    FleetOptions opt;
+    if (!parseOptions(argc, argv, opt)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    // Radio settings as the bridge will load them
+    hostSetSerialEnabled(false);
+    seedSettings(opt);
+    loadSettings();
+    printf("Bridge: SF%u, BW %lu kHz, CR 4/%u, preamble %u, sensitivity %.1f dBm\n", lora_sf,
+           (unsigned long)(lora_bw / 1000), lora_cr, lora_preamble, sensitivityDbm(lora_sf, lora_bw));
+    printf("Fleet: interval %.0f s +-%.0f%%, drift +-%.0f ppm, %.1f h per point, capture margin %.1f dB\n\n",
+           opt.interval_s, opt.spread * 100, opt.drift_ppm, opt.hours, opt.capture_db);
+    printf("%-8s %7s %8s %8s %6s %6s %8s %7s %9s %8s %7s %8s %9s %8s\n", "format", "sensors", "toa_ms",
+           "offered", "weak", "othsf", "collided", "overrun", "delivered", "rate", "load_G", "aloha",
+           "coll_rate", "est_coll");
+
+    FILE* csv = opt.csv ? fopen(opt.csv, "w") : nullptr;
+    if (opt.csv && !csv) {
+        perror(opt.csv);
+        return 1;
+    }
+    if (csv) {
+        fprintf(csv, "format,sensors,avg_toa_ms,offered,weak,other_sf,collided,overrun,delivered,"
+                     "delivered_rate,load_g,aloha_rate,collision_rate,estimated_collision,devices\n");
+    }
+
+    for (uint8_t format : opt.formats) {
+        for (uint32_t count : opt.sensors) {
+            PointResult r;
+            if (!runPoint(opt, count, format, r)) {
+                fprintf(stderr, "%s/%u: simulation failed\n", format_names[format], count);
+                return 1;
+            }
+
+            // Pure ALOHA: a frame survives if nothing else starts within one frame time either side
+            double load = (double)r.airtime_us / (r.duration_s * 1e6);
+            double aloha = exp(-2.0 * load);
+            double rate = r.offered ? (double)r.delivered / r.offered : 0;
+
+            // What the bridge would report from the frames it heard. Compact
+            // frames are delivered as JSON, so its airtime is only right for json
+            uint32_t audible = r.offered - r.other_sf - r.weak;
+            double collision_rate = audible ? (double)r.collided / audible : 0;
+            char estimate[16] = "-";
+            char estimate_csv[16] = "";
+            if (format == FORMAT_JSON) {
+                snprintf(estimate, sizeof(estimate), "%.1f%%", r.est_collision * 100);
+                snprintf(estimate_csv, sizeof(estimate_csv), "%.4f", r.est_collision);
+            }
+            printf("%-8s %7u %8.1f %8u %6u %6u %8u %7u %9u %7.1f%% %7.3f %7.1f%% %8.1f%% %8s\n",
+                   format_names[format], r.sensors, r.avg_toa_us / 1000.0, r.offered, r.weak, r.other_sf,
+                   r.collided, r.overrun, r.delivered, rate * 100, load, aloha * 100, collision_rate * 100,
+                   estimate);
+            if (csv) {
+                fprintf(csv, "%s,%u,%.2f,%u,%u,%u,%u,%u,%u,%.4f,%.4f,%.4f,%.4f,%s,%u\n",
+                        format_names[format], r.sensors, r.avg_toa_us / 1000.0, r.offered, r.weak,
+                        r.other_sf, r.collided, r.overrun, r.delivered, rate, load, aloha, collision_rate,
+                        estimate_csv, r.devices);
+            }
+        }
+    }
+    if (csv) fclose(csv);
+    return 0;
+}
@@ -0,0 +1,76 @@
+/*
+ * FuzzMain.cpp - Stand-alone driver for the fuzz harnesses
+ * Used in place of libFuzzer when the compiler is not clang. Runs each file
+ * given, or every file in each directory given, through the harness once:
+ * enough to reproduce a crash, replay a corpus under the sanitizers or
+ * time it for the slowest-input report.
+ *
+ *   bridge_fuzz_ingest crash-1234abcd
+ *   bridge_fuzz_ingest host/fuzz/corpus
+ */
+
+#include <dirent.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+extern "C" int LLVMFuzzerInitialize(int* argc, char*** argv);
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+static bool runFile(const std::string& path) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) {
+        perror(path.c_str());
+        return false;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) data.insert(data.end(), chunk, chunk + n);
+    fclose(f);
+
+    LLVMFuzzerTestOneInput(data.data(), data.size());
+    return true;
+}
+
+static void listDir(const std::string& dir, std::vector<std::string>& files) {
+    DIR* d = opendir(dir.c_str());
+    if (!d) return;
+    while (struct dirent* e = readdir(d)) {
+        if (e->d_name[0] == '.') continue;
+        std::string path = dir + "/" + e->d_name;
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) continue;
+        if (S_ISDIR(st.st_mode)) listDir(path, files);
+        else files.push_back(path);
+    }
+    closedir(d);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s file|dir...\n", argv[0]);
+        return 2;
+    }
+    LLVMFuzzerInitialize(&argc, &argv);
+
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++) {
+        struct stat st;
+        if (stat(argv[i], &st) == 0 && S_ISDIR(st.st_mode)) listDir(argv[i], files);
+        else files.push_back(argv[i]);
+    }
+    std::sort(files.begin(), files.end());
+
+    int failed = 0;
+    for (const std::string& path : files) {
+        if (!runFile(path)) failed++;
+    }
+    fprintf(stderr, "[FUZZ] Ran %zu inputs\n", files.size() - failed);
+    return failed ? 1 : 0;
+}
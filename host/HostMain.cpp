@@ -0,0 +1,102 @@
+/*
+ * HostMain.cpp - Run the bridge firmware on a workstation
+ * Compiles the sketch unmodified against the shims in host/shims and drives
+ * setup()/loop() on a virtual clock, so a simulated hour takes seconds and
+ * runs are repeatable under sanitizers and profilers. The accelerated clock
+ * keeps real compute time (for profiling) but still skips waits.
+ *
+ *   bridge_host [--seconds N] [--dual-core] [--clock virtual|accelerated|wall]
+ *               [--quiet] [--no-wifi]
+ */
+
+#include "../LoRa-HomeKit-Bridge.ino"
+
+#include <Preferences.h>
+#include <cstdlib>
+
+// ============== Options ==============
+struct HostOptions {
+    uint32_t seconds = 60;            // Simulated run time
+    bool dual_core = false;           // Ingest task on its own thread (implies wall clock)
+    HostClock clock = HOST_CLOCK_VIRTUAL;
+    bool quiet = false;               // Suppress firmware Serial output
+    bool wifi = true;                 // Preload WiFi credentials (else the bridge boots into AP mode)
+};
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [--seconds N] [--dual-core] [--clock virtual|accelerated|wall]\n"
+                    "       [--quiet] [--no-wifi]\n", argv0);
+}
+
+static bool parseOptions(int argc, char** argv, HostOptions& opt) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            opt.seconds = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--dual-core") == 0) {
+            opt.dual_core = true;
+            opt.clock = HOST_CLOCK_WALL;
+        } else if (strcmp(argv[i], "--clock") == 0 && i + 1 < argc) {
+            const char* clock = argv[++i];
+            if (strcmp(clock, "virtual") == 0) opt.clock = HOST_CLOCK_VIRTUAL;
+            else if (strcmp(clock, "accelerated") == 0) opt.clock = HOST_CLOCK_ACCELERATED;
+            else if (strcmp(clock, "wall") == 0) opt.clock = HOST_CLOCK_WALL;
+            else {
+                usage(argv[0]);
+                return false;
+            }
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            opt.quiet = true;
+        } else if (strcmp(argv[i], "--no-wifi") == 0) {
+            opt.wifi = false;
+        } else {
+            usage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Settings a freshly flashed board would get from the setup portal
+static void seedSettings(const HostOptions& opt) {
+    Preferences p;
+    p.begin(NVS_NAMESPACE, false);
+    if (opt.wifi) {
+        p.putString("wifi_ssid", "host-ssid");
+        p.putString("wifi_pass", "host-pass");
+    }
+    p.putBool("dual_core", opt.dual_core);
+    p.end();
+}
+
+// ============== Main ==============
+int main(int argc, char** argv) {
+    HostOptions opt;
+    if (!parseOptions(argc, argv, opt)) return 2;
+
+    hostSetClock(opt.clock);
+    hostSetSerialEnabled(!opt.quiet);
+    seedSettings(opt);
+
+    setup();
+
+    uint32_t loops = 0;
+    uint64_t end_us = hostMicros64() + (uint64_t)opt.seconds * 1000000ULL;
+    while (hostMicros64() < end_us) {
+        loop();
+        loops++;
+    }
+
+    hostSetSerialEnabled(true);
+    Serial.flush();
+    fprintf(stderr, "[HOST] %lu s simulated, %lu loop() calls, %lu HomeKit updates, %llu Serial bytes\n",
+            (unsigned long)opt.seconds, (unsigned long)loops,
+            (unsigned long)SpanCharacteristic::total_updates, (unsigned long long)hostSerialBytes());
+
+    // The ingest task never returns: leave without running static
+    // destructors it may still be using
+    if (pipelineIsDualCore()) {
+        fflush(stdout);
+        std::quick_exit(0);
+    }
+    return 0;
+}
@@ -0,0 +1,147 @@
+/*
+ * LogDecode.cpp - Turn LOG_BINARY serial output back into text
+ * Reads the bridge's serial output from a file, a serial device or stdin
+ * and prints it as the text build would have: frames become log lines, and
+ * everything else (boot messages, HomeSpan, Serial prints that bypass the
+ * log) is passed through as it arrives.
+ *
+ *   bridge_logdecode [--time] [capture.bin | /dev/ttyUSB0]
+ *   pio device monitor --raw | bridge_logdecode
+ *
+ * --time prefixes each decoded line with the bridge uptime and level.
+ * Records whose format was defined before the reader started print as
+ * "[LOG] format #n not yet known" until the bridge re-sends its format
+ * table (every LOG_FORMAT_REFRESH_MS).
+ */
+
+#include <Arduino.h>
+#include "core/Log.h"
+
+#include <map>
+#include <string>
+
+static std::map<uint16_t, std::string> formats;
+static bool show_time = false;
+static unsigned long decoded = 0;
+static unsigned long bad_frames = 0;
+
+// ============== Frames ==============
+static void printRecord(const uint8_t* p, size_t len) {
+    if (len < 8) {
+        bad_frames++;
+        return;
+    }
+    uint16_t id = p[0] | (p[1] << 8);
+    uint8_t level = p[2];
+    uint32_t at_ms;
+    memcpy(&at_ms, p + 3, 4);
+    uint8_t argc = p[7];
+
+    if (show_time) {
+        printf("%10.3f %-5s ", at_ms / 1000.0, getLogLevelName(level));
+    }
+    auto it = formats.find(id);
+    if (it == formats.end()) {
+        printf("[LOG] format #%u not yet known\n", id);
+        return;
+    }
+    char line[LOG_LINE_MAX + 1];
+    logFormat(line, sizeof(line), it->second.c_str(), p + 8, len - 8, argc);
+    printf("%s\n", line);
+    decoded++;
+}
+
+static void handleFrame(uint8_t type, const uint8_t* p, size_t len) {
+    switch (type) {
+        case LOG_FRAME_FORMAT:
+            if (len < 2) {
+                bad_frames++;
+                return;
+            }
+            formats[p[0] | (p[1] << 8)] = std::string((const char*)p + 2, len - 2);
+            break;
+        case LOG_FRAME_RECORD:
+            printRecord(p, len);
+            break;
+        case LOG_FRAME_DROPPED: {
+            uint32_t dropped = 0;
+            memcpy(&dropped, p, min(len, (size_t)4));
+            printf("[LOG] %lu lines dropped (ring full)\n", (unsigned long)dropped);
+            break;
+        }
+        default:
+            bad_frames++;
+            break;
+    }
+}
+
+// ============== Stream ==============
+// A frame is only taken once its checksum matches; until then the bytes
+// may be text that happens to contain the sync pair
+static void decode(FILE* in) {
+    std::string pending;              // Bytes not yet known to be text or frame
+    int c;
+    while ((c = fgetc(in)) != EOF) {
+        pending.push_back((char)c);
+
+        while (!pending.empty()) {
+            const uint8_t* b = (const uint8_t*)pending.data();
+            size_t n = pending.size();
+
+            if (b[0] != LOG_SYNC_0) {
+                size_t text = 1;
+                while (text < n && b[text] != LOG_SYNC_0) text++;
+                fwrite(b, 1, text, stdout);
+                pending.erase(0, text);
+                continue;
+            }
+            if (n >= 2 && b[1] != LOG_SYNC_1) {
+                fputc(b[0], stdout);
+                pending.erase(0, 1);
+                continue;
+            }
+            if (n < 4 || n < (size_t)b[3] + 5) break;   // Wait for the rest
+
+            size_t len = b[3];
+            uint8_t sum = b[2] + b[3];
+            for (size_t i = 0; i < len; i++) sum += b[4 + i];
+            if ((uint8_t)~sum != b[4 + len]) {
+                fputc(b[0], stdout);
+                pending.erase(0, 1);
+                continue;
+            }
+            handleFrame(b[2], b + 4, len);
+            pending.erase(0, len + 5);
+        }
+        fflush(stdout);
+    }
+    fwrite(pending.data(), 1, pending.size(), stdout);
+}
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--time") == 0) {
+            show_time = true;
+        } else if (argv[i][0] == '-' && argv[i][1]) {
+            fprintf(stderr, "usage: %s [--time] [file]\n", argv[0]);
+            return 2;
+        } else {
+            path = argv[i];
+        }
+    }
+
+    FILE* in = stdin;
+    if (path && strcmp(path, "-") != 0) {
+        in = fopen(path, "rb");
+        if (!in) {
+            perror(path);
+            return 1;
+        }
+    }
+    decode(in);
+    if (in != stdin) fclose(in);
+
+    fprintf(stderr, "[LOGDECODE] %lu lines decoded, %lu bad frames\n", decoded, bad_frames);
+    return 0;
+}
@@ -0,0 +1,439 @@
+/*
+ * Replay.cpp - Feed recorded radio traffic through the bridge
+ * Reads a capture (from /api/capture/download) or a Serial log of the
+ * bridge, boots the unmodified sketch and hands each frame to the LoRa mock
+ * at its recorded time, so processLoRaPacket() and everything after it runs
+ * exactly as on site. Then reports the device table, what each sink
+ * produced and how long each stage took.
+ *
+ *   bridge_replay [options] capture.txt|serial.log
+ *     --key K           Gateway key (default: "xy")
+ *     --enc MODE        none | xor | aes (default: from the capture header, else xor)
+ *     --enc-key HEX     Encryption key (default: the firmware default)
+ *     --speed X         Compress recorded gaps X times; 0 = back to back (default 1)
+ *     --realtime        Wall clock: waits really sleep (default: accelerated clock)
+ *     --log-gap MS      Spacing of log frames without timestamps (default 1000)
+ *     --tail S          Keep running after the last frame (default 5 s)
+ *     --no-mqtt         Leave MQTT disabled
+ *     --verbose         Show the firmware's Serial output
+ *
+ * A v2 capture records the receive profile and SF of each frame. The bridge
+ * is set up with the capture's main settings and extra profiles, and the
+ * receiver is put on each frame's profile and SF before the frame arrives,
+ * so frames heard on other profiles or in follow windows are read as they
+ * were on site.
+ *
+ * Serial logs only hold the first 64 bytes of each frame; longer frames are
+ * skipped and counted. Where the recorded time goes backwards (a capture
+ * spanning a reboot), the next frame follows after the --log-gap. Lines may carry the Arduino IDE "HH:MM:SS.mmm -> "
+ * timestamp prefix.
+ */
+
+#include "../LoRa-HomeKit-Bridge.ino"
+
+#include <LoRa.h>
+#include <Preferences.h>
+#include "data/Capture.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// ============== Options ==============
+struct ReplayOptions {
+    const char* path = nullptr;
+    const char* key = "xy";
+    int enc = -1;                     // EncryptMode, -1 = from capture header
+    uint8_t enc_key[16];
+    uint8_t enc_key_len = 0;          // 0 = firmware default
+    double speed = 1.0;
+    bool realtime = false;
+    uint32_t log_gap_ms = 1000;
+    uint32_t tail_s = 5;
+    bool mqtt = true;
+    bool verbose = false;
+};
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [--key K] [--enc none|xor|aes] [--enc-key HEX] [--speed X] [--realtime]\n"
+                    "       [--log-gap MS] [--tail S] [--no-mqtt] [--verbose] capture\n", argv0);
+}
+
+static int parseEncMode(const char* name) {
+    if (strcmp(name, "none") == 0) return ENCRYPT_NONE;
+    if (strcmp(name, "xor") == 0) return ENCRYPT_XOR;
+    if (strcmp(name, "aes") == 0) return ENCRYPT_AES;
+    return -1;
+}
+
+static size_t parseHex(const char* hex, uint8_t* out, size_t max) {
+    size_t n = 0;
+    while (hex[0] && hex[1] && n < max) {
+        if (!isxdigit((unsigned char)hex[0]) || !isxdigit((unsigned char)hex[1])) break;
+        char byte[3] = {hex[0], hex[1], 0};
+        out[n++] = (uint8_t)strtoul(byte, nullptr, 16);
+        hex += 2;
+        while (*hex == ' ') hex++;
+    }
+    return n;
+}
+
+static bool parseOptions(int argc, char** argv, ReplayOptions& opt) {
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        bool has_value = i + 1 < argc;
+        if (strcmp(a, "--key") == 0 && has_value) {
+            opt.key = argv[++i];
+        } else if (strcmp(a, "--enc") == 0 && has_value) {
+            opt.enc = parseEncMode(argv[++i]);
+            if (opt.enc < 0) return false;
+        } else if (strcmp(a, "--enc-key") == 0 && has_value) {
+            opt.enc_key_len = (uint8_t)parseHex(argv[++i], opt.enc_key, sizeof(opt.enc_key));
+        } else if (strcmp(a, "--speed") == 0 && has_value) {
+            opt.speed = atof(argv[++i]);
+        } else if (strcmp(a, "--realtime") == 0) {
+            opt.realtime = true;
+        } else if (strcmp(a, "--log-gap") == 0 && has_value) {
+            opt.log_gap_ms = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(a, "--tail") == 0 && has_value) {
+            opt.tail_s = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(a, "--no-mqtt") == 0) {
+            opt.mqtt = false;
+        } else if (strcmp(a, "--verbose") == 0) {
+            opt.verbose = true;
+        } else if (a[0] != '-' && !opt.path) {
+            opt.path = a;
+        } else {
+            return false;
+        }
+    }
+    return opt.path != nullptr;
+}
+
+// ============== Capture Input ==============
+struct ReplayFrame {
+    uint32_t at_ms;                   // Recorded time
+    int rssi;
+    float snr;
+    std::vector<uint8_t> data;
+    uint8_t profile;                  // Receiver settings (v2 captures), else RX_PROFILE_NONE
+    RxProfile rx;
+};
+
+struct CaptureFile {
+    std::vector<ReplayFrame> frames;
+    int enc = -1;                     // From the capture header
+    bool has_main = false;            // Main profile settings from the header
+    RxProfile main;
+    uint8_t cr = 0;
+    uint16_t preamble = 0;
+    RxProfile profiles[RX_PROFILES_MAX];   // Extra profiles seen in the frames
+    uint8_t profile_count = 1;
+    uint32_t lines = 0;
+    uint32_t truncated = 0;           // Log frames over 64 bytes
+};
+
+// "12:34:56.789 -> " (Arduino IDE Serial Monitor timestamps)
+static bool parseLogTime(const char*& line, uint32_t& ms) {
+    unsigned h, m, s, frac;
+    int used = 0;
+    if (sscanf(line, "%2u:%2u:%2u.%3u -> %n", &h, &m, &s, &frac, &used) != 4 || used == 0) return false;
+    ms = ((h * 60 + m) * 60 + s) * 1000 + frac;
+    line += used;
+    return true;
+}
+
+static void parseHeader(const char* line, CaptureFile& cap) {
+    unsigned version, sf, cr, pre, sync;
+    unsigned long bw;
+    float mhz;
+    if (sscanf(line, "# lora-capture v%u freq=%f sf=%u bw=%lu cr=%u pre=%u sync=0x%x", &version, &mhz, &sf, &bw,
+               &cr, &pre, &sync) == 7) {
+        cap.main = {mhz, (uint8_t)sf, (uint32_t)bw, (uint8_t)sync};
+        cap.cr = (uint8_t)cr;
+        cap.preamble = (uint16_t)pre;
+        cap.has_main = true;
+    }
+
+    const char* enc = strstr(line, "enc=");
+    if (!enc) return;
+    char name[8] = "";
+    sscanf(enc + 4, "%7s", name);
+    cap.enc = parseEncMode(name);
+}
+
+// "<MHz>/<SF>/<kHz>/<sync> <profile>" after the hex bytes (v2); the hex has
+// no '/', so the settings token is the one holding the first
+static void parseFrameSettings(const char* rest, ReplayFrame& fr) {
+    fr.profile = RX_PROFILE_NONE;
+    const char* token = strchr(rest, '/');
+    if (!token) return;
+    while (token > rest && token[-1] != ' ') token--;
+
+    float mhz;
+    unsigned sf, khz, sync, profile;
+    if (sscanf(token, "%f/%u/%u/%x %u", &mhz, &sf, &khz, &sync, &profile) != 5 || profile >= RX_PROFILES_MAX) {
+        return;
+    }
+    fr.rx = {mhz, (uint8_t)sf, khz * 1000, (uint8_t)sync};
+    fr.profile = (uint8_t)profile;
+}
+
+// Extra profiles as the bridge had them; only usable without gaps
+static void collectProfiles(CaptureFile& cap) {
+    bool seen[RX_PROFILES_MAX] = {true};
+    uint8_t highest = 0;
+    for (const ReplayFrame& fr : cap.frames) {
+        if (fr.profile == RX_PROFILE_NONE || fr.profile == RX_PROFILE_MAIN) continue;
+        cap.profiles[fr.profile] = fr.rx;
+        seen[fr.profile] = true;
+        if (fr.profile > highest) highest = fr.profile;
+    }
+    for (uint8_t i = 1; i <= highest; i++) {
+        if (!seen[i]) {
+            fprintf(stderr, "Profile %u has no frames; replaying on the main profile only\n", i);
+            return;
+        }
+    }
+    cap.profile_count = highest + 1;
+}
+
+static bool readCapture(const char* path, CaptureFile& cap, uint32_t log_gap_ms) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+
+    char raw[1024];
+    bool log_pending = false;         // "Received" seen, waiting for its hex line
+    ReplayFrame log_frame;
+    uint32_t log_len = 0;
+    uint32_t last_ms = 0;
+    uint32_t rebase_ms = 0;
+
+    while (fgets(raw, sizeof(raw), f)) {
+        cap.lines++;
+        const char* line = raw;
+        uint32_t stamp = 0;
+        bool stamped = parseLogTime(line, stamp);
+
+        if (strncmp(line, "# lora-capture", 14) == 0) {
+            parseHeader(line, cap);
+            continue;
+        }
+
+        // Capture record: <millis> <rssi> <snr> <len> <hex>
+        unsigned long at;
+        int rssi, used = 0;
+        float snr;
+        unsigned len;
+        if (isdigit((unsigned char)line[0]) &&
+            sscanf(line, "%lu %d %f %u %n", &at, &rssi, &snr, &len, &used) == 4 && used > 0) {
+            // Captures from flash can span reboots, where millis() restarts
+            if (!cap.frames.empty() && at + rebase_ms < cap.frames.back().at_ms) {
+                rebase_ms = cap.frames.back().at_ms + log_gap_ms - (uint32_t)at;
+            }
+            ReplayFrame fr = {(uint32_t)at + rebase_ms, rssi, snr, std::vector<uint8_t>(len)};
+            fr.data.resize(parseHex(line + used, fr.data.data(), len));
+            parseFrameSettings(line + used, fr);
+            cap.frames.push_back(fr);
+            continue;
+        }
+
+        // Serial log: "[LORA] Received N bytes, RSSI: R" then "[LORA] Raw hex: .."
+        const char* p;
+        if ((p = strstr(line, "[LORA] Received ")) != nullptr &&
+            sscanf(p, "[LORA] Received %u bytes, RSSI: %d", &log_len, &rssi) == 2) {
+            log_frame = ReplayFrame();
+            log_frame.at_ms = stamped ? stamp : last_ms + log_gap_ms;
+            log_frame.rssi = rssi;
+            log_frame.snr = 0;
+            log_frame.profile = RX_PROFILE_NONE;
+            log_pending = true;
+        } else if (log_pending && (p = strstr(line, "[LORA] Raw hex: ")) != nullptr) {
+            log_pending = false;
+            if (log_len > 64 || strstr(p, "...")) {
+                cap.truncated++;
+                continue;
+            }
+            log_frame.data.resize(log_len);
+            log_frame.data.resize(parseHex(p + 16, log_frame.data.data(), log_len));
+            last_ms = log_frame.at_ms;
+            cap.frames.push_back(log_frame);
+        }
+    }
+    fclose(f);
+    collectProfiles(cap);
+    return true;
+}
+
+// ============== Bridge Setup ==============
+static void seedSettings(const ReplayOptions& opt, const CaptureFile& cap) {
+    Preferences p;
+    p.begin(NVS_NAMESPACE, false);
+    p.putString("wifi_ssid", "replay");
+    p.putString("wifi_pass", "replay");
+    p.putString("gw_key", opt.key);
+
+    int enc = opt.enc >= 0 ? opt.enc : (cap.enc >= 0 ? cap.enc : DEFAULT_ENCRYPTION_MODE);
+    p.putUChar("enc_mode", (uint8_t)enc);
+    if (opt.enc_key_len > 0) {
+        p.putUChar("enc_len", opt.enc_key_len);
+        p.putBytes("enc_key", opt.enc_key, opt.enc_key_len);
+    }
+
+    if (cap.has_main) {
+        p.putFloat("lora_freq", cap.main.frequency);
+        p.putUChar("lora_sf", cap.main.sf);
+        p.putUInt("lora_bw", cap.main.bw);
+        p.putUChar("lora_sync", cap.main.syncword);
+        p.putUChar("lora_cr", cap.cr);
+        p.putUShort("lora_pre", cap.preamble);
+    }
+    char text[RX_PROFILES_TEXT_LEN] = "";
+    size_t used = 0;
+    for (uint8_t i = 1; i < cap.profile_count; i++) {
+        const RxProfile& rx = cap.profiles[i];
+        used += snprintf(text + used, sizeof(text) - used, "%s%.3f/%u/%lu/%02X", i > 1 ? ";" : "", rx.frequency,
+                         rx.sf, (unsigned long)(rx.bw / 1000), rx.syncword);
+        if (used >= sizeof(text)) break;
+    }
+    p.putString("rx_prof", text);
+
+    if (opt.mqtt) {
+        p.putBool("mqtt_en", true);
+        p.putString("mqtt_srv", "replay.local");
+    }
+    p.end();
+}
+
+// ============== Report ==============
+struct RejectCounts {
+    uint32_t by_reason[4];
+};
+
+static bool countReject(const JournalRecord& rec, void* ctx) {
+    RejectCounts* counts = (RejectCounts*)ctx;
+    counts->by_reason[rec.detail < 4 ? rec.detail : 0]++;
+    return true;
+}
+
+static void printReport(const CaptureFile& cap, uint32_t replayed, uint32_t overrun, uint64_t wall_us) {
+    printf("\n== Replay ==\n");
+    printf("frames %lu replayed, %lu skipped (truncated in log), %lu overrun (radio still full)\n",
+           (unsigned long)replayed, (unsigned long)cap.truncated, (unsigned long)overrun);
+    printf("packets accepted %lu, wall time %.1f ms\n", (unsigned long)packets_received, wall_us / 1000.0);
+    if (cap.profile_count > 1) printf("receive profiles %u, from the capture\n", cap.profile_count);
+
+    RejectCounts rejects = {};
+    JournalFilter filter = {0, nullptr, JOURNAL_REJECTED, -1, 0, UINT32_MAX};
+    journalRead(filter, UINT16_MAX, countReject, &rejects);
+    printf("rejected: bad json %lu, wrong key %lu, no id %lu\n",
+           (unsigned long)rejects.by_reason[JOURNAL_REJECT_BAD_JSON],
+           (unsigned long)rejects.by_reason[JOURNAL_REJECT_WRONG_KEY],
+           (unsigned long)rejects.by_reason[JOURNAL_REJECT_NO_ID]);
+
+    printf("\n== Devices ==\n");
+    printf("%-24s %6s %8s %6s %5s %6s %6s %s\n", "id", "rssi", "temp", "hum", "batt", "lux", "seen", "state");
+    for (int i = 0; i < device_count; i++) {
+        const Device& d = devices[i];
+        if (!d.active) continue;
+        printf("%-24s %6d %8.1f %6.0f %5d %6d %5lus %s\n", d.id, d.rssi, d.temperature, d.humidity,
+               d.battery, d.lux, (unsigned long)(clockElapsedMs(d.last_seen) / 1000),
+               d.offline ? "offline" : "online");
+    }
+
+    printf("\n== Sinks ==\n");
+    printf("%-10s %9s %8s %9s %8s %8s\n", "sink", "delivered", "dropped", "coalesced", "avg_us", "max_us");
+    for (uint8_t i = 0; i < event_sink_count; i++) {
+        const EventSink& s = event_sinks[i];
+        printf("%-10s %9lu %8lu %9lu %8lu %8lu\n", s.name, (unsigned long)s.stats.delivered,
+               (unsigned long)s.stats.dropped, (unsigned long)s.stats.coalesced,
+               (unsigned long)(s.stats.delivered ? s.stats.total_us / s.stats.delivered : 0),
+               (unsigned long)s.stats.max_us);
+    }
+    PubSubClient* mqtt = PubSubClient::last_instance;
+    printf("mqtt messages %lu (%llu bytes), homekit updates %lu, journal records %lu\n",
+           (unsigned long)(mqtt ? mqtt->published : 0),
+           (unsigned long long)(mqtt ? mqtt->published_bytes : 0),
+           (unsigned long)SpanCharacteristic::total_updates, (unsigned long)journalNewestSeq());
+
+    const PipelineStats& st = pipeline_stats;
+    printf("\n== Stages ==\n");
+    printf("ingest   %lu events, avg %lu us\n", (unsigned long)st.ingested,
+           (unsigned long)(st.ingested ? st.ingest_us / st.ingested : 0));
+    printf("fan-out  %lu events, avg %lu us, max pickup->done %lu us\n", (unsigned long)st.fanned_out,
+           (unsigned long)(st.fanned_out ? st.fanout_us / st.fanned_out : 0),
+           (unsigned long)st.max_latency_us);
+    for (uint8_t i = 0; i < LOOP_SECTION_COUNT; i++) {
+        const LoopSectionStats& s = loop_sections[i];
+        printf("loop %-9s avg %6lu us  p99 %7lu us  max %7lu us\n", getLoopSectionName(i),
+               (unsigned long)(s.count ? s.total_us / s.count : 0),
+               (unsigned long)loopProfilerPercentile(s, 99), (unsigned long)s.max_us);
+    }
+}
+
+// ============== Main ==============
+static uint64_t wallMicros() {
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static void runUntil(uint32_t until_ms) {
+    while ((int32_t)(millis() - until_ms) < 0) loop();
+}
+
+int main(int argc, char** argv) {
+    ReplayOptions opt;
+    if (!parseOptions(argc, argv, opt)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    CaptureFile cap;
+    if (!readCapture(opt.path, cap, opt.log_gap_ms)) return 1;
+    if (cap.frames.empty()) {
+        fprintf(stderr, "%s: no frames found in %lu lines\n", opt.path, (unsigned long)cap.lines);
+        return 1;
+    }
+
+    hostSetClock(opt.realtime ? HOST_CLOCK_WALL : HOST_CLOCK_ACCELERATED);
+    hostSetSerialEnabled(opt.verbose);
+    seedSettings(opt, cap);
+    setup();
+
+    // Let boot-time jobs settle, then start from clean statistics
+    runUntil(millis() + 1000);
+    loopProfilerReset();
+    pipelineResetStats();
+    eventBusResetStats();
+
+    uint64_t wall_start = wallMicros();
+    uint32_t start_ms = millis();
+    uint32_t first_at = cap.frames.front().at_ms;
+    uint32_t replayed = 0, overrun = 0;
+
+    for (const ReplayFrame& fr : cap.frames) {
+        if (opt.speed > 0) {
+            runUntil(start_ms + (uint32_t)((fr.at_ms - first_at) / opt.speed));
+        }
+        // The previous frame must have been read, or the radio overwrites it
+        for (int i = 0; LoRa.hasPendingPacket() && i < 100; i++) loop();
+        if (LoRa.hasPendingPacket()) overrun++;
+
+        // Onto the recorded settings; the schedule holds off while the frame waits
+        if (fr.profile < rx_profile_count) loraSetReceive(fr.profile, fr.rx.sf);
+        LoRa.injectPacket(fr.data.data(), fr.data.size(), fr.rssi, fr.snr);
+        loop();
+        replayed++;
+    }
+    runUntil(millis() + opt.tail_s * 1000);
+
+    uint64_t wall_us = wallMicros() - wall_start;
+
+    hostSetSerialEnabled(true);
+    Serial.flush();
+    printReport(cap, replayed, overrun, wall_us);
+    return 0;
+}
@@ -0,0 +1,342 @@
+/*
+ * RxSchedSim.cpp - Multi-profile receive schedule on the mock radio
+ * Runs the bridge against sensors spread over several radio profiles
+ * (hardware/RxScheduler.h). The radio mock only hears a frame if the bridge
+ * was listening on its frequency, bandwidth, SF and sync word for all of it,
+ * and each setting written costs --switch-us of clock, so dwells, switches
+ * and the missed-frame estimates are exercised as on the board.
+ *
+ *   bridge_rxsched [options]
+ *     --profile P:N       Radio profile MHz/SF/kHz/sync with N sensors; repeat
+ *                         for each, the first is the bridge's own settings
+ *                         (default 868.0/8/125/12:12, 869.525/7/250/34:6,
+ *                         868.3/10/125/12:2)
+ *     --hours H           Simulated time (default 6)
+ *     --interval S        Mean report interval (default 300 s)
+ *     --spread F          Per-sensor interval varies by +-F (default 0.2)
+ *     --jitter MS         Transmissions vary by +-MS (default 200)
+ *     --switch-us US      Clock cost of each radio setting written (default 40)
+ *     --max-error F       Largest error of a profile's estimated frames sent (default 0.15)
+ *     --seed N            Random seed (default 1)
+ *
+ * Checked: every profile is heard (none starved); no quieter profile gets
+ * more time than the busiest, unless its dwell is held at the least that
+ * fits a frame; and each profile's frames heard plus estimated missed is
+ * within --max-error of the frames it could have heard (sent, not
+ * collided), or 2.5/sqrt(heard) if that is more, as the estimate scales up
+ * a count. The exit status is 1 if any fails. For comparison the report
+ * also gives what an equal split of the cycle would hear.
+ *
+ * Sensors on a profile collide with each other (a frame starting while
+ * another on the same profile is on the air is left out), not with other
+ * profiles'. Links are strong: only the schedule loses frames.
+ */
+
+#include "../LoRa-HomeKit-Bridge.ino"
+#include "../hardware/RxScheduler.h"
+
+#include <LoRa.h>
+#include <Preferences.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#define SIM_US_PER_HOUR (3600ULL * 1000000ULL)
+
+// ============== Options ==============
+struct SimProfile {
+    RxProfile radio;
+    uint32_t sensors;
+};
+
+struct RxSchedOptions {
+    std::vector<SimProfile> profiles;
+    double hours = 6.0;
+    double interval_s = 300.0;
+    double spread = 0.2;
+    uint32_t jitter_ms = 200;
+    uint32_t switch_us = 40;
+    double max_error = 0.15;
+    uint32_t seed = 1;
+};
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [--profile MHz/SF/kHz/sync:N]... [--hours H] [--interval S] [--spread F]\n"
+                    "       [--jitter MS] [--switch-us US] [--max-error F] [--seed N]\n", argv0);
+}
+
+static bool parseProfile(const char* v, SimProfile& out) {
+    const char* colon = strchr(v, ':');
+    if (!colon) return false;
+    std::string radio(v, colon - v);
+    uint8_t n = 0;
+    if (!rxSchedParseProfiles(radio.c_str(), &out.radio, 1, n) || n != 1) return false;
+    out.sensors = (uint32_t)strtoul(colon + 1, nullptr, 10);
+    return true;
+}
+
+static bool parseOptions(int argc, char** argv, RxSchedOptions& opt) {
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        if (i + 1 >= argc) return false;
+        const char* v = argv[++i];
+        if (strcmp(a, "--profile") == 0) {
+            SimProfile p;
+            if (!parseProfile(v, p)) return false;
+            opt.profiles.push_back(p);
+        } else if (strcmp(a, "--hours") == 0) {
+            opt.hours = atof(v);
+        } else if (strcmp(a, "--interval") == 0) {
+            opt.interval_s = atof(v);
+        } else if (strcmp(a, "--spread") == 0) {
+            opt.spread = atof(v);
+        } else if (strcmp(a, "--jitter") == 0) {
+            opt.jitter_ms = (uint32_t)strtoul(v, nullptr, 10);
+        } else if (strcmp(a, "--switch-us") == 0) {
+            opt.switch_us = (uint32_t)strtoul(v, nullptr, 10);
+        } else if (strcmp(a, "--max-error") == 0) {
+            opt.max_error = atof(v);
+        } else if (strcmp(a, "--seed") == 0) {
+            opt.seed = (uint32_t)strtoul(v, nullptr, 10);
+        } else {
+            return false;
+        }
+    }
+    if (opt.profiles.empty()) {
+        const char* defaults[] = {"868.0/8/125/12:12", "869.525/7/250/34:6", "868.3/10/125/12:2"};
+        for (const char* d : defaults) {
+            SimProfile p;
+            parseProfile(d, p);
+            opt.profiles.push_back(p);
+        }
+    }
+    uint32_t sensors = 0;
+    for (const SimProfile& p : opt.profiles) sensors += p.sensors;
+    return opt.profiles.size() <= RX_PROFILES_MAX && sensors > 0 && sensors <= MAX_DEVICES && opt.hours > 0 &&
+           opt.interval_s > 0;
+}
+
+// ============== Sensors ==============
+struct Sensor {
+    char id[24];
+    uint8_t profile;
+    double period_us;
+    uint64_t next_us;                 // Next transmission
+    uint64_t end_us;                  // ... and when it ends
+    std::string frame;
+    uint32_t n;                       // Transmissions
+};
+
+struct ProfileResult {
+    uint32_t sent = 0;
+    uint32_t collided = 0;            // Started while another sensor's frame on the profile was on the air
+    uint32_t heard = 0;               // Taken by the radio
+    uint32_t delivered = 0;           // ... and accepted
+    uint64_t airtime_us = 0;
+    uint64_t busy_until_us = 0;       // End of the last frame on the air
+};
+
+static std::string payload(const Sensor& s) {
+    char buf[160];
+    snprintf(buf, sizeof(buf), "{\"k\":\"%s\",\"id\":\"%s\",\"t\":%.1f,\"hu\":%u,\"b\":%u}", gateway_key, s.id,
+             20.0 + (s.n % 30) / 10.0, 40 + s.n % 20, 95 - s.n % 20);
+    return buf;
+}
+
+static uint32_t frameUs(const RxProfile& p, size_t len) {
+    return loraTimeOnAirUs((int)len, p.sf, p.bw, lora_cr, lora_preamble);
+}
+
+// ============== Simulation ==============
+static void seedSettings(const RxSchedOptions& opt) {
+    const RxProfile& main = opt.profiles[0].radio;
+    std::string extra;
+    char entry[32];
+    for (size_t i = 1; i < opt.profiles.size(); i++) {
+        const RxProfile& p = opt.profiles[i].radio;
+        snprintf(entry, sizeof(entry), "%s%.3f/%u/%lu/%02X", extra.empty() ? "" : ";", p.frequency, p.sf,
+                 (unsigned long)(p.bw / 1000), p.syncword);
+        extra += entry;
+    }
+
+    Preferences p;
+    p.begin(NVS_NAMESPACE, false);
+    p.putString("wifi_ssid", "rxsched");
+    p.putString("wifi_pass", "rxsched");
+    p.putFloat("lora_freq", main.frequency);
+    p.putUChar("lora_sf", main.sf);
+    p.putUInt("lora_bw", main.bw);
+    p.putUChar("lora_sync", main.syncword);
+    p.putString("rx_prof", extra.c_str());
+    p.putUChar("adr_mode", 0);
+    p.end();
+}
+
+static void runUntilUs(uint64_t until_us) {
+    while (hostMicros64() < until_us) loop();
+}
+
+static std::vector<Sensor> makeFleet(const RxSchedOptions& opt, uint64_t t0, std::mt19937& rng) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<Sensor> fleet;
+    for (size_t p = 0; p < opt.profiles.size(); p++) {
+        for (uint32_t i = 0; i < opt.profiles[p].sensors; i++) {
+            Sensor s = {};
+            snprintf(s.id, sizeof(s.id), "rx%u_%03u", (unsigned)p, i % 1000);
+            s.profile = (uint8_t)p;
+            s.period_us = opt.interval_s * 1e6 * (1.0 + opt.spread * (2 * unit(rng) - 1));
+            s.next_us = t0 + (uint64_t)(unit(rng) * s.period_us);
+            fleet.push_back(s);
+        }
+    }
+    return fleet;
+}
+
+// A profile's typical frame, as the scheduler sizes dwells with it
+static double frameMs(const RxProfileStats* stats, uint8_t i) {
+    return frameUs(rx_profiles[i], stats[i].frame_len) / 1000 + 1;
+}
+
+// Share of the time a profile can catch a typical frame if the cycle is
+// split equally (clamped to the scheduler's least dwell)
+static void equalSplit(const RxProfileStats* stats, uint8_t n, double* usable) {
+    double dwell[RX_PROFILES_MAX], cycle = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        dwell[i] = (double)RX_SCHED_CYCLE_MS / n;
+        if (dwell[i] < RX_SCHED_MIN_FRAMES * frameMs(stats, i)) dwell[i] = RX_SCHED_MIN_FRAMES * frameMs(stats, i);
+        cycle += dwell[i];
+    }
+    for (uint8_t i = 0; i < n; i++) usable[i] = (dwell[i] - frameMs(stats, i)) / cycle;
+}
+
+int main(int argc, char** argv) {
+    RxSchedOptions opt;
+    if (!parseOptions(argc, argv, opt)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    hostSetSerialEnabled(false);
+    seedSettings(opt);
+    setup();
+    LoRa.config_write_us = opt.switch_us;
+
+    std::mt19937 rng(opt.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    uint8_t n = (uint8_t)opt.profiles.size();
+    std::vector<ProfileResult> res(n);
+    uint64_t t0 = hostMicros64() + 1000000ULL;
+    uint64_t end_us = t0 + (uint64_t)(opt.hours * SIM_US_PER_HOUR);
+    std::vector<Sensor> fleet = makeFleet(opt, t0, rng);
+
+    printf("Bridge: %u receive profile(s), interval %.0f s +-%.0f%%, %u us per setting written, %.1f h\n\n",
+           rx_profile_count, opt.interval_s, opt.spread * 100, opt.switch_us, opt.hours);
+    if (rx_profile_count != n) {
+        fprintf(stderr, "bridge took %u of %u profiles\n", rx_profile_count, n);
+        return 2;
+    }
+
+    for (;;) {
+        // Frames reach the radio in the order they end
+        for (Sensor& f : fleet) {
+            f.frame = payload(f);
+            f.end_us = f.next_us + frameUs(rx_profiles[f.profile], f.frame.size());
+        }
+        Sensor* s = &fleet[0];
+        for (Sensor& f : fleet) {
+            if (f.end_us < s->end_us) s = &f;
+        }
+        if (s->next_us >= end_us) break;
+
+        const RxProfile& radio = rx_profiles[s->profile];
+        ProfileResult& r = res[s->profile];
+        uint64_t start = s->next_us;
+        uint8_t buf[256];
+        size_t len = s->frame.size() < sizeof(buf) ? s->frame.size() : sizeof(buf) - 1;
+        memcpy(buf, s->frame.data(), len);
+        len = encryptBuffer(buf, len, sizeof(buf));
+        r.sent++;
+        r.airtime_us += s->end_us - start;
+
+        runUntilUs(s->end_us);
+        if (start < r.busy_until_us) {
+            r.collided++;
+        } else if (LoRa.injectFrame(buf, len, -90, 8.0f, radio.sf, start, (long)(radio.frequency * 1E6), radio.bw,
+                                    radio.syncword)) {
+            r.heard++;
+            uint32_t before = packets_received;
+            loop();
+            r.delivered += packets_received - before;
+        }
+        if (s->end_us > r.busy_until_us) r.busy_until_us = s->end_us;
+
+        s->n++;
+        double jitter = (2 * unit(rng) - 1) * opt.jitter_ms * 1000.0;
+        s->next_us = start + (uint64_t)(s->period_us + jitter);
+    }
+    runUntilUs(end_us);
+
+    // ============== Report ==============
+    RxProfileStats stats[RX_PROFILES_MAX];
+    RxSchedStats sched;
+    rxSchedSnapshot(stats, sched);
+    double equal[RX_PROFILES_MAX];
+    equalSplit(stats, n, equal);
+
+    printf("Profile                     Sensors   Sent Collided  Heard  Missed  Estimated  Error  Time  Dwell  "
+           "Rate/h%s\n", n > 1 ? "  Equal split" : "");
+    uint32_t misjudged = 0;
+    uint8_t busiest = 0;
+    uint32_t heard_all = 0, delivered_all = 0, audible_all = 0;
+    double equal_all = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        const RxProfile& p = rx_profiles[i];
+        const ProfileResult& r = res[i];
+        const RxProfileStats& st = stats[i];
+        uint32_t audible = r.sent - r.collided;
+        uint32_t missed = audible - r.heard;
+        double error = audible ? ((double)st.frames + st.missed - audible) / audible : 0;
+        double share = sched.elapsed_ms ? (double)st.listen_ms / sched.elapsed_ms : 0;
+
+        // Scaling up a count of heard frames is itself about 1/sqrt(heard) out
+        double tolerance = r.heard ? fmax(opt.max_error, 2.5 / sqrt((double)r.heard)) : 0;
+        bool ok = r.heard > 0 && fabs(error) <= tolerance;
+        if (!ok) misjudged++;
+        if (r.sent > res[busiest].sent) busiest = i;
+        heard_all += r.heard;
+        delivered_all += r.delivered;
+        audible_all += audible;
+        equal_all += audible * equal[i];
+
+        char name[32], split[16] = "";
+        snprintf(name, sizeof(name), "%u: %.3f/SF%u/%lu/%02X", i, p.frequency, p.sf, (unsigned long)(p.bw / 1000),
+                 p.syncword);
+        if (n > 1) snprintf(split, sizeof(split), "  %10.1f%%", equal[i] * 100);
+        printf("%-27s %7u %6u %8u %6u %7u %10u %+5.1f%% %4.0f%% %5.2fs %7.1f%s%s\n", name, opt.profiles[i].sensors,
+               r.sent, r.collided, r.heard, missed, st.missed, error * 100, share * 100, st.dwell_ms / 1000.0,
+               st.rate_per_h, split, ok ? "" : "  FAIL");
+    }
+
+    printf("\nHeard:     %u of %u frames that did not collide (%.1f%%), %u accepted", heard_all, audible_all,
+           audible_all ? 100.0 * heard_all / audible_all : 0.0, delivered_all);
+    if (n > 1) printf("; an equal split would hear about %.1f%%", audible_all ? 100.0 * equal_all / audible_all : 0.0);
+    printf("\nSwitches:  %u (%u cycles), %.1f us avg / %u us max, %.2f s in all; %u deferred by a frame; "
+           "%u settings written\n", sched.switches, sched.cycles,
+           sched.switches ? (double)sched.switch_us / sched.switches : 0.0, sched.switch_max_us,
+           sched.switch_us / 1e6, sched.deferred, LoRa.config_changes);
+
+    // Time follows traffic: no quieter profile gets more than the busiest,
+    // unless it is held at its least dwell to fit a frame in
+    uint32_t outweighed = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        bool held = stats[i].dwell_ms <= RX_SCHED_MIN_FRAMES * frameMs(stats, i);
+        if (i != busiest && !held && stats[i].listen_ms > stats[busiest].listen_ms) outweighed++;
+    }
+
+    bool ok = misjudged == 0 && outweighed == 0;
+    printf("\n%s: %u profile(s) starved or misestimated (tolerance %.0f%% or 2.5/sqrt(heard)), "
+           "%u quieter profile(s) given more time than the busiest\n", ok ? "PASS" : "FAIL", misjudged,
+           opt.max_error * 100, outweighed);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+/*
+ * SnapshotStress.cpp - Torn-read stress test for the device sequence lock
+ * Writer threads update devices inside deviceWriteBegin()/deviceWriteEnd()
+ * while reader threads copy them with snapshotDevice(), as the ingest task
+ * and loop() do in dual-core mode. Every write derives all guarded fields
+ * from one value, so a snapshot mixing two writes breaks the invariant.
+ *
+ *   bridge_snapshot_stress [--writers N] [--readers N] [--devices N]
+ *                          [--seconds S] [--raw]
+ *
+ * --raw copies the fields without the lock, to show that the check does
+ * catch torn reads on this machine. Reports device_snapshot_retries and
+ * exits 1 if any snapshot was torn.
+ */
+
+#include <Arduino.h>
+#include "core/Device.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// ============== Options ==============
+struct StressOptions {
+    uint32_t writers = 2;             // Per device: writers also exclude each other
+    uint32_t readers = 4;
+    uint32_t devices = 2;
+    double seconds = 2;               // Wall time
+    bool raw = false;
+};
+
+static StressOptions opt;
+static std::atomic<bool> stop{false};
+static std::atomic<uint64_t> writes{0};
+static std::atomic<uint64_t> snapshots{0};
+static std::atomic<uint64_t> torn{0};
+static std::atomic<bool> reported{false};
+
+// ============== Invariant ==============
+// Every guarded field is a function of last_seen
+static void writeFields(Device* dev, uint32_t v) {
+    dev->last_seen = v;
+    dev->rssi = -(int)(v % 128);
+    dev->temperature = (float)(v % 4096) / 8;
+    dev->humidity = (float)(v % 101);
+    dev->battery = (int)(v ^ 0x5A5A5A5A);
+    dev->lux = (int)(v * 3);
+    dev->motion = v & 1;
+    dev->contact = !(v & 1);
+    dev->interval.period_ms = v + 1;
+    dev->interval.expected = ~v;
+}
+
+static bool consistent(const DeviceSnapshot& s) {
+    uint32_t v = s.last_seen;
+    return s.rssi == -(int)(v % 128) && s.temperature == (float)(v % 4096) / 8 &&
+           s.humidity == (float)(v % 101) && s.battery == (int)(v ^ 0x5A5A5A5A) && s.lux == (int)(v * 3) &&
+           s.motion == (bool)(v & 1) && s.contact == !(v & 1) && s.interval.period_ms == v + 1 &&
+           s.interval.expected == ~v && !(s.seq & 1);
+}
+
+// Unlocked copy of the same fields (--raw)
+static void rawCopy(const Device* dev, DeviceSnapshot& out) {
+    const volatile Device* d = dev;
+    out.seq = 0;
+    out.last_seen = d->last_seen;
+    out.rssi = d->rssi;
+    out.temperature = d->temperature;
+    out.humidity = d->humidity;
+    out.battery = d->battery;
+    out.lux = d->lux;
+    out.motion = d->motion;
+    out.contact = d->contact;
+    out.interval.period_ms = d->interval.period_ms;
+    out.interval.expected = d->interval.expected;
+}
+
+// ============== Threads ==============
+static void writer(uint32_t index) {
+    uint32_t n = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+        Device* dev = &devices[n % opt.devices];
+        uint32_t v = (n++ << 4) | index;      // Distinct per writer
+        deviceWriteBegin(dev);
+        writeFields(dev, v);
+        deviceWriteEnd(dev);
+        writes.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+static void reader(uint32_t index) {
+    uint32_t n = index;
+    while (!stop.load(std::memory_order_relaxed)) {
+        const Device* dev = &devices[n++ % opt.devices];
+        DeviceSnapshot snap;
+        if (opt.raw) rawCopy(dev, snap);
+        else snapshotDevice(dev, snap);
+        snapshots.fetch_add(1, std::memory_order_relaxed);
+        if (consistent(snap)) continue;
+
+        torn.fetch_add(1, std::memory_order_relaxed);
+        if (!reported.exchange(true)) {
+            printf("Torn snapshot of %s at seq %lu: last_seen %lu, rssi %d, battery %d, lux %d, period %lu\n",
+                   dev->id, (unsigned long)snap.seq, (unsigned long)snap.last_seen, snap.rssi, snap.battery,
+                   snap.lux, (unsigned long)snap.interval.period_ms);
+        }
+    }
+}
+
+// ============== Main ==============
+static bool parseOptions(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        if (strcmp(a, "--raw") == 0) {
+            opt.raw = true;
+            continue;
+        }
+        if (i + 1 >= argc) return false;
+        const char* v = argv[++i];
+        if (strcmp(a, "--writers") == 0) opt.writers = (uint32_t)strtoul(v, nullptr, 10);
+        else if (strcmp(a, "--readers") == 0) opt.readers = (uint32_t)strtoul(v, nullptr, 10);
+        else if (strcmp(a, "--devices") == 0) opt.devices = (uint32_t)strtoul(v, nullptr, 10);
+        else if (strcmp(a, "--seconds") == 0) opt.seconds = atof(v);
+        else return false;
+    }
+    return opt.writers > 0 && opt.writers <= 16 && opt.readers > 0 && opt.devices > 0 &&
+           opt.devices <= MAX_DEVICES && opt.seconds > 0;
+}
+
+int main(int argc, char** argv) {
+    if (!parseOptions(argc, argv)) {
+        fprintf(stderr, "usage: %s [--writers N] [--readers N] [--devices N] [--seconds S] [--raw]\n", argv[0]);
+        return 2;
+    }
+
+    for (uint32_t i = 0; i < opt.devices; i++) {
+        Device* dev = &devices[i];
+        snprintf(dev->id, sizeof(dev->id), "stress_%02lu", (unsigned long)i);
+        writeFields(dev, 0);
+        dev->active = true;
+    }
+    device_count = (int)opt.devices;
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < opt.writers; i++) threads.emplace_back(writer, i);
+    for (uint32_t i = 0; i < opt.readers; i++) threads.emplace_back(reader, i);
+    std::this_thread::sleep_for(std::chrono::duration<double>(opt.seconds));
+    stop = true;
+    for (std::thread& t : threads) t.join();
+
+    printf("%s: %llu writes, %llu snapshots (%s), %llu torn, device_snapshot_retries %lu\n",
+           torn ? "FAIL" : "PASS", (unsigned long long)writes.load(), (unsigned long long)snapshots.load(),
+           opt.raw ? "unlocked" : "snapshotDevice", (unsigned long long)torn.load(),
+           (unsigned long)device_snapshot_retries);
+    return torn ? 1 : 0;
+}
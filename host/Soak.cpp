@@ -0,0 +1,819 @@
+/*
+ * Soak.cpp - Weeks of bridge uptime on a virtual clock
+ * Runs the sketch for days of simulated time with sensors joining, leaving
+ * and going quiet, MQTT broker outages and a steady trickle of web API
+ * requests, and checks the bridge's state at every checkpoint. Problems
+ * that take days to show up on a real board (millis() rollover, slow heap
+ * growth, fragmentation, timers slipping) show up here in minutes.
+ *
+ *   bridge_soak [options]
+ *     --days D            Simulated uptime (default 21)
+ *     --start-days D      millis() at boot, in days (default 40, so the
+ *                         49.7-day rollover happens on day 9.7 of the run)
+ *     --devices N         Sensors reporting at any time (default 12)
+ *     --interval S        Mean report interval (default 120 s)
+ *     --churn-hours H     One sensor is retired and a new one joins every
+ *                         H hours; another goes quiet for a while (default 12)
+ *     --outage-hours H    Mean time between MQTT broker outages (default 6)
+ *     --web-per-hour N    API requests per hour (default 30)
+ *     --noise-hours H     Mean time between interference spells, 2-30 min
+ *                         at 12-25 dB over the noise floor and at least an
+ *                         hour apart (default 8)
+ *     --checkpoint-min M  Heap sample and invariant check period (default 15)
+ *     --leak-bytes B      Free heap lost per day that counts as a leak (default 1024)
+ *     --seed N            Random seed (default 1)
+ *     --csv FILE          Write the heap samples as CSV
+ *
+ * Invariants checked at every checkpoint: each device's last_seen matches
+ * the time its last frame was delivered, offline flags follow the
+ * device's deviceOfflineTimeout(), removed devices are gone and their HomeKit accessories
+ * freed, uptime matches the simulated clock, every periodic job is still
+ * registered, keeps its phase and never runs more than a second late, MQTT
+ * reconnects after each outage, every API request succeeds, /metrics is
+ * well-formed (no line cut short by a fixed buffer), and every
+ * interference spell (and nothing else) is flagged as an episode that ends
+ * once the spell is over. The exit
+ * status is 1 if any was violated.
+ *
+ * Heap figures come from the host allocator (see EspClass in the shims):
+ * trends are meaningful, absolute values are not the ESP32's. Allocation
+ * counts come from the shims' allocator hooks, as HEAP_PROFILER_HOOKS
+ * gives on the device; the summary shows the heaviest packet and request.
+ */
+
+#include "../LoRa-HomeKit-Bridge.ino"
+#include "../hardware/NoiseMonitor.h"
+
+#include <LoRa.h>
+#include <Preferences.h>
+
+#include <chrono>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+extern PubSubClient mqttClient;
+
+#define SOAK_US_PER_DAY (86400ULL * 1000000ULL)
+#define SOAK_US_PER_HOUR (3600ULL * 1000000ULL)
+#define SOAK_MAX_LATE_MS 1000           // Jobs later than this are a violation
+#define SOAK_LAST_SEEN_SLACK_MS 1000
+#define SOAK_UPTIME_SLACK_S 2
+#define SOAK_AVAILABILITY_MS 10000      // "availability" job period
+#define SOAK_NEVER UINT64_MAX
+#define SOAK_NOISE_FLOOR_DBM -120
+#define SOAK_NOISE_SLACK_US 30000000ULL // Two decision windows and a margin
+
+// ============== Options ==============
+struct SoakOptions {
+    double days = 21.0;
+    double start_days = 40.0;
+    uint32_t devices = 12;
+    double interval_s = 120.0;
+    double churn_hours = 12.0;
+    double outage_hours = 6.0;
+    double web_per_hour = 30.0;
+    double noise_hours = 8.0;
+    double checkpoint_min = 15.0;
+    double leak_bytes = 1024.0;
+    uint32_t seed = 1;
+    const char* csv = nullptr;
+};
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [--days D] [--start-days D] [--devices N] [--interval S]\n"
+                    "       [--churn-hours H] [--outage-hours H] [--web-per-hour N]\n"
+                    "       [--noise-hours H] [--checkpoint-min M] [--leak-bytes B] [--seed N]\n"
+                    "       [--csv FILE]\n", argv0);
+}
+
+static bool parseOptions(int argc, char** argv, SoakOptions& opt) {
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        if (i + 1 >= argc) return false;
+        const char* v = argv[++i];
+        if (strcmp(a, "--days") == 0) opt.days = atof(v);
+        else if (strcmp(a, "--start-days") == 0) opt.start_days = atof(v);
+        else if (strcmp(a, "--devices") == 0) opt.devices = (uint32_t)strtoul(v, nullptr, 10);
+        else if (strcmp(a, "--interval") == 0) opt.interval_s = atof(v);
+        else if (strcmp(a, "--churn-hours") == 0) opt.churn_hours = atof(v);
+        else if (strcmp(a, "--outage-hours") == 0) opt.outage_hours = atof(v);
+        else if (strcmp(a, "--web-per-hour") == 0) opt.web_per_hour = atof(v);
+        else if (strcmp(a, "--noise-hours") == 0) opt.noise_hours = atof(v);
+        else if (strcmp(a, "--checkpoint-min") == 0) opt.checkpoint_min = atof(v);
+        else if (strcmp(a, "--leak-bytes") == 0) opt.leak_bytes = atof(v);
+        else if (strcmp(a, "--seed") == 0) opt.seed = (uint32_t)strtoul(v, nullptr, 10);
+        else if (strcmp(a, "--csv") == 0) opt.csv = v;
+        else return false;
+    }
+    return opt.days > 0 && opt.start_days >= 0 && opt.devices > 0 && opt.interval_s > 0 &&
+           opt.checkpoint_min > 0;
+}
+
+// ============== Violations ==============
+// One slot per kind: the first occurrence is kept, later ones only counted
+enum ViolationKind : uint8_t {
+    VIOLATION_LAST_SEEN = 0,
+    VIOLATION_OFFLINE,
+    VIOLATION_ONLINE,
+    VIOLATION_NOT_REGISTERED,
+    VIOLATION_TABLE_FULL,
+    VIOLATION_NOT_REMOVED,
+    VIOLATION_VANISHED,
+    VIOLATION_ACCESSORIES,
+    VIOLATION_UPTIME,
+    VIOLATION_METRICS,
+    VIOLATION_JOB_MISSING,
+    VIOLATION_JOB_LATE,
+    VIOLATION_JOB_PHASE,
+    VIOLATION_MQTT,
+    VIOLATION_WEB,
+    VIOLATION_EVENT_QUEUE,
+    VIOLATION_HEAP_LEAK,
+    VIOLATION_NOISE_MISSED,
+    VIOLATION_NOISE_FALSE,
+    VIOLATION_KIND_COUNT
+};
+
+static const char* const violation_names[VIOLATION_KIND_COUNT] = {
+    "last_seen mismatch", "missed offline", "offline while reporting", "frame not registered",
+    "device table full", "removed device still present", "device vanished", "HomeKit accessories",
+    "uptime", "malformed metrics", "job missing", "job late", "job phase drift", "mqtt reconnect", "web request",
+    "event queue", "heap leak", "interference missed", "false interference"
+};
+
+struct Violation {
+    uint32_t count;
+    double at_h;                      // Simulated hours since boot
+    char first[160];
+};
+
+static Violation violations[VIOLATION_KIND_COUNT];
+static uint64_t soak_boot_us = 0;
+
+static double hoursSinceBoot() {
+    return (hostMicros64() - soak_boot_us) / (double)SOAK_US_PER_HOUR;
+}
+
+static void violation(ViolationKind kind, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+static void violation(ViolationKind kind, const char* fmt, ...) {
+    Violation& v = violations[kind];
+    if (v.count++ > 0) return;
+    v.at_h = hoursSinceBoot();
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(v.first, sizeof(v.first), fmt, ap);
+    va_end(ap);
+}
+
+// ============== Sensors ==============
+enum SensorState : uint8_t { SENSOR_REPORTING = 0, SENSOR_QUIET, SENSOR_RETIRED, SENSOR_REMOVED };
+
+struct SoakSensor {
+    char id[24];
+    uint8_t kind;                     // 0 temp/humidity, 1 motion, 2 contact
+    SensorState state;
+    bool registered;                  // Seen in the device table
+    bool refused;                     // Registration refused (reported once)
+    double period_ms;
+    uint64_t next_us;                 // Next transmission (or end of quiet spell)
+    uint64_t delivered_us;            // Last frame delivered, SOAK_NEVER before the first
+    uint64_t remove_us;               // Retired: when the user removes it
+    uint32_t n;
+};
+
+struct SoakStats {
+    uint32_t frames;
+    uint32_t joined;
+    uint32_t retired;
+    uint32_t removed;
+    uint32_t quiet_spells;
+    uint32_t outages;
+    uint32_t reconnects;
+    uint32_t web_requests;
+    uint32_t checkpoints;
+    uint32_t noise_spells;
+    uint32_t noise_flagged;           // Spells the bridge reported
+    uint64_t web_bytes;
+};
+
+static SoakStats stats;
+static std::vector<SoakSensor> sensors;
+static uint32_t next_sensor_id = 0;
+
+static void addSensor(const SoakOptions& opt, std::mt19937& rng, uint64_t now) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    SoakSensor s;
+    memset(&s, 0, sizeof(s));
+    snprintf(s.id, sizeof(s.id), "soak_%04u", next_sensor_id++);
+    s.kind = (uint8_t)(s.id[8] % 3);
+    s.state = SENSOR_REPORTING;
+    s.period_ms = opt.interval_s * 1000.0 * (0.7 + 0.6 * unit(rng));
+    s.next_us = now + (uint64_t)(unit(rng) * s.period_ms * 1000.0);
+    s.delivered_us = SOAK_NEVER;
+    s.remove_us = SOAK_NEVER;
+    sensors.push_back(s);
+    stats.joined++;
+}
+
+static size_t payload(const SoakSensor& s, char* buf, size_t len) {
+    int n;
+    switch (s.kind) {
+        case 1:
+            n = snprintf(buf, len, "{\"k\":\"%s\",\"id\":\"%s\",\"m\":%s,\"b\":%u}", gateway_key, s.id,
+                         s.n % 2 ? "true" : "false", 100 - s.n % 20);
+            break;
+        case 2:
+            n = snprintf(buf, len, "{\"k\":\"%s\",\"id\":\"%s\",\"c\":%s,\"b\":%u}", gateway_key, s.id,
+                         s.n % 2 ? "true" : "false", 90 - s.n % 20);
+            break;
+        default:
+            n = snprintf(buf, len, "{\"k\":\"%s\",\"id\":\"%s\",\"t\":%.1f,\"hu\":%u,\"b\":%u}", gateway_key, s.id,
+                         20.0 + (s.n % 30) / 10.0, 40 + s.n % 20, 95 - s.n % 20);
+            break;
+    }
+    return n < 0 ? 0 : min((size_t)n, len - 1);
+}
+
+static int activeDevices() {
+    int n = 0;
+    for (int i = 0; i < device_count; i++) {
+        if (devices[i].active) n++;
+    }
+    return n;
+}
+
+static void transmit(SoakSensor& s) {
+    uint8_t buf[160];
+    size_t len = payload(s, (char*)buf, sizeof(buf));
+    if (encryption_mode == ENCRYPT_XOR) xorBuffer(buf, len);
+    LoRa.injectPacket(buf, len, -80 - (int)(s.n % 30), 7.5f);
+    loop();
+    loop();
+    stats.frames++;
+    s.n++;
+
+    Device* dev = findDevice(s.id);
+    if (dev) {
+        s.registered = true;
+        s.delivered_us = hostMicros64();
+    } else if (device_count >= MAX_DEVICES) {
+        if (!s.refused) {
+            int active = activeDevices();
+            violation(VIOLATION_TABLE_FULL, "%s refused with %d active devices, %d of %d slots held by removed devices",
+                      s.id, active, device_count - active, MAX_DEVICES);
+        }
+        s.refused = true;
+    } else {
+        violation(VIOLATION_NOT_REGISTERED, "frame from %s accepted but no device entry", s.id);
+    }
+}
+
+// ============== Web Traffic ==============
+static int webGet(const char* uri, const std::map<std::string, std::string>& args = {}) {
+    bool routed;
+    {
+        HeapScope heapScope(HEAP_SUBSYS_WEB);   // As around handleClient() in loop()
+        routed = webServer.hostRequest(uri, HTTP_GET, args);
+    }
+    int code = webServer.last_code;
+    stats.web_requests++;
+    stats.web_bytes += webServer.last_length;
+    if (!routed || code != 200) violation(VIOLATION_WEB, "GET %s returned %d", uri, code);
+    return code;
+}
+
+static void randomRequest(std::mt19937& rng) {
+    static const char* const pages[] = {
+        "/", "/api/activity", "/api/journal", "/api/loop", "/api/heap", "/api/pipeline",
+        "/api/events", "/api/scheduler", "/metrics", "/api/capture", "/api/capture/download",
+    };
+    const size_t count = sizeof(pages) / sizeof(pages[0]);
+    uint32_t pick = rng() % (count + 1);
+    if (pick < count) {
+        webGet(pages[pick]);
+        return;
+    }
+
+    // Rename a registered sensor (the UI's only write besides removal)
+    for (size_t tries = 0; tries < sensors.size(); tries++) {
+        SoakSensor& s = sensors[rng() % sensors.size()];
+        if (!s.registered || s.state == SENSOR_REMOVED) continue;
+        char name[32];
+        snprintf(name, sizeof(name), "Soak %s %u", s.id + 5, (unsigned)(rng() % 100));
+        webGet("/api/rename", {{"id", s.id}, {"name", name}});
+        return;
+    }
+}
+
+// ============== Checkpoints ==============
+struct JobTrack {
+    const char* name;                 // nullptr = not tracked (one-shot or free slot)
+    uint32_t period_ms;
+    uint8_t catchup;
+    uint32_t last_due;
+    int64_t advance_ms;               // Total movement of the deadline
+    uint32_t runs_start;
+    uint32_t skipped_start;
+    uint32_t max_late_ms;             // Worst lateness already reported
+};
+
+struct HeapTrend {
+    uint32_t first_free;
+    uint32_t last_free;
+    uint32_t min_free;
+    uint32_t min_largest;
+    uint32_t last_largest;
+    // Least-squares fit of free heap over time, after the warm-up
+    double n, st, sf, stt, stf;
+};
+
+static JobTrack job_tracks[SCHEDULER_MAX_JOBS];
+static HeapTrend heap;
+static size_t accessory_base = 0;     // Accessories that are not devices (the bridge)
+static uint64_t track_start_us = 0;
+
+static size_t deviceAccessories() {
+    size_t n = 0;
+    for (int i = 0; i < device_count; i++) {
+        if (devices[i].active && devices[i].aid) n++;
+    }
+    return n;
+}
+
+static void startTracking() {
+    track_start_us = hostMicros64();
+    for (int i = 0; i < SCHEDULER_MAX_JOBS; i++) {
+        const SchedulerJob& job = scheduler_jobs[i];
+        JobTrack& t = job_tracks[i];
+        memset(&t, 0, sizeof(t));
+        if (!job.active || job.period_ms == 0) continue;
+        t.name = job.name;
+        t.period_ms = job.period_ms;
+        t.catchup = job.catchup;
+        t.last_due = job.due_ms;
+        t.runs_start = job.stats.runs;
+        t.skipped_start = job.stats.skipped;
+        t.max_late_ms = max((uint32_t)SOAK_MAX_LATE_MS, job.stats.max_late_ms);
+    }
+    accessory_base = homeSpan.accessories.size() - deviceAccessories();
+    heap.first_free = ESP.getFreeHeap();
+    heap.min_largest = UINT32_MAX;
+}
+
+static void checkJobs() {
+    for (int i = 0; i < SCHEDULER_MAX_JOBS; i++) {
+        JobTrack& t = job_tracks[i];
+        if (!t.name) continue;
+        const SchedulerJob& job = scheduler_jobs[i];
+        if (!job.active || job.name != t.name) {
+            violation(VIOLATION_JOB_MISSING, "%s is no longer scheduled", t.name);
+            t.name = nullptr;
+            continue;
+        }
+        // Checkpoints are far closer than 2^31 ms, so the 32-bit difference is exact
+        t.advance_ms += (int32_t)(job.due_ms - t.last_due);
+        t.last_due = job.due_ms;
+        if (job.stats.max_late_ms > t.max_late_ms) {
+            violation(VIOLATION_JOB_LATE, "%s ran %lu ms late", t.name, (unsigned long)job.stats.max_late_ms);
+            t.max_late_ms = job.stats.max_late_ms;
+        }
+    }
+}
+
+// Time since the job's deadline moved, minus how far it moved. A job that
+// keeps its phase stays within one period; DELAY jobs slip by design.
+static int64_t jobDriftMs(const JobTrack& t) {
+    int64_t elapsed_ms = (int64_t)((hostMicros64() - track_start_us) / 1000);
+    return t.advance_ms - elapsed_ms;
+}
+
+static void checkDevices() {
+    uint64_t now = hostMicros64();
+    for (SoakSensor& s : sensors) {
+        Device* dev = findDevice(s.id);
+        if (s.state == SENSOR_REMOVED) {
+            if (dev) violation(VIOLATION_NOT_REMOVED, "%s still in the device table after removal", s.id);
+            continue;
+        }
+        if (!s.registered) continue;
+        if (!dev) {
+            violation(VIOLATION_VANISHED, "%s disappeared from the device table", s.id);
+            continue;
+        }
+
+        DeviceSnapshot snap;
+        snapshotDevice(dev, snap);
+        uint64_t age_ms = (now - s.delivered_us) / 1000;
+        uint32_t seen_ms = clockElapsedMs(snap.last_seen);
+        if (age_ms < 0x80000000ULL && llabs((int64_t)seen_ms - (int64_t)age_ms) > SOAK_LAST_SEEN_SLACK_MS) {
+            violation(VIOLATION_LAST_SEEN, "%s last frame %llu ms ago, bridge says %lu ms", s.id,
+                      (unsigned long long)age_ms, (unsigned long)seen_ms);
+        }
+
+        uint32_t timeout_ms = deviceOfflineTimeout(snap.interval);
+        if (!dev->offline && age_ms > timeout_ms + SOAK_AVAILABILITY_MS + SOAK_LAST_SEEN_SLACK_MS) {
+            violation(VIOLATION_OFFLINE, "%s silent for %llu s but not offline", s.id,
+                      (unsigned long long)(age_ms / 1000));
+        } else if (dev->offline && age_ms <= timeout_ms) {
+            violation(VIOLATION_ONLINE, "%s offline %llu s after its last frame", s.id,
+                      (unsigned long long)(age_ms / 1000));
+        }
+    }
+
+    size_t expected = accessory_base + deviceAccessories();
+    if (homeSpan.accessories.size() != expected) {
+        violation(VIOLATION_ACCESSORIES, "%zu HomeKit accessories for %zu devices and %zu bridge accessories",
+                  homeSpan.accessories.size(), deviceAccessories(), accessory_base);
+    }
+
+    for (uint8_t i = 0; i < event_sink_count; i++) {
+        const EventSink& sink = event_sinks[i];
+        if (sink.count > sink.capacity) {
+            violation(VIOLATION_EVENT_QUEUE, "sink %s holds %u of %u events", sink.name, sink.count, sink.capacity);
+        }
+    }
+}
+
+// Text exposition format: comments, or "name{labels} value", one per line
+static void checkMetricsFormat(const char* body) {
+    const char* line = body;
+    while (*line) {
+        const char* end = strchr(line, '\n');
+        if (!end) {
+            violation(VIOLATION_METRICS, "last line not terminated: %.60s", line);
+            return;
+        }
+        std::string l(line, end - line);
+        line = end + 1;
+        if (l.compare(0, 7, "# TYPE ") == 0 || l.compare(0, 7, "# HELP ") == 0) continue;
+
+        size_t name_end = l.find_first_of("{ ");
+        size_t value_at = name_end == std::string::npos ? name_end
+                          : l[name_end] == '{' ? l.find("} ", name_end) : name_end;
+        char* parsed = nullptr;
+        if (value_at != std::string::npos) {
+            const char* value = l.c_str() + value_at + (l[value_at] == '}' ? 2 : 1);
+            strtod(value, &parsed);
+            if (parsed == value || *parsed) parsed = nullptr;
+        }
+        if (name_end == 0 || !parsed) {
+            violation(VIOLATION_METRICS, "bad line: %.100s", l.c_str());
+            return;
+        }
+    }
+}
+
+static void checkUptime() {
+    webServer.keep_body = true;
+    webServer.hostRequest("/metrics");
+    checkMetricsFormat(webServer.last_body.c_str());
+    const char* at = strstr(webServer.last_body.c_str(), "\nlora_bridge_uptime_seconds ");
+    unsigned long reported = at ? strtoul(at + 28, nullptr, 10) : 0;
+    webServer.last_body = String();
+    webServer.keep_body = false;
+
+    uint64_t actual = (hostMicros64() - soak_boot_us) / 1000000ULL;
+    if (!at || llabs((int64_t)reported - (int64_t)actual) > SOAK_UPTIME_SLACK_S) {
+        violation(VIOLATION_UPTIME, "uptime %lu s reported after %llu s", reported, (unsigned long long)actual);
+    }
+}
+
+static void sampleHeap(const SoakOptions& opt, FILE* csv) {
+    uint32_t free_heap = ESP.getFreeHeap();
+    uint32_t largest = ESP.getMaxAllocHeap();
+    heap.last_free = free_heap;
+    heap.last_largest = largest;
+    heap.min_free = ESP.getMinFreeHeap();
+    heap.min_largest = min(heap.min_largest, largest);
+
+    double day = (hostMicros64() - track_start_us) / (double)SOAK_US_PER_DAY;
+    double warmup = max(1.0, opt.days * 0.1);
+    if (day >= warmup) {
+        heap.n++;
+        heap.st += day;
+        heap.sf += free_heap;
+        heap.stt += day * day;
+        heap.stf += day * free_heap;
+    }
+    if (csv) {
+        fprintf(csv, "%.3f,%lu,%lu,%lu,%d,%d,%lu\n", hoursSinceBoot(), (unsigned long)free_heap,
+                (unsigned long)heap.min_free, (unsigned long)largest, device_count, activeDevices(),
+                (unsigned long)millis());
+    }
+}
+
+// Free heap change per day after the warm-up (negative = shrinking)
+static double heapSlope() {
+    double d = heap.n * heap.stt - heap.st * heap.st;
+    return heap.n >= 3 && d > 0 ? (heap.n * heap.stf - heap.st * heap.sf) / d : 0.0;
+}
+
+// ============== Bridge ==============
+static void seedSettings() {
+    Preferences p;
+    p.begin(NVS_NAMESPACE, false);
+    p.putString("wifi_ssid", "soak");
+    p.putString("wifi_pass", "soak");
+    p.putBool("mqtt_en", true);
+    p.putString("mqtt_srv", "broker.soak");
+    p.end();
+}
+
+static void runUntilUs(uint64_t until_us) {
+    while (hostMicros64() < until_us) loop();
+}
+
+static uint64_t expDelayUs(std::mt19937& rng, double mean_hours) {
+    std::exponential_distribution<double> exp(1.0 / mean_hours);
+    return (uint64_t)(exp(rng) * SOAK_US_PER_HOUR);
+}
+
+// ============== Report ==============
+// One HeapReport: allocations by subsystem for a packet or an API request
+static void printHeapReport(const char* label, const HeapReport& r) {
+    printf("Allocs:   %-8s %-24s %4lu allocs %6lu B, net %+ld B (", label, r.site, (unsigned long)r.allocs,
+           (unsigned long)r.bytes, (long)r.free_delta);
+    bool first = true;
+    for (uint8_t i = 0; i < HEAP_SUBSYS_COUNT; i++) {
+        if (!r.subsys_allocs[i]) continue;
+        printf("%s%s %u", first ? "" : ", ", getHeapSubsystemName(i), r.subsys_allocs[i]);
+        first = false;
+    }
+    printf(")\n");
+}
+
+static void printReport(const SoakOptions& opt, double wall_s) {
+    uint64_t now = hostMicros64();
+    double days = (now - track_start_us) / (double)SOAK_US_PER_DAY;
+    uint64_t start_ms = (uint64_t)(opt.start_days * 86400000.0);
+    printf("Simulated %.1f days in %.1f s from millis() %llu", days, wall_s, (unsigned long long)start_ms);
+    if (start_ms < 0x100000000ULL) printf(" (rollover on day %.1f)", (0x100000000ULL - start_ms) / 86400000.0);
+    printf("\n\n");
+
+    int active = activeDevices();
+    int offline = 0;
+    for (int i = 0; i < device_count; i++) {
+        if (devices[i].active && devices[i].offline) offline++;
+    }
+    printf("Traffic:  %lu frames, %lu sensors joined, %lu retired, %lu removed, %lu quiet spells\n",
+           (unsigned long)stats.frames, (unsigned long)stats.joined, (unsigned long)stats.retired,
+           (unsigned long)stats.removed, (unsigned long)stats.quiet_spells);
+    printf("          %lu MQTT outages (%lu reconnected), %lu API requests (%llu KB), %lu MQTT messages\n",
+           (unsigned long)stats.outages, (unsigned long)stats.reconnects, (unsigned long)stats.web_requests,
+           (unsigned long long)(stats.web_bytes / 1024), (unsigned long)mqttClient.published);
+    printf("Devices:  %d active (%d offline), %d of %d table slots used, %zu HomeKit accessories\n", active,
+           offline, device_count, MAX_DEVICES, homeSpan.accessories.size());
+
+    // Learned reporting intervals against the sensors' true mean period
+    int learned = 0;
+    double worst_error = 0;
+    float worst_on_time = 1;
+    for (const SoakSensor& s : sensors) {
+        Device* dev = s.registered ? findDevice(s.id) : nullptr;
+        if (!dev || dev->interval.samples < DEVICE_INTERVAL_MIN_SAMPLES) continue;
+        learned++;
+        worst_error = max(worst_error, fabs(dev->interval.period_ms - s.period_ms) / s.period_ms);
+        float on_time = deviceOnTimeRatio(dev->interval);
+        if (on_time >= 0) worst_on_time = min(worst_on_time, on_time);
+    }
+    printf("          %d intervals learned, worst error %.1f%%, lowest on-time %.1f%%\n", learned,
+           worst_error * 100, worst_on_time * 100);
+    printf("Noise:    floor %d dBm, %lu interference spells (%lu flagged), %lu episodes, %lu samples (%lu deferred)\n",
+           noise_stats.floor_dbm, (unsigned long)stats.noise_spells, (unsigned long)stats.noise_flagged,
+           (unsigned long)noise_stats.episodes, (unsigned long)noise_stats.samples,
+           (unsigned long)noise_stats.deferred);
+    printf("Heap:     free %lu -> %lu bytes (min %lu), largest block %lu (min %lu), trend %+.0f bytes/day\n\n",
+           (unsigned long)heap.first_free, (unsigned long)heap.last_free, (unsigned long)heap.min_free,
+           (unsigned long)heap.last_largest, (unsigned long)heap.min_largest, heapSlope());
+
+    if (heap_alloc_tracking) {
+        printHeapReport("packet", heap_last_packet);
+        printHeapReport("worst", heap_worst_packet);
+        printHeapReport("request", heap_last_http);
+        printHeapReport("worst", heap_worst_http);
+        printf("\n");
+    }
+
+    printf("%-16s %9s %6s %9s %9s %8s %8s %10s\n", "job", "period_ms", "mode", "runs", "expected", "skipped",
+           "max_late", "drift_ms");
+    uint64_t elapsed_ms = (now - track_start_us) / 1000;
+    for (int i = 0; i < SCHEDULER_MAX_JOBS; i++) {
+        const JobTrack& t = job_tracks[i];
+        if (!t.name) continue;
+        const SchedulerJob& job = scheduler_jobs[i];
+        printf("%-16s %9lu %6s %9lu %9llu %8lu %8lu %10lld\n", t.name, (unsigned long)t.period_ms,
+               getSchedulerCatchUpName(t.catchup), (unsigned long)(job.stats.runs - t.runs_start),
+               (unsigned long long)(elapsed_ms / t.period_ms),
+               (unsigned long)(job.stats.skipped - t.skipped_start), (unsigned long)job.stats.max_late_ms,
+               (long long)jobDriftMs(t));
+    }
+
+    uint32_t total = 0;
+    for (const Violation& v : violations) total += v.count;
+    printf("\nInvariant violations: %lu\n", (unsigned long)total);
+    for (int k = 0; k < VIOLATION_KIND_COUNT; k++) {
+        const Violation& v = violations[k];
+        if (!v.count) continue;
+        printf("  %-30s %6lu  first at %.1f h: %s\n", violation_names[k], (unsigned long)v.count, v.at_h, v.first);
+    }
+}
+
+// ============== Main ==============
+int main(int argc, char** argv) {
+    SoakOptions opt;
+    if (!parseOptions(argc, argv, opt)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    FILE* csv = opt.csv ? fopen(opt.csv, "w") : nullptr;
+    if (opt.csv && !csv) {
+        perror(opt.csv);
+        return 1;
+    }
+    if (csv) fprintf(csv, "hours,free_heap,min_free_heap,largest_block,device_slots,active_devices,millis\n");
+
+    std::mt19937 rng(opt.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    // Reserved up front: the harness's own allocations would show in the heap trend
+    sensors.reserve(opt.devices + (size_t)(opt.churn_hours > 0 ? opt.days * 24 / opt.churn_hours : 0) + 2);
+
+    using namespace std::chrono;
+    steady_clock::time_point wall_start = steady_clock::now();
+
+    hostSetSerialEnabled(false);
+    hostSetMicros((uint64_t)(opt.start_days * SOAK_US_PER_DAY));
+    soak_boot_us = hostMicros64();
+    seedSettings();
+    LoRa.channel_spread_db = 2;
+    setup();
+    webServer.keep_body = false;
+    runUntilUs(hostMicros64() + 5000000ULL);
+
+    startTracking();
+    uint64_t now = hostMicros64();
+    for (uint32_t i = 0; i < opt.devices; i++) addSensor(opt, rng, now);
+
+    uint64_t end_us = now + (uint64_t)(opt.days * SOAK_US_PER_DAY);
+    uint64_t checkpoint_us = (uint64_t)(opt.checkpoint_min * 60e6);
+    uint64_t churn_us = (uint64_t)(opt.churn_hours * SOAK_US_PER_HOUR);
+    uint64_t next_checkpoint = now + checkpoint_us;
+    uint64_t next_churn = churn_us ? now + churn_us : SOAK_NEVER;
+    uint64_t next_outage = opt.outage_hours > 0 ? now + expDelayUs(rng, opt.outage_hours) : SOAK_NEVER;
+    uint64_t outage_end = SOAK_NEVER;
+    uint64_t reconnect_check = SOAK_NEVER;
+    uint64_t next_web = opt.web_per_hour > 0 ? now + expDelayUs(rng, 1.0 / opt.web_per_hour) : SOAK_NEVER;
+
+    // Channel noise has its own generator so the rest of the run is unchanged
+    std::mt19937 noise_rng(opt.seed + 1);
+    uint64_t next_spell = opt.noise_hours > 0 ? now + expDelayUs(noise_rng, opt.noise_hours) : SOAK_NEVER;
+    uint64_t spell_end = SOAK_NEVER;
+    uint64_t spell_check = SOAK_NEVER;
+    int noise_boost_db = 0;
+    uint32_t episodes_seen = noise_stats.episodes;
+
+    while (true) {
+        uint64_t next = min({end_us, next_checkpoint, next_churn, next_outage, outage_end, reconnect_check, next_web,
+                             next_spell, spell_end, spell_check});
+        for (const SoakSensor& s : sensors) {
+            if (s.state == SENSOR_REPORTING || s.state == SENSOR_QUIET) next = min(next, s.next_us);
+            else if (s.state == SENSOR_RETIRED) next = min(next, s.remove_us);
+        }
+        runUntilUs(next);
+        now = hostMicros64();
+        if (now >= end_us) break;
+
+        for (SoakSensor& s : sensors) {
+            if (s.state == SENSOR_QUIET && now >= s.next_us) s.state = SENSOR_REPORTING;
+            if (s.state == SENSOR_REPORTING && now >= s.next_us) {
+                transmit(s);
+                s.next_us += (uint64_t)(s.period_ms * 1000.0 * (0.95 + 0.1 * unit(rng)));
+                if (s.next_us <= now) s.next_us = now + (uint64_t)(s.period_ms * 1000.0);
+            } else if (s.state == SENSOR_RETIRED && now >= s.remove_us) {
+                // The user notices the dead sensor and removes it
+                if (s.registered) {
+                    webGet("/api/remove", {{"id", s.id}});
+                    stats.removed++;
+                }
+                s.state = SENSOR_REMOVED;
+            }
+        }
+
+        if (now >= next_churn) {
+            // One sensor dies for good, a new one is installed, another is
+            // out for a battery swap
+            std::vector<size_t> reporting;
+            for (size_t i = 0; i < sensors.size(); i++) {
+                if (sensors[i].state == SENSOR_REPORTING) reporting.push_back(i);
+            }
+            if (reporting.size() >= 2) {
+                size_t a = rng() % reporting.size();
+                size_t b = (a + 1 + rng() % (reporting.size() - 1)) % reporting.size();
+                SoakSensor& dead = sensors[reporting[a]];
+                dead.state = SENSOR_RETIRED;
+                dead.remove_us = now + (uint64_t)DEVICE_TIMEOUT_MS * 1000ULL + SOAK_US_PER_HOUR;
+                stats.retired++;
+
+                SoakSensor& quiet = sensors[reporting[b]];
+                quiet.state = SENSOR_QUIET;
+                quiet.next_us = now + (uint64_t)((0.5 + 2.5 * unit(rng)) * SOAK_US_PER_HOUR);
+                stats.quiet_spells++;
+            }
+            addSensor(opt, rng, now);
+            next_churn += churn_us;
+        }
+
+        if (now >= next_outage) {
+            mqttClient.broker_up = false;
+            mqttClient.disconnect();
+            outage_end = now + (uint64_t)((1.0 + 29.0 * unit(rng)) * 60e6);
+            next_outage = SOAK_NEVER;
+            stats.outages++;
+        }
+        if (now >= outage_end) {
+            // Two reconnect attempts (MQTT_RECONNECT_INTERVAL is 5 s) and a second of slack
+            mqttClient.broker_up = true;
+            reconnect_check = now + 11000000ULL;
+            outage_end = SOAK_NEVER;
+            next_outage = now + expDelayUs(rng, opt.outage_hours);
+        }
+        if (now >= reconnect_check) {
+            if (isMQTTConnected()) stats.reconnects++;
+            else violation(VIOLATION_MQTT, "not reconnected 11 s after the broker came back");
+            reconnect_check = SOAK_NEVER;
+        }
+
+        if (now >= next_web) {
+            randomRequest(rng);
+            next_web = now + expDelayUs(rng, 1.0 / opt.web_per_hour);
+        }
+
+        if (now >= next_spell) {
+            if (noise_stats.episodes != episodes_seen) {
+                violation(VIOLATION_NOISE_FALSE, "%lu episodes flagged in a quiet channel",
+                          (unsigned long)(noise_stats.episodes - episodes_seen));
+            }
+            noise_boost_db = 12 + (int)(noise_rng() % 14);
+            spell_end = now + (uint64_t)((2.0 + 28.0 * unit(noise_rng)) * 60e6);
+            next_spell = SOAK_NEVER;
+            stats.noise_spells++;
+        }
+        if (now >= spell_end) {
+            noise_boost_db = 0;
+            spell_check = now + SOAK_NOISE_SLACK_US;
+            spell_end = SOAK_NEVER;
+        }
+        if (now >= spell_check) {
+            uint32_t flagged = noise_stats.episodes - episodes_seen;
+            if (flagged == 0) violation(VIOLATION_NOISE_MISSED, "interference spell not flagged");
+            else if (flagged > 1) violation(VIOLATION_NOISE_FALSE, "one spell flagged as %lu episodes", (unsigned long)flagged);
+            else stats.noise_flagged++;
+            if (noise_stats.interference) violation(VIOLATION_NOISE_FALSE, "episode still open 30 s after the spell");
+            episodes_seen = noise_stats.episodes;
+            spell_check = SOAK_NEVER;
+            next_spell = now + SOAK_US_PER_HOUR + expDelayUs(noise_rng, opt.noise_hours);
+        }
+        LoRa.channel_rssi = SOAK_NOISE_FLOOR_DBM + noise_boost_db;
+
+        if (now >= next_checkpoint) {
+            checkJobs();
+            checkDevices();
+            checkUptime();
+            sampleHeap(opt, csv);
+            stats.checkpoints++;
+            next_checkpoint += checkpoint_us;
+        }
+    }
+
+    checkJobs();
+    checkDevices();
+    checkUptime();
+    sampleHeap(opt, csv);
+    if (csv) fclose(csv);
+    if (spell_end == SOAK_NEVER && spell_check == SOAK_NEVER && noise_stats.episodes != episodes_seen) {
+        violation(VIOLATION_NOISE_FALSE, "%lu episodes flagged in a quiet channel",
+                  (unsigned long)(noise_stats.episodes - episodes_seen));
+    }
+
+    for (int i = 0; i < SCHEDULER_MAX_JOBS; i++) {
+        const JobTrack& t = job_tracks[i];
+        if (t.name && t.catchup != SCHED_CATCHUP_DELAY && llabs(jobDriftMs(t)) > (int64_t)t.period_ms) {
+            violation(VIOLATION_JOB_PHASE, "%s deadline drifted %lld ms (period %lu ms)", t.name,
+                      (long long)jobDriftMs(t), (unsigned long)t.period_ms);
+        }
+    }
+    double slope = heapSlope();
+    if (-slope > opt.leak_bytes) {
+        violation(VIOLATION_HEAP_LEAK, "free heap shrinks %.0f bytes/day after the warm-up", -slope);
+    }
+
+    double wall_s = duration_cast<duration<double>>(steady_clock::now() - wall_start).count();
+    printReport(opt, wall_s);
+
+    for (const Violation& v : violations) {
+        if (v.count) return 1;
+    }
+    return 0;
+}
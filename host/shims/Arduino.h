@@ -0,0 +1,129 @@
+/*
+ * Arduino.h - Host shim for the Arduino/ESP32 core
+ * Just enough of the core API for the bridge modules to compile and run on
+ * a workstation. Time comes from a clock the host harness controls.
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <algorithm>
+
+#include "WString.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+using std::max;
+using std::min;
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PROGMEM
+#define IRAM_ATTR
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+// ============== Virtual Time ==============
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+// Host harness controls (not part of the Arduino API)
+enum HostClock : uint8_t {
+    HOST_CLOCK_VIRTUAL = 0,          // Advances only when the firmware waits: repeatable runs
+    HOST_CLOCK_ACCELERATED,          // Real time while computing, waits are skipped
+    HOST_CLOCK_WALL                  // Real time, waits sleep (needed with several tasks)
+};
+
+void hostSetClock(HostClock clock);
+void hostSetMicros(uint64_t us);
+void hostAdvanceMicros(uint64_t us);
+uint64_t hostMicros64();
+
+// ============== GPIO ==============
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+#define digitalPinToInterrupt(p) (p)
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode);
+void detachInterrupt(uint8_t pin);
+void hostTriggerInterrupt(uint8_t pin);
+
+// ============== Random ==============
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+// ============== Print / Serial ==============
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buf, size_t n);
+    size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+    size_t print(const char* s) { return write(s); }
+    size_t print(const String& s) { return write((const uint8_t*)s.c_str(), s.length()); }
+    size_t print(const __FlashStringHelper* s) { return print(reinterpret_cast<const char*>(s)); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int v) { return printf("%d", v); }
+    size_t print(unsigned int v) { return printf("%u", v); }
+    size_t print(long v) { return printf("%ld", v); }
+    size_t print(unsigned long v) { return printf("%lu", v); }
+    size_t print(double v, int digits = 2) { return printf("%.*f", digits, v); }
+    size_t println() { return write((const uint8_t*)"\r\n", 2); }
+    template <typename T> size_t println(const T& v) { size_t n = print(v); return n + println(); }
+    size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+    virtual void flush() {}
+};
+
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void setTxBufferSize(size_t size) { (void)size; }
+    int availableForWrite() { return 1 << 16; }     // Writes never block on the host
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buf, size_t n) override;
+    using Print::write;
+    int available() { return 0; }
+    int read() { return -1; }
+    void flush() override;
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+// Silence Serial output (benchmarks, fuzzing, soak runs)
+void hostSetSerialEnabled(bool enabled);
+// Bytes written to Serial since start (lets tools estimate UART time)
+uint64_t hostSerialBytes();
+
+// ============== ESP ==============
+class EspClass {
+public:
+    uint32_t getFreeHeap();
+    uint32_t getHeapSize();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+    void restart();
+};
+
+extern EspClass ESP;
+
+#endif // HOST_ARDUINO_H
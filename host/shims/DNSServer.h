@@ -0,0 +1,21 @@
+/*
+ * DNSServer.h - Host stub of the captive-portal DNS server
+ */
+
+#ifndef HOST_DNSSERVER_H
+#define HOST_DNSSERVER_H
+
+#include <WiFi.h>
+
+class DNSServer {
+public:
+    bool start(uint16_t port, const char* domain, IPAddress ip) {
+        (void)port; (void)domain; (void)ip;
+        return true;
+    }
+    bool start(uint16_t port, const String& domain, IPAddress ip) { return start(port, domain.c_str(), ip); }
+    void stop() {}
+    void processNextRequest() {}
+};
+
+#endif // HOST_DNSSERVER_H
@@ -0,0 +1,144 @@
+/*
+ * HomeSpan.h - Host stub of the HomeSpan library
+ * Accessories, services and characteristics are plain objects owned by
+ * homeSpan, as in the real library: services and characteristics belong to
+ * the accessory created before them, and deleteAccessory() frees all three.
+ * setVal() just records the value and counts updates so host tools can
+ * observe fan-out.
+ */
+
+#ifndef HOST_HOMESPAN_H
+#define HOST_HOMESPAN_H
+
+#include <Arduino.h>
+#include <vector>
+
+enum class Category { Bridges = 2 };
+
+class SpanAccessory {
+public:
+    SpanAccessory();
+    uint32_t getAID() const { return aid_; }
+private:
+    uint32_t aid_;
+};
+
+class SpanService {
+public:
+    SpanService();
+    virtual ~SpanService() {}
+    virtual void loop() {}
+    SpanAccessory* owner;
+};
+
+class SpanCharacteristic {
+public:
+    explicit SpanCharacteristic(double v = 0);
+    virtual ~SpanCharacteristic() {}
+
+    template <typename T> void setVal(T v, bool notify = true) {
+        (void)notify;
+        value_ = (double)v;
+        updated_ms_ = millis();
+        updates++;
+        total_updates++;
+    }
+    template <typename T = double> T getVal() const { return (T)value_; }
+    uint32_t timeVal() const { return (uint32_t)(millis() - updated_ms_); }
+    SpanCharacteristic* setRange(double min, double max, double step = 0) {
+        (void)min; (void)max; (void)step;
+        return this;
+    }
+
+    uint32_t updates = 0;
+    static uint32_t total_updates;
+    SpanAccessory* owner;
+
+private:
+    double value_;
+    unsigned long updated_ms_;
+};
+
+#define HOST_SERVICE(name) struct name : SpanService { name() {} }
+#define HOST_CHARACTERISTIC(name) \
+    struct name : SpanCharacteristic { \
+        explicit name(double v = 0) : SpanCharacteristic(v) {} \
+        explicit name(const char* s, bool nvs = false) : SpanCharacteristic(0) { (void)s; (void)nvs; } \
+        explicit name(double v, bool nvs) : SpanCharacteristic(v) { (void)nvs; } \
+    }
+
+namespace Service {
+HOST_SERVICE(AccessoryInformation);
+HOST_SERVICE(TemperatureSensor);
+HOST_SERVICE(HumiditySensor);
+HOST_SERVICE(BatteryService);
+HOST_SERVICE(LightSensor);
+HOST_SERVICE(MotionSensor);
+HOST_SERVICE(OccupancySensor);
+HOST_SERVICE(LeakSensor);
+HOST_SERVICE(SmokeSensor);
+HOST_SERVICE(CarbonMonoxideSensor);
+HOST_SERVICE(ContactSensor);
+}
+
+namespace Characteristic {
+HOST_CHARACTERISTIC(Identify);
+HOST_CHARACTERISTIC(Name);
+HOST_CHARACTERISTIC(Manufacturer);
+HOST_CHARACTERISTIC(Model);
+HOST_CHARACTERISTIC(SerialNumber);
+HOST_CHARACTERISTIC(FirmwareRevision);
+HOST_CHARACTERISTIC(ConfiguredName);
+HOST_CHARACTERISTIC(CurrentTemperature);
+HOST_CHARACTERISTIC(CurrentRelativeHumidity);
+HOST_CHARACTERISTIC(BatteryLevel);
+HOST_CHARACTERISTIC(StatusLowBattery);
+HOST_CHARACTERISTIC(CurrentAmbientLightLevel);
+HOST_CHARACTERISTIC(MotionDetected);
+HOST_CHARACTERISTIC(OccupancyDetected);
+HOST_CHARACTERISTIC(LeakDetected);
+HOST_CHARACTERISTIC(SmokeDetected);
+HOST_CHARACTERISTIC(CarbonMonoxideDetected);
+HOST_CHARACTERISTIC(ContactSensorState);
+}
+
+class Span {
+public:
+    void begin(Category cat, const char* name, const char* modelPrefix = "", const char* model = "") {
+        (void)cat; (void)name; (void)modelPrefix; (void)model;
+        started = true;
+    }
+    void poll() { polls++; }
+    Span& setPortNum(uint16_t port) { (void)port; return *this; }
+    Span& setLogLevel(int level) { (void)level; return *this; }
+    Span& setStatusPin(uint8_t pin) { (void)pin; return *this; }
+    Span& setControlPin(uint8_t pin) { (void)pin; return *this; }
+    Span& setPairingCode(const char* code) { (void)code; return *this; }
+    Span& setQRID(const char* id) { (void)id; return *this; }
+    Span& enableOTA() { return *this; }
+    bool updateDatabase() { database_updates++; return true; }
+    bool deleteAccessory(uint32_t aid);
+    void processSerialCommand(const char* cmd) { (void)cmd; }
+
+    // Pairing state: begin() == end() means unpaired
+    typedef std::vector<int>::const_iterator controllerIt;
+    controllerIt controllerListBegin() const { return controllers.begin(); }
+    controllerIt controllerListEnd() const { return controllers.end(); }
+
+    // Host harness state
+    bool started = false;
+    uint32_t polls = 0;
+    uint32_t database_updates = 0;
+    uint32_t next_aid = 1;
+    std::vector<int> controllers;
+
+    // The attribute database lives as long as the program (never freed, so
+    // leak checkers see it as reachable at exit)
+    std::vector<SpanAccessory*>& accessories = *new std::vector<SpanAccessory*>;
+    std::vector<SpanService*>& services = *new std::vector<SpanService*>;
+    std::vector<SpanCharacteristic*>& characteristics = *new std::vector<SpanCharacteristic*>;
+};
+
+extern Span homeSpan;
+
+#endif // HOST_HOMESPAN_H
@@ -0,0 +1,113 @@
+/*
+ * HostFlash.cpp - Host implementation of the partition and reset-reason shims
+ */
+
+#include "esp_partition.h"
+#include "esp_system.h"
+#include <string.h>
+#include <sys/mman.h>
+
+#define HOST_FLASH_SECTOR 4096
+
+// ============== Reset Reason ==============
+static esp_reset_reason_t reset_reason = ESP_RST_POWERON;
+
+esp_reset_reason_t esp_reset_reason(void) { return reset_reason; }
+void hostSetResetReason(esp_reset_reason_t reason) { reset_reason = reason; }
+
+// ============== Data Partitions ==============
+// Flash contents live in their own mapping, not on the heap, so they do not
+// count as used RAM in the EspClass heap figures
+struct HostFlashArea {
+    uint8_t* data;
+    size_t size;
+
+    void assign(size_t n) {
+        if (data) munmap(data, size);
+        void* m = n ? mmap(nullptr, n, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) : MAP_FAILED;
+        data = m == MAP_FAILED ? nullptr : (uint8_t*)m;
+        size = data ? n : 0;
+        if (data) memset(data, 0xFF, size);
+    }
+};
+
+// Same type/subtype/label as the entries in partitions.csv
+struct HostPartition {
+    esp_partition_t part;
+    HostFlashArea flash;
+    bool present;
+    uint32_t erases;
+};
+
+static HostPartition partitions[] = {
+    {{ESP_PARTITION_TYPE_DATA, 0x40, 0x3D0000, 0x10000, "journal"}, {nullptr, 0}, true, 0},
+    {{ESP_PARTITION_TYPE_DATA, 0x41, 0x3E0000, 0x10000, "capture"}, {nullptr, 0}, true, 0},
+};
+
+static HostPartition* findPartition(const char* label) {
+    for (HostPartition& p : partitions) {
+        if (strcmp(p.part.label, label) == 0) return &p;
+    }
+    return nullptr;
+}
+
+static HostPartition& owner(const esp_partition_t* part) {
+    for (HostPartition& p : partitions) {
+        if (&p.part == part) return p;
+    }
+    return partitions[0];
+}
+
+void hostPartitionEnable(bool enable, uint32_t size, const char* label) {
+    HostPartition* p = findPartition(label);
+    if (!p) return;
+    p->present = enable;
+    p->part.size = size;
+    p->flash.assign(size);
+}
+
+uint32_t hostPartitionErases(const char* label) {
+    HostPartition* p = findPartition(label);
+    return p ? p->erases : 0;
+}
+
+uint8_t* hostPartitionData(const char* label) {
+    HostPartition* p = findPartition(label);
+    return p ? p->flash.data : nullptr;
+}
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char* label) {
+    for (HostPartition& p : partitions) {
+        if (!p.present || type != p.part.type || subtype != p.part.subtype) continue;
+        if (label && strcmp(label, p.part.label) != 0) continue;
+        if (p.flash.size != p.part.size) p.flash.assign(p.part.size);
+        return &p.part;
+    }
+    return nullptr;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* p, size_t offset, void* dst, size_t size) {
+    if (offset + size > p->size) return ESP_ERR_INVALID_ARG;
+    memcpy(dst, owner(p).flash.data + offset, size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t* p, size_t offset, const void* src, size_t size) {
+    if (offset + size > p->size) return ESP_ERR_INVALID_ARG;
+    uint8_t* flash = owner(p).flash.data;
+    const uint8_t* s = (const uint8_t*)src;
+    for (size_t i = 0; i < size; i++) {
+        flash[offset + i] &= s[i];      // NOR flash: bits only go 1 -> 0
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* p, size_t offset, size_t size) {
+    if (offset % HOST_FLASH_SECTOR || size % HOST_FLASH_SECTOR || offset + size > p->size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(owner(p).flash.data + offset, 0xFF, size);
+    owner(p).erases++;
+    return ESP_OK;
+}
@@ -0,0 +1,321 @@
+/*
+ * HostLibraries.cpp - Host implementations of the third-party library shims
+ */
+
+#include <HomeSpan.h>
+#include <LoRa.h>
+#include <Preferences.h>
+#include <PubSubClient.h>
+#include <SPI.h>
+#include <WiFi.h>
+
+// ============== HomeSpan ==============
+Span homeSpan;
+uint32_t SpanCharacteristic::total_updates = 0;
+
+SpanAccessory::SpanAccessory() : aid_(homeSpan.next_aid++) {
+    homeSpan.accessories.push_back(this);
+}
+
+SpanService::SpanService() : owner(homeSpan.accessories.empty() ? nullptr : homeSpan.accessories.back()) {
+    homeSpan.services.push_back(this);
+}
+
+SpanCharacteristic::SpanCharacteristic(double v)
+    : owner(homeSpan.accessories.empty() ? nullptr : homeSpan.accessories.back()), value_(v),
+      updated_ms_(millis()) {
+    homeSpan.characteristics.push_back(this);
+}
+
+template <typename T> static void deleteOwned(std::vector<T*>& list, SpanAccessory* acc) {
+    auto keep = std::remove_if(list.begin(), list.end(), [acc](T* obj) {
+        if (obj->owner != acc) return false;
+        delete obj;
+        return true;
+    });
+    list.erase(keep, list.end());
+}
+
+bool Span::deleteAccessory(uint32_t aid) {
+    for (auto it = accessories.begin(); it != accessories.end(); ++it) {
+        SpanAccessory* acc = *it;
+        if (acc->getAID() != aid) continue;
+        deleteOwned(characteristics, acc);
+        deleteOwned(services, acc);
+        accessories.erase(it);
+        delete acc;
+        return true;
+    }
+    return false;
+}
+
+// ============== SPI ==============
+SPIClass SPI;
+
+// ============== LoRa ==============
+LoRaClass LoRa;
+
+int LoRaClass::begin(long frequency) {
+    frequency_ = frequency;
+    return begin_ok ? 1 : 0;
+}
+
+void LoRaClass::configured() {
+    config_changes++;
+    if (config_write_us) hostAdvanceMicros(config_write_us);
+    rx_since_us_ = hostMicros64();   // A frame being demodulated is lost
+}
+
+void LoRaClass::setSpreadingFactor(int sf) {
+    sf = sf < 6 ? 6 : (sf > 12 ? 12 : sf);
+    sf_ = sf;
+    configured();
+}
+
+void LoRaClass::setSignalBandwidth(long bw) {
+    bw_ = bw;
+    configured();
+}
+
+void LoRaClass::setSyncWord(int sw) {
+    sync_ = sw;
+    configured();
+}
+
+void LoRaClass::setFrequency(long frequency) {
+    frequency_ = frequency;
+    configured();
+}
+
+void LoRaClass::receive(int size) {
+    (void)size;
+    if (!receiving) rx_since_us_ = hostMicros64();
+    receiving = true;
+}
+
+void hostTriggerInterrupt(uint8_t pin);
+bool LoRaClass::injectFrame(const uint8_t* data, size_t len, int rssi, float snr, int sf, uint64_t start_us,
+                            long frequency, long bw, int sync) {
+    bool tuned = (frequency == 0 || frequency == frequency_) && (bw == 0 || bw == bw_) && (sync < 0 || sync == sync_);
+    if (!receiving || sf != sf_ || !tuned || rx_since_us_ > start_us) {
+        frames_missed++;
+        return false;
+    }
+    injectPacket(data, len, rssi, snr);
+    return true;
+}
+
+void LoRaClass::injectPacket(const uint8_t* data, size_t len, int rssi, float snr, long freqErr) {
+    if (len > sizeof(pending_)) len = sizeof(pending_);
+    memcpy(pending_, data, len);
+    pending_len_ = len;
+    pending_rssi_ = rssi;
+    pending_snr_ = snr;
+    pending_ferr_ = freqErr;
+    has_pending_ = true;
+    if (receiving) {                 // Continuous RX: DIO0 rises on RxDone
+        digitalWrite(dio0_, HIGH);
+        hostTriggerInterrupt(dio0_);
+    }
+}
+
+int LoRaClass::rssi() {
+    if (channel_spread_db <= 0) return channel_rssi;
+    noise_state_ = noise_state_ * 1664525u + 1013904223u;
+    return channel_rssi + (int)((noise_state_ >> 16) % (2 * channel_spread_db + 1)) - channel_spread_db;
+}
+
+int LoRaClass::parsePacket(int size) {
+    (void)size;
+    parse_calls++;
+    digitalWrite(dio0_, LOW);        // IRQ flags cleared
+    if (!has_pending_) { receiving = false; return 0; }   // Real lib drops to RX_SINGLE
+    has_pending_ = false;
+    receiving = false;               // idle() after RxDone
+    memcpy(rx_, pending_, pending_len_);
+    rx_len_ = pending_len_;
+    rx_pos_ = 0;
+    rssi_ = pending_rssi_;
+    snr_ = pending_snr_;
+    ferr_ = pending_ferr_;
+    return (int)rx_len_;
+}
+
+int LoRaClass::available() {
+    return (int)(rx_len_ - rx_pos_);
+}
+
+int LoRaClass::read() {
+    return rx_pos_ < rx_len_ ? rx_[rx_pos_++] : -1;
+}
+
+int LoRaClass::beginPacket(int implicitHeader) {
+    (void)implicitHeader;
+    tx_len_ = 0;
+    return 1;
+}
+
+size_t LoRaClass::write(uint8_t c) {
+    if (tx_len_ < sizeof(tx_)) tx_[tx_len_++] = c;
+    return 1;
+}
+
+size_t LoRaClass::write(const uint8_t* buf, size_t n) {
+    for (size_t i = 0; i < n; i++) write(buf[i]);
+    return n;
+}
+
+// The firmware's own formula (hardware/LoRaModule.h)
+uint32_t loraTimeOnAirUs(int len, uint8_t sf, uint32_t bw, uint8_t cr, uint16_t preamble);
+
+int LoRaClass::endPacket(bool async) {
+    (void)async;
+    tx_packets++;
+    receiving = false;               // Standby after TxDone
+    tx_sf = sf_;
+    tx_start_us = hostMicros64();
+    hostAdvanceMicros(loraTimeOnAirUs((int)tx_len_, (uint8_t)sf_, (uint32_t)bw_, (uint8_t)cr_, (uint16_t)preamble_));
+    tx_end_us = hostMicros64();
+    if (on_transmit) on_transmit(tx_, tx_len_);
+    return 1;
+}
+
+// ============== Preferences ==============
+std::map<std::string, std::map<std::string, std::vector<uint8_t>>> Preferences::store_;
+
+bool Preferences::begin(const char* name, bool readOnly) {
+    ns_ = name;
+    read_only_ = readOnly;
+    open_ = true;
+    return true;
+}
+
+void Preferences::end() {
+    open_ = false;
+}
+
+bool Preferences::clear() {
+    if (!open_ || read_only_) return false;
+    store_[ns_].clear();
+    return true;
+}
+
+bool Preferences::remove(const char* key) {
+    if (!open_ || read_only_) return false;
+    return store_[ns_].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+    return open_ && store_[ns_].count(key) > 0;
+}
+
+size_t Preferences::putRaw(const char* key, const void* data, size_t len) {
+    if (!open_ || read_only_) return 0;
+    const uint8_t* p = (const uint8_t*)data;
+    store_[ns_][key] = std::vector<uint8_t>(p, p + len);
+    return len;
+}
+
+bool Preferences::getRaw(const char* key, void* out, size_t len) {
+    if (!open_) return false;
+    auto& ns = store_[ns_];
+    auto it = ns.find(key);
+    if (it == ns.end() || it->second.size() != len) return false;
+    memcpy(out, it->second.data(), len);
+    return true;
+}
+
+size_t Preferences::putString(const char* key, const char* value) {
+    return putRaw(key, value, strlen(value) + 1);
+}
+
+size_t Preferences::putString(const char* key, const String& value) {
+    return putString(key, value.c_str());
+}
+
+size_t Preferences::getString(const char* key, char* value, size_t maxLen) {
+    if (!open_) return 0;
+    auto& ns = store_[ns_];
+    auto it = ns.find(key);
+    if (it == ns.end() || maxLen == 0) return 0;
+    size_t n = std::min(it->second.size(), maxLen);
+    memcpy(value, it->second.data(), n);
+    value[n - 1] = 0;
+    return n;
+}
+
+String Preferences::getString(const char* key, const String defaultValue) {
+    if (!open_) return defaultValue;
+    auto& ns = store_[ns_];
+    auto it = ns.find(key);
+    if (it == ns.end()) return defaultValue;
+    return String((const char*)it->second.data());
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t len) {
+    return putRaw(key, value, len);
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+    if (!open_) return 0;
+    auto& ns = store_[ns_];
+    auto it = ns.find(key);
+    if (it == ns.end()) return 0;
+    size_t n = std::min(it->second.size(), maxLen);
+    memcpy(buf, it->second.data(), n);
+    return n;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    if (!open_) return 0;
+    auto& ns = store_[ns_];
+    auto it = ns.find(key);
+    return it == ns.end() ? 0 : it->second.size();
+}
+
+void Preferences::hostReset() {
+    store_.clear();
+}
+
+// ============== WiFi ==============
+WiFiClass WiFi;
+
+// ============== PubSubClient ==============
+PubSubClient* PubSubClient::last_instance = nullptr;
+
+bool PubSubClient::connect(const char* id) {
+    (void)id;
+    connected_ = broker_up;
+    if (!connected_) state_ = -2;
+    return connected_;
+}
+
+bool PubSubClient::connect(const char* id, const char* willTopic, uint8_t willQos, bool willRetain,
+                           const char* willMessage) {
+    (void)willTopic; (void)willQos; (void)willRetain; (void)willMessage;
+    return connect(id);
+}
+
+bool PubSubClient::connect(const char* id, const char* user, const char* pass, const char* willTopic,
+                           uint8_t willQos, bool willRetain, const char* willMessage) {
+    (void)user; (void)pass;
+    return connect(id, willTopic, willQos, willRetain, willMessage);
+}
+
+bool PubSubClient::connect(const char* id, const char* user, const char* pass) {
+    (void)user; (void)pass;
+    return connect(id);
+}
+
+bool PubSubClient::publish(const char* topic, const char* payload, bool retained) {
+    return publish(topic, (const uint8_t*)payload, strlen(payload), retained);
+}
+
+bool PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int length, bool retained) {
+    (void)retained;
+    if (!connected_) return false;
+    published++;
+    published_bytes += strlen(topic) + length;
+    if (on_publish) on_publish(topic, payload, length);
+    return true;
+}
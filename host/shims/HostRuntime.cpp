@@ -0,0 +1,325 @@
+/*
+ * HostRuntime.cpp - Host implementation of the Arduino core shim
+ */
+
+#include "Arduino.h"
+#include "core/HeapProfiler.h"
+#include <atomic>
+#include <chrono>
+#include <malloc.h>
+#include <map>
+#include <mutex>
+#include <new>
+#include <thread>
+
+// ============== Virtual Time ==============
+static std::atomic<uint64_t> host_us{0};   // Virtual: the time. Accelerated: waits skipped so far
+static HostClock host_clock = HOST_CLOCK_VIRTUAL;
+
+static uint64_t wallMicros() {
+    using namespace std::chrono;
+    static const steady_clock::time_point start = steady_clock::now();
+    return (uint64_t)duration_cast<microseconds>(steady_clock::now() - start).count();
+}
+
+uint64_t hostMicros64() {
+    switch (host_clock) {
+        case HOST_CLOCK_ACCELERATED: return host_us.load() + wallMicros();
+        case HOST_CLOCK_WALL: return wallMicros();
+        default: return host_us.load();
+    }
+}
+
+void hostSetClock(HostClock clock) {
+    // Keep the time continuous across the switch
+    uint64_t now = hostMicros64();
+    uint64_t wall = wallMicros();
+    host_clock = clock;
+    if (clock == HOST_CLOCK_VIRTUAL) host_us = now;
+    else if (clock == HOST_CLOCK_ACCELERATED) host_us = now > wall ? now - wall : 0;
+}
+
+void hostSetMicros(uint64_t us) { host_us = us; }
+void hostAdvanceMicros(uint64_t us) { host_us += us; }
+
+unsigned long millis() { return (unsigned long)(uint32_t)(hostMicros64() / 1000); }
+unsigned long micros() { return (unsigned long)(uint32_t)hostMicros64(); }
+
+void delay(uint32_t ms) {
+    if (host_clock == HOST_CLOCK_WALL) std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    else host_us += (uint64_t)ms * 1000;
+}
+
+void delayMicroseconds(uint32_t us) {
+    if (host_clock == HOST_CLOCK_WALL) std::this_thread::sleep_for(std::chrono::microseconds(us));
+    else host_us += us;
+}
+
+void yield() {}
+
+// ============== GPIO ==============
+static uint8_t pin_state[64];
+static void (*pin_isr[64])(void);
+
+void pinMode(uint8_t pin, uint8_t mode) { (void)pin; (void)mode; }
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    if (pin < 64) pin_state[pin] = val;
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < 64 ? pin_state[pin] : 0;
+}
+
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode) {
+    (void)mode;
+    if (pin < 64) pin_isr[pin] = isr;
+}
+
+void detachInterrupt(uint8_t pin) {
+    if (pin < 64) pin_isr[pin] = nullptr;
+}
+
+void hostTriggerInterrupt(uint8_t pin) {
+    if (pin < 64 && pin_isr[pin]) pin_isr[pin]();
+}
+
+// ============== Random ==============
+static uint32_t rng_state = 0x12345678;
+
+void randomSeed(unsigned long seed) {
+    rng_state = (uint32_t)seed ? (uint32_t)seed : 1;
+}
+
+static uint32_t nextRandom() {
+    // xorshift32 - deterministic across platforms
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+long random(long max) {
+    return max <= 0 ? 0 : (long)(nextRandom() % (uint32_t)max);
+}
+
+long random(long min, long max) {
+    return max <= min ? min : min + random(max - min);
+}
+
+// ============== Print / Serial ==============
+HardwareSerial Serial;
+static bool serial_enabled = true;
+static uint64_t serial_bytes = 0;
+
+void hostSetSerialEnabled(bool enabled) { serial_enabled = enabled; }
+uint64_t hostSerialBytes() { return serial_bytes; }
+
+size_t Print::write(const uint8_t* buf, size_t n) {
+    size_t w = 0;
+    while (n--) w += write(*buf++);
+    return w;
+}
+
+size_t Print::printf(const char* fmt, ...) {
+    char small[256];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(small, sizeof(small), fmt, ap);
+    va_end(ap);
+    if (n < 0) return 0;
+    if ((size_t)n < sizeof(small)) return write((const uint8_t*)small, (size_t)n);
+
+    char* big = (char*)malloc((size_t)n + 1);
+    if (!big) return 0;
+    va_start(ap, fmt);
+    vsnprintf(big, (size_t)n + 1, fmt, ap);
+    va_end(ap);
+    size_t w = write((const uint8_t*)big, (size_t)n);
+    free(big);
+    return w;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    serial_bytes++;
+    if (serial_enabled) fputc(c, stdout);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buf, size_t n) {
+    serial_bytes += n;
+    if (serial_enabled) fwrite(buf, 1, n, stdout);
+    return n;
+}
+
+void HardwareSerial::flush() {
+    if (serial_enabled) fflush(stdout);
+}
+
+// ============== ESP ==============
+EspClass ESP;
+
+#define HOST_HEAP_SIZE (320 * 1024)
+
+// The firmware's heap is modelled from the process allocator: what was
+// allocated after static initialisation counts against HOST_HEAP_SIZE.
+// The largest block is the untouched rest plus the free top of the arena;
+// free chunks inside the arena count as fragmentation. Sanitizer builds
+// replace the allocator and report the full heap as free.
+struct HostHeapUsage {
+    size_t in_use;
+    size_t arena;                    // Heap obtained from the system
+    size_t top;                      // Free space at the end of the arena
+};
+
+static HostHeapUsage hostHeapUsage() {
+    HostHeapUsage u = {0, 0, 0};
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    struct mallinfo2 mi = mallinfo2();
+    u.in_use = mi.uordblks + mi.hblkhd;
+    u.arena = mi.arena + mi.hblkhd;
+    u.top = mi.keepcost;
+#endif
+    return u;
+}
+
+static const HostHeapUsage heap_base = hostHeapUsage();
+static uint32_t heap_min_free = HOST_HEAP_SIZE;
+
+static uint32_t clampHeap(size_t used, size_t base) {
+    size_t own = used > base ? used - base : 0;
+    return own < HOST_HEAP_SIZE ? (uint32_t)(HOST_HEAP_SIZE - own) : 0;
+}
+
+uint32_t EspClass::getFreeHeap() {
+    uint32_t free_heap = clampHeap(hostHeapUsage().in_use, heap_base.in_use);
+    if (free_heap < heap_min_free) heap_min_free = free_heap;
+    return free_heap;
+}
+
+uint32_t EspClass::getHeapSize() { return HOST_HEAP_SIZE; }
+
+uint32_t EspClass::getMinFreeHeap() {
+    getFreeHeap();
+    return heap_min_free;
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+    HostHeapUsage u = hostHeapUsage();
+    uint32_t untouched = clampHeap(u.arena, heap_base.arena);
+    uint32_t largest = untouched + (uint32_t)min(u.top, (size_t)HOST_HEAP_SIZE);
+    return min(largest, getFreeHeap());
+}
+
+// ============== Allocator Hooks ==============
+// The host counterpart of HEAP_PROFILER_HOOKS: the link wraps malloc and
+// friends (-Wl,--wrap in CMakeLists.txt) and operator new/delete go through
+// malloc/free, so every firmware allocation reaches the heap profiler. Other
+// tasks are charged to HEAP_SUBSYS_TASKS, as on the device.
+#ifdef HOST_ALLOC_HOOKS
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+}
+
+static uint8_t allocSubsys() {
+    return heapProfilerOnLoopTask() ? heap_current_subsys : HEAP_SUBSYS_TASKS;
+}
+
+extern "C" void* __wrap_malloc(size_t size) {
+    void* p = __real_malloc(size);
+    if (p) heapProfilerRecordAlloc(size, allocSubsys());
+    return p;
+}
+
+extern "C" void* __wrap_calloc(size_t n, size_t size) {
+    void* p = __real_calloc(n, size);
+    if (p) heapProfilerRecordAlloc(n * size, allocSubsys());
+    return p;
+}
+
+// A new block and the old one freed, as the ESP-IDF heap sees it
+extern "C" void* __wrap_realloc(void* ptr, size_t size) {
+    void* p = __real_realloc(ptr, size);
+    if (p && size) heapProfilerRecordAlloc(size, allocSubsys());
+    if (ptr && (p || !size)) heapProfilerRecordFree(allocSubsys());
+    return p;
+}
+
+extern "C" void __wrap_free(void* ptr) {
+    if (ptr) heapProfilerRecordFree(allocSubsys());
+    __real_free(ptr);
+}
+
+void* operator new(size_t size) {
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return malloc(size ? size : 1); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return malloc(size ? size : 1); }
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { free(ptr); }
+#endif
+
+void EspClass::restart() {
+    printf("[HOST] ESP.restart() requested\n");
+}
+
+// ============== FreeRTOS ==============
+static thread_local TaskHandle_t current_task = (TaskHandle_t)1;   // Main thread is the loop task
+static thread_local BaseType_t current_core = 1;
+static std::atomic<intptr_t> next_task{2};
+
+void vTaskDelay(TickType_t ticks) { delay(ticks); }
+TickType_t xTaskGetTickCount() { return (TickType_t)millis(); }
+TaskHandle_t xTaskGetCurrentTaskHandle() { return current_task; }
+BaseType_t xPortGetCoreID() { return current_core; }
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core) {
+    (void)name; (void)stack; (void)priority;
+    TaskHandle_t task = (TaskHandle_t)next_task++;
+    if (handle) *handle = task;
+    std::thread([=] {
+        current_task = task;
+        current_core = core;
+        fn(arg);
+    }).detach();
+    return pdPASS;
+}
+
+// ============== Task Notifications ==============
+static std::mutex notify_mutex;
+static std::map<TaskHandle_t, std::atomic<uint32_t>> notify_values;   // Nodes never move
+
+static std::atomic<uint32_t>& notifyValue(TaskHandle_t task) {
+    std::lock_guard<std::mutex> lock(notify_mutex);
+    return notify_values[task];
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+    std::atomic<uint32_t>& value = notifyValue(xTaskGetCurrentTaskHandle());
+    for (TickType_t t = 0;; t++) {
+        uint32_t v = value.load();
+        while (v && !value.compare_exchange_weak(v, clear ? 0 : v - 1)) {}
+        if (v || t >= ticks) return v;
+        delay(1);
+    }
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    notifyValue(task)++;
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken) {
+    notifyValue(task)++;
+    if (woken) *woken = pdTRUE;
+}
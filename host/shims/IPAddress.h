@@ -0,0 +1,25 @@
+/*
+ * IPAddress.h - Host shim for the Arduino IPAddress class
+ */
+
+#ifndef HOST_IPADDRESS_H
+#define HOST_IPADDRESS_H
+
+#include <Arduino.h>
+
+class IPAddress {
+public:
+    IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : octets_{a, b, c, d} {}
+
+    String toString() const {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", octets_[0], octets_[1], octets_[2], octets_[3]);
+        return String(buf);
+    }
+    uint8_t operator[](int i) const { return octets_[i]; }
+
+private:
+    uint8_t octets_[4];
+};
+
+#endif // HOST_IPADDRESS_H
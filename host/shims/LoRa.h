@@ -0,0 +1,116 @@
+/*
+ * LoRa.h - Host mock of the sandeepmistry LoRa library
+ * Frames are injected by the harness and handed out by parsePacket();
+ * transmitted frames are passed to an optional callback. Transmitting takes
+ * the frame's time on air on the virtual clock, as the real endPacket()
+ * blocks until TxDone. Changing the frequency, bandwidth, SF or sync word
+ * loses a frame being received and may cost config_write_us of clock.
+ */
+
+#ifndef HOST_LORA_H
+#define HOST_LORA_H
+
+#include <Arduino.h>
+#include <functional>
+
+class LoRaClass : public Print {
+public:
+    int begin(long frequency);
+    void end() {}
+    void setPins(int ss, int reset, int dio0) { ss_ = ss; (void)reset; dio0_ = dio0; }
+    void setSpreadingFactor(int sf);
+    void setSignalBandwidth(long bw);
+    void setCodingRate4(int denominator) { cr_ = denominator; config_changes++; }
+    void setPreambleLength(long len) { preamble_ = len; }
+    void setSyncWord(int sw);
+    void setFrequency(long frequency);
+    void setTxPower(int level, int outputPin = 1) { tx_power_ = level; (void)outputPin; }
+    void enableCrc() { crc_ = true; }
+    void disableCrc() { crc_ = false; }
+    void receive(int size = 0);
+    void idle() { receiving = false; }
+    void sleep() { receiving = false; }
+    void onReceive(void (*cb)(int)) { on_receive_ = cb; }
+
+    int parsePacket(int size = 0);
+    int packetRssi() { return rssi_; }
+    float packetSnr() { return snr_; }
+    long packetFrequencyError() { return ferr_; }
+    int rssi();
+    int available();
+    int read();
+    int peek() { return rx_pos_ < rx_len_ ? rx_[rx_pos_] : -1; }
+
+    int beginPacket(int implicitHeader = 0);
+    int endPacket(bool async = false);
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buf, size_t n) override;
+    using Print::write;
+
+    // Host harness API
+    void injectPacket(const uint8_t* data, size_t len, int rssi, float snr = 8.0f, long freqErr = 0);
+    bool hasPendingPacket() const { return has_pending_; }
+
+    // A frame on the air from start_us to now: heard only if the radio has
+    // been receiving on its settings since before it started. frequency, bw
+    // and sync of 0 / -1 match whatever the radio is on.
+    bool injectFrame(const uint8_t* data, size_t len, int rssi, float snr, int sf, uint64_t start_us,
+                     long frequency = 0, long bw = 0, int sync = -1);
+    long frequency() const { return frequency_; }
+    int spreadingFactor() const { return sf_; }
+    long signalBandwidth() const { return bw_; }
+    int codingRate4() const { return cr_; }
+    int syncWord() const { return sync_; }
+    bool crcEnabled() const { return crc_; }
+    int txPower() const { return tx_power_; }
+
+    bool begin_ok = true;
+    bool receiving = false;
+    int channel_rssi = -120;
+    int channel_spread_db = 0;          // rssi() varies by up to this either side
+    uint32_t parse_calls = 0;
+    uint32_t tx_packets = 0;
+    uint32_t config_changes = 0;
+    uint32_t config_write_us = 0;       // Clock cost of each setting change (SPI writes)
+    uint32_t frames_missed = 0;         // injectFrame() while not listening for it
+    uint64_t tx_start_us = 0;           // Last transmission, virtual clock
+    uint64_t tx_end_us = 0;
+    int tx_sf = 0;
+    std::function<void(const uint8_t*, size_t)> on_transmit;
+
+private:
+    int ss_ = 18, dio0_ = 26;
+    long frequency_ = 0;
+    int sf_ = 7;
+    long bw_ = 125000;
+    int cr_ = 5;
+    long preamble_ = 8;
+    int sync_ = 0x12;
+    int tx_power_ = 17;
+    bool crc_ = false;
+    void (*on_receive_)(int) = nullptr;
+
+    uint8_t pending_[256];
+    size_t pending_len_ = 0;
+    int pending_rssi_ = 0;
+    float pending_snr_ = 0;
+    long pending_ferr_ = 0;
+    bool has_pending_ = false;
+
+    uint8_t rx_[256];
+    size_t rx_len_ = 0, rx_pos_ = 0;
+    int rssi_ = 0;
+    float snr_ = 0;
+    long ferr_ = 0;
+    uint32_t noise_state_ = 1;
+    uint64_t rx_since_us_ = 0;          // Receiving on the current settings since
+
+    void configured();
+
+    uint8_t tx_[256];
+    size_t tx_len_ = 0;
+};
+
+extern LoRaClass LoRa;
+
+#endif // HOST_LORA_H
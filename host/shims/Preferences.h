@@ -0,0 +1,60 @@
+/*
+ * Preferences.h - Host in-memory stand-in for the ESP32 NVS Preferences API
+ */
+
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <vector>
+
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false);
+    void end();
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+
+#define HOST_PREF_TYPE(Name, T) \
+    size_t put##Name(const char* key, T value) { return putRaw(key, &value, sizeof(T)); } \
+    T get##Name(const char* key, T def = T()) { T v; return getRaw(key, &v, sizeof(T)) ? v : def; }
+    HOST_PREF_TYPE(Char, int8_t)
+    HOST_PREF_TYPE(UChar, uint8_t)
+    HOST_PREF_TYPE(Short, int16_t)
+    HOST_PREF_TYPE(UShort, uint16_t)
+    HOST_PREF_TYPE(Int, int32_t)
+    HOST_PREF_TYPE(UInt, uint32_t)
+    HOST_PREF_TYPE(Long, int32_t)
+    HOST_PREF_TYPE(ULong, uint32_t)
+    HOST_PREF_TYPE(Long64, int64_t)
+    HOST_PREF_TYPE(ULong64, uint64_t)
+    HOST_PREF_TYPE(Float, float)
+    HOST_PREF_TYPE(Double, double)
+    HOST_PREF_TYPE(Bool, bool)
+#undef HOST_PREF_TYPE
+
+    size_t putString(const char* key, const char* value);
+    size_t putString(const char* key, const String& value);
+    size_t getString(const char* key, char* value, size_t maxLen);
+    String getString(const char* key, const String defaultValue = String());
+    size_t putBytes(const char* key, const void* value, size_t len);
+    size_t getBytes(const char* key, void* buf, size_t maxLen);
+    size_t getBytesLength(const char* key);
+
+    // Wipe every namespace (simulates a fresh flash)
+    static void hostReset();
+
+private:
+    size_t putRaw(const char* key, const void* data, size_t len);
+    bool getRaw(const char* key, void* out, size_t len);
+
+    static std::map<std::string, std::map<std::string, std::vector<uint8_t>>> store_;
+    std::string ns_;
+    bool read_only_ = false;
+    bool open_ = false;
+};
+
+#endif // HOST_PREFERENCES_H
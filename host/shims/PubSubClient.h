@@ -0,0 +1,56 @@
+/*
+ * PubSubClient.h - Host stub of the PubSubClient MQTT library
+ * publish() succeeds while the fake broker is up and reports each message
+ * through an optional callback.
+ */
+
+#ifndef HOST_PUBSUBCLIENT_H
+#define HOST_PUBSUBCLIENT_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <functional>
+
+#define MQTT_CALLBACK_SIGNATURE std::function<void(char*, uint8_t*, unsigned int)> callback
+
+class PubSubClient {
+public:
+    PubSubClient() { last_instance = this; }
+    explicit PubSubClient(WiFiClient& c) { (void)c; last_instance = this; }
+    PubSubClient& setClient(WiFiClient& c) { (void)c; return *this; }
+    PubSubClient& setServer(const char* host, uint16_t port) { (void)host; (void)port; return *this; }
+    PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE) { cb_ = callback; return *this; }
+    PubSubClient& setKeepAlive(uint16_t s) { (void)s; return *this; }
+    PubSubClient& setSocketTimeout(uint16_t s) { (void)s; return *this; }
+    bool setBufferSize(uint16_t size) { buffer_size_ = size; return true; }
+    uint16_t getBufferSize() { return buffer_size_; }
+
+    bool connect(const char* id);
+    bool connect(const char* id, const char* user, const char* pass);
+    bool connect(const char* id, const char* willTopic, uint8_t willQos, bool willRetain, const char* willMessage);
+    bool connect(const char* id, const char* user, const char* pass, const char* willTopic, uint8_t willQos,
+                 bool willRetain, const char* willMessage);
+    void disconnect() { connected_ = false; }
+    bool connected() { return connected_; }
+    int state() { return state_; }
+    bool loop() { return connected_; }
+    bool subscribe(const char* topic, uint8_t qos = 0) { (void)topic; (void)qos; return connected_; }
+
+    bool publish(const char* topic, const char* payload, bool retained = false);
+    bool publish(const char* topic, const uint8_t* payload, unsigned int length, bool retained = false);
+
+    // Host harness state
+    bool broker_up = true;
+    uint32_t published = 0;
+    uint64_t published_bytes = 0;
+    std::function<void(const char*, const uint8_t*, unsigned int)> on_publish;
+    static PubSubClient* last_instance;
+
+private:
+    std::function<void(char*, uint8_t*, unsigned int)> cb_;
+    uint16_t buffer_size_ = 256;
+    bool connected_ = false;
+    int state_ = -1;
+};
+
+#endif // HOST_PUBSUBCLIENT_H
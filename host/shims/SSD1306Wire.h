@@ -0,0 +1,41 @@
+/*
+ * SSD1306Wire.h - Host stub of the OLED driver
+ * Drawing calls are accepted and discarded; display() counts frames.
+ */
+
+#ifndef HOST_SSD1306WIRE_H
+#define HOST_SSD1306WIRE_H
+
+#include <Arduino.h>
+
+enum OLEDDISPLAY_TEXT_ALIGNMENT { TEXT_ALIGN_LEFT, TEXT_ALIGN_RIGHT, TEXT_ALIGN_CENTER, TEXT_ALIGN_CENTER_BOTH };
+enum OLEDDISPLAY_COLOR { BLACK = 0, WHITE = 1, INVERSE = 2 };
+
+static const uint8_t ArialMT_Plain_10[1] = {0};
+static const uint8_t ArialMT_Plain_16[1] = {0};
+static const uint8_t ArialMT_Plain_24[1] = {0};
+
+class SSD1306Wire {
+public:
+    SSD1306Wire(uint8_t address, int sda, int scl) { (void)address; (void)sda; (void)scl; }
+    bool init() { return true; }
+    void clear() {}
+    void display() { frames++; }
+    void displayOn() {}
+    void displayOff() {}
+    void flipScreenVertically() {}
+    void setBrightness(uint8_t b) { (void)b; }
+    void setContrast(uint8_t c) { (void)c; }
+    void setFont(const uint8_t* font) { (void)font; }
+    void setTextAlignment(OLEDDISPLAY_TEXT_ALIGNMENT a) { (void)a; }
+    void setColor(OLEDDISPLAY_COLOR c) { (void)c; }
+    void drawString(int16_t x, int16_t y, const String& s) { (void)x; (void)y; (void)s; }
+    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1) { (void)x0; (void)y0; (void)x1; (void)y1; }
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h) { (void)x; (void)y; (void)w; (void)h; }
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h) { (void)x; (void)y; (void)w; (void)h; }
+    void setPixel(int16_t x, int16_t y) { (void)x; (void)y; }
+
+    uint32_t frames = 0;
+};
+
+#endif // HOST_SSD1306WIRE_H
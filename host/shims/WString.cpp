@@ -0,0 +1,235 @@
+/*
+ * WString.cpp - Host shim for the Arduino String class
+ */
+
+#include "WString.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+String::String(const char* s) : buf_(nullptr), len_(0), cap_(0) {
+    if (s && *s) concat(s);
+}
+
+String::String(const String& s) : buf_(nullptr), len_(0), cap_(0) {
+    concat(s.c_str(), s.len_);
+}
+
+String::String(String&& s) noexcept : buf_(s.buf_), len_(s.len_), cap_(s.cap_) {
+    s.buf_ = nullptr;
+    s.len_ = s.cap_ = 0;
+}
+
+String::String(char c) : buf_(nullptr), len_(0), cap_(0) {
+    concat(&c, 1);
+}
+
+static void formatInteger(char* out, size_t n, unsigned long long v, bool neg, unsigned char base) {
+    char tmp[72];
+    int i = 0;
+    if (base < 2 || base > 36) base = 10;
+    do {
+        int d = (int)(v % base);
+        tmp[i++] = (char)(d < 10 ? '0' + d : 'a' + d - 10);
+        v /= base;
+    } while (v && i < 70);
+    size_t o = 0;
+    if (neg && o < n - 1) out[o++] = '-';
+    while (i > 0 && o < n - 1) out[o++] = tmp[--i];
+    out[o] = 0;
+}
+
+String::String(int v, unsigned char base) : String((long long)v, base) {}
+String::String(unsigned int v, unsigned char base) : String((unsigned long long)v, base) {}
+String::String(long v, unsigned char base) : String((long long)v, base) {}
+String::String(unsigned long v, unsigned char base) : String((unsigned long long)v, base) {}
+
+String::String(long long v, unsigned char base) : buf_(nullptr), len_(0), cap_(0) {
+    char tmp[72];
+    bool neg = v < 0 && base == 10;
+    formatInteger(tmp, sizeof(tmp), neg ? 0ULL - (unsigned long long)v : (unsigned long long)v, neg, base);
+    concat(tmp);
+}
+
+String::String(unsigned long long v, unsigned char base) : buf_(nullptr), len_(0), cap_(0) {
+    char tmp[72];
+    formatInteger(tmp, sizeof(tmp), v, false, base);
+    concat(tmp);
+}
+
+String::String(float v, unsigned int decimals) : String((double)v, decimals) {}
+
+String::String(double v, unsigned int decimals) : buf_(nullptr), len_(0), cap_(0) {
+    char tmp[64];
+    snprintf(tmp, sizeof(tmp), "%.*f", (int)decimals, v);
+    concat(tmp);
+}
+
+String::~String() {
+    free(buf_);
+}
+
+String& String::operator=(const String& s) {
+    if (this == &s) return *this;
+    len_ = 0;
+    if (buf_) buf_[0] = 0;
+    concat(s.c_str(), s.len_);
+    return *this;
+}
+
+String& String::operator=(String&& s) noexcept {
+    if (this == &s) return *this;
+    free(buf_);
+    buf_ = s.buf_;
+    len_ = s.len_;
+    cap_ = s.cap_;
+    s.buf_ = nullptr;
+    s.len_ = s.cap_ = 0;
+    return *this;
+}
+
+String& String::operator=(const char* s) {
+    len_ = 0;
+    if (buf_) buf_[0] = 0;
+    if (s) concat(s);
+    return *this;
+}
+
+bool String::reserve(unsigned int size) {
+    if (buf_ && cap_ >= size) return true;
+    char* nb = (char*)realloc(buf_, size + 1);
+    if (!nb) return false;
+    if (!buf_) nb[0] = 0;
+    buf_ = nb;
+    cap_ = size;
+    return true;
+}
+
+bool String::concat(const char* s, unsigned int n) {
+    if (!s) return false;
+    if (n == 0) return true;
+    if (!reserve(len_ + n)) return false;
+    memmove(buf_ + len_, s, n);
+    len_ += n;
+    buf_[len_] = 0;
+    return true;
+}
+
+bool String::concat(const char* s) {
+    return s ? concat(s, (unsigned int)strlen(s)) : false;
+}
+
+String operator+(const String& a, const String& b) {
+    String r(a);
+    r.concat(b);
+    return r;
+}
+
+String operator+(const String& a, const char* b) {
+    String r(a);
+    r.concat(b);
+    return r;
+}
+
+String operator+(const char* a, const String& b) {
+    String r(a);
+    r.concat(b);
+    return r;
+}
+
+String operator+(const String& a, char b) {
+    String r(a);
+    r.concat(b);
+    return r;
+}
+
+bool String::equals(const char* s) const {
+    return strcmp(c_str(), s ? s : "") == 0;
+}
+
+bool String::equalsIgnoreCase(const String& s) const {
+    return strcasecmp(c_str(), s.c_str()) == 0;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    if (from >= len_) return -1;
+    const char* p = strchr(c_str() + from, c);
+    return p ? (int)(p - c_str()) : -1;
+}
+
+int String::indexOf(const char* s, unsigned int from) const {
+    if (from > len_) return -1;
+    const char* p = strstr(c_str() + from, s);
+    return p ? (int)(p - c_str()) : -1;
+}
+
+bool String::startsWith(const char* s) const {
+    size_t n = strlen(s);
+    return n <= len_ && strncmp(c_str(), s, n) == 0;
+}
+
+bool String::endsWith(const char* s) const {
+    size_t n = strlen(s);
+    return n <= len_ && strcmp(c_str() + len_ - n, s) == 0;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) {
+        unsigned int t = from;
+        from = to;
+        to = t;
+    }
+    if (from >= len_) return String();
+    if (to > len_) to = len_;
+    String r;
+    r.concat(c_str() + from, to - from);
+    return r;
+}
+
+void String::replace(const char* find, const char* with) {
+    size_t fn = strlen(find);
+    if (fn == 0 || len_ == 0) return;
+    String out;
+    const char* p = c_str();
+    const char* hit;
+    while ((hit = strstr(p, find)) != nullptr) {
+        out.concat(p, (unsigned int)(hit - p));
+        out.concat(with);
+        p = hit + fn;
+    }
+    out.concat(p);
+    *this = static_cast<String&&>(out);
+}
+
+void String::replace(char find, char with) {
+    for (unsigned int i = 0; i < len_; i++) {
+        if (buf_[i] == find) buf_[i] = with;
+    }
+}
+
+void String::toLowerCase() {
+    for (unsigned int i = 0; i < len_; i++) buf_[i] = (char)tolower((unsigned char)buf_[i]);
+}
+
+void String::toUpperCase() {
+    for (unsigned int i = 0; i < len_; i++) buf_[i] = (char)toupper((unsigned char)buf_[i]);
+}
+
+void String::trim() {
+    if (len_ == 0) return;
+    unsigned int b = 0, e = len_;
+    while (b < e && isspace((unsigned char)buf_[b])) b++;
+    while (e > b && isspace((unsigned char)buf_[e - 1])) e--;
+    memmove(buf_, buf_ + b, e - b);
+    len_ = e - b;
+    buf_[len_] = 0;
+}
+
+long String::toInt() const {
+    return atol(c_str());
+}
+
+float String::toFloat() const {
+    return (float)atof(c_str());
+}
@@ -0,0 +1,92 @@
+/*
+ * WString.h - Host shim for the Arduino String class
+ * Heap-backed (malloc/realloc) like the ESP32 core, so allocation profiling
+ * on the host sees the same allocation pattern as the firmware.
+ */
+
+#ifndef HOST_WSTRING_H
+#define HOST_WSTRING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class __FlashStringHelper;
+#define F(str) (reinterpret_cast<const __FlashStringHelper*>(str))
+#define FPSTR(p) (reinterpret_cast<const __FlashStringHelper*>(p))
+
+class String {
+public:
+    String(const char* s = "");
+    String(const String& s);
+    String(String&& s) noexcept;
+    String(const __FlashStringHelper* s) : String(reinterpret_cast<const char*>(s)) {}
+    explicit String(char c);
+    explicit String(int v, unsigned char base = 10);
+    explicit String(unsigned int v, unsigned char base = 10);
+    explicit String(long v, unsigned char base = 10);
+    explicit String(unsigned long v, unsigned char base = 10);
+    explicit String(long long v, unsigned char base = 10);
+    explicit String(unsigned long long v, unsigned char base = 10);
+    explicit String(float v, unsigned int decimals = 2);
+    explicit String(double v, unsigned int decimals = 2);
+    ~String();
+
+    String& operator=(const String& s);
+    String& operator=(String&& s) noexcept;
+    String& operator=(const char* s);
+    String& operator=(const __FlashStringHelper* s) { return *this = reinterpret_cast<const char*>(s); }
+
+    bool reserve(unsigned int size);
+    unsigned int length() const { return len_; }
+    const char* c_str() const { return buf_ ? buf_ : ""; }
+
+    bool concat(const char* s, unsigned int n);
+    bool concat(const char* s);
+    bool concat(const String& s) { return concat(s.c_str(), s.length()); }
+    bool concat(char c) { return concat(&c, 1); }
+    String& operator+=(const String& s) { concat(s); return *this; }
+    String& operator+=(const char* s) { concat(s); return *this; }
+    String& operator+=(const __FlashStringHelper* s) { concat(reinterpret_cast<const char*>(s)); return *this; }
+    String& operator+=(char c) { concat(c); return *this; }
+    String& operator+=(int v) { concat(String(v)); return *this; }
+    String& operator+=(unsigned int v) { concat(String(v)); return *this; }
+    String& operator+=(long v) { concat(String(v)); return *this; }
+    String& operator+=(unsigned long v) { concat(String(v)); return *this; }
+
+    friend String operator+(const String& a, const String& b);
+    friend String operator+(const String& a, const char* b);
+    friend String operator+(const char* a, const String& b);
+    friend String operator+(const String& a, char b);
+
+    bool equals(const char* s) const;
+    bool operator==(const String& s) const { return equals(s.c_str()); }
+    bool operator==(const char* s) const { return equals(s); }
+    bool operator!=(const String& s) const { return !equals(s.c_str()); }
+    bool operator!=(const char* s) const { return !equals(s); }
+    bool equalsIgnoreCase(const String& s) const;
+
+    char charAt(unsigned int i) const { return i < len_ ? buf_[i] : 0; }
+    char operator[](unsigned int i) const { return charAt(i); }
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const char* s, unsigned int from = 0) const;
+    bool startsWith(const char* s) const;
+    bool startsWith(const String& s) const { return startsWith(s.c_str()); }
+    bool endsWith(const char* s) const;
+    bool endsWith(const String& s) const { return endsWith(s.c_str()); }
+    String substring(unsigned int from) const { return substring(from, len_); }
+    String substring(unsigned int from, unsigned int to) const;
+    void replace(const char* find, const char* with);
+    void replace(char find, char with);
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+    long toInt() const;
+    float toFloat() const;
+
+private:
+    char* buf_;
+    unsigned int len_;
+    unsigned int cap_;
+};
+
+#endif // HOST_WSTRING_H
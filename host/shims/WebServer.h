@@ -0,0 +1,94 @@
+/*
+ * WebServer.h - Host stub of the ESP32 WebServer
+ * Handlers can be invoked directly with hostRequest(); the last response is
+ * kept for inspection unless keep_body is cleared (a real server streams it
+ * to the socket, so long runs that watch the heap only count its length).
+ */
+
+#ifndef HOST_WEBSERVER_H
+#define HOST_WEBSERVER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <functional>
+#include <map>
+#include <string>
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE, HTTP_OPTIONS };
+enum HTTPAuthMethod { BASIC_AUTH, DIGEST_AUTH };
+
+class WebServer {
+public:
+    typedef std::function<void(void)> THandlerFunction;
+
+    explicit WebServer(int port = 80) { (void)port; }
+    void begin() {}
+    void handleClient() { handle_calls++; }
+    void on(const String& uri, THandlerFunction fn) { routes_[uri.c_str()] = fn; }
+    void on(const String& uri, HTTPMethod m, THandlerFunction fn) { (void)m; routes_[uri.c_str()] = fn; }
+    void onNotFound(THandlerFunction fn) { not_found_ = fn; }
+
+    String arg(const String& name) {
+        auto it = args_.find(name.c_str());
+        return it == args_.end() ? String() : String(it->second.c_str());
+    }
+    bool hasArg(const String& name) { return args_.count(name.c_str()) > 0; }
+    String header(const String& name) { (void)name; return String(); }
+    String uri() { return String(uri_.c_str()); }
+    HTTPMethod method() { return method_; }
+    void requestAuthentication(HTTPAuthMethod m = BASIC_AUTH, const char* realm = nullptr,
+                               const String& failMsg = String("")) {
+        (void)m; (void)realm; (void)failMsg;
+        last_code = 401;
+    }
+
+    void sendHeader(const String& name, const String& value, bool first = false) {
+        (void)name; (void)value; (void)first;
+    }
+    void setContentLength(size_t len) { (void)len; }
+    void send(int code, const char* type = nullptr, const String& content = String()) {
+        (void)type;
+        last_code = code;
+        last_length = content.length();
+        if (keep_body) last_body = content;
+    }
+    void send(int code, const String& type, const String& content) { send(code, type.c_str(), content); }
+    void send_P(int code, const char* type, const char* content) { send(code, type, String(content)); }
+    void sendContent(const String& content) { sendContent(content.c_str(), content.length()); }
+    void sendContent(const char* content, size_t len) {
+        last_length += len;
+        if (keep_body) last_body.concat(content, (unsigned int)len);
+    }
+
+    // Host harness API
+    bool hostRequest(const char* uri, HTTPMethod m = HTTP_GET,
+                     const std::map<std::string, std::string>& args = {}) {
+        uri_ = uri;
+        method_ = m;
+        args_ = args;
+        last_body = String();
+        last_length = 0;
+        auto it = routes_.find(uri);
+        if (it != routes_.end()) { it->second(); return true; }
+        if (not_found_) not_found_();
+        return false;
+    }
+
+    int last_code = 0;
+    String last_body;
+    size_t last_length = 0;
+    bool keep_body = true;
+    uint32_t handle_calls = 0;
+
+private:
+    std::map<std::string, THandlerFunction> routes_;
+    THandlerFunction not_found_;
+    std::map<std::string, std::string> args_;
+    std::string uri_;
+    HTTPMethod method_ = HTTP_GET;
+};
+
+#endif // HOST_WEBSERVER_H
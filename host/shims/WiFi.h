@@ -0,0 +1,66 @@
+/*
+ * WiFi.h - Host stub of the ESP32 WiFi API
+ */
+
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include <Arduino.h>
+#include "IPAddress.h"
+
+typedef enum { WL_IDLE_STATUS = 0, WL_NO_SSID_AVAIL = 1, WL_CONNECTED = 3, WL_CONNECT_FAILED = 4,
+               WL_CONNECTION_LOST = 5, WL_DISCONNECTED = 6 } wl_status_t;
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } wifi_mode_t;
+typedef enum { WIFI_AUTH_OPEN = 0, WIFI_AUTH_WPA2_PSK = 3 } wifi_auth_mode_t;
+
+class WiFiClient {
+public:
+    virtual ~WiFiClient() {}
+    int connect(const char* host, uint16_t port) { (void)host; (void)port; return 0; }
+    void stop() {}
+    uint8_t connected() { return 0; }
+    void setTimeout(int t) { (void)t; }
+};
+
+class WiFiClass {
+public:
+    bool mode(wifi_mode_t m) { mode_ = m; return true; }
+    wifi_mode_t getMode() { return mode_; }
+    wl_status_t begin(const char* ssid, const char* pass = nullptr) {
+        (void)ssid; (void)pass;
+        begin_calls++;
+        status_ = connect_succeeds ? WL_CONNECTED : WL_DISCONNECTED;
+        return status_;
+    }
+    bool disconnect(bool off = false) { (void)off; status_ = WL_DISCONNECTED; return true; }
+    bool reconnect() { return true; }
+    bool setAutoReconnect(bool v) { (void)v; return true; }
+    wl_status_t status() { return status_; }
+    String SSID() { return String("host-ssid"); }
+    String SSID(uint8_t i) { (void)i; return String("net"); }
+    int32_t RSSI() { return -55; }
+    int32_t RSSI(uint8_t i) { (void)i; return -60; }
+    wifi_auth_mode_t encryptionType(uint8_t i) { (void)i; return WIFI_AUTH_WPA2_PSK; }
+    IPAddress localIP() { return IPAddress(192, 168, 1, 50); }
+    IPAddress softAPIP() { return IPAddress(192, 168, 4, 1); }
+    String macAddress() { return String("24:6F:28:AA:BB:CC"); }
+    uint8_t* macAddress(uint8_t* mac) { static const uint8_t m[6] = {0x24, 0x6F, 0x28, 0xAA, 0xBB, 0xCC}; memcpy(mac, m, 6); return mac; }
+    bool softAP(const char* ssid, const char* pass = nullptr) { (void)ssid; (void)pass; return true; }
+    bool softAPdisconnect(bool off = false) { (void)off; return true; }
+    int16_t scanNetworks(bool async = false) { (void)async; return 0; }
+    void scanDelete() {}
+    bool setSleep(bool v) { (void)v; return true; }
+
+    // Host harness state
+    bool connect_succeeds = true;
+    uint32_t begin_calls = 0;
+    void hostSetStatus(wl_status_t s) { status_ = s; }
+
+private:
+    wifi_mode_t mode_ = WIFI_OFF;
+    wl_status_t status_ = WL_DISCONNECTED;
+};
+
+extern WiFiClass WiFi;
+
+#endif // HOST_WIFI_H
@@ -0,0 +1,16 @@
+/*
+ * WiFiClientSecure.h - Host stub of the TLS client (never connects)
+ */
+
+#ifndef HOST_WIFICLIENTSECURE_H
+#define HOST_WIFICLIENTSECURE_H
+
+#include <WiFi.h>
+
+class WiFiClientSecure : public WiFiClient {
+public:
+    void setInsecure() {}
+    void setCACert(const char* cert) { (void)cert; }
+};
+
+#endif // HOST_WIFICLIENTSECURE_H
@@ -0,0 +1,42 @@
+/*
+ * esp_partition.h - Host shim for the ESP-IDF partition API
+ * The data partitions from partitions.csv ("journal", "capture") in memory,
+ * with NOR semantics: writes can only clear bits and erases work on whole
+ * 4 KB sectors.
+ */
+
+#ifndef HOST_ESP_PARTITION_H
+#define HOST_ESP_PARTITION_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_INVALID_ARG 0x102
+
+typedef enum { ESP_PARTITION_TYPE_APP = 0, ESP_PARTITION_TYPE_DATA = 1 } esp_partition_type_t;
+typedef int esp_partition_subtype_t;
+
+typedef struct {
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+} esp_partition_t;
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char* label);
+esp_err_t esp_partition_read(const esp_partition_t* p, size_t offset, void* dst, size_t size);
+esp_err_t esp_partition_write(const esp_partition_t* p, size_t offset, const void* src, size_t size);
+esp_err_t esp_partition_erase_range(const esp_partition_t* p, size_t offset, size_t size);
+
+// ============== Host Harness ==============
+// Also erases it
+void hostPartitionEnable(bool present, uint32_t size, const char* label = "journal");
+uint32_t hostPartitionErases(const char* label = "journal");
+uint8_t* hostPartitionData(const char* label = "journal");
+
+#endif // HOST_ESP_PARTITION_H
@@ -0,0 +1,15 @@
+/*
+ * esp_random.h - Host shim for the ESP32 hardware RNG
+ * Draws from the seeded Arduino random() so host runs are reproducible.
+ */
+
+#ifndef HOST_ESP_RANDOM_H
+#define HOST_ESP_RANDOM_H
+
+#include <Arduino.h>
+
+static inline uint32_t esp_random() {
+    return (uint32_t)random(0x7fffffff) ^ ((uint32_t)random(0xffff) << 16);
+}
+
+#endif // HOST_ESP_RANDOM_H
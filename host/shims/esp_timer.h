@@ -0,0 +1,15 @@
+/*
+ * esp_timer.h - Host shim for the ESP32 high-resolution timer
+ * Microseconds on the host clock, 64 bits wide like the hardware timer.
+ */
+
+#ifndef HOST_ESP_TIMER_H
+#define HOST_ESP_TIMER_H
+
+#include <Arduino.h>
+
+static inline int64_t esp_timer_get_time() {
+    return (int64_t)hostMicros64();
+}
+
+#endif // HOST_ESP_TIMER_H
@@ -0,0 +1,42 @@
+/*
+ * FreeRTOS.h - Host shim for the FreeRTOS base types
+ * One tick is one millisecond, as configured on the ESP32.
+ */
+
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define configTICK_RATE_HZ 1000
+
+// Critical sections: a spinlock, as between the two ESP32 cores
+typedef struct {
+    volatile bool locked;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {false}
+
+static inline void hostEnterCritical(portMUX_TYPE* mux) {
+    while (__atomic_test_and_set(&mux->locked, __ATOMIC_ACQUIRE)) {
+    }
+}
+
+static inline void hostExitCritical(portMUX_TYPE* mux) {
+    __atomic_clear(&mux->locked, __ATOMIC_RELEASE);
+}
+
+#define portENTER_CRITICAL(mux) hostEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) hostExitCritical(mux)
+
+#endif // HOST_FREERTOS_H
@@ -0,0 +1,30 @@
+/*
+ * task.h - Host shim for FreeRTOS tasks and task notifications
+ * Tasks run on std::thread. The thread that calls setup()/loop() is the
+ * loop task on core 1; created tasks report the core they were pinned to.
+ */
+
+#ifndef HOST_FREERTOS_TASK_H
+#define HOST_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount();
+TaskHandle_t xTaskGetCurrentTaskHandle();
+BaseType_t xPortGetCoreID();
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core);
+
+// ============== Task Notifications ==============
+// Waiting advances the virtual clock one tick at a time, so a blocked task
+// still lets simulated time pass
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken);
+#define portYIELD_FROM_ISR(...) ((void)0)
+
+#endif // HOST_FREERTOS_TASK_H
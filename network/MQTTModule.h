@@ -29,12 +29,13 @@ void disconnectMQTT();
 bool isMQTTConnected();
 bool testMQTTConnection(const char *server, uint16_t port, const char *username,
                         const char *password);
-void publishDeviceData(Device *dev, JsonDocument &doc, int rssi);
+void publishDeviceData(Device *dev, const DeviceReading &r);
 void publishHomeAssistantDiscovery(Device *dev, const char *deviceId);
 void removeDeviceFromMQTT(const char *deviceId);
 void publishBridgeStatus(bool online);
 void publishBridgeDiagnostics();
 void publishBridgeDiagnosticsIfChanged();  // Rate-limited version
+void publishBootTimeline();
 void publishGatewayDiscovery();
 
 #endif
@@ -12,9 +12,6 @@
 // ============== Global Objects ==============
 extern WebServer webServer;
 
-// ============== Activity Logging ==============
-void logActivity(const char* deviceName, const char* message);
-
 // ============== Authentication ==============
 bool authenticateRequest();
 void requireAuth();
@@ -35,9 +32,22 @@ void handleSetSensorType();
 void handleHardwareSettings();
 void handleClearActivity();
 void handleRemoveActivity();
+void handleActivity();
+void handleJournal();
+void handleCapture();
+void handleCaptureDownload();
 void handleAuthSettings();
 void handleMQTTSettings();
 void handleMQTTTest();
+void handleLoopStats();
+void handleNoiseStats();
+void handleAdr();
+void handleRxSchedule();
+void handleHeapStats();
+void handlePipeline();
+void handleEventBus();
+void handleScheduler();
+void handleMetrics();
 void handleNotFound();
 
 #endif // WEBSERVER_MODULE_H
@@ -15,10 +15,20 @@ extern DNSServer dnsServer;
 
 // ============== Mode Flags ==============
 extern bool ap_mode;
+extern bool wifi_connect_pending;   // Background connect in progress (fast boot)
+
+// Result of polling a background connect
+enum WiFiConnectState : uint8_t {
+    WIFI_CONNECT_PENDING = 0,
+    WIFI_CONNECT_OK,
+    WIFI_CONNECT_FAILED
+};
 
 // ============== WiFi Functions ==============
 bool connectWiFi();
+void beginWiFi();
+WiFiConnectState pollWiFiConnect();
 void startAPMode();
-bool attemptWiFiReconnect();
+bool attemptWiFiReconnect();        // Blocks up to 10 s
 
 #endif // WIFI_MODULE_H